@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "include/modules/dropouts.h"
 #include "include/modules/compander.h"
 
@@ -7,7 +9,8 @@ struct DSPContext {
     /** Parameters surfaced to the host at process time. */
     struct Parameters {
         float dropoutRatePerMin = 0.0f;
-        bool nrTrack4Bypass = false;
+        /** Noise-reduction bypass per track: bit n bypasses track n. */
+        uint64_t nrBypassMask = 0;
     };
 
     /** Configure all submodules before processing. */
@@ -35,12 +38,25 @@ struct DSPContext {
         }
 
         dropouts_.setRate(parameters.dropoutRatePerMin);
-        compander_.setTrackBypass(3, parameters.nrTrack4Bypass);
+        compander_.setBypassMask(parameters.nrBypassMask);
 
         dropouts_.process(interleaved, frames, channels);
         compander_.process(interleaved, frames, channels);
     }
 
+    /**
+     * Position the dropout schedule at absolute frame `position` for the given
+     * parameters. The compander has only short-lived state and is expected to
+     * settle during a pre-roll instead.
+     */
+    void seek(int64_t position, const Parameters& parameters) {
+        dropouts_.setRate(parameters.dropoutRatePerMin);
+        dropouts_.seek(position);
+    }
+
+    /** Update the noise-reduction gain once per few frames rather than every sample; see Compander. */
+    void setControlRateGain(bool enabled) { compander_.setControlRateGain(enabled); }
+
     int dropoutCount() const { return dropouts_.dropoutCount(); }
 
 private:
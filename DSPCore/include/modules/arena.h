@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * One cache-line-aligned block that a DSP instance carves all of its state
+ * from. Allocation bumps an offset, and every allocation starts on its own
+ * cache line so slices rendered on different cores never share one. Freeing
+ * is a no-op, except that the most recent allocation is rolled back so a
+ * buffer that is reallocated straight away does not strand its old storage.
+ *
+ * When the block is full, or none was given, requests fall back to the heap
+ * and are counted. The arena therefore never fails, and building an instance
+ * over an empty arena measures the exact block size to reserve next time.
+ */
+class Arena {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    /** An arena without a block: everything goes to the heap and is measured. */
+    Arena() = default;
+    Arena(void* block, std::size_t capacity)
+        : base_(static_cast<unsigned char*>(block)), capacity_(capacity) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    static std::size_t roundUp(std::size_t bytes) {
+        return (std::max<std::size_t>(bytes, 1) + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    static void* allocateBlock(std::size_t bytes) {
+        return ::operator new(roundUp(bytes), std::align_val_t{kAlignment});
+    }
+    static void freeBlock(void* block) { ::operator delete(block, std::align_val_t{kAlignment}); }
+
+    void* allocate(std::size_t bytes) {
+        const std::size_t size = roundUp(bytes);
+        void* p = nullptr;
+        if (base_ && used_ + size <= capacity_) {
+            p = base_ + used_;
+        } else {
+            p = ::operator new(size, std::align_val_t{kAlignment});
+            heapBytes_.fetch_add(size, std::memory_order_relaxed);
+        }
+        // The offset advances in measuring mode too, so peak() predicts the
+        // block a real arena needs for the same sequence of requests.
+        used_ += size;
+        peak_ = std::max(peak_, used_);
+        last_ = p;
+        lastSize_ = size;
+        return p;
+    }
+
+    void deallocate(void* p, std::size_t bytes) {
+        const std::size_t size = roundUp(bytes);
+        if (p == last_ && size == lastSize_) {
+            used_ -= size;
+            last_ = nullptr;
+        }
+        if (!owns(p)) {
+            heapBytes_.fetch_sub(size, std::memory_order_relaxed);
+            ::operator delete(p, std::align_val_t{kAlignment});
+        }
+    }
+
+    bool owns(const void* p) const {
+        const auto* bytes = static_cast<const unsigned char*>(p);
+        return base_ && bytes >= base_ && bytes < base_ + capacity_;
+    }
+
+    std::size_t capacity() const { return capacity_; }
+    /** Largest offset reached so far, i.e. the block size these requests need. */
+    std::size_t peak() const { return peak_; }
+    /** Bytes currently held on the heap because the block was full. */
+    std::size_t heapBytes() const { return heapBytes_.load(std::memory_order_relaxed); }
+
+    /** Arena that containers constructed on this thread allocate from. */
+    static Arena*& current() {
+        thread_local Arena* arena = nullptr;
+        return arena;
+    }
+
+private:
+    unsigned char* base_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t used_ = 0;
+    std::size_t peak_ = 0;
+    std::atomic<std::size_t> heapBytes_{0}; // read by footprint queries off the audio thread
+    void* last_ = nullptr;
+    std::size_t lastSize_ = 0;
+};
+
+/** Makes `arena` current on this thread for the lifetime of the scope. */
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena* arena) : previous_(Arena::current()) { Arena::current() = arena; }
+    ~ArenaScope() { Arena::current() = previous_; }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* previous_;
+};
+
+/**
+ * Allocator that binds to the current arena when the container is
+ * constructed. Outside an ArenaScope it is a plain heap allocator, so modules
+ * used on their own behave exactly as with std::allocator.
+ */
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept : arena(Arena::current()) {}
+    explicit ArenaAllocator(Arena* owner) noexcept : arena(owner) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    // Copies bind to whatever arena is current where they are made.
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    T* allocate(std::size_t n) {
+        static_assert(alignof(T) <= Arena::kAlignment, "ArenaAllocator cannot over-align");
+        if (!arena) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        if (!arena) {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+        arena->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+    Arena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -2,15 +2,38 @@
 
 #include <algorithm>
 #include <cmath>
-#include <vector>
-
-/** Stereo azimuth misalignment emulator using an LFO-driven delay offset. */
+#include <cstdint>
+
+#include "arena.h"
+
+/**
+ * Stereo azimuth misalignment emulator using an LFO-driven delay offset. Both
+ * channels swing in opposite directions around a common, whole-sample centre
+ * delay (the base offset plus the jitter depth), which is the latency the
+ * stage reports.
+ *
+ * At control rate the jitter LFO is evaluated every kControlInterval samples
+ * and interpolated linearly in between; the control points lie on the
+ * per-sample trajectory, so switching rate is continuous.
+ *
+ * The delay lines are exactly as long as the base offset plus the larger of
+ * the jitter depth and the depth reserved in prepare() need. A change to that
+ * length reallocates them on the calling thread and keeps their most recent
+ * contents. The centre glides to its new position instead of jumping, so
+ * depth changes do not click.
+ */
 class Azimuth {
 public:
-    void prepare(float newSampleRate, int maxBlockSize)
+    /**
+     * Size the delay lines for blocks of up to `maxBlockSize` and jitter depths
+     * of up to `reservedJitterDepthSamples`, so depth changes within it never
+     * reallocate. Preparing again with the same arguments keeps the buffers.
+     */
+    void prepare(float newSampleRate, int maxBlockSize, float reservedJitterDepthSamples = 0.0f)
     {
         sampleRate = newSampleRate;
         reservedBlockSize = maxBlockSize;
+        reservedJitterSamples = std::max(0.0f, reservedJitterDepthSamples);
         updateBuffers();
         updateLfoIncrement();
     }
@@ -33,6 +56,49 @@ public:
         updateLfoIncrement();
     }
 
+    int latencySamples() const { return latencyForOffsets(baseOffsetSamples, jitterDepthSamples); }
+
+    static int latencyForOffsets(float baseOffset, float jitterDepth)
+    {
+        return static_cast<int>(std::ceil(std::max(0.0f, baseOffset) + std::max(0.0f, jitterDepth)));
+    }
+
+    /** Start the jitter LFO at `radians`, e.g. to decorrelate track pairs. */
+    void setLfoPhase(float radians)
+    {
+        lfoStartPhase = std::fmod(static_cast<double>(std::max(0.0f, radians)), static_cast<double>(twoPi));
+        lfoPhase = lfoStartPhase;
+    }
+
+    void setControlRate(bool enabled)
+    {
+        controlRate = enabled;
+        controlCountdown = 0;
+    }
+
+    bool isControlRate() const { return controlRate; }
+
+    /** Clear the delay lines and return the LFO to its start phase. */
+    void reset()
+    {
+        seek(0);
+    }
+
+    /**
+     * Clear the delay lines and move the LFO to where it would be `position`
+     * samples after its start phase.
+     */
+    void seek(int64_t position)
+    {
+        for (auto& buffer : delayBuffers)
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+        writeIndex = 0;
+        const double advanced = lfoStartPhase + static_cast<double>(std::max<int64_t>(position, 0)) * lfoPhaseIncrement;
+        lfoPhase = std::fmod(advanced, static_cast<double>(twoPi));
+        controlCountdown = 0;
+        centreDelay = -1.0f;
+    }
+
     void process(float* left, float* right, int numSamples)
     {
         if (left == nullptr || right == nullptr || numSamples <= 0)
@@ -41,23 +107,23 @@ public:
         if (delayBufferSize == 0)
             return;
 
+        const float centreTarget = static_cast<float>(latencySamples());
         for (int i = 0; i < numSamples; ++i) {
-            const float lfo = std::sin(lfoPhase);
+            const float centre = nextCentre(centreTarget);
+            const float lfo = controlRate ? nextControlLfo() : std::sin(static_cast<float>(lfoPhase));
             lfoPhase += lfoPhaseIncrement;
             if (lfoPhase > twoPi)
                 lfoPhase -= twoPi;
 
-            const float offsetLeft = baseOffsetSamples + jitterDepthSamples * lfo;
-            const float offsetRight = baseOffsetSamples - jitterDepthSamples * lfo;
-
-            const float outLeft = readInterpolated(0, offsetLeft);
-            const float outRight = readInterpolated(1, offsetRight);
+            const float offsetLeft = centre + jitterDepthSamples * lfo;
+            const float offsetRight = centre - jitterDepthSamples * lfo;
 
+            // Write first so that a zero offset passes the current sample.
             writeSample(0, left[i]);
             writeSample(1, right[i]);
 
-            left[i] = outLeft;
-            right[i] = outRight;
+            left[i] = readInterpolated(0, offsetLeft);
+            right[i] = readInterpolated(1, offsetRight);
 
             advanceWriteIndex();
         }
@@ -66,25 +132,60 @@ public:
 private:
     void updateBuffers()
     {
-        const int delay = static_cast<int>(std::ceil(baseOffsetSamples + jitterDepthSamples)) + 4;
+        const float depth = std::max(jitterDepthSamples, reservedJitterSamples);
+        const int delay = latencyForOffsets(baseOffsetSamples, depth) + static_cast<int>(std::ceil(depth)) + 4;
         const int newSize = std::max(reservedBlockSize + delay, delay);
-        if (newSize == delayBufferSize && delayBufferSize != 0)
+        if (newSize == delayBufferSize)
             return;
 
-        delayBufferSize = newSize;
-        for (auto& buffer : delayBuffers)
-            buffer.assign(delayBufferSize, 0.0f);
+        // Unroll the most recent history to end just behind a write index of
+        // zero, as after a reset, so the delays read back the same samples;
+        // any new space before it is silence.
+        const int kept = std::min(newSize, delayBufferSize);
+        for (auto& buffer : delayBuffers) {
+            ArenaVector<float> resized(newSize, 0.0f, buffer.get_allocator());
+            for (int i = 0; i < kept; ++i)
+                resized[newSize - kept + i] = buffer[(writeIndex + delayBufferSize - kept + i) % delayBufferSize];
+            buffer.swap(resized);
+        }
         writeIndex = 0;
+        delayBufferSize = newSize;
     }
 
     void updateLfoIncrement()
     {
         if (sampleRate <= 0.0f) {
-            lfoPhaseIncrement = 0.0f;
+            lfoPhaseIncrement = 0.0;
             return;
         }
 
-        lfoPhaseIncrement = twoPi * jitterRateHz / sampleRate;
+        lfoPhaseIncrement = static_cast<double>(twoPi) * jitterRateHz / sampleRate;
+    }
+
+    /** The centre delay for this sample, gliding towards `target` (snapping after a reset). */
+    float nextCentre(float target)
+    {
+        if (centreDelay < 0.0f) {
+            centreDelay = target;
+        } else if (centreDelay != target) {
+            centreDelay += std::clamp(target - centreDelay, -kCentreGlidePerSample, kCentreGlidePerSample);
+        }
+        return centreDelay;
+    }
+
+    /** The LFO at the current phase, exact at control points and interpolated between them. */
+    float nextControlLfo()
+    {
+        if (controlCountdown > 0) {
+            --controlCountdown;
+            controlValue += controlStep;
+            return controlValue;
+        }
+        controlValue = std::sin(static_cast<float>(lfoPhase));
+        const float end = std::sin(static_cast<float>(lfoPhase + kControlInterval * lfoPhaseIncrement));
+        controlStep = (end - controlValue) / static_cast<float>(kControlInterval);
+        controlCountdown = kControlInterval - 1;
+        return controlValue;
     }
 
     float readInterpolated(int channel, float delaySamples) const
@@ -121,6 +222,10 @@ private:
     }
 
     static constexpr float twoPi = 6.283185307179586476925286766559f;
+    static constexpr int kControlInterval = 32;
+    // Largest change of the centre delay per sample, as in WowFlutter: a
+    // brief 1% speed change instead of a click.
+    static constexpr float kCentreGlidePerSample = 0.01f;
 
     float sampleRate { 0.0f };
     int reservedBlockSize { 0 };
@@ -128,11 +233,21 @@ private:
     float baseOffsetSamples { 0.0f };
     float jitterDepthSamples { 0.05f };
     float jitterRateHz { 0.3f };
+    float reservedJitterSamples { 0.0f };
+    float centreDelay { -1.0f }; // negative until the first sample snaps it to the target
+
+    // Double precision keeps long runs of per-sample increments on the
+    // closed-form trajectory used by seek().
+    double lfoStartPhase { 0.0 };
+    double lfoPhase { 0.0 };
+    double lfoPhaseIncrement { 0.0 };
 
-    float lfoPhase { 0.0f };
-    float lfoPhaseIncrement { 0.0f };
+    bool controlRate { false };
+    int controlCountdown { 0 };
+    float controlValue { 0.0f };
+    float controlStep { 0.0f };
 
     int delayBufferSize { 0 };
     int writeIndex { 0 };
-    std::vector<float> delayBuffers[2];
+    ArenaVector<float> delayBuffers[2];
 };
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <cmath>
 
+#include "frequency_response.h"
+
 /**
  * Simple biquad (second-order IIR) filter implementation used by several tape
  * processing modules. The class exposes coefficient design helpers for the
@@ -29,6 +31,18 @@ public:
         return output;
     }
 
+    /** Current coefficients, for FrequencyResponse. */
+    BiquadCoefficients coefficients() const { return {b0_, b1_, b2_, a1_, a2_}; }
+
+    /** Take `other`'s coefficients but keep this filter's state, so a retune does not click. */
+    void setCoefficients(const Biquad& other) {
+        b0_ = other.b0_;
+        b1_ = other.b1_;
+        b2_ = other.b2_;
+        a1_ = other.a1_;
+        a2_ = other.a2_;
+    }
+
     /** Design and apply a low-shelf filter. */
     void setLowShelf(float sampleRate, float frequency, float gainDb, float q = 0.7071f) {
         computeShelf(sampleRate, frequency, gainDb, q, /*highShelf=*/false);
@@ -42,7 +56,7 @@ public:
     /** Design and apply a peaking EQ filter. */
     void setPeaking(float sampleRate, float frequency, float gainDb, float q) {
         const float fs = std::max(sampleRate, 1.0f);
-        const float A = dbToLinear(gainDb);
+        const float A = amplitude(gainDb);
         const float w0 = 2.0f * static_cast<float>(M_PI) * clampFrequency(frequency, fs);
         const float alpha = std::sin(w0) / (2.0f * std::max(q, 1.0e-6f));
         const float cosw0 = std::cos(w0);
@@ -86,16 +100,19 @@ private:
     float z1_{0.0f};
     float z2_{0.0f};
 
-    static float dbToLinear(float db) { return std::pow(10.0f, db / 20.0f); }
+    // The cookbook's A: the square root of the linear gain, so the shelf
+    // plateau or bell centre lands at `db`.
+    static float amplitude(float db) { return std::pow(10.0f, db / 40.0f); }
 
+    // Normalised frequency (cycles per sample), kept below Nyquist.
     static float clampFrequency(float frequency, float sampleRate) {
         const float nyquist = 0.5f * sampleRate;
-        return std::clamp(frequency, 0.0f, nyquist);
+        return std::clamp(frequency, 0.0f, nyquist) / sampleRate;
     }
 
     void computeShelf(float sampleRate, float frequency, float gainDb, float q, bool highShelf) {
         const float fs = std::max(sampleRate, 1.0f);
-        const float A = dbToLinear(gainDb);
+        const float A = amplitude(gainDb);
         const float w0 = 2.0f * static_cast<float>(M_PI) * clampFrequency(frequency, fs);
         const float alpha = std::sin(w0) / (2.0f * std::max(q, 1.0e-6f));
         const float cosw0 = std::cos(w0);
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * Always-on timing of the render callback: how long each call takes as a
+ * fraction of its real-time budget (frames / sample rate), in a histogram
+ * with four buckets per octave of load, plus deadline misses and the worst
+ * call. Recording costs two clock reads and a handful of relaxed stores.
+ *
+ * One thread records (the render thread); any thread may read. Each
+ * counter is its own atomic with a single writer, so recording needs no
+ * read-modify-write instructions and reading needs no lock. A read taken
+ * while a call is being recorded may see some counters before it and some
+ * after.
+ */
+class CallbackTiming {
+public:
+    static constexpr int kBuckets = 32;
+    static constexpr int kBucketsPerOctave = 4;
+    /** First bucket at or over budget: bucket b starts at load 2^((b - kUnityBucket) / 4). */
+    static constexpr int kUnityBucket = 24;
+
+    struct Snapshot {
+        uint64_t calls = 0;
+        uint64_t overruns = 0;
+        uint64_t busyNanos = 0;
+        uint64_t budgetNanos = 0;
+        float maxLoad = 0.0f;
+        float lastLoad = 0.0f;
+        uint64_t histogram[kBuckets] = {};
+    };
+
+    /** Lowest load bucket `b` holds; the first and last buckets also take everything below and above. */
+    static float bucketFloor(int bucket) {
+        return std::exp2(static_cast<float>(bucket - kUnityBucket) / static_cast<float>(kBucketsPerOctave));
+    }
+
+    static int bucketFor(float load) {
+        if (!(load > 0.0f)) {
+            return 0;
+        }
+        int exponent = 0;
+        const float mantissa = std::frexp(load, &exponent); // load = mantissa * 2^exponent, mantissa in [0.5, 1)
+        // Quarter-octave steps within [0.5, 1): 2^-0.75, 2^-0.5, 2^-0.25.
+        const int quarter = (mantissa >= 0.59460356f) + (mantissa >= 0.70710678f) + (mantissa >= 0.84089642f);
+        const int bucket = (exponent - 1) * kBucketsPerOctave + quarter + kUnityBucket;
+        return bucket < 0 ? 0 : (bucket >= kBuckets ? kBuckets - 1 : bucket);
+    }
+
+    /** Render thread: one call that took `nanos` against a budget of `budgetNanos`. */
+    void record(uint64_t nanos, uint64_t budgetNanos) {
+        const float load = budgetNanos > 0 ? static_cast<float>(nanos) / static_cast<float>(budgetNanos) : 0.0f;
+        bump(histogram_[bucketFor(load)], 1);
+        bump(calls_, 1);
+        bump(busyNanos_, nanos);
+        bump(budgetNanos_, budgetNanos);
+        if (nanos > budgetNanos) {
+            bump(overruns_, 1);
+        }
+        lastLoad_.store(load, std::memory_order_relaxed);
+        if (load > maxLoad_.load(std::memory_order_relaxed)) {
+            maxLoad_.store(load, std::memory_order_relaxed);
+        }
+    }
+
+    Snapshot read() const {
+        Snapshot s;
+        s.calls = calls_.load(std::memory_order_relaxed);
+        s.overruns = overruns_.load(std::memory_order_relaxed);
+        s.busyNanos = busyNanos_.load(std::memory_order_relaxed);
+        s.budgetNanos = budgetNanos_.load(std::memory_order_relaxed);
+        s.maxLoad = maxLoad_.load(std::memory_order_relaxed);
+        s.lastLoad = lastLoad_.load(std::memory_order_relaxed);
+        for (int b = 0; b < kBuckets; ++b) {
+            s.histogram[b] = histogram_[b].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    /** Start counting afresh. Only while nothing records, e.g. when a pooled handle is handed out again. */
+    void reset() {
+        for (auto* counter : {&calls_, &overruns_, &busyNanos_, &budgetNanos_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        for (auto& bucket : histogram_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        maxLoad_.store(0.0f, std::memory_order_relaxed);
+        lastLoad_.store(0.0f, std::memory_order_relaxed);
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> busyNanos_{0};
+    std::atomic<uint64_t> budgetNanos_{0};
+    std::atomic<float> maxLoad_{0.0f};
+    std::atomic<float> lastLoad_{0.0f};
+    std::atomic<uint64_t> histogram_[kBuckets] = {};
+};
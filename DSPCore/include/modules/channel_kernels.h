@@ -0,0 +1,36 @@
+#pragma once
+
+#include <type_traits>
+
+/**
+ * Per-frame loops over interleaved tracks are compiled for the common widths
+ * 1, 2, 4 and 8, where the inner loop over a frame's tracks has a constant
+ * trip count the compiler can unroll and vectorise, plus a generic kernel
+ * (width 0) that reads the channel count at run time.
+ */
+template <int Width>
+constexpr int kernelLanes(int channels) {
+    return Width > 0 ? Width : channels;
+}
+
+/**
+ * Returns `make(std::integral_constant<int, W>{})` for the specialised width
+ * matching `channels`, or with W = 0 for any other count. Modules call this
+ * when their channel count changes and keep the result, so the dispatch is
+ * not repeated per block.
+ */
+template <typename Make>
+auto selectChannelKernel(int channels, Make make) {
+    switch (channels) {
+    case 1:
+        return make(std::integral_constant<int, 1>{});
+    case 2:
+        return make(std::integral_constant<int, 2>{});
+    case 4:
+        return make(std::integral_constant<int, 4>{});
+    case 8:
+        return make(std::integral_constant<int, 8>{});
+    default:
+        return make(std::integral_constant<int, 0>{});
+    }
+}
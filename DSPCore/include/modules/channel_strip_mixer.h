@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+#include "eq.h"
+
+/** Knob and switch positions of one channel strip, normalised as on the console (0...1, 0.5 = centre). */
+struct ChannelStripSettings {
+    float trim = 0.5f;
+    float hiEQ = 0.5f;
+    float midEQ = 0.5f;
+    float loEQ = 0.5f;
+    float aux1 = 0.0f;
+    float aux2 = 0.0f;
+    float tapeCue = 0.0f;
+    float pan = 0.5f;
+    float fader = 0.75f;
+    bool mute = false;
+    bool assignL = true;
+    bool assignR = true;
+
+    bool operator==(const ChannelStripSettings& o) const {
+        return trim == o.trim && hiEQ == o.hiEQ && midEQ == o.midEQ && loEQ == o.loEQ && aux1 == o.aux1 &&
+               aux2 == o.aux2 && tapeCue == o.tapeCue && pan == o.pan && fader == o.fader && mute == o.mute &&
+               assignL == o.assignL && assignR == o.assignR;
+    }
+    bool operator!=(const ChannelStripSettings& o) const { return !(*this == o); }
+};
+
+/** Planar mix buses a ChannelStripMixer block is written to. Null buses are skipped. */
+struct MixerBuses {
+    float* groupL = nullptr;
+    float* groupR = nullptr;
+    float* fx1 = nullptr; // mono send
+    float* fx2 = nullptr; // mono send
+    float* cueL = nullptr;
+    float* cueR = nullptr;
+};
+
+/** A strip's source: frame i, channel c at samples[i * stride + c]. Null is silence. */
+struct StripInput {
+    const float* samples = nullptr;
+    int stride = 1;
+};
+
+/**
+ * Every channel strip of the console in one pass: trim, three-band EQ, the
+ * pre-fader aux and cue sends, and fader, pan and group assign onto the L/R
+ * group buses. It replaces a graph of per-strip mixer nodes, each with its
+ * own pull and buffer copy, with one loop per strip that reads its source
+ * once and accumulates into planar buses.
+ *
+ * The mapping follows the console: trim spans -60...0 dB; low shelf 100 Hz
+ * and high shelf 10 kHz at ±12 dB, mid bell 1 kHz one octave wide at ±9 dB.
+ * A mono strip pans with a constant-power law, a stereo strip balances. Gain
+ * changes ramp across the block that picks them up, and EQ changes retune
+ * without clearing the filters, so knob moves do not click. Only prepare()
+ * allocates.
+ */
+class ChannelStripMixer {
+public:
+    static constexpr int kMaxStrips = 8;
+
+    /** `stripChannels[s]` is 1 or 2. */
+    void prepare(float sampleRate, int maxFrames, const int* stripChannels, int strips) {
+        maxFrames_ = std::max(maxFrames, 1);
+        strips_.clear();
+        strips_.resize(static_cast<size_t>(std::clamp(strips, 0, kMaxStrips)));
+        for (size_t s = 0; s < strips_.size(); ++s) {
+            Strip& strip = strips_[s];
+            strip.channels = stripChannels && stripChannels[s] == 2 ? 2 : 1;
+            strip.eq.prepare(sampleRate, maxFrames_);
+            strip.eq.setLowFrequency(100.0f);
+            strip.eq.setMidFrequency(1000.0f);
+            strip.eq.setMidQ(1.4142f); // one octave
+            strip.eq.setHighFrequency(10000.0f);
+            strip.direct.assign(static_cast<size_t>(maxFrames_), 0.0f);
+            strip.target = gainsFor(strip.settings, strip.channels);
+            strip.current = strip.target;
+        }
+        scratch_.assign(static_cast<size_t>(maxFrames_) * 3, 0.0f);
+    }
+
+    /** Clear the EQ state and jump to the target gains. */
+    void reset() {
+        for (Strip& strip : strips_) {
+            strip.eq.reset();
+            strip.current = strip.target;
+            strip.peak = 0.0f;
+        }
+    }
+
+    int strips() const { return static_cast<int>(strips_.size()); }
+    int maxFrames() const { return maxFrames_; }
+    int channels(int strip) const { return strips_[static_cast<size_t>(strip)].channels; }
+    const ChannelStripSettings& settings(int strip) const { return strips_[static_cast<size_t>(strip)].settings; }
+
+    /** Takes effect from the next process(); cheap when nothing changed. */
+    void setStrip(int index, const ChannelStripSettings& settings) {
+        if (index < 0 || index >= strips()) {
+            return;
+        }
+        Strip& strip = strips_[static_cast<size_t>(index)];
+        if (settings == strip.settings) {
+            return;
+        }
+        if (settings.loEQ != strip.settings.loEQ || settings.midEQ != strip.settings.midEQ ||
+            settings.hiEQ != strip.settings.hiEQ) {
+            strip.eq.setGainsDb((settings.loEQ - 0.5f) * 24.0f, (settings.midEQ - 0.5f) * 18.0f,
+                                (settings.hiEQ - 0.5f) * 24.0f);
+        }
+        strip.settings = settings;
+        strip.target = gainsFor(settings, strip.channels);
+    }
+
+    /**
+     * Mix `frames` frames (at most maxFrames()) of every strip's source into
+     * `buses`, which are overwritten.
+     */
+    void process(const StripInput* inputs, int frames, const MixerBuses& buses) {
+        frames = std::clamp(frames, 0, maxFrames_);
+        for (float* bus : {buses.groupL, buses.groupR, buses.fx1, buses.fx2, buses.cueL, buses.cueR}) {
+            if (bus) {
+                std::fill(bus, bus + frames, 0.0f);
+            }
+        }
+        if (frames == 0) {
+            return;
+        }
+        const float ramp = 1.0f / static_cast<float>(frames);
+        for (size_t s = 0; s < strips_.size(); ++s) {
+            Strip& strip = strips_[s];
+            const Gains from = strip.current;
+            const Gains step = (strip.target - from) * ramp;
+            const StripInput input = inputs ? inputs[s] : StripInput{};
+
+            // Trimmed source, interleaved as the EQ expects, then the EQ in place.
+            float* x = scratch_.data();
+            const int channels = strip.channels;
+            const int count = frames * channels;
+            if (input.samples) {
+                const int stride = std::max(input.stride, channels);
+                for (int i = 0; i < frames; ++i) {
+                    const float trim = from.trim + step.trim * static_cast<float>(i + 1);
+                    for (int c = 0; c < channels; ++c) {
+                        x[i * channels + c] = input.samples[static_cast<size_t>(i) * static_cast<size_t>(stride) +
+                                                            static_cast<size_t>(c)] *
+                                              trim;
+                    }
+                }
+            } else {
+                std::fill(x, x + count, 0.0f);
+            }
+            strip.eq.processBlock(x, frames, channels);
+
+            float peak = 0.0f;
+            if (channels == 1) {
+                std::copy(x, x + frames, strip.direct.data());
+                peak = mixMono(x, frames, from, step, buses);
+            } else {
+                peak = mixStereo(x, frames, from, step, buses, strip.direct.data());
+            }
+            strip.peak = peak * strip.target.level;
+            strip.current = strip.target;
+        }
+    }
+
+    /** Post-EQ, pre-fader signal of `strip` from the last block (stereo strips summed), for direct recording. */
+    const float* direct(int strip) const { return strips_[static_cast<size_t>(strip)].direct.data(); }
+
+    /** Post-fader peak of `strip` over the last block. */
+    float peak(int strip) const { return strips_[static_cast<size_t>(strip)].peak; }
+
+private:
+    // Linear gains behind one settings snapshot; ramped as a unit.
+    struct Gains {
+        float trim = 1.0f;
+        float left = 0.0f;  // mono: source to group L; stereo: left channel to group L
+        float right = 0.0f; // mono: source to group R; stereo: right channel to group R
+        float fx1 = 0.0f;
+        float fx2 = 0.0f;
+        float cue = 0.0f;
+        float level = 0.0f; // fader after mute, for the meter
+
+        Gains operator-(const Gains& o) const {
+            return {trim - o.trim, left - o.left, right - o.right, fx1 - o.fx1, fx2 - o.fx2, cue - o.cue, level - o.level};
+        }
+        Gains operator*(float k) const { return {trim * k, left * k, right * k, fx1 * k, fx2 * k, cue * k, level * k}; }
+    };
+
+    struct Strip {
+        int channels = 1;
+        EQ eq;
+        ChannelStripSettings settings;
+        Gains current;
+        Gains target;
+        std::vector<float> direct;
+        float peak = 0.0f;
+    };
+
+    static Gains gainsFor(const ChannelStripSettings& s, int channels) {
+        Gains g;
+        g.trim = std::pow(10.0f, -60.0f * (1.0f - std::clamp(s.trim, 0.0f, 1.0f)) / 20.0f);
+        g.level = s.mute ? 0.0f : std::max(s.fader, 0.0f);
+        const float pan = std::clamp(s.pan, 0.0f, 1.0f);
+        float panL = 0.0f;
+        float panR = 0.0f;
+        if (channels == 1) {
+            const float theta = pan * 1.5707963f;
+            panL = std::cos(theta);
+            panR = std::sin(theta);
+        } else {
+            panL = std::min(1.0f, 2.0f * (1.0f - pan));
+            panR = std::min(1.0f, 2.0f * pan);
+        }
+        g.left = s.assignL ? g.level * panL : 0.0f;
+        g.right = s.assignR ? g.level * panR : 0.0f;
+        g.fx1 = std::max(s.aux1, 0.0f);
+        g.fx2 = std::max(s.aux2, 0.0f);
+        g.cue = std::max(s.tapeCue, 0.0f);
+        return g;
+    }
+
+    // Each bus is its own loop over contiguous memory with the gain ramp as a
+    // function of the index, so the compiler can vectorise them.
+    static void accumulate(float* bus, const float* y, int frames, float from, float step) {
+        if (!bus || (from == 0.0f && step == 0.0f)) {
+            return;
+        }
+        for (int i = 0; i < frames; ++i) {
+            bus[i] += y[i] * (from + step * static_cast<float>(i + 1));
+        }
+    }
+
+    static float peakOf(const float* y, int frames) {
+        float peak = 0.0f;
+        for (int i = 0; i < frames; ++i) {
+            peak = std::max(peak, std::fabs(y[i]));
+        }
+        return peak;
+    }
+
+    float mixMono(const float* y, int frames, const Gains& from, const Gains& step, const MixerBuses& buses) {
+        accumulate(buses.groupL, y, frames, from.left, step.left);
+        accumulate(buses.groupR, y, frames, from.right, step.right);
+        accumulate(buses.fx1, y, frames, from.fx1, step.fx1);
+        accumulate(buses.fx2, y, frames, from.fx2, step.fx2);
+        accumulate(buses.cueL, y, frames, from.cue, step.cue);
+        accumulate(buses.cueR, y, frames, from.cue, step.cue);
+        return peakOf(y, frames);
+    }
+
+    // Deinterleaves into the scratch's second half, keeps the channel sum
+    // for the mono sends and the direct output.
+    float mixStereo(const float* x, int frames, const Gains& from, const Gains& step, const MixerBuses& buses,
+                    float* direct) {
+        float* left = scratch_.data() + 2 * maxFrames_;
+        float* right = direct; // reused once the sum is formed below
+        for (int i = 0; i < frames; ++i) {
+            left[i] = x[2 * i];
+            right[i] = x[2 * i + 1];
+        }
+        accumulate(buses.groupL, left, frames, from.left, step.left);
+        accumulate(buses.groupR, right, frames, from.right, step.right);
+        accumulate(buses.cueL, left, frames, from.cue, step.cue);
+        accumulate(buses.cueR, right, frames, from.cue, step.cue);
+        const float peak = std::max(peakOf(left, frames), peakOf(right, frames));
+        for (int i = 0; i < frames; ++i) {
+            direct[i] = 0.5f * (left[i] + right[i]);
+        }
+        accumulate(buses.fx1, direct, frames, from.fx1, step.fx1);
+        accumulate(buses.fx2, direct, frames, from.fx2, step.fx2);
+        return peak;
+    }
+
+    int maxFrames_ = 0;
+    std::vector<Strip> strips_;
+    std::vector<float> scratch_; // [interleaved source, two frames wide | deinterleaved left]
+};
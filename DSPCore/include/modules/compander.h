@@ -1,14 +1,123 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <vector>
 
+#include "arena.h"
+#include "channel_kernels.h"
+#include "table_cache.h"
+
+/** Static curve of the compander: threshold, knee and ratio in dB, plus make-up gain. */
+struct CompanderCurve {
+    float thresholdDb = -24.0f;
+    float kneeWidthDb = 8.0f;
+    float ratio = 3.0f;
+    float makeupGainDb = 4.0f;
+
+    bool operator==(const CompanderCurve& other) const {
+        return thresholdDb == other.thresholdDb && kneeWidthDb == other.kneeWidthDb && ratio == other.ratio &&
+               makeupGainDb == other.makeupGainDb;
+    }
+
+    /** Gain reduction in dB for a detector level of `envDb`, before make-up. */
+    float gainReductionDb(float envDb) const {
+        const float lowerKnee = thresholdDb - 0.5f * kneeWidthDb;
+        const float upperKnee = thresholdDb + 0.5f * kneeWidthDb;
+
+        if (envDb <= lowerKnee) {
+            return 0.0f;
+        }
+        if (envDb >= upperKnee) {
+            const float compressed = thresholdDb + (envDb - thresholdDb) / ratio;
+            return compressed - envDb;
+        }
+
+        const float delta = envDb - lowerKnee;
+        const float softness = delta * delta / (2.0f * kneeWidthDb);
+        return (1.0f / ratio - 1.0f) * softness;
+    }
+
+    /** Linear gain, make-up included, for a linear detector level. */
+    float gain(float envelope) const {
+        const float envDb = 20.0f * std::log10(envelope);
+        return std::pow(10.0f, (gainReductionDb(envDb) + makeupGainDb) / 20.0f);
+    }
+};
+
+/**
+ * The static curve sampled on a grid that follows the float exponent: each
+ * octave of detector level is split into kStepsPerOctave linear segments, so
+ * a lookup is a few bit operations and one interpolation instead of a log10
+ * and a pow. Below the lower knee the curve is flat; above the top octave
+ * the exact curve is used.
+ */
+class CompanderGainTable {
+public:
+    using Key = CompanderCurve;
+
+    static constexpr int kStepsPerOctave = 256;
+    static constexpr int kTopExponent = 4; // exact curve from 2^4 (+24 dBFS) up
+
+    explicit CompanderGainTable(const CompanderCurve& curve) : curve_(curve) {
+        const float lowerKnee = std::pow(10.0f, (curve.thresholdDb - 0.5f * curve.kneeWidthDb) / 20.0f);
+        int exponent = 0;
+        std::frexp(lowerKnee, &exponent);
+        minExponent_ = std::min(exponent - 1, kTopExponent - 1);
+        floorGain_ = curve.gain(std::ldexp(1.0f, minExponent_) * 0.5f);
+
+        const int octaves = kTopExponent - minExponent_;
+        gains_.resize(static_cast<size_t>(octaves * kStepsPerOctave + 1));
+        for (size_t i = 0; i < gains_.size(); ++i) {
+            const int octave = static_cast<int>(i) / kStepsPerOctave;
+            const int step = static_cast<int>(i) % kStepsPerOctave;
+            const float level = std::ldexp(1.0f + static_cast<float>(step) / kStepsPerOctave, minExponent_ + octave);
+            gains_[i] = curve.gain(level);
+        }
+    }
+
+    float gain(float envelope) const {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &envelope, sizeof(bits));
+        const int exponent = static_cast<int>((bits >> 23) & 0xFFu) - 127;
+        if (exponent < minExponent_) {
+            return floorGain_;
+        }
+        if (exponent >= kTopExponent) {
+            return curve_.gain(envelope);
+        }
+        constexpr int kFractionBits = 23 - 8; // 8 = log2(kStepsPerOctave)
+        const uint32_t mantissa = bits & 0x7FFFFFu;
+        const size_t index = static_cast<size_t>((exponent - minExponent_) * kStepsPerOctave) +
+                             static_cast<size_t>(mantissa >> kFractionBits);
+        const float frac = static_cast<float>(mantissa & ((1u << kFractionBits) - 1u)) *
+                           (1.0f / static_cast<float>(1u << kFractionBits));
+        const float a = gains_[index];
+        const float b = gains_[index + 1];
+        return a + (b - a) * frac;
+    }
+
+    std::size_t bytes() const { return sizeof(*this) + gains_.capacity() * sizeof(float); }
+
+private:
+    CompanderCurve curve_;
+    int minExponent_ = 0;
+    float floorGain_ = 1.0f;
+    std::vector<float> gains_;
+};
+
 /**
  * Downward compressor/expander used for tape noise reduction. The class tracks
  * one envelope follower and gain computer per channel and supports per-track
- * bypassing for the NR-incompatible track.
+ * bypassing for NR-incompatible tracks. Per-track state is struct-of-arrays.
+ *
+ * With control-rate gain the detectors still follow every sample, but the
+ * gain curve is read and smoothed once per kControlInterval frames and the
+ * applied gain ramps linearly across them.
  */
 class Compander {
 public:
@@ -16,15 +125,27 @@ public:
 
     void prepare(float sampleRate, int channels) {
         sampleRate_ = sampleRate > 1.0f ? sampleRate : 1.0f;
+        if (!gainTable_) {
+            gainTable_ = SharedTableCache<CompanderGainTable>::acquire(curve_);
+        }
         setChannelCount(channels);
         updateCoefficients();
+        reset();
+    }
+
+    /** Return every channel's detector and gain to the idle state. */
+    void reset() {
+        std::fill(envelope_.begin(), envelope_.end(), kInitialEnvelope);
+        std::fill(gain_.begin(), gain_.end(), 1.0f);
     }
 
     /** Resize the per-channel state buffers as needed. */
     void setChannelCount(int channels) {
         const int count = std::max(channels, 1);
-        if (static_cast<int>(states_.size()) != count) {
-            states_.assign(count, ChannelState{});
+        if (static_cast<int>(envelope_.size()) != count) {
+            envelope_.assign(count, kInitialEnvelope);
+            gain_.assign(count, 1.0f);
+            gainStep_.assign(count, 0.0f);
             bypassMask_.assign(count, 0);
         }
     }
@@ -43,6 +164,26 @@ public:
         bypassMask_[trackIndex] = bypass ? 1 : 0;
     }
 
+    /**
+     * Set the bypass flag of every prepared track at once from a bit mask
+     * (bit n = track n). Never resizes, so it is safe on the audio thread.
+     */
+    void setBypassMask(uint64_t mask) {
+        const int count = std::min(static_cast<int>(bypassMask_.size()), 64);
+        for (int track = 0; track < count; ++track) {
+            bypassMask_[track] = static_cast<uint8_t>((mask >> track) & 1u);
+        }
+    }
+
+    void setControlRateGain(bool enabled) {
+        if (enabled != controlRateGain_) {
+            controlRateGain_ = enabled;
+            kernelWidth_ = 0;
+        }
+    }
+
+    bool controlRateGain() const { return controlRateGain_; }
+
     /**
      * Apply compression to an interleaved buffer in place.
      * The detector uses a simple peak follower with different attack/release
@@ -53,43 +194,94 @@ public:
             return;
         }
 
-        if (channels != static_cast<int>(states_.size())) {
+        if (channels != static_cast<int>(envelope_.size())) {
             setChannelCount(channels);
         }
+        if (channels != kernelWidth_) {
+            kernelWidth_ = channels;
+            kernel_ = selectChannelKernel(channels, [this](auto w) -> Kernel {
+                constexpr int width = decltype(w)::value;
+                return controlRateGain_ ? &Compander::processFramesControlRate<width> : &Compander::processFrames<width>;
+            });
+        }
+        (this->*kernel_)(interleaved, frames, channels);
+    }
+
+private:
+    static constexpr float kInitialEnvelope = 1e-3f;
+    static constexpr int kControlInterval = 16;
 
+    using Kernel = void (Compander::*)(float*, int, int);
+
+    template <int Width>
+    void processFrames(float* interleaved, int frames, int channels) {
+        const int lanes = kernelLanes<Width>(channels);
+        float* envelopes = envelope_.data();
+        float* gains = gain_.data();
+        const uint8_t* bypass = bypassMask_.data();
+        const CompanderGainTable* table = gainTable_.get();
         for (int i = 0; i < frames; ++i) {
-            for (int c = 0; c < channels; ++c) {
-                if (c >= static_cast<int>(states_.size()) || bypassMask_[c]) {
+            float* frame = interleaved + i * lanes;
+            for (int c = 0; c < lanes; ++c) {
+                if (bypass[c]) {
                     continue;
                 }
 
-                const int index = i * channels + c;
-                float sample = interleaved[index];
-                float level = std::max(std::fabs(sample), detectorFloor_);
+                const float sample = frame[c];
+                const float level = std::max(std::fabs(sample), detectorFloor_);
 
-                ChannelState& state = states_[c];
-                if (level > state.envelope) {
-                    state.envelope = attackCoeff_ * (state.envelope - level) + level;
-                } else {
-                    state.envelope = releaseCoeff_ * (state.envelope - level) + level;
-                }
-                state.envelope = std::max(state.envelope, detectorFloor_);
+                float envelope = envelopes[c];
+                const float coeff = level > envelope ? attackCoeff_ : releaseCoeff_;
+                envelope = coeff * (envelope - level) + level;
+                envelope = std::max(envelope, detectorFloor_);
+                envelopes[c] = envelope;
 
-                const float envDb = linearToDb(state.envelope);
-                const float gainDb = compressionGain(envDb) + makeupGainDb_;
-                const float targetGain = dbToLinear(gainDb);
+                const float targetGain = table ? table->gain(envelope) : curve_.gain(envelope);
 
-                state.gain = gainSmoothing_ * state.gain + (1.0f - gainSmoothing_) * targetGain;
-                interleaved[index] = sample * state.gain;
+                gains[c] = gainSmoothing_ * gains[c] + (1.0f - gainSmoothing_) * targetGain;
+                frame[c] = sample * gains[c];
             }
         }
     }
 
-private:
-    struct ChannelState {
-        float envelope = 1e-3f;
-        float gain = 1.0f;
-    };
+    template <int Width>
+    void processFramesControlRate(float* interleaved, int frames, int channels) {
+        const int lanes = kernelLanes<Width>(channels);
+        float* envelopes = envelope_.data();
+        float* gains = gain_.data();
+        float* steps = gainStep_.data();
+        const uint8_t* bypass = bypassMask_.data();
+        const CompanderGainTable* table = gainTable_.get();
+        for (int start = 0; start < frames; start += kControlInterval) {
+            const int count = std::min(kControlInterval, frames - start);
+            // The smoother's `count` per-sample steps collapsed into one.
+            const float smoothing = smoothingPowers_[static_cast<size_t>(count - 1)];
+            for (int c = 0; c < lanes; ++c) {
+                const float targetGain = table ? table->gain(envelopes[c]) : curve_.gain(envelopes[c]);
+                const float next = smoothing * gains[c] + (1.0f - smoothing) * targetGain;
+                steps[c] = (next - gains[c]) / static_cast<float>(count);
+            }
+            for (int i = start; i < start + count; ++i) {
+                float* frame = interleaved + i * lanes;
+                for (int c = 0; c < lanes; ++c) {
+                    if (bypass[c]) {
+                        continue;
+                    }
+
+                    const float sample = frame[c];
+                    const float level = std::max(std::fabs(sample), detectorFloor_);
+
+                    float envelope = envelopes[c];
+                    const float coeff = level > envelope ? attackCoeff_ : releaseCoeff_;
+                    envelope = coeff * (envelope - level) + level;
+                    envelopes[c] = std::max(envelope, detectorFloor_);
+
+                    gains[c] += steps[c];
+                    frame[c] = sample * gains[c];
+                }
+            }
+        }
+    }
 
     void updateCoefficients() {
         const float attackSeconds = 0.050f;
@@ -97,40 +289,29 @@ private:
         attackCoeff_ = std::exp(-1.0f / (attackSeconds * sampleRate_));
         releaseCoeff_ = std::exp(-1.0f / (releaseSeconds * sampleRate_));
         gainSmoothing_ = std::exp(-1.0f / (0.020f * sampleRate_));
-    }
-
-    static float linearToDb(float value) { return 20.0f * std::log10(value); }
-    static float dbToLinear(float db) { return std::pow(10.0f, db / 20.0f); }
-
-    float compressionGain(float envDb) const {
-        const float lowerKnee = thresholdDb_ - 0.5f * kneeWidthDb_;
-        const float upperKnee = thresholdDb_ + 0.5f * kneeWidthDb_;
-
-        if (envDb <= lowerKnee) {
-            return 0.0f;
+        float power = 1.0f;
+        for (float& smoothing : smoothingPowers_) {
+            power *= gainSmoothing_;
+            smoothing = power;
         }
-        if (envDb >= upperKnee) {
-            const float compressed = thresholdDb_ + (envDb - thresholdDb_) / ratio_;
-            return compressed - envDb;
-        }
-
-        const float delta = envDb - lowerKnee;
-        const float knee = kneeWidthDb_;
-        const float softness = delta * delta / (2.0f * knee);
-        return (1.0f / ratio_ - 1.0f) * softness;
     }
 
     float sampleRate_ = 48000.0f;
-    std::vector<ChannelState> states_;
-    std::vector<uint8_t> bypassMask_;
+    ArenaVector<float> envelope_;
+    ArenaVector<float> gain_;
+    ArenaVector<float> gainStep_; // control rate: per-frame gain change in the current interval
+    ArenaVector<uint8_t> bypassMask_;
+    // Shared by every compander with the same curve; acquired in prepare().
+    std::shared_ptr<const CompanderGainTable> gainTable_;
+    Kernel kernel_ = &Compander::processFrames<0>;
+    int kernelWidth_ = 0;
 
     float attackCoeff_ = 0.0f;
     float releaseCoeff_ = 0.0f;
     float gainSmoothing_ = 0.0f;
+    std::array<float, kControlInterval> smoothingPowers_{}; // gainSmoothing_^(n + 1)
+    bool controlRateGain_ = false;
 
     static constexpr float detectorFloor_ = 1e-5f;
-    static constexpr float thresholdDb_ = -24.0f;
-    static constexpr float kneeWidthDb_ = 8.0f;
-    static constexpr float ratio_ = 3.0f;
-    static constexpr float makeupGainDb_ = 4.0f;
+    static constexpr CompanderCurve curve_{};
 };
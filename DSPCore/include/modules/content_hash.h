@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * 64-bit FNV-1a over whatever is folded in, for naming cache files after
+ * their inputs. Unlike std::hash it is the same on every run, so a digest
+ * can be written to disk and recognised by a later launch.
+ */
+struct ContentHash {
+    uint64_t value = 0xCBF29CE484222325ULL;
+
+    void addBytes(const void* data, size_t bytes) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            value = (value ^ p[i]) * 0x100000001B3ULL;
+        }
+    }
+
+    /** Numbers and padding-free structs, by their bytes. */
+    template <typename T>
+    void add(const T& item) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed by their bytes");
+        addBytes(&item, sizeof(T));
+    }
+
+    /** Length first, so consecutive strings cannot run into each other. */
+    void add(const std::string& text) {
+        add(static_cast<uint64_t>(text.size()));
+        addBytes(text.data(), text.size());
+    }
+
+    /** Sixteen lower-case hex digits. */
+    std::string hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(16, '0');
+        for (int i = 0; i < 16; ++i) {
+            out[static_cast<size_t>(i)] = digits[(value >> (60 - 4 * i)) & 0xF];
+        }
+        return out;
+    }
+};
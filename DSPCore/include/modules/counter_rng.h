@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Stateless, counter-based random numbers: every draw is a pure function of a
+ * key (seed and stream identity) and a counter (which draw it is), mixed with
+ * the SplitMix64 finalizer. Generators built on it can jump to any position by
+ * setting the counter instead of replaying every earlier draw.
+ */
+struct CounterRng {
+    static constexpr uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+
+    static uint64_t bits(uint64_t key, uint64_t counter) {
+        uint64_t z = key + (counter + 1) * kGolden;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /** Uniform float in [0, 1) with 24 bits of resolution. */
+    static float uniform(uint64_t key, uint64_t counter) {
+        return static_cast<float>(bits(key, counter) >> 40) * (1.0f / 16777216.0f);
+    }
+
+    /** Derive an independent key for sub-stream `stream` of `key`. */
+    static uint64_t subKey(uint64_t key, uint64_t stream) {
+        return bits(key ^ 0xD1B54A32D192ED03ULL, stream);
+    }
+};
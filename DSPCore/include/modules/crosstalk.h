@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 
 /**
@@ -20,6 +21,13 @@ public:
         crosstalkGain = std::pow(10.0f, crosstalkDb / 20.0f);
     }
 
+    /** Bleed as a linear gain, e.g. a blend of two setAmountDb() settings. */
+    void setGain(float gain)
+    {
+        crosstalkGain = std::max(gain, 0.0f);
+        crosstalkDb = crosstalkGain > 0.0f ? 20.0f * std::log10(crosstalkGain) : -120.0f;
+    }
+
     /**
      * Applies the crosstalk bleed to a stereo buffer.
      *
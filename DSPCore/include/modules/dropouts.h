@@ -3,11 +3,20 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
+
+#include "counter_rng.h"
 
 /**
  * Simulates mechanical tape dropouts by modulating a shared gain envelope.
  * The envelope follows a four-stage ADSR-like shape with randomized hold
- * durations and a simple linear congruential RNG for deterministic tests.
+ * durations. Random draws come from a counter-based generator keyed by the
+ * seed, so the schedule is a pure function of seed, rate and position.
+ *
+ * Dropouts are rare, so onsets are scheduled as events: the idle gap before
+ * the next onset is drawn once from the geometric distribution that matches a
+ * per-frame Bernoulli trial (the discrete form of Poisson arrivals), and idle
+ * stretches are skipped without touching the samples.
  */
 class Dropouts {
 public:
@@ -23,8 +32,11 @@ public:
         reset();
     }
 
+    /** Return to the start of the schedule for the current seed. */
     void reset() {
+        drawCounter_ = 0;
         stage_ = Stage::Idle;
+        idleFramesRemaining_ = kUnscheduled;
         stageSamplesRemaining_ = 0;
         holdSamplesRemaining_ = 0;
         envelope_ = 1.0f;
@@ -32,9 +44,31 @@ public:
     }
 
     /** Rate of dropouts expressed as events per minute. */
-    void setRate(float ratePerMinute) { dropoutRatePerMinute_ = std::max(ratePerMinute, 0.0f); }
+    void setRate(float ratePerMinute) {
+        const float rate = std::max(ratePerMinute, 0.0f);
+        if (rate != dropoutRatePerMinute_) {
+            dropoutRatePerMinute_ = rate;
+            // Arrivals are memoryless, so redrawing the pending gap at the new
+            // rate keeps the statistics exact.
+            idleFramesRemaining_ = kUnscheduled;
+        }
+    }
 
-    void setSeed(uint32_t seed) { rngState_ = seed; }
+    void setSeed(uint32_t seed) {
+        seed_ = seed;
+        drawCounter_ = 0;
+        idleFramesRemaining_ = kUnscheduled;
+    }
+
+    /**
+     * Restart from the seed and advance the scheduler to absolute frame
+     * `position`, as if that many frames had been processed at the current
+     * rate. Only events are simulated, so the cost is O(events), not O(frames).
+     */
+    void seek(int64_t position) {
+        reset();
+        skip(position);
+    }
 
     void setHoldRangeSamplesForTesting(int minSamples, int maxSamples) {
         minHoldSamples_ = std::max(1, minSamples);
@@ -51,12 +85,31 @@ public:
             channels_ = channels;
         }
 
-        const float probability = computeTriggerProbability();
+        int frame = 0;
+        while (frame < frames) {
+            if (stage_ == Stage::Idle) {
+                envelope_ = 1.0f;
+                if (idleFramesRemaining_ == kUnscheduled) {
+                    idleFramesRemaining_ = drawIdleFrames();
+                }
+                const int64_t remaining = static_cast<int64_t>(frames - frame);
+                if (idleFramesRemaining_ >= remaining) {
+                    // Nothing happens for the rest of this block: unity gain.
+                    idleFramesRemaining_ -= remaining;
+                    break;
+                }
+                frame += static_cast<int>(idleFramesRemaining_);
+                idleFramesRemaining_ = kUnscheduled;
+                startEvent();
+            }
 
-        for (int i = 0; i < frames; ++i) {
-            const float gain = advance(probability);
-            for (int c = 0; c < channels_; ++c) {
-                interleaved[i * channels + c] *= gain;
+            // Only the attack/hold/release span is rendered sample by sample.
+            while (frame < frames && stage_ != Stage::Idle) {
+                const float gain = advance();
+                for (int c = 0; c < channels_; ++c) {
+                    interleaved[frame * channels + c] *= gain;
+                }
+                ++frame;
             }
         }
     }
@@ -64,17 +117,39 @@ public:
     int dropoutCount() const { return dropoutsTriggered_; }
 
 private:
+    /** Advance the envelope by `frames` without touching any audio. */
+    void skip(int64_t frames) {
+        while (frames > 0) {
+            if (stage_ == Stage::Idle) {
+                envelope_ = 1.0f;
+                if (idleFramesRemaining_ == kUnscheduled) {
+                    idleFramesRemaining_ = drawIdleFrames();
+                }
+                if (idleFramesRemaining_ >= frames) {
+                    idleFramesRemaining_ -= frames;
+                    return;
+                }
+                frames -= idleFramesRemaining_;
+                idleFramesRemaining_ = kUnscheduled;
+                startEvent();
+            }
+            while (frames > 0 && stage_ != Stage::Idle) {
+                advance();
+                --frames;
+            }
+        }
+    }
+
     enum class Stage { Idle, Attack, Hold, Release };
 
-    float advance(float triggerProbability) {
+    static constexpr int64_t kUnscheduled = -1;
+    static constexpr int64_t kNever = std::numeric_limits<int64_t>::max();
+
+    float advance() {
         while (true) {
             switch (stage_) {
                 case Stage::Idle:
                     envelope_ = 1.0f;
-                    if (dropoutRatePerMinute_ > 0.0f && randomFloat() < triggerProbability) {
-                        startEvent();
-                        continue;
-                    }
                     break;
                 case Stage::Attack:
                     if (stageSamplesRemaining_ > 0) {
@@ -143,6 +218,30 @@ private:
         return eventsPerSecond / sampleRate_;
     }
 
+    /**
+     * Number of idle frames before the next onset. A per-frame trigger with
+     * probability p fires after k quiet frames with probability (1 - p)^k * p,
+     * which is sampled here by inverting the geometric CDF with one draw.
+     */
+    int64_t drawIdleFrames() {
+        const double p = static_cast<double>(computeTriggerProbability());
+        if (p <= 0.0) {
+            return kNever;
+        }
+        if (p >= 1.0) {
+            return 0;
+        }
+        const double u = 1.0 - static_cast<double>(randomFloat());
+        if (u <= 0.0) {
+            return kNever;
+        }
+        const double frames = std::floor(std::log(u) / std::log1p(-p));
+        if (!(frames < static_cast<double>(kNever))) {
+            return kNever;
+        }
+        return static_cast<int64_t>(frames);
+    }
+
     int randomHoldSamples() {
         if (maxHoldSamples_ <= minHoldSamples_) {
             return minHoldSamples_;
@@ -153,11 +252,11 @@ private:
     }
 
     float randomFloat() {
-        rngState_ = rngState_ * 1664525u + 1013904223u;
-        return static_cast<float>((rngState_ >> 1) & 0x7FFFFFFFu) / static_cast<float>(0x7FFFFFFF);
+        return CounterRng::uniform(seed_, drawCounter_++);
     }
 
     Stage stage_ = Stage::Idle;
+    int64_t idleFramesRemaining_ = kUnscheduled;
     float sampleRate_ = 48000.0f;
     int channels_ = 1;
     int stageSamplesRemaining_ = 0;
@@ -171,7 +270,8 @@ private:
     float envelope_ = 1.0f;
     float dropoutRatePerMinute_ = 0.0f;
     int dropoutsTriggered_ = 0;
-    uint32_t rngState_ = 0x1234567u;
+    uint32_t seed_ = 0x1234567u;
+    uint64_t drawCounter_ = 0;
 
     static constexpr float minGain_ = 0.25f;
     static constexpr float attackTimeSeconds_ = 0.004f;   // ~4 ms
@@ -8,6 +8,8 @@
 /**
  * Three-band EQ used to emulate the tape machine tone controls. The class owns
  * one biquad per band per channel and simply cascades them for each sample.
+ * Changing a setting retunes the bands without clearing their state, so knob
+ * moves while audio runs do not click.
  */
 class EQ : public Module {
 public:
@@ -37,6 +39,26 @@ public:
         updateCoefficients();
     }
 
+    /** Update all three gains with a single retune. */
+    void setGainsDb(float lowDb, float midDb, float highDb) {
+        lowGainDb = lowDb;
+        midGainDb = midDb;
+        highGainDb = highDb;
+        updateCoefficients();
+    }
+
+    /** Corner frequency of the low shelf. */
+    void setLowFrequency(float freq) {
+        lowFrequency = std::clamp(freq, 20.0f, fs * 0.45f);
+        updateCoefficients();
+    }
+
+    /** Corner frequency of the high shelf. */
+    void setHighFrequency(float freq) {
+        highFrequency = std::clamp(freq, 200.0f, fs * 0.45f);
+        updateCoefficients();
+    }
+
     /** Center frequency for the mid bell, clamped to a sensible range. */
     void setMidFrequency(float freq) {
         midFrequency = std::clamp(freq, 200.0f, fs * 0.45f);
@@ -49,6 +71,16 @@ public:
         updateCoefficients();
     }
 
+    /** Multiply `response` by the three bands in processing order. */
+    void applyTo(FrequencyResponse& response) const {
+        if (lowShelfStates.empty()) {
+            return;
+        }
+        response.applyBiquad(lowShelfStates.front().coefficients());
+        response.applyBiquad(peakStates.front().coefficients());
+        response.applyBiquad(highShelfStates.front().coefficients());
+    }
+
     void processBlock(float* interleavedBuffer, int numFrames, int numChannels) override {
         if (!interleavedBuffer || numFrames <= 0 || numChannels <= 0) {
             return;
@@ -72,7 +104,9 @@ private:
     float lowGainDb{0.0f};
     float midGainDb{0.0f};
     float highGainDb{0.0f};
+    float lowFrequency{120.0f};
     float midFrequency{1000.0f};
+    float highFrequency{6000.0f};
     float midQ{0.7071f};
 
     std::vector<Biquad> lowShelfStates;
@@ -98,21 +132,18 @@ private:
         Biquad lowTemplate;
         Biquad peakTemplate;
         Biquad highTemplate;
-        lowTemplate.setLowShelf(fs, 120.0f, lowGainDb);
+        lowTemplate.setLowShelf(fs, lowFrequency, lowGainDb);
         peakTemplate.setPeaking(fs, midFrequency, midGainDb, midQ);
-        highTemplate.setHighShelf(fs, 6000.0f, highGainDb);
+        highTemplate.setHighShelf(fs, highFrequency, highGainDb);
 
         for (auto& b : lowShelfStates) {
-            b = lowTemplate;
-            b.reset();
+            b.setCoefficients(lowTemplate);
         }
         for (auto& b : peakStates) {
-            b = peakTemplate;
-            b.reset();
+            b.setCoefficients(peakTemplate);
         }
         for (auto& b : highShelfStates) {
-            b = highTemplate;
-            b.reset();
+            b.setCoefficients(highTemplate);
         }
     }
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a 32-bit float WAV of a known length the way cache entries need
+ * it: into `path` + ".partial", renamed onto `path` by commit() once every
+ * frame is on disk, so a reader never maps a half-written file. Dropping
+ * the writer without committing removes the partial file.
+ */
+class FloatWavWriter {
+public:
+    FloatWavWriter() = default;
+    FloatWavWriter(const FloatWavWriter&) = delete;
+    FloatWavWriter& operator=(const FloatWavWriter&) = delete;
+    ~FloatWavWriter() { abandon(); }
+
+    /** Largest frame count a plain WAV header can describe for `channels`. */
+    static uint64_t maxFrames(int channels) { return (0xFFFFFFFFull - 36) / (static_cast<uint64_t>(channels) * 4); }
+
+    /** Start the file and write its header. Returns false if it cannot be created or is too long. */
+    bool open(const std::string& path, int channels, uint32_t sampleRate, uint64_t frames) {
+        abandon();
+        if (channels < 1 || frames > maxFrames(channels)) {
+            return false;
+        }
+        path_ = path;
+        partial_ = path + ".partial";
+        file_ = std::fopen(partial_.c_str(), "wb");
+        if (!file_) {
+            return false;
+        }
+        ok_ = true;
+        const auto header = headerFor(channels, sampleRate, frames);
+        return write(header.data(), header.size());
+    }
+
+    /** Append interleaved samples. */
+    bool write(const float* samples, size_t count) {
+        // WAV is little-endian, as are the platforms this builds for.
+        return write(static_cast<const void*>(samples), count * sizeof(float));
+    }
+
+    /** Close the file and move it into place. Returns false, leaving nothing behind, if any write failed. */
+    bool commit() {
+        if (!file_) {
+            return false;
+        }
+        ok_ = std::fclose(file_) == 0 && ok_;
+        file_ = nullptr;
+        if (!ok_ || std::rename(partial_.c_str(), path_.c_str()) != 0) {
+            std::remove(partial_.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool write(const void* bytes, size_t count) {
+        ok_ = ok_ && file_ && std::fwrite(bytes, 1, count, file_) == count;
+        return ok_;
+    }
+
+    void abandon() {
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+            std::remove(partial_.c_str());
+        }
+    }
+
+    static void putLe(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    // Canonical 44-byte header.
+    static std::vector<uint8_t> headerFor(int channels, uint32_t sampleRate, uint64_t frames) {
+        const uint64_t dataBytes = frames * static_cast<uint64_t>(channels) * 4;
+        std::vector<uint8_t> header;
+        const auto tag = [&header](const char* text) { header.insert(header.end(), text, text + 4); };
+        tag("RIFF");
+        putLe(header, 36 + dataBytes, 4);
+        tag("WAVE");
+        tag("fmt ");
+        putLe(header, 16, 4);
+        putLe(header, 3, 2); // IEEE float
+        putLe(header, static_cast<uint64_t>(channels), 2);
+        putLe(header, sampleRate, 4);
+        putLe(header, static_cast<uint64_t>(sampleRate) * static_cast<uint64_t>(channels) * 4, 4);
+        putLe(header, static_cast<uint64_t>(channels) * 4, 2);
+        putLe(header, 32, 2);
+        tag("data");
+        putLe(header, dataBytes, 4);
+        return header;
+    }
+
+    std::string path_;
+    std::string partial_;
+    FILE* file_ = nullptr;
+    bool ok_ = false;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mapped_audio_file.h"
+
+/**
+ * Processed tape frozen to disk: the output of the whole chain for every
+ * track, in fixed-length segments of the timeline, each a float WAV mapped
+ * into memory. While the settings and timeline it was rendered for are the
+ * ones playing, a block inside frozen segments is copied from the mappings
+ * instead of being read from the takes and processed again.
+ *
+ * Segments are whole-tape rather than per take because the chain is not
+ * per track: crosstalk and azimuth act on track pairs, and the delays and
+ * filters carry a take's tail into whatever follows it.
+ *
+ * publish() runs off the audio thread and hands the new set over through
+ * an atomic pointer, as TapeTimelineReader does with its timeline; the set
+ * it replaces is freed by the next publish() or the destructor. The
+ * counters are written by the audio thread and readable from any other.
+ */
+class FreezeCache {
+public:
+    /** How a block relates to the frozen segments. */
+    enum class Coverage {
+        Live,   // not (entirely) frozen for the current settings and timeline
+        Frozen, // every frame frozen
+        WarmUp, // frozen, but coverage ends within the warm-up that follows it
+    };
+
+    struct Stats {
+        uint64_t frozenBlocks = 0;
+        uint64_t liveBlocks = 0;
+        uint64_t frozenFrames = 0;
+        uint64_t liveFrames = 0;
+        uint64_t frozenNanos = 0;
+        uint64_t liveNanos = 0;
+        uint64_t segmentsRendered = 0;
+        uint64_t segmentsReused = 0;
+    };
+
+    explicit FreezeCache(int tracks) : tracks_(std::max(tracks, 1)) {}
+
+    ~FreezeCache() {
+        delete pending_.load(std::memory_order_acquire);
+        delete retired_.load(std::memory_order_acquire);
+        delete current_;
+    }
+
+    FreezeCache(const FreezeCache&) = delete;
+    FreezeCache& operator=(const FreezeCache&) = delete;
+
+    int tracks() const { return tracks_; }
+
+    /**
+     * Replace the frozen set. Segment i covers timeline frames
+     * [i * segmentFrames, (i + 1) * segmentFrames) and needs `tracks`
+     * channels and at least that many frames; null entries are not frozen.
+     * The set serves blocks only while the chain's settings digest is
+     * `settings` and the timeline is at `version`.
+     */
+    void publish(std::vector<std::shared_ptr<MappedAudioFile>> segments, int64_t segmentFrames, int64_t warmUpFrames,
+                 uint64_t settings, uint64_t version) {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        delete retired_.exchange(nullptr, std::memory_order_acq_rel);
+        auto* next = new FrozenSet;
+        next->segments = std::move(segments);
+        next->segmentFrames = std::max<int64_t>(segmentFrames, 1);
+        next->warmUpFrames = std::max<int64_t>(warmUpFrames, 0);
+        next->settings = settings;
+        next->version = version;
+        latest_ = next;
+        delete pending_.exchange(next, std::memory_order_acq_rel);
+    }
+
+    /** Drop every segment; blocks play live from the next one. */
+    void clear() { publish({}, 1, 0, 0, 0); }
+
+    /** The mapping of `path` in the newest set, so an unchanged segment is not mapped twice. */
+    std::shared_ptr<MappedAudioFile> find(const std::string& path) const {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        if (latest_) {
+            for (const auto& segment : latest_->segments) {
+                if (segment && segment->path() == path) {
+                    return segment;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void recordFreeze(int rendered, int reused) {
+        segmentsRendered_.fetch_add(static_cast<uint64_t>(std::max(rendered, 0)), std::memory_order_relaxed);
+        segmentsReused_.fetch_add(static_cast<uint64_t>(std::max(reused, 0)), std::memory_order_relaxed);
+    }
+
+    /** Audio thread: how [position, position + frames) is covered for these settings and timeline. */
+    Coverage coverage(int64_t position, int frames, uint64_t settings, uint64_t version) {
+        adoptPending();
+        const FrozenSet* set = current_;
+        if (!set || set->segments.empty() || set->settings != settings || set->version != version || position < 0) {
+            return Coverage::Live;
+        }
+        const int64_t end = position + frames;
+        if (!covered(*set, position, end)) {
+            return Coverage::Live;
+        }
+        return covered(*set, end, end + set->warmUpFrames) ? Coverage::Frozen : Coverage::WarmUp;
+    }
+
+    /** Audio thread, after coverage() found the block frozen: copy it out, interleaved. */
+    void read(int64_t position, float* interleaved, int frames) const {
+        const FrozenSet& set = *current_;
+        for (int done = 0; done < frames;) {
+            const int64_t frame = position + done;
+            const int64_t index = frame / set.segmentFrames;
+            const int64_t offset = frame - index * set.segmentFrames;
+            const auto count = static_cast<int>(std::min<int64_t>(frames - done, set.segmentFrames - offset));
+            const MappedAudioFile& file = *set.segments[static_cast<size_t>(index)];
+            float* out = interleaved + static_cast<size_t>(done) * static_cast<size_t>(tracks_);
+            for (int t = 0; t < tracks_; ++t) {
+                file.read(offset, count, t, 1.0f, out + t, tracks_);
+            }
+            done += count;
+        }
+    }
+
+    /** Audio thread: account for one block served from the freeze or processed live. */
+    void recordBlock(bool frozen, int frames, uint64_t nanos) {
+        auto& blocks = frozen ? frozenBlocks_ : liveBlocks_;
+        auto& frameCount = frozen ? frozenFrames_ : liveFrames_;
+        auto& time = frozen ? frozenNanos_ : liveNanos_;
+        blocks.fetch_add(1, std::memory_order_relaxed);
+        frameCount.fetch_add(static_cast<uint64_t>(frames), std::memory_order_relaxed);
+        time.fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.frozenBlocks = frozenBlocks_.load(std::memory_order_relaxed);
+        s.liveBlocks = liveBlocks_.load(std::memory_order_relaxed);
+        s.frozenFrames = frozenFrames_.load(std::memory_order_relaxed);
+        s.liveFrames = liveFrames_.load(std::memory_order_relaxed);
+        s.frozenNanos = frozenNanos_.load(std::memory_order_relaxed);
+        s.liveNanos = liveNanos_.load(std::memory_order_relaxed);
+        s.segmentsRendered = segmentsRendered_.load(std::memory_order_relaxed);
+        s.segmentsReused = segmentsReused_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    struct FrozenSet {
+        std::vector<std::shared_ptr<MappedAudioFile>> segments;
+        int64_t segmentFrames = 1;
+        int64_t warmUpFrames = 0;
+        uint64_t settings = 0;
+        uint64_t version = 0;
+    };
+
+    /** Whether every frame of [start, end) lies in a frozen segment. */
+    static bool covered(const FrozenSet& set, int64_t start, int64_t end) {
+        if (end <= start) {
+            return true;
+        }
+        const int64_t last = (end - 1) / set.segmentFrames;
+        if (last >= static_cast<int64_t>(set.segments.size())) {
+            return false;
+        }
+        for (int64_t index = start / set.segmentFrames; index <= last; ++index) {
+            if (!set.segments[static_cast<size_t>(index)]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void adoptPending() {
+        if (retired_.load(std::memory_order_acquire)) {
+            return;
+        }
+        if (FrozenSet* next = pending_.exchange(nullptr, std::memory_order_acq_rel)) {
+            retired_.store(current_, std::memory_order_release);
+            current_ = next;
+        }
+    }
+
+    int tracks_;
+
+    mutable std::mutex publishMutex_;
+    FrozenSet* latest_ = nullptr; // newest published, for reusing mappings
+
+    std::atomic<FrozenSet*> pending_{nullptr};
+    std::atomic<FrozenSet*> retired_{nullptr};
+    FrozenSet* current_ = nullptr; // audio thread only
+
+    std::atomic<uint64_t> frozenBlocks_{0};
+    std::atomic<uint64_t> liveBlocks_{0};
+    std::atomic<uint64_t> frozenFrames_{0};
+    std::atomic<uint64_t> liveFrames_{0};
+    std::atomic<uint64_t> frozenNanos_{0};
+    std::atomic<uint64_t> liveNanos_{0};
+    std::atomic<uint64_t> segmentsRendered_{0};
+    std::atomic<uint64_t> segmentsReused_{0};
+};
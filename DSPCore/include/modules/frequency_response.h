@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/** Normalised biquad coefficients (a0 == 1), as used by the filters in this folder. */
+struct BiquadCoefficients {
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+};
+
+/**
+ * Evaluates the transfer function of a cascade of linear stages at a set of
+ * frequencies. prepare() computes z^-1 and z^-2 for every point once; each
+ * stage then multiplies the running response in place, so every loop is a
+ * straight pass over contiguous arrays of points. Meant for UI and analysis
+ * threads: prepare() allocates.
+ */
+class FrequencyResponse {
+public:
+    void prepare(const float* frequencies, int count, float sampleRate) {
+        const auto n = static_cast<size_t>(std::max(count, 0));
+        cos1_.resize(n);
+        sin1_.resize(n);
+        cos2_.resize(n);
+        sin2_.resize(n);
+        re_.assign(n, 1.0);
+        im_.assign(n, 0.0);
+        const double fs = std::max(static_cast<double>(sampleRate), 1.0);
+        for (size_t i = 0; i < n; ++i) {
+            const double f = std::clamp(static_cast<double>(frequencies[i]), 0.0, 0.5 * fs);
+            const double w = 2.0 * kPi * f / fs;
+            cos1_[i] = std::cos(w);
+            sin1_[i] = -std::sin(w);
+            cos2_[i] = std::cos(2.0 * w);
+            sin2_[i] = -std::sin(2.0 * w);
+        }
+    }
+
+    int size() const { return static_cast<int>(re_.size()); }
+
+    /** Multiply by (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2). */
+    void applyBiquad(const BiquadCoefficients& c) {
+        const size_t n = re_.size();
+        for (size_t i = 0; i < n; ++i) {
+            const double nr = c.b0 + c.b1 * cos1_[i] + c.b2 * cos2_[i];
+            const double ni = c.b1 * sin1_[i] + c.b2 * sin2_[i];
+            const double dr = 1.0 + c.a1 * cos1_[i] + c.a2 * cos2_[i];
+            const double di = c.a1 * sin1_[i] + c.a2 * sin2_[i];
+            multiply(i, nr, ni, dr, di);
+        }
+    }
+
+    /** Multiply by the one-pole smoother y += g (x - y), i.e. g / (1 - (1 - g) z^-1). */
+    void applyOnePole(float g) {
+        const size_t n = re_.size();
+        const double feedback = 1.0 - static_cast<double>(g);
+        for (size_t i = 0; i < n; ++i) {
+            multiply(i, g, 0.0, 1.0 - feedback * cos1_[i], -feedback * sin1_[i]);
+        }
+    }
+
+    /**
+     * Write the magnitude in dB (floored at -240 dB) and, when `phase` is not
+     * null, the phase in radians, wrapped to [-pi, pi].
+     */
+    void read(float* magnitudeDb, float* phase) const {
+        const size_t n = re_.size();
+        for (size_t i = 0; i < n; ++i) {
+            const double power = re_[i] * re_[i] + im_[i] * im_[i];
+            magnitudeDb[i] = static_cast<float>(10.0 * std::log10(std::max(power, 1.0e-24)));
+        }
+        if (phase) {
+            for (size_t i = 0; i < n; ++i) {
+                phase[i] = static_cast<float>(std::atan2(im_[i], re_[i]));
+            }
+        }
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    // H[i] *= (nr + j ni) / (dr + j di)
+    void multiply(size_t i, double nr, double ni, double dr, double di) {
+        const double inv = 1.0 / std::max(dr * dr + di * di, 1.0e-30);
+        const double qr = (nr * dr + ni * di) * inv;
+        const double qi = (ni * dr - nr * di) * inv;
+        const double r = re_[i] * qr - im_[i] * qi;
+        im_[i] = re_[i] * qi + im_[i] * qr;
+        re_[i] = r;
+    }
+
+    std::vector<double> cos1_;
+    std::vector<double> sin1_;
+    std::vector<double> cos2_;
+    std::vector<double> sin2_;
+    std::vector<double> re_;
+    std::vector<double> im_;
+};
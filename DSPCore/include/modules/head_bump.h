@@ -2,9 +2,148 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <vector>
 
-/** Low-frequency resonant filter that recreates analog head bump coloration. */
+#include "arena.h"
+#include "channel_kernels.h"
+#include "frequency_response.h"
+#include "table_cache.h"
+
+/**
+ * The head bump's peaking designs at one sample rate, sampled over frequency
+ * and gain so a design is a lookup instead of a sin, cos, pow and five
+ * divisions. Frequency rows follow the float exponent, as in
+ * CompanderGainTable: kStepsPerOctave linear steps per octave from the octave
+ * below 10 Hz to the first step past 0.45 fs. Gain columns run in
+ * 1/kStepsPerDb dB steps over +/-kMaxGainDb; design() falls back to the exact
+ * design beyond them.
+ *
+ * Entries hold each coefficient's offset from its 0 Hz limit (1, -2, 1, -2,
+ * 1), computed in double, so the small differences that set the response at
+ * low frequencies survive interpolation and only the final add rounds; b1
+ * equals a1 in a peaking design, so it is not stored. Every entry is a stable
+ * design and bilinear weights are convex, so every interpolated design is
+ * stable too (the stable (a1, a2) region is a convex triangle); lookup()
+ * checks that the final rounding kept it so.
+ */
+class HeadBumpTable {
+public:
+    using Key = float; // sample rate
+
+    static constexpr double kQ = 1.4;
+    static constexpr int kStepsPerOctave = 24;
+    static constexpr int kStepsPerDb = 1;
+    static constexpr float kMaxGainDb = 12.0f;
+    static constexpr float kMinFrequencyHz = 10.0f;
+    static constexpr float kMaxFrequencyRatio = 0.45f;
+
+    explicit HeadBumpTable(float sampleRate) : sampleRate_(sampleRate) {
+        int exponent = 0;
+        std::frexp(kMinFrequencyHz, &exponent);
+        minExponent_ = exponent - 1;
+        const float maxFrequency = std::max(kMaxFrequencyRatio * sampleRate, kMinFrequencyHz);
+        rows_ = static_cast<int>(position(maxFrequency)) + 2;
+        columns_ = static_cast<int>(2.0f * kMaxGainDb) * kStepsPerDb + 1;
+        offsets_.resize(static_cast<size_t>(rows_ * columns_ * kOffsets));
+
+        const double pi = 3.14159265358979323846;
+        for (int row = 0; row < rows_; ++row) {
+            const int octave = row / kStepsPerOctave;
+            const int step = row % kStepsPerOctave;
+            const double freqHz = std::ldexp(1.0 + static_cast<double>(step) / kStepsPerOctave, minExponent_ + octave);
+            const double omega = std::min(2.0 * pi * freqHz / static_cast<double>(sampleRate), pi);
+            for (int column = 0; column < columns_; ++column) {
+                const double gainDb = -kMaxGainDb + static_cast<double>(column) / kStepsPerDb;
+                storeOffsets(omega, gainDb, &offsets_[static_cast<size_t>((row * columns_ + column) * kOffsets)]);
+            }
+        }
+    }
+
+    float sampleRate() const { return sampleRate_; }
+
+    /** Whether lookup() serves this setting; below a ~22 Hz sample rate no frequency is. */
+    bool covers(float freqHz, float gainDb) const {
+        return freqHz >= kMinFrequencyHz && freqHz <= kMaxFrequencyRatio * sampleRate_ && std::fabs(gainDb) <= kMaxGainDb;
+    }
+
+    /** Interpolated design for a covered setting. */
+    BiquadCoefficients lookup(float freqHz, float gainDb) const {
+        const float row = std::clamp(position(freqHz), 0.0f, static_cast<float>(rows_ - 1));
+        const float column = (std::clamp(gainDb, -kMaxGainDb, kMaxGainDb) + kMaxGainDb) * kStepsPerDb;
+        const int r = std::min(static_cast<int>(row), rows_ - 2);
+        const int c = std::min(static_cast<int>(column), columns_ - 2);
+        const float fr = row - static_cast<float>(r);
+        const float fc = column - static_cast<float>(c);
+
+        const float* low = &offsets_[static_cast<size_t>((r * columns_ + c) * kOffsets)];
+        const float* high = low + columns_ * kOffsets;
+        float offsets[kOffsets];
+        for (int i = 0; i < kOffsets; ++i) {
+            const float lower = low[i] + (low[i + kOffsets] - low[i]) * fc;
+            const float upper = high[i] + (high[i + kOffsets] - high[i]) * fc;
+            offsets[i] = lower + (upper - lower) * fr;
+        }
+        const float a2 = 1.0f + offsets[3];
+        const float a1 = keepPolesInside(-2.0f + offsets[2], a2);
+        return {1.0f + offsets[0], a1, 1.0f + offsets[1], a1, a2};
+    }
+
+    /**
+     * `a1`, moved just inside the stable triangle if rounding put it on the
+     * edge: with the bump far below fs, 1 + a1 + a2 can fall under float
+     * resolution and leave a pole on the unit circle. |a2| < 1 has room to
+     * spare at any rate.
+     */
+    static float keepPolesInside(float a1, float a2) {
+        const float edge = -1.0f - a2;
+        return a1 > edge ? a1 : std::nextafter(edge, 0.0f);
+    }
+
+    std::size_t bytes() const { return sizeof(*this) + offsets_.capacity() * sizeof(float); }
+
+private:
+    static constexpr int kOffsets = 4; // b0, b2, a1, a2
+
+    /** Row coordinate of `freqHz`: octaves above the first row's, in steps. */
+    float position(float freqHz) const {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &freqHz, sizeof(bits));
+        const int exponent = static_cast<int>((bits >> 23) & 0xFFu) - 127;
+        bits = (bits & 0x7FFFFFu) | 0x3F800000u; // mantissa as a float in [1, 2)
+        float mantissa = 1.0f;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
+        return (static_cast<float>(exponent - minExponent_) + (mantissa - 1.0f)) * kStepsPerOctave;
+    }
+
+    static void storeOffsets(double omega, double gainDb, float* offsets) {
+        const double alpha = std::sin(omega) / (2.0 * kQ);
+        const double a = std::pow(10.0, gainDb / 40.0);
+        const double a0 = 1.0 + alpha / a;
+        const double halfSin = std::sin(0.5 * omega);
+        // 1 - cos(omega) without the cancellation.
+        const double oneMinusCos = 2.0 * halfSin * halfSin;
+        offsets[0] = static_cast<float>((alpha * a - alpha / a) / a0);
+        offsets[1] = static_cast<float>(-(alpha * a + alpha / a) / a0);
+        offsets[2] = static_cast<float>(2.0 * (oneMinusCos + alpha / a) / a0);
+        offsets[3] = static_cast<float>(-2.0 * alpha / (a * a0));
+    }
+
+    float sampleRate_;
+    int minExponent_ = 0;
+    int rows_ = 0;
+    int columns_ = 0;
+    std::vector<float> offsets_;
+};
+
+/**
+ * Low-frequency resonant filter that recreates analog head bump coloration.
+ * Every track shares one smoothed coefficient set, so only the two state
+ * variables are per track; they are stored as struct-of-arrays so a frame's
+ * tracks are filtered across contiguous lanes.
+ */
 class HeadBump {
 public:
     void prepare(float sampleRate, int channels) {
@@ -15,64 +154,89 @@ public:
             channels = 1;
         }
 
-        if (static_cast<int>(filters_.size()) != channels) {
-            filters_.assign(static_cast<size_t>(channels), Filter{});
-        } else {
-            for (auto& filter : filters_) {
-                filter.resetState();
-            }
+        z1_.assign(static_cast<size_t>(channels), 0.0f);
+        z2_.assign(static_cast<size_t>(channels), 0.0f);
+        if (!table_ || table_->sampleRate() != sampleRate_) {
+            table_ = SharedTableCache<HeadBumpTable>::acquire(sampleRate_);
         }
 
         updateSmoothingCoefficient();
-        auto unity = Coeffs::unity();
-        for (auto& filter : filters_) {
-            filter.setImmediate(unity);
-        }
+        current_ = Coeffs::unity();
+        target_ = Coeffs::unity();
     }
 
     void reset() {
-        for (auto& filter : filters_) {
-            filter.resetState();
-        }
+        std::fill(z1_.begin(), z1_.end(), 0.0f);
+        std::fill(z2_.begin(), z2_.end(), 0.0f);
     }
 
     void setParams(float freqHz, float gainDb) {
-        if (filters_.empty()) {
+        if (z1_.empty()) {
             return;
         }
+        const BiquadCoefficients c = design(freqHz, gainDb);
+        target_ = {c.b0, c.b1, c.b2, c.a1, c.a2};
+    }
 
-        if (!std::isfinite(freqHz)) {
-            freqHz = defaultFrequency();
-        }
-        if (!std::isfinite(gainDb)) {
-            gainDb = 0.0f;
-        }
+    /**
+     * The coefficients setParams(`freqHz`, `gainDb`) would target at the
+     * prepared rate, from the shared HeadBumpTable.
+     */
+    BiquadCoefficients design(float freqHz, float gainDb) const {
+        return designWith(freqHz, gainDb, true);
+    }
 
-        freqHz = std::clamp(freqHz, minFrequency(), maxFrequency());
-        if (std::fabs(gainDb) < 1.0e-4f) {
-            auto unity = Coeffs::unity();
-            for (auto& filter : filters_) {
-                filter.setTarget(unity);
-            }
-            return;
-        }
+    /** design() computed directly instead of looked up, e.g. to measure the table against. */
+    BiquadCoefficients designExact(float freqHz, float gainDb) const {
+        return designWith(freqHz, gainDb, false);
+    }
 
-        auto coeffs = designPeaking(freqHz, gainDb);
-        for (auto& filter : filters_) {
-            filter.setTarget(coeffs);
+    /**
+     * Target precomputed coefficients, e.g. a blend of two design() results;
+     * the filter glides to them as it does after setParams. Blends of stable
+     * designs stay stable: the stable (a1, a2) region is a convex triangle.
+     */
+    void setCoefficients(const BiquadCoefficients& c) {
+        if (z1_.empty()) {
+            return;
         }
+        target_ = {c.b0, c.b1, c.b2, c.a1, c.a2};
     }
 
+    /**
+     * Filter one sample of a single-channel stream. Coefficient smoothing
+     * advances on every call, so use process() for multi-channel buffers.
+     */
     float processSample(float x, int channel) {
-        if (filters_.empty()) {
+        if (z1_.empty()) {
             return x;
         }
-        int idx = std::clamp(channel, 0, static_cast<int>(filters_.size()) - 1);
-        return filters_[static_cast<size_t>(idx)].process(x, smoothingCoeff_);
+        int idx = std::clamp(channel, 0, static_cast<int>(z1_.size()) - 1);
+        advanceSmoothing();
+        return filterLane(current_, x, z1_[static_cast<size_t>(idx)], z2_[static_cast<size_t>(idx)]);
+    }
+
+    /** Filter an interleaved buffer in place, advancing smoothing once per frame. */
+    void process(float* interleaved, int frames, int channels) {
+        if (!interleaved || frames <= 0 || channels <= 0 || z1_.empty()) {
+            return;
+        }
+        const int lanes = std::min(channels, static_cast<int>(z1_.size()));
+        // Fixed-width kernels assume every channel of the frame is filtered.
+        const int width = lanes == channels ? channels : 0;
+        if (width != kernelWidth_) {
+            selectKernel(width);
+        }
+        (this->*kernel_)(interleaved, frames, channels, lanes);
     }
 
     int channelCount() const {
-        return static_cast<int>(filters_.size());
+        return static_cast<int>(z1_.size());
+    }
+
+    /** The smoothed coefficients the next frame will use. */
+    BiquadCoefficients coefficients() const {
+        return {current_.b0, current_.b1, current_.b2, current_.a1, current_.a2};
     }
 
 private:
@@ -88,70 +252,71 @@ private:
         }
     };
 
-    struct Filter {
-        Coeffs current;
-        Coeffs target;
-        float z1;
-        float z2;
-
-        Filter()
-        : current(Coeffs::unity()),
-          target(Coeffs::unity()),
-          z1(0.0f),
-          z2(0.0f) {}
+    using Kernel = void (HeadBump::*)(float*, int, int, int);
 
-        void setTarget(const Coeffs& coeffs) {
-            target = coeffs;
-        }
+    void selectKernel(int width) {
+        kernelWidth_ = width;
+        kernel_ = selectChannelKernel(width, [](auto w) -> Kernel {
+            return &HeadBump::processFrames<decltype(w)::value>;
+        });
+    }
 
-        void setImmediate(const Coeffs& coeffs) {
-            current = coeffs;
-            target = coeffs;
+    template <int Width>
+    void processFrames(float* interleaved, int frames, int channels, int lanes) {
+        const int stride = kernelLanes<Width>(channels);
+        const int count = kernelLanes<Width>(lanes);
+        float* z1 = z1_.data();
+        float* z2 = z2_.data();
+        for (int frame = 0; frame < frames; ++frame) {
+            advanceSmoothing();
+            const Coeffs c = current_;
+            float* x = interleaved + frame * stride;
+            for (int lane = 0; lane < count; ++lane) {
+                x[lane] = filterLane(c, x[lane], z1[lane], z2[lane]);
+            }
         }
+    }
 
-        void resetState() {
-            z1 = 0.0f;
-            z2 = 0.0f;
+    void advanceSmoothing() {
+        const float smoothing = smoothingCoeff_;
+        if (smoothing > 0.0f && smoothing < 1.0f) {
+            current_.b0 += smoothing * (target_.b0 - current_.b0);
+            current_.b1 += smoothing * (target_.b1 - current_.b1);
+            current_.b2 += smoothing * (target_.b2 - current_.b2);
+            current_.a1 += smoothing * (target_.a1 - current_.a1);
+            current_.a2 += smoothing * (target_.a2 - current_.a2);
+        } else {
+            current_ = target_;
         }
+    }
 
-        float process(float input, float smoothing) {
-            if (smoothing > 0.0f && smoothing < 1.0f) {
-                current.b0 += smoothing * (target.b0 - current.b0);
-                current.b1 += smoothing * (target.b1 - current.b1);
-                current.b2 += smoothing * (target.b2 - current.b2);
-                current.a1 += smoothing * (target.a1 - current.a1);
-                current.a2 += smoothing * (target.a2 - current.a2);
-            } else {
-                current = target;
-            }
-
-            float y = current.b0 * input + z1;
-            float newZ1 = current.b1 * input - current.a1 * y + z2;
-            float newZ2 = current.b2 * input - current.a2 * y;
+    static float filterLane(const Coeffs& c, float input, float& z1, float& z2) {
+        float y = c.b0 * input + z1;
+        float newZ1 = c.b1 * input - c.a1 * y + z2;
+        float newZ2 = c.b2 * input - c.a2 * y;
 
-            if (std::fabs(newZ1) < denormalLimit()) {
-                newZ1 = 0.0f;
-            }
-            if (std::fabs(newZ2) < denormalLimit()) {
-                newZ2 = 0.0f;
-            }
+        if (std::fabs(newZ1) < denormalLimit()) {
+            newZ1 = 0.0f;
+        }
+        if (std::fabs(newZ2) < denormalLimit()) {
+            newZ2 = 0.0f;
+        }
 
-            z1 = newZ1;
-            z2 = newZ2;
+        z1 = newZ1;
+        z2 = newZ2;
 
-            if (!std::isfinite(y)) {
-                return 0.0f;
-            }
-            return y;
+        if (!std::isfinite(y)) {
+            return 0.0f;
         }
-    };
+        return y;
+    }
 
     float maxFrequency() const {
-        return 0.45f * sampleRate_;
+        return HeadBumpTable::kMaxFrequencyRatio * sampleRate_;
     }
 
     static constexpr float minFrequency() {
-        return 10.0f;
+        return HeadBumpTable::kMinFrequencyHz;
     }
 
     static constexpr float defaultFrequency() {
@@ -177,8 +342,28 @@ private:
         }
     }
 
+    BiquadCoefficients designWith(float freqHz, float gainDb, bool useTable) const {
+        if (!std::isfinite(freqHz)) {
+            freqHz = defaultFrequency();
+        }
+        if (!std::isfinite(gainDb)) {
+            gainDb = 0.0f;
+        }
+
+        freqHz = std::clamp(freqHz, minFrequency(), maxFrequency());
+        if (std::fabs(gainDb) < 1.0e-4f) {
+            return {};
+        }
+        if (useTable && table_ && table_->covers(freqHz, gainDb)) {
+            return table_->lookup(freqHz, gainDb);
+        }
+        const Coeffs c = designPeaking(freqHz, gainDb);
+        const float a1 = HeadBumpTable::keepPolesInside(c.a1, c.a2);
+        return {c.b0, a1, c.b2, a1, c.a2};
+    }
+
     Coeffs designPeaking(float freqHz, float gainDb) const {
-        constexpr float qValue = 1.4f;
+        constexpr auto qValue = static_cast<float>(HeadBumpTable::kQ);
         constexpr float pi = 3.14159265358979323846f;
         float omega = 2.0f * pi * freqHz / sampleRate_;
         omega = std::clamp(omega, 0.0f, pi);
@@ -209,6 +394,12 @@ private:
 
     float sampleRate_ = 48000.0f;
     float smoothingCoeff_ = 1.0f;
-    std::vector<Filter> filters_;
+    std::shared_ptr<const HeadBumpTable> table_;
+    Coeffs current_ = Coeffs::unity();
+    Coeffs target_ = Coeffs::unity();
+    ArenaVector<float> z1_;
+    ArenaVector<float> z2_;
+    Kernel kernel_ = &HeadBump::processFrames<0>;
+    int kernelWidth_ = 0;
 };
 
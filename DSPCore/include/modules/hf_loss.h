@@ -2,30 +2,55 @@
 
 #include <algorithm>
 #include <cmath>
-#include <vector>
 
-/** Two-stage low-pass filter that simulates tape head high-frequency roll-off. */
+#include "arena.h"
+#include "channel_kernels.h"
+#include "frequency_response.h"
+
+/**
+ * Two-stage low-pass filter that simulates tape head high-frequency roll-off.
+ * Per-track state is stored as struct-of-arrays so the inner loop over the
+ * tracks of one interleaved frame runs across contiguous lanes.
+ */
 class HFLoss {
 public:
     void prepare(float sampleRate, int maxChannels);
     void reset();
 
     void setCutoff(float cutoffHz);
+    /** The one-pole coefficient setCutoff(`cutoffHz`) would target, e.g. to precompute a morph. */
+    float coefficientFor(float cutoffHz) const;
+    /** Target a coefficient from coefficientFor() directly; it is smoothed like a cutoff change. */
+    void setCoefficient(float g) { gTarget_ = std::clamp(g, 0.0f, 1.0f); }
 
     void process(float* interleaved, int frames, int channels);
 
+    /** The smoothed one-pole coefficient used for the last block. */
+    float coefficient() const { return gCurrent_; }
+    /** Multiply `response` by both stages running at coefficient `g`. */
+    static void applyResponse(FrequencyResponse& response, float g) {
+        response.applyOnePole(g);
+        response.applyOnePole(g);
+    }
+
 private:
-    struct ChannelState {
-        float stage1 = 0.0f;
-        float stage2 = 0.0f;
-    };
+    static constexpr float kOpenCutoffHz = 20000.0f;
 
     float sampleRate_ = 48000.0f;
-    float cutoffTarget_ = 20000.0f;
+    float cutoffTarget_ = kOpenCutoffHz;
     float gTarget_ = 1.0f;
     float gCurrent_ = 1.0f;
 
-    std::vector<ChannelState> channels_;
+    ArenaVector<float> stage1_;
+    ArenaVector<float> stage2_;
+
+    using Kernel = void (HFLoss::*)(float*, int, int, float);
+    Kernel kernel_ = &HFLoss::processFrames<0>;
+    int kernelWidth_ = 0;
+
+    void selectKernel(int channels);
+    template <int Width>
+    void processFrames(float* interleaved, int frames, int channels, float g);
 
     static float computeOnePoleCoefficient(float cutoffHz, float sampleRate);
     float smoothingAlpha(int frames) const;
@@ -33,17 +58,19 @@ private:
 
 inline void HFLoss::prepare(float sampleRate, int maxChannels) {
     sampleRate_ = std::max(sampleRate, 1.0f);
-    channels_.assign(std::max(maxChannels, 1), ChannelState{});
-    setCutoff(cutoffTarget_);
+    const size_t count = static_cast<size_t>(std::max(maxChannels, 1));
+    stage1_.assign(count, 0.0f);
+    stage2_.assign(count, 0.0f);
+    // Start fully open regardless of earlier settings, so a re-prepared filter
+    // glides to its next cutoff exactly as a new one does.
+    setCutoff(kOpenCutoffHz);
     gCurrent_ = gTarget_;
     reset();
 }
 
 inline void HFLoss::reset() {
-    for (auto& ch : channels_) {
-        ch.stage1 = 0.0f;
-        ch.stage2 = 0.0f;
-    }
+    std::fill(stage1_.begin(), stage1_.end(), 0.0f);
+    std::fill(stage2_.begin(), stage2_.end(), 0.0f);
 }
 
 inline void HFLoss::setCutoff(float cutoffHz) {
@@ -51,6 +78,10 @@ inline void HFLoss::setCutoff(float cutoffHz) {
     gTarget_ = computeOnePoleCoefficient(cutoffTarget_, sampleRate_);
 }
 
+inline float HFLoss::coefficientFor(float cutoffHz) const {
+    return computeOnePoleCoefficient(std::clamp(cutoffHz, 20.0f, sampleRate_ * 0.49f), sampleRate_);
+}
+
 inline float HFLoss::computeOnePoleCoefficient(float cutoffHz, float sampleRate) {
     float nyquist = sampleRate * 0.5f;
     if (cutoffHz >= nyquist * 0.98f) {
@@ -76,24 +107,38 @@ inline void HFLoss::process(float* interleaved, int frames, int channels) {
         return;
     }
 
-    if ((int)channels_.size() < channels) {
-        channels_.resize(channels);
+    if ((int)stage1_.size() < channels) {
+        stage1_.resize(channels, 0.0f);
+        stage2_.resize(channels, 0.0f);
     }
 
     float alpha = smoothingAlpha(frames);
     gCurrent_ += (gTarget_ - gCurrent_) * alpha;
 
-    float g = gCurrent_;
+    if (channels != kernelWidth_) {
+        selectKernel(channels);
+    }
+    (this->*kernel_)(interleaved, frames, channels, gCurrent_);
+}
+
+inline void HFLoss::selectKernel(int channels) {
+    kernelWidth_ = channels;
+    kernel_ = selectChannelKernel(channels, [](auto w) -> Kernel {
+        return &HFLoss::processFrames<decltype(w)::value>;
+    });
+}
 
+template <int Width>
+inline void HFLoss::processFrames(float* interleaved, int frames, int channels, float g) {
+    const int lanes = kernelLanes<Width>(channels);
+    float* s1 = stage1_.data();
+    float* s2 = stage2_.data();
     for (int frame = 0; frame < frames; ++frame) {
-        for (int ch = 0; ch < channels; ++ch) {
-            auto& state = channels_[ch];
-            int idx = frame * channels + ch;
-            float x = interleaved[idx];
-
-            state.stage1 += g * (x - state.stage1);
-            state.stage2 += g * (state.stage1 - state.stage2);
-            interleaved[idx] = state.stage2;
+        float* x = interleaved + frame * lanes;
+        for (int ch = 0; ch < lanes; ++ch) {
+            s1[ch] += g * (x[ch] - s1[ch]);
+            s2[ch] += g * (s1[ch] - s2[ch]);
+            x[ch] = s2[ch];
         }
     }
 }
@@ -1,26 +1,61 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <random>
-#include <vector>
 
-/** Wideband noise generator used to add subtle tape hiss. */
+#include "arena.h"
+#include "channel_kernels.h"
+#include "counter_rng.h"
+
+/**
+ * Wideband noise generator used to add subtle tape hiss. Every channel draws
+ * from its own counter-based stream, keyed by the seed and the absolute track
+ * index, so the noise at a given frame of a given track is the same no matter
+ * which instance (or thread) renders it or how playback got there.
+ *
+ * At half rate a white sample is drawn every other frame and the frames in
+ * between take the mean of their neighbours, which halves the noise
+ * generation. The averaged frames carry half the power and sit closer to
+ * their neighbours, so the tilt is renormalised to keep the overall hiss
+ * level; its top octave rolls off. Half rate
+ * is a stream of its own, so switching reseeks at the current position.
+ */
 class Hiss {
 public:
     Hiss();
 
-    void prepare(float sampleRate, int maxChannels);
+    /** `firstChannel` is the absolute track index of this instance's channel 0. */
+    void prepare(float sampleRate, int maxChannels, int firstChannel = 0);
     void reset();
 
     void setLevelDbFS(float levelDb);
+    /** Level as a linear gain, e.g. a blend of two setLevelDbFS() settings. */
+    void setLevelLinear(float level) { levelLinear_ = std::max(level, 0.0f); }
     void setSeed(uint64_t seed);
 
+    void setHalfRate(bool enabled);
+    bool halfRate() const { return halfRate_; }
+
+    /**
+     * Jump every channel's noise stream to absolute frame `position`. Streams
+     * are counter-based, so the result matches having processed that many
+     * frames and costs O(channels).
+     */
+    void seek(uint64_t position);
+
     void process(float* interleaved, int frames, int channels);
 
 private:
     struct ChannelState {
         float prevWhite = 0.0f;
+        uint64_t key = 0;
+        uint64_t counter = 0; // splitmix draws taken; each yields two normals
+        float spareNormal = 0.0f;
+        bool hasSpare = false;
+        float knot = 0.0f;     // half rate: the draw for the current even frame
+        float nextKnot = 0.0f; // half rate: the draw for the next even frame, once taken
     };
 
     float levelDb_ = -120.0f;
@@ -28,13 +63,28 @@ private:
 
     float tiltAmount_ = 0.35f;
     float tiltNorm_ = 1.0f;
+    float halfRateNorm_ = 1.0f;
 
-    std::mt19937_64 rng_;
-    std::normal_distribution<float> normal_{0.0f, 1.0f};
+    uint64_t seed_ = 0;
+    int firstChannel_ = 0;
+    uint64_t position_ = 0;    // frames rendered (or skipped) since the start
+    bool streamsStale_ = false; // frames were skipped while silent
+    bool halfRate_ = false;
+    ArenaVector<ChannelState> channels_;
 
-    std::vector<ChannelState> channels_;
+    using Kernel = void (Hiss::*)(float*, int, int, float, uint64_t);
+    Kernel kernel_ = &Hiss::processFrames<0>;
+    int kernelWidth_ = 0;
+
+    template <int Width>
+    void processFrames(float* interleaved, int frames, int channels, float level, uint64_t start);
+    template <int Width>
+    void processFramesHalfRate(float* interleaved, int frames, int channels, float level, uint64_t start);
 
     void updateTiltNormalization();
+    void positionChannel(ChannelState& state, int channelIndex, uint64_t position) const;
+    static float nextNormal(ChannelState& state);
+    static void seekNormal(ChannelState& state, uint64_t index);
 };
 
 inline Hiss::Hiss() {
@@ -48,10 +98,14 @@ inline Hiss::Hiss() {
 inline void Hiss::updateTiltNormalization() {
     float t = tiltAmount_;
     tiltNorm_ = 1.0f / std::sqrt(std::max(1.0f + 2.0f * t + 2.0f * t * t, 1e-6f));
+    // Half rate: even frames have unit variance, odd ones 1/2, and neighbours covary by 1/2.
+    const float a = 1.0f + t;
+    halfRateNorm_ = 1.0f / std::sqrt(std::max(0.75f * (a * a + t * t) - a * t, 1e-6f));
 }
 
-inline void Hiss::prepare(float sampleRate, int maxChannels) {
+inline void Hiss::prepare(float sampleRate, int maxChannels, int firstChannel) {
     (void)sampleRate;
+    firstChannel_ = std::max(firstChannel, 0);
     channels_.assign(std::max(maxChannels, 1), ChannelState{});
     // Re-seed deterministically so two freshly-prepared instances with the same
     // configuration produce identical hiss. (The constructor seeds from
@@ -61,9 +115,7 @@ inline void Hiss::prepare(float sampleRate, int maxChannels) {
 }
 
 inline void Hiss::reset() {
-    for (auto& ch : channels_) {
-        ch.prevWhite = 0.0f;
-    }
+    seek(0);
 }
 
 inline void Hiss::setLevelDbFS(float levelDb) {
@@ -76,7 +128,85 @@ inline void Hiss::setLevelDbFS(float levelDb) {
 }
 
 inline void Hiss::setSeed(uint64_t seed) {
-    rng_.seed(seed);
+    seed_ = seed;
+    seek(position_);
+}
+
+inline void Hiss::setHalfRate(bool enabled) {
+    if (enabled == halfRate_) {
+        return;
+    }
+    halfRate_ = enabled;
+    kernelWidth_ = 0;
+    seek(position_);
+}
+
+inline void Hiss::seek(uint64_t position) {
+    position_ = position;
+    streamsStale_ = false;
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        positionChannel(channels_[i], static_cast<int>(i), position);
+    }
+}
+
+// One white sample is drawn per frame and each counter step yields a pair of
+// normals, so frame n uses step n / 2. prevWhite must hold frame n - 1.
+// At half rate the n-th normal is the white sample of frame 2n, and an odd
+// frame 2n + 1 takes the mean of normals n and n + 1.
+inline void Hiss::positionChannel(ChannelState& state, int channelIndex, uint64_t position) const {
+    state.key = CounterRng::subKey(seed_, static_cast<uint64_t>(firstChannel_ + channelIndex));
+    state.counter = 0;
+    state.hasSpare = false;
+    state.prevWhite = 0.0f;
+    if (halfRate_) {
+        const uint64_t pair = position / 2;
+        if (position % 2 == 1) {
+            seekNormal(state, pair);
+            state.knot = nextNormal(state);
+            state.nextKnot = nextNormal(state);
+            state.prevWhite = state.knot;
+        } else if (position > 0) {
+            seekNormal(state, pair - 1);
+            const float previous = nextNormal(state);
+            state.knot = nextNormal(state);
+            state.prevWhite = 0.5f * (previous + state.knot);
+        } else {
+            state.knot = nextNormal(state);
+        }
+        return;
+    }
+    if (position == 0) {
+        return;
+    }
+    const uint64_t previous = position - 1;
+    state.counter = previous / 2;
+    const float even = nextNormal(state);
+    state.prevWhite = (previous % 2 == 0) ? even : nextNormal(state);
+}
+
+/** Make `index` the next normal the state draws. */
+inline void Hiss::seekNormal(ChannelState& state, uint64_t index) {
+    state.counter = index / 2;
+    state.hasSpare = false;
+    if (index % 2 == 1) {
+        nextNormal(state);
+    }
+}
+
+// Box-Muller over 24-bit uniforms; each pair of draws yields two normals.
+inline float Hiss::nextNormal(ChannelState& state) {
+    if (state.hasSpare) {
+        state.hasSpare = false;
+        return state.spareNormal;
+    }
+    const uint64_t bits = CounterRng::bits(state.key, state.counter++);
+    const float u1 = (static_cast<float>(bits >> 40) + 1.0f) * (1.0f / 16777217.0f);
+    const float u2 = static_cast<float>((bits >> 16) & 0xFFFFFFu) * (1.0f / 16777216.0f);
+    const float radius = std::sqrt(-2.0f * std::log(u1));
+    const float angle = 6.28318530718f * u2;
+    state.spareNormal = radius * std::sin(angle);
+    state.hasSpare = true;
+    return radius * std::cos(angle);
 }
 
 inline void Hiss::process(float* interleaved, int frames, int channels) {
@@ -85,24 +215,74 @@ inline void Hiss::process(float* interleaved, int frames, int channels) {
     }
 
     if ((int)channels_.size() < channels) {
+        const size_t previous = channels_.size();
         channels_.resize(channels);
+        for (size_t i = previous; i < channels_.size(); ++i) {
+            positionChannel(channels_[i], static_cast<int>(i), position_);
+        }
     }
 
     const float level = levelLinear_;
     if (level <= 0.0f) {
+        // Keep counting so the noise at a given frame does not depend on
+        // whether hiss was muted earlier; the streams catch up lazily.
+        position_ += static_cast<uint64_t>(frames);
+        streamsStale_ = true;
         return;
     }
+    if (streamsStale_) {
+        seek(position_);
+    }
+    const uint64_t start = position_;
+    position_ += static_cast<uint64_t>(frames);
 
+    if (channels != kernelWidth_) {
+        kernelWidth_ = channels;
+        kernel_ = selectChannelKernel(channels, [this](auto w) -> Kernel {
+            constexpr int width = decltype(w)::value;
+            return halfRate_ ? &Hiss::processFramesHalfRate<width> : &Hiss::processFrames<width>;
+        });
+    }
+    (this->*kernel_)(interleaved, frames, channels, level, start);
+}
+
+template <int Width>
+inline void Hiss::processFrames(float* interleaved, int frames, int channels, float level, uint64_t /*start*/) {
+    const int lanes = kernelLanes<Width>(channels);
+    ChannelState* states = channels_.data();
     for (int frame = 0; frame < frames; ++frame) {
-        for (int ch = 0; ch < channels; ++ch) {
-            auto& state = channels_[ch];
-            float white = normal_(rng_);
+        float* x = interleaved + frame * lanes;
+        for (int ch = 0; ch < lanes; ++ch) {
+            auto& state = states[ch];
+            float white = nextNormal(state);
             float colored = ((1.0f + tiltAmount_) * white - tiltAmount_ * state.prevWhite) * tiltNorm_;
             state.prevWhite = white;
-
-            int idx = frame * channels + ch;
-            interleaved[idx] += colored * level;
+            x[ch] += colored * level;
         }
     }
 }
 
+template <int Width>
+inline void Hiss::processFramesHalfRate(float* interleaved, int frames, int channels, float level, uint64_t start) {
+    const float gain = level * halfRateNorm_;
+    const int lanes = kernelLanes<Width>(channels);
+    ChannelState* states = channels_.data();
+    for (int frame = 0; frame < frames; ++frame) {
+        float* x = interleaved + frame * lanes;
+        const bool odd = ((start + static_cast<uint64_t>(frame)) & 1u) != 0;
+        for (int ch = 0; ch < lanes; ++ch) {
+            auto& state = states[ch];
+            float white;
+            if (odd) {
+                white = 0.5f * (state.knot + state.nextKnot);
+                state.knot = state.nextKnot;
+            } else {
+                white = state.knot;
+                state.nextKnot = nextNormal(state);
+            }
+            const float colored = (1.0f + tiltAmount_) * white - tiltAmount_ * state.prevWhite;
+            state.prevWhite = white;
+            x[ch] += colored * gain;
+        }
+    }
+}
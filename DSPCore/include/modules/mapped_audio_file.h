@@ -0,0 +1,308 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "pcm_convert.h"
+
+/**
+ * Read-only memory map of an uncompressed audio file: CAF (what the recorder
+ * writes) or WAV, holding 16/24/32-bit integer or 32/64-bit float linear PCM
+ * in either byte order. Opening parses the header and maps the file once;
+ * reading frames afterwards is a plain decode from the mapping, with no
+ * system calls, so it is safe on the audio thread once the pages are
+ * resident.
+ */
+class MappedAudioFile {
+public:
+    MappedAudioFile() = default;
+    MappedAudioFile(const MappedAudioFile&) = delete;
+    MappedAudioFile& operator=(const MappedAudioFile&) = delete;
+    ~MappedAudioFile() { close(); }
+
+    /** Map `path` and parse its header. Returns false (and stays closed) on failure. */
+    bool open(const std::string& path) {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        base_ = static_cast<const uint8_t*>(mapping);
+        size_ = static_cast<size_t>(info.st_size);
+        path_ = path;
+        if (!parseCaf() && !parseWav()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_) {
+            ::munmap(const_cast<uint8_t*>(base_), size_);
+        }
+        base_ = nullptr;
+        size_ = 0;
+        data_ = nullptr;
+        frames_ = 0;
+        decode_ = nullptr;
+    }
+
+    bool isOpen() const { return decode_ != nullptr; }
+
+    /** False once the file on disk has changed size since it was mapped, e.g. a take still being written. */
+    bool matchesDisk() const {
+        struct stat info {};
+        return isOpen() && ::stat(path_.c_str(), &info) == 0 && static_cast<size_t>(info.st_size) == size_;
+    }
+    const std::string& path() const { return path_; }
+    /** Size of the mapped file in bytes. */
+    size_t fileBytes() const { return size_; }
+    double sampleRate() const { return sampleRate_; }
+    int channels() const { return channels_; }
+    int64_t frames() const { return frames_; }
+
+    /**
+     * Ask the kernel to start reading `frames` frames from `start` into the
+     * page cache, so the audio thread does not fault on them later.
+     */
+    void prefetch(int64_t start, int64_t frames) const {
+        if (!decode_ || frames <= 0) {
+            return;
+        }
+        start = std::clamp<int64_t>(start, 0, frames_);
+        const int64_t end = std::clamp<int64_t>(start + frames, 0, frames_);
+        const size_t frameBytes = static_cast<size_t>(bytesPerSample_) * static_cast<size_t>(channels_);
+        const size_t first = static_cast<size_t>(data_ - base_) + static_cast<size_t>(start) * frameBytes;
+        const size_t last = static_cast<size_t>(data_ - base_) + static_cast<size_t>(end) * frameBytes;
+        const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t aligned = first / page * page;
+        if (last > aligned) {
+            ::madvise(const_cast<uint8_t*>(base_) + aligned, last - aligned, MADV_WILLNEED);
+        }
+    }
+
+    /**
+     * Write `frames` samples of `channel` starting at file frame `start`,
+     * scaled by `gain`, to `out` with a stride of `outStride` floats. Frames
+     * outside the file are written as silence.
+     */
+    void read(int64_t start, int frames, int channel, float gain, float* out, int outStride) const {
+        int done = 0;
+        if (start < 0) {
+            const int lead = static_cast<int>(std::min<int64_t>(-start, frames));
+            for (; done < lead; ++done) {
+                out[static_cast<size_t>(done) * static_cast<size_t>(outStride)] = 0.0f;
+            }
+        }
+        const int64_t first = start + done;
+        const int available = first < frames_ ? static_cast<int>(std::min<int64_t>(frames - done, frames_ - first)) : 0;
+        if (available > 0 && decode_) {
+            const size_t frameBytes = static_cast<size_t>(bytesPerSample_) * static_cast<size_t>(channels_);
+            const uint8_t* src = data_ + static_cast<size_t>(first) * frameBytes +
+                                 static_cast<size_t>(std::clamp(channel, 0, channels_ - 1)) * bytesPerSample_;
+            decode_(src, frameBytes, available, gain, out + static_cast<size_t>(done) * static_cast<size_t>(outStride),
+                    outStride);
+            done += available;
+        }
+        for (; done < frames; ++done) {
+            out[static_cast<size_t>(done) * static_cast<size_t>(outStride)] = 0.0f;
+        }
+    }
+
+private:
+    using Decoder = void (*)(const uint8_t*, size_t, int, float, float*, int);
+
+    // Byte-swapped copy of a big-endian sample, so the little-endian readers apply.
+    template <int Bytes, bool BigEndian>
+    static const uint8_t* ordered(const uint8_t* p, uint8_t (&swapped)[8]) {
+        if (!BigEndian) {
+            return p;
+        }
+        for (int i = 0; i < Bytes; ++i) {
+            swapped[i] = p[Bytes - 1 - i];
+        }
+        return swapped;
+    }
+
+    template <typename Format, bool BigEndian>
+    static void decodeInt(const uint8_t* src, size_t stride, int frames, float gain, float* out, int outStride) {
+        const float scale = gain / static_cast<float>(1ull << (Format::kBits - 1));
+        uint8_t swapped[8];
+        for (int i = 0; i < frames; ++i) {
+            const uint8_t* p = ordered<Format::kBytes, BigEndian>(src + static_cast<size_t>(i) * stride, swapped);
+            out[static_cast<size_t>(i) * static_cast<size_t>(outStride)] = static_cast<float>(Format::read(p)) * scale;
+        }
+    }
+
+    template <typename Float, bool BigEndian>
+    static void decodeFloat(const uint8_t* src, size_t stride, int frames, float gain, float* out, int outStride) {
+        uint8_t swapped[8];
+        for (int i = 0; i < frames; ++i) {
+            const uint8_t* p = ordered<sizeof(Float), BigEndian>(src + static_cast<size_t>(i) * stride, swapped);
+            Float value;
+            std::memcpy(&value, p, sizeof(value));
+            out[static_cast<size_t>(i) * static_cast<size_t>(outStride)] = static_cast<float>(value) * gain;
+        }
+    }
+
+    template <bool BigEndian>
+    static Decoder selectDecoder(bool isFloat, int bits) {
+        if (isFloat) {
+            return bits == 32 ? &decodeFloat<float, BigEndian> : bits == 64 ? &decodeFloat<double, BigEndian> : nullptr;
+        }
+        switch (bits) {
+        case 16:
+            return &decodeInt<Pcm16, BigEndian>;
+        case 24:
+            return &decodeInt<Pcm24, BigEndian>;
+        case 32:
+            return &decodeInt<Pcm32, BigEndian>;
+        default:
+            return nullptr;
+        }
+    }
+
+    bool setFormat(double sampleRate, int channels, int bits, bool isFloat, bool bigEndian, size_t dataOffset,
+                   uint64_t dataBytes) {
+        if (!(sampleRate > 0.0) || channels <= 0 || bits % 8 != 0 || dataOffset > size_) {
+            return false;
+        }
+        decode_ = bigEndian ? selectDecoder<true>(isFloat, bits) : selectDecoder<false>(isFloat, bits);
+        if (!decode_) {
+            return false;
+        }
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+        bytesPerSample_ = bits / 8;
+        data_ = base_ + dataOffset;
+        // A take still being written may declare more data than is on disk.
+        const uint64_t bytes = std::min<uint64_t>(dataBytes, size_ - dataOffset);
+        frames_ = static_cast<int64_t>(bytes / (static_cast<uint64_t>(bytesPerSample_) * static_cast<uint64_t>(channels)));
+        return true;
+    }
+
+    static uint32_t be32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+    static uint64_t be64(const uint8_t* p) { return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4); }
+    static uint32_t le32(const uint8_t* p) {
+        return p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+               (static_cast<uint32_t>(p[3]) << 24);
+    }
+    static uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+    // Core Audio Format: big-endian chunk headers; 'desc' holds an
+    // AudioStreamBasicDescription, 'data' a 4-byte edit count then the samples.
+    bool parseCaf() {
+        if (size_ < 8 || std::memcmp(base_, "caff", 4) != 0) {
+            return false;
+        }
+        double sampleRate = 0.0;
+        int channels = 0;
+        int bits = 0;
+        bool isFloat = false;
+        bool bigEndian = true;
+        bool haveDesc = false;
+        size_t offset = 8;
+        while (offset + 12 <= size_) {
+            const uint8_t* chunk = base_ + offset;
+            const auto chunkSize = static_cast<int64_t>(be64(chunk + 4));
+            const size_t body = offset + 12;
+            if (std::memcmp(chunk, "desc", 4) == 0 && body + 32 <= size_) {
+                uint64_t rateBits = be64(base_ + body);
+                std::memcpy(&sampleRate, &rateBits, sizeof(sampleRate));
+                if (std::memcmp(base_ + body + 8, "lpcm", 4) != 0) {
+                    return false;
+                }
+                const uint32_t flags = be32(base_ + body + 12);
+                isFloat = (flags & 1u) != 0;
+                bigEndian = (flags & 2u) == 0;
+                if (be32(base_ + body + 20) != 1) { // frames per packet
+                    return false;
+                }
+                channels = static_cast<int>(be32(base_ + body + 24));
+                bits = static_cast<int>(be32(base_ + body + 28));
+                haveDesc = true;
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                if (!haveDesc || body + 4 > size_) {
+                    return false;
+                }
+                // Size -1 means the data runs to the end of the file.
+                const uint64_t bytes = chunkSize < 4 ? UINT64_MAX : static_cast<uint64_t>(chunkSize) - 4;
+                return setFormat(sampleRate, channels, bits, isFloat, bigEndian, body + 4, bytes);
+            }
+            if (chunkSize < 0 || static_cast<uint64_t>(chunkSize) > size_ - body) {
+                return false;
+            }
+            offset = body + static_cast<size_t>(chunkSize);
+        }
+        return false;
+    }
+
+    // RIFF/WAVE: little-endian chunks padded to even sizes.
+    bool parseWav() {
+        if (size_ < 12 || std::memcmp(base_, "RIFF", 4) != 0 || std::memcmp(base_ + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+        double sampleRate = 0.0;
+        int channels = 0;
+        int bits = 0;
+        bool isFloat = false;
+        bool haveFormat = false;
+        size_t offset = 12;
+        while (offset + 8 <= size_) {
+            const uint8_t* chunk = base_ + offset;
+            const uint32_t chunkSize = le32(chunk + 4);
+            const size_t body = offset + 8;
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && body + 16 <= size_) {
+                uint16_t tag = le16(base_ + body);
+                if (tag == 0xFFFE && chunkSize >= 40 && body + 26 <= size_) {
+                    tag = le16(base_ + body + 24); // WAVE_FORMAT_EXTENSIBLE sub-format
+                }
+                if (tag != 1 && tag != 3) {
+                    return false;
+                }
+                isFloat = tag == 3;
+                channels = le16(base_ + body + 2);
+                sampleRate = static_cast<double>(le32(base_ + body + 4));
+                bits = le16(base_ + body + 14);
+                haveFormat = true;
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                return haveFormat && setFormat(sampleRate, channels, bits, isFloat, false, body, chunkSize);
+            }
+            offset = body + chunkSize + (chunkSize & 1u);
+        }
+        return false;
+    }
+
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    std::string path_;
+
+    const uint8_t* data_ = nullptr;
+    double sampleRate_ = 0.0;
+    int channels_ = 0;
+    int bytesPerSample_ = 0;
+    int64_t frames_ = 0;
+    Decoder decode_ = nullptr;
+};
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "arena.h"
+
+/**
+ * Odd-branch taps of a half-band filter with `HalfLength` odd-tap pairs
+ * (4 * HalfLength - 1 taps in total): a Kaiser-windowed sinc, normalized so
+ * the full filter has unity DC gain. Every odd offset d from the centre puts
+ * sin(pi * d / 2) at exactly +/-1, so the design needs no trigonometry and is
+ * evaluated entirely at compile time.
+ */
+template <int HalfLength>
+struct HalfbandTaps {
+    static constexpr int kCount = 2 * HalfLength;
+    float values[kCount] = {};
+
+    constexpr HalfbandTaps() {
+        constexpr double beta = 8.0;
+        constexpr double pi = 3.14159265358979323846;
+        const double halfSpan = 0.5 * (static_cast<double>(2 * kCount - 1) - 1.0);
+        double raw[kCount] = {};
+        double sum = 0.0;
+        for (int j = 0; j < kCount; ++j) {
+            // Window index j maps to odd offset d = 2j - (kCount - 1) from the centre tap.
+            const int d = 2 * j - (kCount - 1);
+            const int magnitude = d < 0 ? -d : d;
+            const double sign = ((magnitude - 1) / 2) % 2 == 0 ? 1.0 : -1.0;
+            const double sinc = sign / (pi * static_cast<double>(magnitude));
+            const double ratio = static_cast<double>(d) / halfSpan;
+            const double radicand = 1.0 - ratio * ratio;
+            const double window = besselI0(beta * squareRoot(radicand > 0.0 ? radicand : 0.0)) / besselI0(beta);
+            raw[j] = sinc * window;
+            sum += raw[j];
+        }
+        const double norm = sum != 0.0 ? 0.5 / sum : 0.0;
+        for (int j = 0; j < kCount; ++j) {
+            values[j] = static_cast<float>(raw[j] * norm);
+        }
+    }
+
+private:
+    static constexpr double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        const double halfX = 0.5 * x;
+        for (int k = 1; k < 32; ++k) {
+            term *= (halfX / static_cast<double>(k)) * (halfX / static_cast<double>(k));
+            sum += term;
+            if (term < 1.0e-12 * sum) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    /** Newton's method; converges to the correctly rounded root within a few steps. */
+    static constexpr double squareRoot(double x) {
+        if (x <= 0.0) {
+            return 0.0;
+        }
+        double guess = x > 1.0 ? x : 1.0;
+        for (int i = 0; i < 64; ++i) {
+            const double next = 0.5 * (guess + x / guess);
+            if (next >= guess) {
+                break;
+            }
+            guess = next;
+        }
+        return guess;
+    }
+};
+
+/**
+ * Polyphase half-band FIR used as one 2x stage of the oversampler. Only the
+ * odd taps of a half-band filter are non-zero (besides the 0.5 centre tap), so
+ * each stage splits into a pure delay branch and a short symmetric FIR branch.
+ * Histories are kept linear ([history | block]) so every output is a plain dot
+ * product over contiguous memory that the compiler can vectorize.
+ */
+class HalfbandStage {
+public:
+    /** Use the `2 * halfLength` odd-branch taps at `taps`, which must outlive the stage. */
+    void setTaps(const float* taps, int halfLength) {
+        taps_ = taps;
+        halfLength_ = std::max(halfLength, 1);
+    }
+
+    /** Allocate the linear histories for blocks of up to `maxInputFrames` low-rate frames. */
+    void prepare(int maxInputFrames) {
+        maxFrames_ = std::max(maxInputFrames, 1);
+        const size_t length = static_cast<size_t>(historyLength() + maxFrames_);
+        upBuffer_.assign(length, 0.0f);
+        downEven_.assign(length, 0.0f);
+        downOdd_.assign(length, 0.0f);
+    }
+
+    void reset() {
+        std::fill(upBuffer_.begin(), upBuffer_.end(), 0.0f);
+        std::fill(downEven_.begin(), downEven_.end(), 0.0f);
+        std::fill(downOdd_.begin(), downOdd_.end(), 0.0f);
+    }
+
+    /** Interpolate `frames` input samples into `2 * frames` output samples. */
+    void upsample(const float* input, float* output, int frames) {
+        const int history = historyLength();
+        const int oddTaps = 2 * halfLength_;
+        std::copy(input, input + frames, upBuffer_.begin() + history);
+
+        const float* taps = taps_;
+        for (int i = 0; i < frames; ++i) {
+            const float* window = upBuffer_.data() + i + 1;
+            float acc = 0.0f;
+            for (int j = 0; j < oddTaps; ++j) {
+                acc += taps[j] * window[j];
+            }
+            output[2 * i] = upBuffer_[static_cast<size_t>(i + halfLength_)];
+            output[2 * i + 1] = 2.0f * acc;
+        }
+
+        shiftHistory(upBuffer_, frames);
+    }
+
+    /** Band-limit and decimate `2 * frames` input samples into `frames` outputs. */
+    void downsample(const float* input, float* output, int frames) {
+        const int history = historyLength();
+        const int oddTaps = 2 * halfLength_;
+        float* even = downEven_.data() + history;
+        float* odd = downOdd_.data() + history;
+        for (int i = 0; i < frames; ++i) {
+            even[i] = input[2 * i];
+            odd[i] = input[2 * i + 1];
+        }
+
+        const float* taps = taps_;
+        for (int i = 0; i < frames; ++i) {
+            const float* window = downOdd_.data() + i;
+            float acc = 0.0f;
+            for (int j = 0; j < oddTaps; ++j) {
+                acc += taps[j] * window[j];
+            }
+            output[i] = 0.5f * downEven_[static_cast<size_t>(i + halfLength_)] + acc;
+        }
+
+        shiftHistory(downEven_, frames);
+        shiftHistory(downOdd_, frames);
+    }
+
+private:
+    int historyLength() const { return 2 * halfLength_; }
+
+    void shiftHistory(ArenaVector<float>& buffer, int frames) {
+        const int history = historyLength();
+        std::copy(buffer.begin() + frames, buffer.begin() + frames + history, buffer.begin());
+    }
+
+    const float* taps_ = nullptr;
+    int halfLength_ = 1;
+    int maxFrames_ = 1;
+    ArenaVector<float> upBuffer_;
+    ArenaVector<float> downEven_;
+    ArenaVector<float> downOdd_;
+};
+
+/**
+ * Mono 2x/4x/8x oversampler built from cascaded half-band stages. Buffers for
+ * the maximum factor are allocated in prepare(), so switching factors later is
+ * allocation-free and safe to do from the audio thread.
+ */
+class Oversampler {
+public:
+    static constexpr int kMaxFactor = 8;
+    static constexpr int kStageCount = 3;
+    // The first stage sees the narrowest transition band relative to its
+    // rate, so it gets the longest filter; later stages can be much shorter.
+    static constexpr int kStageHalfLengths[kStageCount] = {12, 6, 4};
+
+    Oversampler() {
+        stages_[0].setTaps(kStage0Taps.values, kStageHalfLengths[0]);
+        stages_[1].setTaps(kStage1Taps.values, kStageHalfLengths[1]);
+        stages_[2].setTaps(kStage2Taps.values, kStageHalfLengths[2]);
+    }
+
+    void prepare(int maxBlockSize) {
+        maxBlock_ = std::max(maxBlockSize, 1);
+        int frames = maxBlock_;
+        for (auto& stage : stages_) {
+            stage.prepare(frames);
+            frames *= 2;
+        }
+        bufferA_.assign(static_cast<size_t>(maxBlock_) * kMaxFactor, 0.0f);
+        bufferB_.assign(static_cast<size_t>(maxBlock_) * kMaxFactor, 0.0f);
+    }
+
+    void reset() {
+        for (auto& stage : stages_) {
+            stage.reset();
+        }
+    }
+
+    /** Select 1, 2, 4 or 8; other values snap to the nearest supported factor below. */
+    void setFactor(int factor) {
+        const int snapped = snapFactor(factor);
+        if (snapped == factor_) {
+            return;
+        }
+        factor_ = snapped;
+        stageCount_ = factor_ == 8 ? 3 : factor_ == 4 ? 2 : factor_ == 2 ? 1 : 0;
+        reset();
+    }
+
+    int factor() const { return factor_; }
+
+    /** Total up + down latency in base-rate samples for the active factor. */
+    int latencySamples() const { return latencyForFactor(factor_); }
+
+    /**
+     * Latency for any factor without needing a prepared instance. Each stage
+     * delays by 2 * halfLength samples at its own input rate.
+     */
+    static int latencyForFactor(int factor) {
+        const int snapped = snapFactor(factor);
+        int latency = 0;
+        int rateMultiple = 1;
+        for (int s = 0; s < kStageCount && (1 << (s + 1)) <= snapped; ++s) {
+            latency += 2 * kStageHalfLengths[s] / rateMultiple;
+            rateMultiple *= 2;
+        }
+        return latency;
+    }
+
+    /**
+     * Run `shaper(float* highRate, int count, int baseOffset)` on an upsampled
+     * copy of `samples`, then decimate the result back into `samples`. Blocks
+     * larger than the prepared size are processed in chunks; `baseOffset` is
+     * the chunk start in base-rate frames so callers can follow parameter ramps.
+     */
+    template <typename Shaper>
+    void process(float* samples, int frames, Shaper&& shaper) {
+        if (!samples || frames <= 0) {
+            return;
+        }
+        if (stageCount_ == 0 || bufferA_.empty()) {
+            shaper(samples, frames, 0);
+            return;
+        }
+
+        for (int offset = 0; offset < frames; offset += maxBlock_) {
+            const int chunk = std::min(maxBlock_, frames - offset);
+            float* block = samples + offset;
+
+            const float* src = block;
+            float* dst = bufferA_.data();
+            int count = chunk;
+            for (int s = 0; s < stageCount_; ++s) {
+                stages_[s].upsample(src, dst, count);
+                count *= 2;
+                src = dst;
+                dst = (dst == bufferA_.data()) ? bufferB_.data() : bufferA_.data();
+            }
+
+            float* highRate = const_cast<float*>(src);
+            shaper(highRate, count, offset);
+
+            for (int s = stageCount_ - 1; s >= 0; --s) {
+                count /= 2;
+                float* out = s == 0 ? block : dst;
+                stages_[s].downsample(src, out, count);
+                src = out;
+                dst = (dst == bufferA_.data()) ? bufferB_.data() : bufferA_.data();
+            }
+        }
+    }
+
+    static int snapFactor(int factor) {
+        if (factor >= 8) {
+            return 8;
+        }
+        if (factor >= 4) {
+            return 4;
+        }
+        if (factor >= 2) {
+            return 2;
+        }
+        return 1;
+    }
+
+private:
+    // Designed by the compiler and shared by every instance.
+    static constexpr HalfbandTaps<kStageHalfLengths[0]> kStage0Taps{};
+    static constexpr HalfbandTaps<kStageHalfLengths[1]> kStage1Taps{};
+    static constexpr HalfbandTaps<kStageHalfLengths[2]> kStage2Taps{};
+
+    HalfbandStage stages_[kStageCount];
+    int factor_ = 1;
+    int stageCount_ = 0;
+    int maxBlock_ = 0;
+    ArenaVector<float> bufferA_;
+    ArenaVector<float> bufferB_;
+};
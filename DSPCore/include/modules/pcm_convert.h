@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "counter_rng.h"
+
+/**
+ * Interleaved integer PCM formats the bridge converts at its edges. Samples
+ * are little-endian; 24-bit samples are packed in three bytes.
+ */
+struct Pcm16 {
+    static constexpr int kBits = 16;
+    static constexpr int kBytes = 2;
+
+    static int32_t read(const uint8_t* p) {
+        int16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    static void write(uint8_t* p, int32_t value) {
+        const auto narrow = static_cast<int16_t>(value);
+        std::memcpy(p, &narrow, sizeof(narrow));
+    }
+};
+
+struct Pcm24 {
+    static constexpr int kBits = 24;
+    static constexpr int kBytes = 3;
+
+    static int32_t read(const uint8_t* p) {
+        const uint32_t raw = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                             (static_cast<uint32_t>(p[2]) << 16);
+        // Move the sign bit to bit 31, then shift back to sign-extend.
+        return static_cast<int32_t>(raw << 8) >> 8;
+    }
+    static void write(uint8_t* p, int32_t value) {
+        const auto raw = static_cast<uint32_t>(value);
+        p[0] = static_cast<uint8_t>(raw);
+        p[1] = static_cast<uint8_t>(raw >> 8);
+        p[2] = static_cast<uint8_t>(raw >> 16);
+    }
+};
+
+struct Pcm32 {
+    static constexpr int kBits = 32;
+    static constexpr int kBytes = 4;
+
+    static int32_t read(const uint8_t* p) {
+        int32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    static void write(uint8_t* p, int32_t value) { std::memcpy(p, &value, sizeof(value)); }
+};
+
+/** Scale `samples` PCM values to floats in [-1, 1). */
+template <typename Format>
+void pcmToFloat(const uint8_t* in, float* out, std::size_t samples) {
+    constexpr float scale = 1.0f / static_cast<float>(1ull << (Format::kBits - 1));
+    for (std::size_t i = 0; i < samples; ++i) {
+        out[i] = static_cast<float>(Format::read(in + i * Format::kBytes)) * scale;
+    }
+}
+
+/**
+ * Quantise floats to PCM, rounding to nearest and clipping at full scale.
+ * With `dither`, triangular (TPDF) noise of +-1 LSB is added first. Its n-th
+ * value comes from CounterRng(ditherKey, ditherCounter + n), so there is no
+ * serial generator state in the loop and `ditherCounter` simply advances by
+ * `samples`.
+ */
+template <typename Format>
+void floatToPcm(const float* in, uint8_t* out, std::size_t samples, bool dither, uint64_t ditherKey,
+                uint64_t& ditherCounter) {
+    // 32-bit output needs more precision than a float carries.
+    using Math = std::conditional_t<(Format::kBits > 24), double, float>;
+    constexpr Math fullScale = static_cast<Math>(1ull << (Format::kBits - 1));
+    constexpr Math lowest = -fullScale;
+    constexpr Math highest = fullScale - 1;
+    constexpr Math kUnit = static_cast<Math>(1.0 / 4294967296.0);
+
+    const uint64_t counter = ditherCounter;
+    for (std::size_t i = 0; i < samples; ++i) {
+        const float sample = in[i] == in[i] ? in[i] : 0.0f; // NaN becomes silence, not a full-scale click
+        Math value = static_cast<Math>(sample) * fullScale;
+        if (dither) {
+            const uint64_t bits = CounterRng::bits(ditherKey, counter + i);
+            value += static_cast<Math>(bits & 0xFFFFFFFFu) * kUnit - static_cast<Math>(bits >> 32) * kUnit;
+        }
+        value = std::min(std::max(value, lowest), highest);
+        Format::write(out + i * Format::kBytes, static_cast<int32_t>(std::floor(value + static_cast<Math>(0.5))));
+    }
+    if (dither) {
+        ditherCounter = counter + samples;
+    }
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Level summary of a stretch of audio: extremes and mean square. */
+struct PeakStats {
+    float min = 0.0f;
+    float max = 0.0f;
+    double sumSquares = 0.0;
+    int64_t frames = 0;
+
+    void merge(const PeakStats& other) {
+        if (other.frames <= 0) {
+            return;
+        }
+        if (frames <= 0) {
+            *this = other;
+            return;
+        }
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        sumSquares += other.sumSquares;
+        frames += other.frames;
+    }
+
+    float rms() const { return frames > 0 ? static_cast<float>(std::sqrt(sumSquares / static_cast<double>(frames))) : 0.0f; }
+};
+
+/**
+ * Min/max/RMS overview of one take at 256, 4096 and 65536 frames per bin,
+ * built incrementally as recorded blocks arrive and saved as a compact
+ * sidecar file, so a waveform at any zoom is drawn without decoding audio.
+ * stats() covers a range with the coarsest bins that fit inside it, so it
+ * touches at most a few dozen bins however long the range is.
+ */
+class PeakPyramid {
+public:
+    static constexpr int kLevels = 3;
+    static constexpr int kFinestBin = 256;
+    static constexpr int kFanout = 16;
+
+    explicit PeakPyramid(double sampleRate = 48000.0) : sampleRate_(sampleRate) {}
+
+    static constexpr int64_t binFrames(int level) {
+        int64_t size = kFinestBin;
+        for (int i = 0; i < level; ++i) {
+            size *= kFanout;
+        }
+        return size;
+    }
+
+    double sampleRate() const { return sampleRate_; }
+    int64_t frames() const { return frames_; }
+    size_t binCount(int level) const { return levels_[level].size(); }
+
+    /** Where the sidecar of the take at `takePath` lives: next to it, with ".peaks" appended. */
+    static std::string sidecarPath(const std::string& takePath) { return takePath + ".peaks"; }
+
+    /** Append `frames` samples read with a stride of `stride` floats. Allocates as bins are added. */
+    void append(const float* samples, int frames, int stride) {
+        int done = 0;
+        while (done < frames) {
+            // Run up to the end of the current finest bin.
+            const int64_t inBin = frames_ % kFinestBin;
+            const int run = static_cast<int>(std::min<int64_t>(frames - done, kFinestBin - inBin));
+            PeakStats stats;
+            stats.min = stats.max = samples[static_cast<size_t>(done) * static_cast<size_t>(stride)];
+            for (int i = 0; i < run; ++i) {
+                const float x = samples[static_cast<size_t>(done + i) * static_cast<size_t>(stride)];
+                stats.min = std::min(stats.min, x);
+                stats.max = std::max(stats.max, x);
+                stats.sumSquares += static_cast<double>(x) * static_cast<double>(x);
+            }
+            stats.frames = run;
+            for (int level = 0; level < kLevels; ++level) {
+                const auto index = static_cast<size_t>(frames_ / binFrames(level));
+                if (levels_[level].size() <= index) {
+                    levels_[level].push_back(Bin{});
+                    open_[level] = PeakStats{};
+                }
+                open_[level].merge(stats);
+                levels_[level][index] = Bin::from(open_[level]);
+            }
+            frames_ += run;
+            done += run;
+        }
+    }
+
+    /**
+     * Summary of frames [start, end). The inside of the range is read from
+     * the coarsest level that fits and each end from finer levels, so only
+     * the finest bins at the two ends can reach past the range.
+     */
+    PeakStats stats(int64_t start, int64_t end) const {
+        PeakStats result;
+        start = std::max<int64_t>(start, 0);
+        end = std::min(end, frames_);
+        if (end <= start) {
+            return result;
+        }
+        int level = 0;
+        while (level + 1 < kLevels && binFrames(level + 1) <= end - start) {
+            ++level;
+        }
+        collect(level, start, end, result);
+        return result;
+    }
+
+    /**
+     * Write the sidecar: a small header, then per level int16 min and max
+     * (rounded outwards) and uint16 RMS for every bin, little-endian.
+     * Returns false on I/O failure.
+     */
+    bool save(const std::string& path) const {
+        std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+        if (!file) {
+            return false;
+        }
+        std::vector<uint8_t> out;
+        out.insert(out.end(), kMagic, kMagic + 4);
+        putLe(out, static_cast<uint64_t>(kVersion), 2);
+        putLe(out, static_cast<uint64_t>(kLevels), 2);
+        uint64_t rateBits;
+        std::memcpy(&rateBits, &sampleRate_, sizeof(rateBits));
+        putLe(out, rateBits, 8);
+        putLe(out, static_cast<uint64_t>(frames_), 8);
+        for (const auto& bins : levels_) {
+            putLe(out, bins.size(), 8);
+        }
+        for (const auto& bins : levels_) {
+            for (const Bin& bin : bins) {
+                putLe(out, static_cast<uint16_t>(quantize(bin.min, false)), 2);
+                putLe(out, static_cast<uint16_t>(quantize(bin.max, true)), 2);
+                putLe(out, static_cast<uint16_t>(std::lround(std::clamp(std::sqrt(bin.meanSquare), 0.0f, 1.0f) * 65535.0f)), 2);
+            }
+        }
+        return std::fwrite(out.data(), 1, out.size(), file.get()) == out.size();
+    }
+
+    /** Read a sidecar written by save(). Returns null if it is missing or malformed. */
+    static std::unique_ptr<PeakPyramid> load(const std::string& path) {
+        std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+        if (!file) {
+            return nullptr;
+        }
+        std::vector<uint8_t> in;
+        uint8_t chunk[4096];
+        size_t got;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), file.get())) > 0) {
+            in.insert(in.end(), chunk, chunk + got);
+        }
+        constexpr size_t kHeader = 4 + 2 + 2 + 8 + 8 + 8 * kLevels;
+        if (in.size() < kHeader || std::memcmp(in.data(), kMagic, 4) != 0 || getLe(in.data() + 4, 2) != kVersion ||
+            getLe(in.data() + 6, 2) != kLevels) {
+            return nullptr;
+        }
+        const uint64_t rateBits = getLe(in.data() + 8, 8);
+        double sampleRate;
+        std::memcpy(&sampleRate, &rateBits, sizeof(sampleRate));
+        auto pyramid = std::make_unique<PeakPyramid>(sampleRate);
+        pyramid->frames_ = static_cast<int64_t>(getLe(in.data() + 16, 8));
+        size_t offset = kHeader;
+        for (int level = 0; level < kLevels; ++level) {
+            const uint64_t count = getLe(in.data() + 24 + 8 * level, 8);
+            const uint64_t expected = pyramid->frames_ <= 0 ? 0 : (static_cast<uint64_t>(pyramid->frames_) - 1) / binFrames(level) + 1;
+            if (count != expected || count > (in.size() - offset) / 6) {
+                return nullptr;
+            }
+            auto& bins = pyramid->levels_[level];
+            bins.resize(static_cast<size_t>(count));
+            for (Bin& bin : bins) {
+                bin.min = static_cast<float>(static_cast<int16_t>(getLe(in.data() + offset, 2))) / 32767.0f;
+                bin.max = static_cast<float>(static_cast<int16_t>(getLe(in.data() + offset + 2, 2))) / 32767.0f;
+                const float rms = static_cast<float>(getLe(in.data() + offset + 4, 2)) / 65535.0f;
+                bin.meanSquare = rms * rms;
+                offset += 6;
+            }
+        }
+        // Loaded pyramids are for queries: the open bins are not restored, so
+        // nothing should be appended to them.
+        return pyramid;
+    }
+
+private:
+    struct Bin {
+        float min = 0.0f;
+        float max = 0.0f;
+        float meanSquare = 0.0f;
+
+        static Bin from(const PeakStats& stats) {
+            return {stats.min, stats.max,
+                    stats.frames > 0 ? static_cast<float>(stats.sumSquares / static_cast<double>(stats.frames)) : 0.0f};
+        }
+        PeakStats stats(int64_t frames) const {
+            return {min, max, static_cast<double>(meanSquare) * static_cast<double>(frames), frames};
+        }
+    };
+
+    void collect(int level, int64_t start, int64_t end, PeakStats& result) const {
+        if (end <= start) {
+            return;
+        }
+        const int64_t size = binFrames(level);
+        int64_t first = (start + size - 1) / size;
+        int64_t last = end / size;
+        if (level == 0) {
+            first = start / size;
+            last = (end + size - 1) / size;
+        } else if (first >= last) {
+            collect(level - 1, start, end, result);
+            return;
+        } else {
+            collect(level - 1, start, first * size, result);
+            collect(level - 1, last * size, end, result);
+        }
+        const auto& bins = levels_[level];
+        for (int64_t index = first; index < last && index < static_cast<int64_t>(bins.size()); ++index) {
+            result.merge(bins[static_cast<size_t>(index)].stats(std::min(size, frames_ - index * size)));
+        }
+    }
+
+    static constexpr char kMagic[4] = {'P', 'K', 'P', 'Y'};
+    static constexpr uint64_t kVersion = 1;
+
+    // Extremes are rounded away from zero so the drawn envelope never
+    // clips a peak.
+    static int16_t quantize(float value, bool upward) {
+        const float scaled = std::clamp(value, -1.0f, 1.0f) * 32767.0f;
+        return static_cast<int16_t>(upward ? std::ceil(scaled) : std::floor(scaled));
+    }
+
+    static void putLe(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    static uint64_t getLe(const uint8_t* p, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    double sampleRate_;
+    int64_t frames_ = 0;
+    std::vector<Bin> levels_[kLevels];
+    PeakStats open_[kLevels]; // the last, still filling bin of each level
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Steps the processing quality tier down when the render callback runs
+ * close to its deadline and back up once it has been comfortably idle for a
+ * while. Tiers are numbered from 0 (cheapest) up to a ceiling the host
+ * picks; the governor never goes above it.
+ *
+ * The load each call reports (time over budget) is smoothed over about a
+ * quarter of a second. A missed deadline or a smoothed load over
+ * kStepDownLoad drops one tier, at most once per kStepDownHoldSeconds so
+ * the average can follow the cheaper tier. Stepping back up takes a
+ * smoothed load under kStepUpLoad for the whole up-hold. If a step down
+ * comes within one up-hold of the last step up, the up-hold doubles (up to
+ * 64 s), so a session that only just fits settles on the lower tier instead
+ * of oscillating.
+ *
+ * update() and reset() run on the render thread; the tier, the smoothed
+ * load and the step counts are single-writer atomics any thread can read.
+ */
+class QualityGovernor {
+public:
+    static constexpr float kStepDownLoad = 0.8f;
+    static constexpr float kStepUpLoad = 0.45f;
+    static constexpr double kSmoothingSeconds = 0.25;
+    static constexpr double kStepDownHoldSeconds = 0.5;
+    static constexpr double kStepUpHoldSeconds = 4.0;
+    static constexpr double kMaxStepUpHoldSeconds = 64.0;
+
+    struct State {
+        int tier = 0;
+        float smoothedLoad = 0.0f;
+        uint64_t stepsDown = 0;
+        uint64_t stepsUp = 0;
+    };
+
+    /** Start governing at `tier` with no load history. */
+    void reset(int tier) {
+        tier_.store(std::max(tier, 0), std::memory_order_relaxed);
+        smoothedLoad_.store(0.0f, std::memory_order_relaxed);
+        stepsDown_.store(0, std::memory_order_relaxed);
+        stepsUp_.store(0, std::memory_order_relaxed);
+        sinceChange_ = 0.0;
+        calm_ = 0.0;
+        sinceStepUp_ = kMaxStepUpHoldSeconds;
+        stepUpHold_ = kStepUpHoldSeconds;
+    }
+
+    /** One call that took `load` of its `budgetSeconds`; returns the tier for the next block. */
+    int update(float load, double budgetSeconds, int ceiling) {
+        const double dt = std::max(budgetSeconds, 0.0);
+        const float alpha = static_cast<float>(dt / (kSmoothingSeconds + dt));
+        float smoothed = smoothedLoad_.load(std::memory_order_relaxed);
+        smoothed += alpha * (load - smoothed);
+        smoothedLoad_.store(smoothed, std::memory_order_relaxed);
+        sinceChange_ += dt;
+        sinceStepUp_ += dt;
+
+        int tier = std::min(tier_.load(std::memory_order_relaxed), std::max(ceiling, 0));
+        if (tier > 0 && (load > 1.0f || smoothed > kStepDownLoad) && sinceChange_ >= kStepDownHoldSeconds) {
+            if (sinceStepUp_ < stepUpHold_) {
+                stepUpHold_ = std::min(2.0 * stepUpHold_, kMaxStepUpHoldSeconds);
+            }
+            --tier;
+            sinceChange_ = 0.0;
+            calm_ = 0.0;
+            bump(stepsDown_);
+        } else if (tier < ceiling && smoothed < kStepUpLoad) {
+            calm_ += dt;
+            if (calm_ >= stepUpHold_) {
+                ++tier;
+                sinceChange_ = 0.0;
+                sinceStepUp_ = 0.0;
+                calm_ = 0.0;
+                bump(stepsUp_);
+            }
+        } else {
+            calm_ = 0.0;
+        }
+        tier_.store(tier, std::memory_order_relaxed);
+        return tier;
+    }
+
+    int tier() const { return tier_.load(std::memory_order_relaxed); }
+
+    State read() const {
+        State s;
+        s.tier = tier_.load(std::memory_order_relaxed);
+        s.smoothedLoad = smoothedLoad_.load(std::memory_order_relaxed);
+        s.stepsDown = stepsDown_.load(std::memory_order_relaxed);
+        s.stepsUp = stepsUp_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<int> tier_{0};
+    std::atomic<float> smoothedLoad_{0.0f};
+    std::atomic<uint64_t> stepsDown_{0};
+    std::atomic<uint64_t> stepsUp_{0};
+
+    // Render thread only, in seconds of audio.
+    double sinceChange_ = 0.0;
+    double calm_ = 0.0;
+    double sinceStepUp_ = kMaxStepUpHoldSeconds;
+    double stepUpHold_ = kStepUpHoldSeconds;
+};
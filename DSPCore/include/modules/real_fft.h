@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "table_cache.h"
+
+/**
+ * Twiddles, bit-reversal permutation and Hann window for one transform size,
+ * shared through SharedTableCache by every analyzer using that size.
+ */
+class RealFftTables {
+public:
+    using Key = int;
+
+    explicit RealFftTables(int size) : size_(size) {
+        const int half = size / 2;
+        cos_.resize(static_cast<size_t>(half));
+        sin_.resize(static_cast<size_t>(half));
+        for (int k = 0; k < half; ++k) {
+            const double angle = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(size);
+            cos_[static_cast<size_t>(k)] = static_cast<float>(std::cos(angle));
+            sin_[static_cast<size_t>(k)] = static_cast<float>(std::sin(angle));
+        }
+
+        int bits = 0;
+        while ((1 << bits) < half) {
+            ++bits;
+        }
+        reversed_.resize(static_cast<size_t>(half));
+        for (int i = 0; i < half; ++i) {
+            int r = 0;
+            for (int b = 0; b < bits; ++b) {
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            reversed_[static_cast<size_t>(i)] = r;
+        }
+
+        window_.resize(static_cast<size_t>(size));
+        windowPower_ = 0.0f;
+        for (int n = 0; n < size; ++n) {
+            const float w = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * n / static_cast<double>(size)));
+            window_[static_cast<size_t>(n)] = w;
+            windowPower_ += w * w;
+        }
+    }
+
+    int size() const { return size_; }
+    const float* cosines() const { return cos_.data(); }
+    const float* sines() const { return sin_.data(); }
+    const int* reversed() const { return reversed_.data(); }
+    const float* window() const { return window_.data(); }
+    /** Sum of the squared window, for power normalisation. */
+    float windowPower() const { return windowPower_; }
+
+    std::size_t bytes() const {
+        return sizeof(*this) + (cos_.capacity() + sin_.capacity() + window_.capacity()) * sizeof(float) +
+               reversed_.capacity() * sizeof(int);
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    int size_;
+    std::vector<float> cos_;
+    std::vector<float> sin_;
+    std::vector<int> reversed_;
+    std::vector<float> window_;
+    float windowPower_ = 0.0f;
+};
+
+/**
+ * Power-of-two real FFT. The N real inputs are packed into an N/2-point
+ * complex transform, which runs as iterative radix-2 butterflies over
+ * separate real and imaginary arrays so the inner loops vectorise, and the
+ * two interleaved half-spectra are then split apart. prepare() allocates;
+ * power() does not.
+ */
+class RealFft {
+public:
+    static bool validSize(int size) { return size >= 16 && size <= (1 << 16) && (size & (size - 1)) == 0; }
+
+    void prepare(int size) {
+        tables_ = SharedTableCache<RealFftTables>::acquire(size);
+        re_.assign(static_cast<size_t>(size / 2), 0.0f);
+        im_.assign(static_cast<size_t>(size / 2), 0.0f);
+    }
+
+    int size() const { return tables_ ? tables_->size() : 0; }
+    const RealFftTables* tables() const { return tables_.get(); }
+
+    /**
+     * Hann-window `input` (size() samples) and write |X[k]|^2 for the bins
+     * k = 0 ... size() / 2 to `power`.
+     */
+    void power(const float* input, float* power) {
+        const int n = tables_->size();
+        const int half = n / 2;
+        const float* window = tables_->window();
+        const int* reversed = tables_->reversed();
+        float* re = re_.data();
+        float* im = im_.data();
+        for (int k = 0; k < half; ++k) {
+            const int src = reversed[k];
+            re[k] = input[2 * src] * window[2 * src];
+            im[k] = input[2 * src + 1] * window[2 * src + 1];
+        }
+
+        // Radix-2 butterflies for the half-size complex transform; its
+        // twiddles are every second one of the full-size set.
+        const float* cosines = tables_->cosines();
+        const float* sines = tables_->sines();
+        for (int span = 1; span < half; span *= 2) {
+            const int stride = half / span;
+            for (int start = 0; start < half; start += 2 * span) {
+                float* ar = re + start;
+                float* ai = im + start;
+                float* br = ar + span;
+                float* bi = ai + span;
+                for (int j = 0; j < span; ++j) {
+                    const float wr = cosines[j * stride];
+                    const float wi = sines[j * stride];
+                    const float tr = br[j] * wr - bi[j] * wi;
+                    const float ti = br[j] * wi + bi[j] * wr;
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+
+        // X[k] = E[k] + W^k O[k], with E and O recovered from Z[k] and Z[half - k].
+        power[0] = (re[0] + im[0]) * (re[0] + im[0]);
+        power[half] = (re[0] - im[0]) * (re[0] - im[0]);
+        for (int k = 1; k < half; ++k) {
+            const float zr = re[k];
+            const float zi = im[k];
+            const float cr = re[half - k];
+            const float ci = -im[half - k];
+            const float er = 0.5f * (zr + cr);
+            const float ei = 0.5f * (zi + ci);
+            const float or_ = 0.5f * (zi - ci);
+            const float oi = -0.5f * (zr - cr);
+            const float xr = er + cosines[k] * or_ - sines[k] * oi;
+            const float xi = ei + cosines[k] * oi + sines[k] * or_;
+            power[k] = xr * xr + xi * xi;
+        }
+    }
+
+private:
+    std::shared_ptr<const RealFftTables> tables_;
+    std::vector<float> re_;
+    std::vector<float> im_;
+};
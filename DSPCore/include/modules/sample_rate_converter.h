@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "table_cache.h"
+#include "windowed_sinc.h"
+
+/** One anti-imaging/anti-aliasing kernel, shared by every converter asking for the same design. */
+class SrcKernelTable {
+public:
+    struct Key {
+        int phases;
+        int taps;
+        double cutoff;
+        double beta;
+
+        bool operator==(const Key& other) const {
+            return phases == other.phases && taps == other.taps && cutoff == other.cutoff && beta == other.beta;
+        }
+    };
+
+    explicit SrcKernelTable(const Key& key) : kernel(key.phases, key.taps, key.cutoff, key.beta) {}
+
+    std::size_t bytes() const { return sizeof(*this) + kernel.bytes(); }
+
+    PolyphaseKernel kernel;
+};
+
+/**
+ * Fixed-ratio sample-rate conversion of interleaved audio, streaming or
+ * offline. Output frame k sits at input time k * inRate / outRate, so a
+ * stream converted in pieces lines up with the source and needs no delay
+ * compensation; flush() then emits the tail, for exactly
+ * ceil(inputFrames * outRate / inRate) frames in total.
+ *
+ * When both rates are whole numbers whose reduced ratio L/M has no more than
+ * kMaxRationalPhases output phases (44.1k <-> 48k is 160/147), every output
+ * lands exactly on one of L precomputed kernel rows, stepped with integer
+ * arithmetic. Other ratios step a double position through kInterpolatedPhases
+ * rows blended linearly. Equal rates copy. Downsampling stretches the kernel
+ * so the cut-off follows the lower Nyquist. Only prepare() allocates.
+ */
+class SampleRateConverter {
+public:
+    static constexpr int kMaxRationalPhases = 1024;
+    static constexpr int kInterpolatedPhases = 256;
+
+    void prepare(double inRate, double outRate, int channels, int maxInputFrames, SincQuality quality) {
+        inRate_ = std::max(inRate, 1.0);
+        outRate_ = std::max(outRate, 1.0);
+        channels_ = std::max(channels, 1);
+        maxInput_ = std::max(maxInputFrames, 1);
+
+        rational_ = false;
+        const double inWhole = std::round(inRate_);
+        const double outWhole = std::round(outRate_);
+        if (inWhole == inRate_ && outWhole == outRate_ && inWhole < 1.0e9 && outWhole < 1.0e9) {
+            const auto in = static_cast<int64_t>(inWhole);
+            const auto out = static_cast<int64_t>(outWhole);
+            const int64_t common = std::gcd(in, out);
+            if (out / common <= kMaxRationalPhases) {
+                rational_ = true;
+                up_ = static_cast<int>(out / common);
+                down_ = static_cast<int>(in / common);
+            }
+        }
+        step_ = inRate_ / outRate_;
+        identity_ = inRate_ == outRate_;
+
+        const SincDesign design = SincDesign::forQuality(quality);
+        const double stretch = std::max(1.0, step_);
+        const SrcKernelTable::Key key{rational_ ? up_ : kInterpolatedPhases,
+                                      static_cast<int>(std::ceil(design.taps * stretch)),
+                                      0.5 * design.passband / stretch, design.beta};
+        table_ = SharedTableCache<SrcKernelTable>::acquire(key);
+        const int taps = table_->kernel.taps;
+        half_ = taps / 2;
+        stride_ = taps + maxInput_;
+        buffer_.assign(static_cast<size_t>(stride_) * static_cast<size_t>(channels_), 0.0f);
+        blended_.assign(static_cast<size_t>(taps), 0.0f);
+        reset();
+    }
+
+    /** Start a new stream. */
+    void reset() {
+        std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+        // The first output reads input frame 0 with zeros before it.
+        filled_ = half_ - 1;
+        read_ = half_ - 1;
+        phase_ = 0;
+        fraction_ = 0.0;
+        inputSeen_ = 0;
+        produced_ = 0;
+    }
+
+    bool isRational() const { return rational_ && !identity_; }
+    int channels() const { return channels_; }
+    int maxInputFrames() const { return maxInput_; }
+    /** Input frames an output waits for beyond its own position. */
+    int latency() const { return half_; }
+    /** Capacity process() or flush() needs for `inputFrames` frames. */
+    int maxOutputFrames(int inputFrames) const {
+        return static_cast<int>(std::ceil((inputFrames + half_) / step_)) + 2;
+    }
+
+    /**
+     * Take `inputFrames` (at most maxInputFrames()) interleaved frames and
+     * write the outputs they complete, up to `capacity` frames. Returns the
+     * number written; give it maxOutputFrames(inputFrames) to never drop any.
+     */
+    int process(const float* input, int inputFrames, float* output, int capacity) {
+        inputFrames = std::clamp(inputFrames, 0, maxInput_);
+        if (identity_) {
+            const int frames = std::min(inputFrames, capacity);
+            std::memcpy(output, input, static_cast<size_t>(frames) * static_cast<size_t>(channels_) * sizeof(float));
+            inputSeen_ += frames;
+            produced_ += frames;
+            return frames;
+        }
+        append(input, inputFrames);
+        inputSeen_ += inputFrames;
+        return drain(output, capacity, totalOutputs());
+    }
+
+    /** Emit the outputs still waiting for input past the end of the stream. Returns the number written. */
+    int flush(float* output, int capacity) {
+        int written = 0;
+        while (produced_ < totalOutputs() && written < capacity) {
+            append(nullptr, std::min(half_, maxInput_));
+            written += drain(output + static_cast<size_t>(written) * static_cast<size_t>(channels_), capacity - written,
+                             totalOutputs());
+        }
+        return written;
+    }
+
+private:
+    int64_t totalOutputs() const {
+        return static_cast<int64_t>(std::ceil(static_cast<double>(inputSeen_) / step_ - 1.0e-9));
+    }
+
+    float* line(int c) { return buffer_.data() + static_cast<size_t>(c) * static_cast<size_t>(stride_); }
+
+    // Deinterleave after the history; null input appends silence.
+    void append(const float* input, int frames) {
+        // Drop what no output can read any more.
+        const int drop = std::max(read_ - half_ + 1, 0);
+        if (drop > 0) {
+            for (int c = 0; c < channels_; ++c) {
+                std::memmove(line(c), line(c) + drop, static_cast<size_t>(filled_ - drop) * sizeof(float));
+            }
+            read_ -= drop;
+            filled_ -= drop;
+        }
+        // Only reachable when a caller starved process() of output space.
+        frames = std::min(frames, stride_ - filled_);
+        for (int c = 0; c < channels_; ++c) {
+            float* dst = line(c) + filled_;
+            if (input) {
+                for (int i = 0; i < frames; ++i) {
+                    dst[i] = input[static_cast<size_t>(i) * static_cast<size_t>(channels_) + static_cast<size_t>(c)];
+                }
+            } else {
+                std::fill(dst, dst + frames, 0.0f);
+            }
+        }
+        filled_ += frames;
+    }
+
+    int drain(float* output, int capacity, int64_t limit) {
+        const PolyphaseKernel& kernel = table_->kernel;
+        const int taps = kernel.taps;
+        const float* lines = buffer_.data();
+        float* blended = blended_.data();
+        int written = 0;
+        while (read_ + half_ < filled_ && written < capacity && produced_ < limit) {
+            const float* x = lines + (read_ - half_ + 1);
+            float* frame = output + static_cast<size_t>(written) * static_cast<size_t>(channels_);
+            if (rational_) {
+                const float* h = kernel.row(phase_);
+                for (int ch = 0; ch < channels_; ++ch) {
+                    frame[ch] = PolyphaseKernel::dot(x + static_cast<size_t>(ch) * static_cast<size_t>(stride_), h, taps);
+                }
+                phase_ += down_;
+                read_ += phase_ / up_;
+                phase_ %= up_;
+            } else {
+                const double scaled = fraction_ * kInterpolatedPhases;
+                const int row = std::min(static_cast<int>(scaled), kInterpolatedPhases - 1);
+                const auto blend = static_cast<float>(scaled - row);
+                const float* c = kernel.row(row);
+                const float* d = kernel.rowDelta(row);
+                if (channels_ == 1) {
+                    frame[0] = PolyphaseKernel::interpolate(x, c, d, blend, taps);
+                } else {
+                    for (int k = 0; k < taps; ++k) {
+                        blended[k] = c[k] + blend * d[k];
+                    }
+                    for (int ch = 0; ch < channels_; ++ch) {
+                        frame[ch] = PolyphaseKernel::dot(x + static_cast<size_t>(ch) * static_cast<size_t>(stride_), blended, taps);
+                    }
+                }
+                fraction_ += step_;
+                const auto whole = static_cast<int>(fraction_);
+                read_ += whole;
+                fraction_ -= whole;
+            }
+            ++written;
+            ++produced_;
+        }
+        return written;
+    }
+
+    std::shared_ptr<const SrcKernelTable> table_;
+    double inRate_ = 48000.0;
+    double outRate_ = 48000.0;
+    double step_ = 1.0; // input frames per output frame
+    int channels_ = 1;
+    int maxInput_ = 1;
+    bool rational_ = false;
+    bool identity_ = false;
+    int up_ = 1;   // L: output phases
+    int down_ = 1; // M: rows advanced per output
+    int half_ = 0;
+    int stride_ = 0;
+    std::vector<float> buffer_; // per channel: [kept history | new input]
+    std::vector<float> blended_;
+    int filled_ = 0; // frames in each line
+    int read_ = 0;   // line index of the next output's read position
+    int phase_ = 0;  // rational: next output's row
+    double fraction_ = 0.0;
+    int64_t inputSeen_ = 0;
+    int64_t produced_ = 0;
+};
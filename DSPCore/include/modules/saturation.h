@@ -2,17 +2,45 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 #include "module.h"
+#include "oversampler.h"
 
-/** Simple tanh-based soft clipper used to mimic tape saturation. */
+/**
+ * Simple tanh-based soft clipper used to mimic tape saturation. The clipper can
+ * optionally run oversampled so that high drive settings do not alias.
+ */
 class Saturation : public Module {
 public:
     void prepare(float sampleRate, int maxBlockSize) override {
-        (void)maxBlockSize;
         fs = sampleRate;
+        maxBlock = std::max(maxBlockSize, 1);
+        scratch.assign(static_cast<size_t>(maxBlock), 0.0f);
+        for (auto& os : oversamplers) {
+            os.prepare(maxBlock);
+            os.setFactor(oversamplingFactor);
+            os.reset();
+        }
         update();
     }
 
+    void reset() override {
+        for (auto& os : oversamplers) {
+            os.reset();
+        }
+    }
+
+    /** Oversampling factor for the nonlinearity: 1 (off), 2, 4 or 8. */
+    void setOversamplingFactor(int factor) {
+        oversamplingFactor = Oversampler::snapFactor(factor);
+        for (auto& os : oversamplers) {
+            os.setFactor(oversamplingFactor);
+        }
+    }
+
+    /** Delay introduced by the oversampling filters, in samples. */
+    int latencySamples() const { return Oversampler::latencyForFactor(oversamplingFactor); }
+
     /** Input drive in decibels. */
     void setDriveDb(float db) {
         driveDb = db;
@@ -30,6 +58,11 @@ public:
             return;
         }
 
+        if (oversamplingFactor > 1) {
+            processOversampled(interleavedBuffer, numFrames, numChannels);
+            return;
+        }
+
         for (int i = 0; i < numFrames; ++i) {
             for (int c = 0; c < numChannels; ++c) {
                 const int idx = i * numChannels + c;
@@ -42,12 +75,54 @@ public:
     }
 
 private:
+    void processOversampled(float* interleavedBuffer, int numFrames, int numChannels) {
+        ensureChannels(numChannels);
+        const float drive = driveLinear;
+        const float gain = outputGainLinear;
+        for (int c = 0; c < numChannels; ++c) {
+            for (int start = 0; start < numFrames; start += maxBlock) {
+                const int chunk = std::min(maxBlock, numFrames - start);
+                for (int i = 0; i < chunk; ++i) {
+                    scratch[static_cast<size_t>(i)] = interleavedBuffer[(start + i) * numChannels + c];
+                }
+                oversamplers[static_cast<size_t>(c)].process(scratch.data(), chunk, [drive, gain](float* x, int count, int) {
+                    for (int i = 0; i < count; ++i) {
+                        x[i] = std::tanh(x[i] * drive) * gain;
+                    }
+                });
+                for (int i = 0; i < chunk; ++i) {
+                    interleavedBuffer[(start + i) * numChannels + c] = scratch[static_cast<size_t>(i)];
+                }
+            }
+        }
+    }
+
+    void ensureChannels(int channels) {
+        if (static_cast<int>(oversamplers.size()) >= channels) {
+            return;
+        }
+        const size_t previous = oversamplers.size();
+        oversamplers.resize(static_cast<size_t>(channels));
+        for (size_t c = previous; c < oversamplers.size(); ++c) {
+            oversamplers[c].prepare(maxBlock);
+            oversamplers[c].setFactor(oversamplingFactor);
+        }
+        if (scratch.size() < static_cast<size_t>(maxBlock)) {
+            scratch.assign(static_cast<size_t>(maxBlock), 0.0f);
+        }
+    }
+
     float fs{48000.0f};
     float driveDb{0.0f};
     float outputGainDb{0.0f};
     float driveLinear{1.0f};
     float outputGainLinear{1.0f};
 
+    int maxBlock{512};
+    int oversamplingFactor{1};
+    std::vector<Oversampler> oversamplers;
+    std::vector<float> scratch;
+
     void update() {
         driveLinear = std::pow(10.0f, driveDb / 20.0f);
         outputGainLinear = std::pow(10.0f, outputGainDb / 20.0f);
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "real_fft.h"
+
+/**
+ * Spectrum tap for meter views. The audio thread copies each processed block
+ * into a capture ring and publishes a frame counter; nothing else happens on
+ * that side. read() runs on the caller's thread: it takes the newest fftSize
+ * frames of one channel, transforms them and sums the power into log-spaced
+ * bands.
+ *
+ * The ring holds two transforms' worth of frames, so a reader has a full
+ * transform of headroom before the writer can reach the frames it is copying.
+ * The writer never waits; a reader that was overtaken anyway notices from the
+ * counter and tries again.
+ */
+class SpectrumAnalyzer {
+public:
+    static constexpr float kLowestBandHz = 20.0f;
+    static constexpr float kFloorDb = -120.0f;
+
+    SpectrumAnalyzer(int fftSize, int channels)
+        : fftSize_(fftSize),
+          channels_(std::max(channels, 1)),
+          capacity_(2 * fftSize),
+          ring_(static_cast<size_t>(capacity_) * static_cast<size_t>(channels_), 0.0f),
+          time_(static_cast<size_t>(fftSize), 0.0f),
+          power_(static_cast<size_t>(fftSize / 2 + 1), 0.0f) {
+        fft_.prepare(fftSize);
+    }
+
+    int fftSize() const { return fftSize_; }
+    int channels() const { return channels_; }
+
+    std::size_t bytes() const {
+        return sizeof(*this) + (ring_.capacity() + time_.capacity() + power_.capacity()) * sizeof(float);
+    }
+
+    /** Audio thread: append one interleaved block. Never blocks or allocates. */
+    void capture(const float* interleaved, int frames, int channels) {
+        uint64_t written = written_.load(std::memory_order_relaxed);
+        if (frames > capacity_) {
+            // Only the newest frames can survive in the ring anyway.
+            interleaved += static_cast<size_t>(frames - capacity_) * static_cast<size_t>(channels);
+            written += static_cast<uint64_t>(frames - capacity_);
+            frames = capacity_;
+        }
+
+        int done = 0;
+        while (done < frames) {
+            const int slot = static_cast<int>((written + static_cast<uint64_t>(done)) % static_cast<uint64_t>(capacity_));
+            const int run = std::min(frames - done, capacity_ - slot);
+            float* dst = ring_.data() + static_cast<size_t>(slot) * static_cast<size_t>(channels_);
+            const float* src = interleaved + static_cast<size_t>(done) * static_cast<size_t>(channels);
+            if (channels == channels_) {
+                std::memcpy(dst, src, static_cast<size_t>(run) * static_cast<size_t>(channels_) * sizeof(float));
+            } else {
+                const int common = std::min(channels, channels_);
+                for (int i = 0; i < run; ++i) {
+                    float* frame = dst + static_cast<size_t>(i) * static_cast<size_t>(channels_);
+                    std::memcpy(frame, src + static_cast<size_t>(i) * static_cast<size_t>(channels),
+                                static_cast<size_t>(common) * sizeof(float));
+                    std::fill(frame + common, frame + channels_, 0.0f);
+                }
+            }
+            done += run;
+        }
+        written_.store(written + static_cast<uint64_t>(frames), std::memory_order_release);
+    }
+
+    /**
+     * Caller's thread: power of the newest fftSize frames of `channel` in
+     * `bands` log-spaced bands from kLowestBandHz to Nyquist, in dBFS on the
+     * same scale as the RMS meters, so the bands of a signal sum to its
+     * meter reading. Returns the number of bands written, or 0 when fewer
+     * than fftSize frames have been captured.
+     */
+    int read(int channel, float sampleRate, float* outDb, int bands) {
+        if (channel < 0 || channel >= channels_ || !outDb || bands <= 0) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(readMutex_);
+        if (!copyNewest(channel)) {
+            return 0;
+        }
+        fft_.power(time_.data(), power_.data());
+        accumulateBands(sampleRate, outDb, bands);
+        return bands;
+    }
+
+private:
+    bool copyNewest(int channel) {
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            const uint64_t end = written_.load(std::memory_order_acquire);
+            if (end < static_cast<uint64_t>(fftSize_)) {
+                return false;
+            }
+            const uint64_t start = end - static_cast<uint64_t>(fftSize_);
+            for (int i = 0; i < fftSize_; ++i) {
+                const uint64_t slot = (start + static_cast<uint64_t>(i)) % static_cast<uint64_t>(capacity_);
+                time_[static_cast<size_t>(i)] =
+                    ring_[static_cast<size_t>(slot) * static_cast<size_t>(channels_) + static_cast<size_t>(channel)];
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The writer reuses a slot capacity_ frames after it last wrote
+            // it; if it has got that far past `start`, the copy is torn.
+            if (written_.load(std::memory_order_relaxed) - start <= static_cast<uint64_t>(capacity_)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Bin k covers [k - 1/2, k + 1/2) bin widths; each band takes the part of
+    // every bin it overlaps, so narrow low bands still show a value and the
+    // bands together account for each bin's power exactly once.
+    void accumulateBands(float sampleRate, float* outDb, int bands) {
+        const int half = fftSize_ / 2;
+        const double binHz = static_cast<double>(sampleRate) / static_cast<double>(fftSize_);
+        const double nyquist = 0.5 * static_cast<double>(sampleRate);
+        const double lowest = std::min(static_cast<double>(kLowestBandHz), 0.5 * nyquist);
+        const double ratio = std::pow(nyquist / lowest, 1.0 / static_cast<double>(bands));
+        // One-sided power spectrum, normalised by the window's energy so a
+        // bin's value is its share of the signal's mean square.
+        const double scale = 2.0 / (static_cast<double>(fftSize_) * static_cast<double>(fft_.tables()->windowPower()));
+
+        double bandLow = lowest / binHz;
+        for (int b = 0; b < bands; ++b) {
+            const double bandHigh = b + 1 == bands ? static_cast<double>(half) : lowest * std::pow(ratio, b + 1) / binHz;
+            double sum = 0.0;
+            const int first = std::max(0, static_cast<int>(std::floor(bandLow + 0.5)));
+            const int last = std::min(half, static_cast<int>(std::floor(bandHigh + 0.5)));
+            for (int k = first; k <= last; ++k) {
+                const double overlap = std::min(bandHigh, k + 0.5) - std::max(bandLow, k - 0.5);
+                if (overlap > 0.0) {
+                    const double weight = (k == 0 || k == half) ? 0.5 : 1.0;
+                    sum += overlap * weight * static_cast<double>(power_[static_cast<size_t>(k)]);
+                }
+            }
+            const double meanSquare = sum * scale;
+            outDb[b] = meanSquare > 1.0e-12 ? static_cast<float>(10.0 * std::log10(meanSquare)) : kFloorDb;
+            bandLow = bandHigh;
+        }
+    }
+
+    int fftSize_;
+    int channels_;
+    int capacity_;
+    std::vector<float> ring_;
+    std::atomic<uint64_t> written_{0};
+
+    std::mutex readMutex_;
+    RealFft fft_;
+    std::vector<float> time_;
+    std::vector<float> power_;
+};
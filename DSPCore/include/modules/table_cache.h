@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/** Bytes currently held by every shared table in the process. */
+inline std::atomic<std::size_t>& sharedTableBytes() {
+    static std::atomic<std::size_t> bytes{0};
+    return bytes;
+}
+
+/**
+ * Process-wide cache of immutable lookup tables, one per distinct key, shared
+ * by every instance that asks for the same one. A table is built by the first
+ * acquire() for its key and freed when the last holder lets go of it.
+ *
+ * acquire() takes a lock and may build a table, so call it from prepare()
+ * and similar setup paths, never from the audio thread; reading a table
+ * afterwards needs no synchronisation because it never changes.
+ *
+ * `Table` must provide a `Key` type with operator==, a constructor taking a
+ * Key, and `std::size_t bytes() const`.
+ */
+template <typename Table>
+class SharedTableCache {
+public:
+    using Key = typename Table::Key;
+
+    static std::shared_ptr<const Table> acquire(const Key& key) {
+        SharedTableCache& cache = instance();
+        std::lock_guard<std::mutex> lock(cache.mutex_);
+        for (const Entry& entry : cache.entries_) {
+            if (entry.key == key) {
+                if (auto table = entry.table.lock()) {
+                    return table;
+                }
+            }
+        }
+
+        cache.entries_.erase(std::remove_if(cache.entries_.begin(), cache.entries_.end(),
+                                            [](const Entry& entry) { return entry.table.expired(); }),
+                             cache.entries_.end());
+
+        // Built under the lock, so concurrent first users wait for one build
+        // instead of each making their own copy.
+        std::shared_ptr<const Table> table(new Table(key), [](const Table* released) {
+            sharedTableBytes().fetch_sub(released->bytes(), std::memory_order_relaxed);
+            delete released;
+        });
+        sharedTableBytes().fetch_add(table->bytes(), std::memory_order_relaxed);
+        cache.entries_.push_back({key, table});
+        return table;
+    }
+
+    /** Number of distinct tables of this type currently alive. */
+    static std::size_t liveCount() {
+        SharedTableCache& cache = instance();
+        std::lock_guard<std::mutex> lock(cache.mutex_);
+        return static_cast<std::size_t>(std::count_if(cache.entries_.begin(), cache.entries_.end(),
+                                                      [](const Entry& entry) { return !entry.table.expired(); }));
+    }
+
+private:
+    struct Entry {
+        Key key;
+        std::weak_ptr<const Table> table;
+    };
+
+    static SharedTableCache& instance() {
+        static SharedTableCache cache;
+        return cache;
+    }
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
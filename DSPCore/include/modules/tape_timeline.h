@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "content_hash.h"
+#include "mapped_audio_file.h"
+
+/** One take on a track, in the units TapeRegion uses (seconds). */
+struct TimelineRegion {
+    int track = 0;
+    std::string path;
+    double start = 0.0;
+    double duration = 0.0;
+    double fileOffset = 0.0;
+    float gain = 1.0f;
+};
+
+/**
+ * Punch each span over the ones starting before it, as TapeTimeline does on
+ * record, so the spans of a track never overlap and an earlier take carries
+ * on after a shorter one laid inside it. `Span` needs int64_t start, end
+ * (timeline frames) and fileStart (take frame at `start`).
+ */
+template <typename Span>
+void flattenPunchIns(std::vector<Span>& spans) {
+    const auto byStart = [](const Span& a, const Span& b) { return a.start < b.start; };
+    std::stable_sort(spans.begin(), spans.end(), byStart);
+    std::vector<Span> flat;
+    flat.reserve(spans.size());
+    // Spans that may still reach past the next start; everything else in
+    // `flat` ends before it, because starts only increase.
+    std::vector<size_t> open;
+    std::vector<size_t> stillOpen;
+    for (const Span& span : spans) {
+        stillOpen.clear();
+        for (const size_t i : open) {
+            if (flat[i].end <= span.start) {
+                continue;
+            }
+            if (flat[i].end > span.end) {
+                Span right = flat[i];
+                right.fileStart += span.end - right.start;
+                right.start = span.end;
+                stillOpen.push_back(flat.size());
+                flat.push_back(right);
+            }
+            flat[i].end = span.start;
+        }
+        stillOpen.push_back(flat.size());
+        flat.push_back(span);
+        open.swap(stillOpen);
+    }
+    flat.erase(std::remove_if(flat.begin(), flat.end(), [](const Span& span) { return span.end <= span.start; }),
+               flat.end());
+    std::stable_sort(flat.begin(), flat.end(), byStart);
+    spans.swap(flat);
+}
+
+/**
+ * Renders a multitrack tape timeline straight from memory-mapped takes. Each
+ * call produces `tracks` interleaved channels for any timeline position, so
+ * a seek is just a different position: the region under it is found by
+ * binary search and no file is opened.
+ *
+ * setRegions() runs on a non-realtime thread: it maps any takes not mapped
+ * yet (reusing existing mappings unless the file has grown since), builds
+ * an immutable snapshot and hands it over through an atomic pointer.
+ * render() picks the snapshot up at its next call without locking; the
+ * snapshot it replaces is freed by the following setRegions() or by the
+ * destructor, never on the audio thread.
+ */
+class TapeTimelineReader {
+public:
+    TapeTimelineReader(double sampleRate, int tracks)
+        : sampleRate_(sampleRate > 1.0 ? sampleRate : 1.0), tracks_(std::max(tracks, 1)) {}
+
+    ~TapeTimelineReader() {
+        delete pending_.load(std::memory_order_acquire);
+        delete retired_.load(std::memory_order_acquire);
+        delete current_;
+    }
+
+    TapeTimelineReader(const TapeTimelineReader&) = delete;
+    TapeTimelineReader& operator=(const TapeTimelineReader&) = delete;
+
+    double sampleRate() const { return sampleRate_; }
+    int tracks() const { return tracks_; }
+
+    /**
+     * Replace the timeline. Regions on tracks outside [0, tracks), with no
+     * length, or whose take cannot be mapped or has a different sample rate
+     * are left out. Returns the number of regions kept.
+     */
+    int setRegions(const TimelineRegion* regions, int count) {
+        std::lock_guard<std::mutex> lock(setMutex_);
+        delete retired_.exchange(nullptr, std::memory_order_acq_rel);
+
+        auto* next = new Snapshot;
+        next->tracks.resize(static_cast<size_t>(tracks_));
+        int kept = 0;
+        for (int i = 0; i < count; ++i) {
+            const TimelineRegion& region = regions[i];
+            if (region.track < 0 || region.track >= tracks_) {
+                continue;
+            }
+            Span span;
+            span.start = toFrames(region.start);
+            span.end = toFrames(region.start + region.duration);
+            span.fileStart = toFrames(region.fileOffset);
+            span.gain = region.gain;
+            if (span.end <= span.start) {
+                continue;
+            }
+            span.file = mapTake(*next, region.path);
+            if (!span.file) {
+                continue;
+            }
+            span.file->prefetch(span.fileStart, span.end - span.start);
+            next->tracks[static_cast<size_t>(region.track)].push_back(span);
+            ++kept;
+        }
+        for (auto& spans : next->tracks) {
+            flattenPunchIns(spans);
+            if (!spans.empty()) {
+                next->end = std::max(next->end, spans.back().end);
+            }
+        }
+        next->version = latest_ ? latest_->version + 1 : 1;
+
+        latest_ = next;
+        // A snapshot the audio thread never picked up can go straight away.
+        delete pending_.exchange(next, std::memory_order_acq_rel);
+        return kept;
+    }
+
+    /**
+     * Audio thread: write `frames` interleaved frames of every track starting
+     * at timeline frame `position`. Gaps between regions are silence; where
+     * regions overlap, the later-starting one plays over the earlier one.
+     */
+    void render(int64_t position, float* interleaved, int frames) {
+        adoptPending();
+        renderSnapshot(current_, position, interleaved, frames);
+    }
+
+    /**
+     * Audio thread: which setRegions() call the timeline render() plays
+     * comes from, counting from 1 (0 before the first). Picks up a newly
+     * set timeline just as render() would.
+     */
+    uint64_t version() {
+        adoptPending();
+        return current_ ? current_->version : 0;
+    }
+
+    /** Version of the newest timeline passed to setRegions(). */
+    uint64_t latestVersion() const {
+        std::lock_guard<std::mutex> lock(setMutex_);
+        return latest_ ? latest_->version : 0;
+    }
+
+    /** Timeline frame where the last region of the newest timeline ends. */
+    int64_t latestEnd() const {
+        std::lock_guard<std::mutex> lock(setMutex_);
+        return latest_ ? latest_->end : 0;
+    }
+
+    /**
+     * Digest of what the newest timeline plays in frames [start, end) of
+     * every track: each span reaching into the range, with its take's path
+     * and size, position and gain. Equal digests render equal audio there.
+     */
+    uint64_t contentHash(int64_t start, int64_t end) const {
+        std::lock_guard<std::mutex> lock(setMutex_);
+        ContentHash hash;
+        if (!latest_) {
+            return hash.value;
+        }
+        for (int t = 0; t < tracks_; ++t) {
+            hash.add(t);
+            for (const Span& span : latest_->tracks[static_cast<size_t>(t)]) {
+                if (span.end <= start || span.start >= end) {
+                    continue;
+                }
+                hash.add(span.file->path());
+                hash.add(static_cast<uint64_t>(span.file->fileBytes()));
+                hash.add(span.start);
+                hash.add(span.end);
+                hash.add(span.fileStart);
+                hash.add(span.gain);
+            }
+        }
+        return hash.value;
+    }
+
+    /**
+     * Off the audio thread: render() from the newest timeline, provided it
+     * is still at `version`, for offline work alongside playback. Returns
+     * false, writing nothing, once a later setRegions() has replaced it.
+     */
+    bool renderLatest(uint64_t version, int64_t position, float* interleaved, int frames) const {
+        std::lock_guard<std::mutex> lock(setMutex_);
+        if (!latest_ || latest_->version != version) {
+            return false;
+        }
+        renderSnapshot(latest_, position, interleaved, frames);
+        return true;
+    }
+
+private:
+    struct Span {
+        int64_t start = 0; // timeline frames
+        int64_t end = 0;
+        int64_t fileStart = 0; // take frame at `start`
+        float gain = 1.0f;
+        const MappedAudioFile* file = nullptr;
+    };
+
+    struct Snapshot {
+        std::vector<std::shared_ptr<MappedAudioFile>> files;
+        std::vector<std::vector<Span>> tracks;
+        int64_t end = 0;
+        uint64_t version = 0;
+    };
+
+    int64_t toFrames(double seconds) const { return static_cast<int64_t>(std::llround(seconds * sampleRate_)); }
+
+    const MappedAudioFile* mapTake(Snapshot& next, const std::string& path) {
+        for (const auto& file : next.files) {
+            if (file->path() == path) {
+                return file.get();
+            }
+        }
+        std::shared_ptr<MappedAudioFile> file;
+        if (latest_) {
+            for (const auto& existing : latest_->files) {
+                if (existing->path() == path && existing->matchesDisk()) {
+                    file = existing;
+                    break;
+                }
+            }
+        }
+        if (!file) {
+            file = std::make_shared<MappedAudioFile>();
+            if (!file->open(path) || std::fabs(file->sampleRate() - sampleRate_) > 0.5) {
+                return nullptr;
+            }
+        }
+        next.files.push_back(file);
+        return file.get();
+    }
+
+    void adoptPending() {
+        // Hold off until the last replaced snapshot has been collected, so
+        // there is never more than one waiting to be freed.
+        if (retired_.load(std::memory_order_acquire)) {
+            return;
+        }
+        if (Snapshot* next = pending_.exchange(nullptr, std::memory_order_acq_rel)) {
+            retired_.store(current_, std::memory_order_release);
+            current_ = next;
+        }
+    }
+
+    void renderSnapshot(const Snapshot* snapshot, int64_t position, float* interleaved, int frames) const {
+        if (!snapshot) {
+            std::fill(interleaved, interleaved + static_cast<size_t>(frames) * static_cast<size_t>(tracks_), 0.0f);
+            return;
+        }
+        for (int t = 0; t < tracks_; ++t) {
+            renderTrack(snapshot->tracks[static_cast<size_t>(t)], position, interleaved + t, frames);
+        }
+    }
+
+    void renderTrack(const std::vector<Span>& spans, int64_t position, float* out, int frames) const {
+        const int stride = tracks_;
+        const int64_t blockEnd = position + frames;
+        const auto n = static_cast<int64_t>(spans.size());
+        // Last region starting at or before the position.
+        int64_t index = std::upper_bound(spans.begin(), spans.end(), position,
+                                         [](int64_t value, const Span& span) { return value < span.start; }) -
+                        spans.begin() - 1;
+        int64_t cursor = position;
+        while (cursor < blockEnd) {
+            const int64_t nextStart = index + 1 < n ? spans[static_cast<size_t>(index + 1)].start : blockEnd;
+            const int64_t stop = std::min(nextStart, blockEnd);
+            float* dst = out + static_cast<size_t>(cursor - position) * static_cast<size_t>(stride);
+            if (index >= 0 && cursor < spans[static_cast<size_t>(index)].end) {
+                const Span& span = spans[static_cast<size_t>(index)];
+                const auto count = static_cast<int>(std::min(stop, span.end) - cursor);
+                span.file->read(span.fileStart + (cursor - span.start), count, 0, span.gain, dst, stride);
+                cursor += count;
+            } else {
+                const auto count = static_cast<int>(stop - cursor);
+                for (int i = 0; i < count; ++i) {
+                    dst[static_cast<size_t>(i) * static_cast<size_t>(stride)] = 0.0f;
+                }
+                cursor += count;
+            }
+            while (index + 1 < n && spans[static_cast<size_t>(index + 1)].start <= cursor) {
+                ++index;
+            }
+        }
+    }
+
+    double sampleRate_;
+    int tracks_;
+
+    mutable std::mutex setMutex_;
+    Snapshot* latest_ = nullptr; // newest published, for reusing mappings
+
+    std::atomic<Snapshot*> pending_{nullptr};
+    std::atomic<Snapshot*> retired_{nullptr};
+    Snapshot* current_ = nullptr; // audio thread only
+};
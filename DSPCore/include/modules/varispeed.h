@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "table_cache.h"
+#include "windowed_sinc.h"
+
+using VarispeedQuality = SincQuality;
+
+/**
+ * Kernels for one quality tier. Speeding up needs a lower cut-off to keep
+ * the extra bandwidth from aliasing, so each tier holds a bank per range of
+ * rates, its kernel stretched by the top rate of that range.
+ */
+class VarispeedTables {
+public:
+    using Key = int;
+
+    static constexpr int kPhases = 128;
+    static constexpr int kBanks = 4;
+    static constexpr double kMinRate = 0.25;
+    static constexpr double kMaxRate = 2.0;
+
+    struct Bank {
+        double maxRate;
+        PolyphaseKernel kernel;
+    };
+
+    explicit VarispeedTables(int quality) {
+        static constexpr double kStretch[kBanks] = {1.0, 1.25, 1.5, 2.0};
+        const SincDesign design = SincDesign::forQuality(static_cast<SincQuality>(quality));
+        banks_.reserve(kBanks);
+        for (const double stretch : kStretch) {
+            banks_.push_back({stretch, PolyphaseKernel(kPhases, static_cast<int>(std::ceil(design.taps * stretch)),
+                                                       0.5 * design.passband / stretch, design.beta)});
+            maxTaps_ = std::max(maxTaps_, banks_.back().kernel.taps);
+        }
+    }
+
+    int maxTaps() const { return maxTaps_; }
+
+    /** The narrowest bank that does not alias at `rate`. */
+    const PolyphaseKernel& kernelFor(double rate) const {
+        for (const Bank& bank : banks_) {
+            if (rate <= bank.maxRate + 1.0e-9) {
+                return bank.kernel;
+            }
+        }
+        return banks_.back().kernel;
+    }
+
+    std::size_t bytes() const {
+        std::size_t total = sizeof(*this);
+        for (const Bank& bank : banks_) {
+            total += sizeof(Bank) + bank.kernel.bytes();
+        }
+        return total;
+    }
+
+private:
+    std::vector<Bank> banks_;
+    int maxTaps_ = 0;
+};
+
+/**
+ * Continuously variable tape speed: reads interleaved input at `rate` input
+ * frames per output frame, so pitch and tempo move together as with a
+ * capstan. A rate change glides linearly across the block that asks for it.
+ *
+ * The caller asks inputFramesFor() how much input the next block consumes
+ * and passes exactly that to process(). The read head trails the newest
+ * input frame by latency() frames less the fractional phase, whatever the
+ * rate or quality bank, so the delay through the resampler is fixed. Only
+ * prepare() allocates.
+ */
+class Varispeed {
+public:
+    /** Allocate for `channels` interleaved channels and blocks of up to `maxOutputFrames`. */
+    void prepare(int channels, int maxOutputFrames, VarispeedQuality quality) {
+        channels_ = std::max(channels, 1);
+        maxOutput_ = std::max(maxOutputFrames, 1);
+        tables_ = SharedTableCache<VarispeedTables>::acquire(static_cast<int>(quality));
+        maxHalf_ = tables_->maxTaps() / 2;
+        history_ = 2 * maxHalf_;
+        stride_ = history_ + maxInputFrames();
+        buffer_.assign(static_cast<size_t>(stride_) * static_cast<size_t>(channels_), 0.0f);
+        blended_.assign(static_cast<size_t>(tables_->maxTaps()), 0.0f);
+        reset();
+    }
+
+    /** Silence the history and return to unity speed. */
+    void reset() {
+        std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+        phase_ = 0.0;
+        rate_ = 1.0;
+    }
+
+    int channels() const { return channels_; }
+    int maxOutputFrames() const { return maxOutput_; }
+    /** Largest input any block of maxOutputFrames() can consume. */
+    int maxInputFrames() const { return static_cast<int>(std::ceil(maxOutput_ * VarispeedTables::kMaxRate)) + 1; }
+    /** Frames of input history prime() expects. */
+    int historyFrames() const { return history_; }
+    /** The read head is at the newest input frame minus latency(), plus phase(). */
+    int latency() const { return maxHalf_; }
+    double phase() const { return phase_; }
+    double rate() const { return rate_; }
+
+    static double clampRate(double rate) {
+        return std::clamp(rate, VarispeedTables::kMinRate, VarispeedTables::kMaxRate);
+    }
+
+    /**
+     * Restart from `history` (historyFrames() interleaved frames, newest
+     * last) with the read head latency() frames before the newest plus
+     * `phase`, at `rate` with no glide. Lets a seek start on audio instead of
+     * silence.
+     */
+    void prime(const float* history, double phase, double rate) {
+        for (int c = 0; c < channels_; ++c) {
+            float* line = channel(c);
+            for (int i = 0; i < history_; ++i) {
+                line[i] = history[static_cast<size_t>(i) * static_cast<size_t>(channels_) + static_cast<size_t>(c)];
+            }
+        }
+        phase_ = std::clamp(phase, 0.0, std::nextafter(1.0, 0.0));
+        rate_ = clampRate(rate);
+    }
+
+    /** Input frames the next process() call of `outputFrames` frames gliding to `rate` consumes. */
+    int inputFramesFor(int outputFrames, double rate) const {
+        const double target = clampRate(rate);
+        const double glide = outputFrames > 0 ? (target - rate_) / outputFrames : 0.0;
+        double position = phase_;
+        for (int i = 0; i < outputFrames; ++i) {
+            position += rate_ + glide * (i + 1);
+        }
+        return static_cast<int>(position);
+    }
+
+    /**
+     * Resample `inputFrames` new frames (as returned by inputFramesFor) into
+     * `outputFrames` frames (at most maxOutputFrames()), gliding from the
+     * current rate to `rate`.
+     */
+    void process(const float* input, int inputFrames, float* output, int outputFrames, double rate) {
+        const double target = clampRate(rate);
+        const PolyphaseKernel& kernel = tables_->kernelFor(std::max(rate_, target));
+        for (int c = 0; c < channels_; ++c) {
+            float* line = channel(c) + history_;
+            for (int i = 0; i < inputFrames; ++i) {
+                line[i] = input[static_cast<size_t>(i) * static_cast<size_t>(channels_) + static_cast<size_t>(c)];
+            }
+        }
+
+        const int taps = kernel.taps;
+        const int first = maxHalf_ - 1 - (taps / 2 - 1); // bank's first tap relative to the read index
+        const double glide = outputFrames > 0 ? (target - rate_) / outputFrames : 0.0;
+        const float* lines = buffer_.data();
+        float* blended = blended_.data();
+        double position = phase_;
+        for (int i = 0; i < outputFrames; ++i) {
+            // The position never goes negative, so truncation is floor.
+            const int whole = static_cast<int>(position);
+            const double scaled = (position - whole) * VarispeedTables::kPhases;
+            const int row = std::min(static_cast<int>(scaled), VarispeedTables::kPhases - 1);
+            const auto fraction = static_cast<float>(scaled - row);
+            const float* c = kernel.row(row);
+            const float* d = kernel.rowDelta(row);
+            const float* x = lines + whole + first;
+            float* frame = output + static_cast<size_t>(i) * static_cast<size_t>(channels_);
+            if (channels_ == 1) {
+                frame[0] = PolyphaseKernel::interpolate(x, c, d, fraction, taps);
+            } else {
+                // Blend the phase once and share it across channels.
+                for (int k = 0; k < taps; ++k) {
+                    blended[k] = c[k] + fraction * d[k];
+                }
+                for (int ch = 0; ch < channels_; ++ch) {
+                    frame[ch] = PolyphaseKernel::dot(x + static_cast<size_t>(ch) * static_cast<size_t>(stride_), blended, taps);
+                }
+            }
+            position += rate_ + glide * (i + 1);
+        }
+
+        const auto consumed = static_cast<int>(position);
+        phase_ = position - consumed;
+        rate_ = target;
+        for (int c = 0; c < channels_; ++c) {
+            float* line = channel(c);
+            std::memmove(line, line + consumed, static_cast<size_t>(history_) * sizeof(float));
+        }
+    }
+
+private:
+    float* channel(int c) { return buffer_.data() + static_cast<size_t>(c) * static_cast<size_t>(stride_); }
+
+    std::shared_ptr<const VarispeedTables> tables_;
+    int channels_ = 1;
+    int maxOutput_ = 1;
+    int maxHalf_ = 0;
+    int history_ = 0;
+    int stride_ = 0;
+    std::vector<float> buffer_; // per channel: [history | new input]
+    std::vector<float> blended_;
+    double phase_ = 0.0;
+    double rate_ = 1.0;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "peak_pyramid.h"
+#include "tape_timeline.h"
+
+/**
+ * Waveform overview of a multitrack tape, drawn from the peak sidecars of
+ * its takes rather than their audio. Regions are laid out exactly as
+ * TapeTimelineReader plays them (punch-ins included), and query() fills each
+ * output bin from the pyramid level that fits it, so the cost grows with the
+ * number of bins and the regions they cross, not with the zoom range.
+ * Meant for UI threads: setRegions() reads files and allocates.
+ */
+class WaveformOverview {
+public:
+    WaveformOverview(double sampleRate, int tracks)
+        : sampleRate_(sampleRate > 1.0 ? sampleRate : 1.0), tracks_(std::max(tracks, 1)) {
+        spans_.resize(static_cast<size_t>(tracks_));
+    }
+
+    int tracks() const { return tracks_; }
+
+    /**
+     * Replace the layout. Regions whose take has no readable sidecar, or one
+     * at a different sample rate, are left out. Returns the number kept.
+     */
+    int setRegions(const TimelineRegion* regions, int count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Take> takes;
+        std::vector<std::vector<Span>> spans(static_cast<size_t>(tracks_));
+        int kept = 0;
+        for (int i = 0; i < count; ++i) {
+            const TimelineRegion& region = regions[i];
+            if (region.track < 0 || region.track >= tracks_) {
+                continue;
+            }
+            Span span;
+            span.start = toFrames(region.start);
+            span.end = toFrames(region.start + region.duration);
+            span.fileStart = toFrames(region.fileOffset);
+            span.gain = region.gain;
+            if (span.end <= span.start) {
+                continue;
+            }
+            span.peaks = loadTake(takes, region.path);
+            if (!span.peaks) {
+                continue;
+            }
+            spans[static_cast<size_t>(region.track)].push_back(span);
+            ++kept;
+        }
+        for (auto& track : spans) {
+            flattenPunchIns(track);
+        }
+        takes_.swap(takes);
+        spans_.swap(spans);
+        return kept;
+    }
+
+    /**
+     * Summarise timeline frames [start, end) of `track` into `bins` equal
+     * bins. Time not covered by a region counts as silence. Returns false
+     * for a bad track or range.
+     */
+    bool query(int track, int64_t start, int64_t end, int bins, float* outMin, float* outMax, float* outRms) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (track < 0 || track >= tracks_ || end <= start || bins <= 0) {
+            return false;
+        }
+        const auto& spans = spans_[static_cast<size_t>(track)];
+        // First region ending after the range start; regions are sorted and
+        // disjoint, so the index only moves forward from here.
+        size_t index = static_cast<size_t>(
+            std::upper_bound(spans.begin(), spans.end(), start, [](int64_t value, const Span& span) { return value < span.end; }) -
+            spans.begin());
+        const double width = static_cast<double>(end - start) / bins;
+        for (int b = 0; b < bins; ++b) {
+            const int64_t binStart = start + static_cast<int64_t>(width * b);
+            const int64_t binEnd = std::max(start + static_cast<int64_t>(width * (b + 1)), binStart + 1);
+            while (index < spans.size() && spans[index].end <= binStart) {
+                ++index;
+            }
+            PeakStats stats;
+            int64_t covered = 0;
+            for (size_t i = index; i < spans.size() && spans[i].start < binEnd; ++i) {
+                const Span& span = spans[i];
+                const int64_t from = std::max(binStart, span.start) - span.start + span.fileStart;
+                const int64_t to = std::min(binEnd, span.end) - span.start + span.fileStart;
+                covered += std::max<int64_t>(std::min(to, span.peaks->frames()) - std::max<int64_t>(from, 0), 0);
+                stats.merge(scaled(span.peaks->stats(from, to), span.gain));
+            }
+            if (covered < binEnd - binStart) {
+                stats.merge(PeakStats{0.0f, 0.0f, 0.0, binEnd - binStart - covered});
+            }
+            outMin[b] = stats.min;
+            outMax[b] = stats.max;
+            outRms[b] = stats.rms();
+        }
+        return true;
+    }
+
+private:
+    struct Take {
+        std::string path;
+        std::shared_ptr<const PeakPyramid> peaks;
+    };
+
+    struct Span {
+        int64_t start = 0; // timeline frames
+        int64_t end = 0;
+        int64_t fileStart = 0; // take frame at `start`
+        float gain = 1.0f;
+        const PeakPyramid* peaks = nullptr;
+    };
+
+    int64_t toFrames(double seconds) const { return static_cast<int64_t>(std::llround(seconds * sampleRate_)); }
+
+    // Sidecars are written once, when a take is finished, so one already
+    // loaded for the previous layout is reused as is.
+    const PeakPyramid* loadTake(std::vector<Take>& takes, const std::string& path) const {
+        for (const Take& take : takes) {
+            if (take.path == path) {
+                return take.peaks.get();
+            }
+        }
+        std::shared_ptr<const PeakPyramid> peaks;
+        for (const Take& take : takes_) {
+            if (take.path == path) {
+                peaks = take.peaks;
+                break;
+            }
+        }
+        if (!peaks) {
+            peaks = PeakPyramid::load(PeakPyramid::sidecarPath(path));
+            if (!peaks || std::fabs(peaks->sampleRate() - sampleRate_) > 0.5) {
+                return nullptr;
+            }
+        }
+        takes.push_back({path, peaks});
+        return peaks.get();
+    }
+
+    static PeakStats scaled(PeakStats stats, float gain) {
+        const float lo = stats.min * gain;
+        const float hi = stats.max * gain;
+        stats.min = std::min(lo, hi);
+        stats.max = std::max(lo, hi);
+        stats.sumSquares *= static_cast<double>(gain) * static_cast<double>(gain);
+        return stats;
+    }
+
+    double sampleRate_;
+    int tracks_;
+
+    mutable std::mutex mutex_;
+    std::vector<Take> takes_;
+    std::vector<std::vector<Span>> spans_;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/** Cost/quality trade-off of the windowed-sinc interpolators, cheapest first. */
+enum class SincQuality { Eco = 0, Standard = 1, High = 2 };
+
+/** Kernel length at unity ratio, passband edge (fraction of Nyquist) and Kaiser beta of a tier. */
+struct SincDesign {
+    int taps;
+    double passband;
+    double beta;
+
+    static SincDesign forQuality(SincQuality quality) {
+        switch (quality) {
+        case SincQuality::Eco:
+            return {8, 0.80, 6.0};
+        case SincQuality::High:
+            return {32, 0.93, 10.0};
+        case SincQuality::Standard:
+        default:
+            return {16, 0.88, 8.0};
+        }
+    }
+};
+
+/**
+ * A Kaiser-windowed sinc low-pass sampled at `phases` fractional offsets.
+ * Row p, tap k weights input n - taps/2 + 1 + k for a read position
+ * n + p / phases. Each row is normalised to unity DC gain and stored with its
+ * step to the next row, so a position between rows costs one multiply-add
+ * per tap. Taps are padded to a multiple of four.
+ */
+struct PolyphaseKernel {
+    int phases = 0;
+    int taps = 0;
+    std::vector<float> coefficients; // [phase][tap]
+    std::vector<float> deltas;       // next phase minus this one
+
+    /**
+     * `taps` is rounded up to a multiple of four; `cutoff` is in cycles per
+     * input sample.
+     */
+    PolyphaseKernel(int phaseCount, int tapCount, double cutoff, double beta)
+        : phases(phaseCount), taps((tapCount + 3) / 4 * 4) {
+        const int half = taps / 2;
+        const double i0Beta = besselI0(beta);
+        std::vector<double> rows(static_cast<size_t>((phases + 1) * taps));
+        for (int p = 0; p <= phases; ++p) {
+            double sum = 0.0;
+            for (int k = 0; k < taps; ++k) {
+                const double d = static_cast<double>(half - 1 - k) + static_cast<double>(p) / phases;
+                const double x = 2.0 * cutoff * d;
+                const double sinc = std::fabs(x) < 1.0e-12 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+                const double ratio = d / half;
+                const double window = std::fabs(ratio) >= 1.0 ? 0.0 : besselI0(beta * std::sqrt(1.0 - ratio * ratio)) / i0Beta;
+                rows[static_cast<size_t>(p * taps + k)] = sinc * window;
+                sum += sinc * window;
+            }
+            for (int k = 0; k < taps; ++k) {
+                rows[static_cast<size_t>(p * taps + k)] /= sum;
+            }
+        }
+        coefficients.resize(static_cast<size_t>(phases * taps));
+        deltas.resize(static_cast<size_t>(phases * taps));
+        for (size_t i = 0; i < coefficients.size(); ++i) {
+            coefficients[i] = static_cast<float>(rows[i]);
+            deltas[i] = static_cast<float>(rows[i + static_cast<size_t>(taps)] - rows[i]);
+        }
+    }
+
+    std::size_t bytes() const { return (coefficients.capacity() + deltas.capacity()) * sizeof(float); }
+
+    const float* row(int phase) const { return coefficients.data() + static_cast<size_t>(phase) * static_cast<size_t>(taps); }
+    const float* rowDelta(int phase) const { return deltas.data() + static_cast<size_t>(phase) * static_cast<size_t>(taps); }
+
+    // Four independent partial sums (taps are a multiple of four) so the
+    // compiler can keep them in vector lanes without reassociating floats.
+    static float dot(const float* x, const float* h, int taps) {
+        float a0 = 0.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+        float a3 = 0.0f;
+        for (int k = 0; k < taps; k += 4) {
+            a0 += x[k] * h[k];
+            a1 += x[k + 1] * h[k + 1];
+            a2 += x[k + 2] * h[k + 2];
+            a3 += x[k + 3] * h[k + 3];
+        }
+        return (a0 + a1) + (a2 + a3);
+    }
+
+    /** dot() against row c + fraction * d, blended on the fly. */
+    static float interpolate(const float* x, const float* c, const float* d, float fraction, int taps) {
+        float a0 = 0.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+        float a3 = 0.0f;
+        for (int k = 0; k < taps; k += 4) {
+            a0 += x[k] * (c[k] + fraction * d[k]);
+            a1 += x[k + 1] * (c[k + 1] + fraction * d[k + 1]);
+            a2 += x[k + 2] * (c[k + 2] + fraction * d[k + 2]);
+            a3 += x[k + 3] * (c[k + 3] + fraction * d[k + 3]);
+        }
+        return (a0 + a1) + (a2 + a3);
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    static double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        const double halfX = 0.5 * x;
+        for (int k = 1; k < 64; ++k) {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < 1.0e-12 * sum) {
+                break;
+            }
+        }
+        return sum;
+    }
+};
@@ -4,13 +4,26 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <random>
-#include <vector>
+
+#include "arena.h"
+#include "counter_rng.h"
 
 /**
  * Generates wow and flutter modulation using independent sine LFOs and a
  * modulated delay line. The effect is intentionally lightweight and maintains
- * its own buffer + RNG state for deterministic playback.
+ * its own buffer. Random phases and drift come from a counter-based generator,
+ * so the modulation at any sample index can be reached with seek().
+ *
+ * By default the read head sits near the end of the delay line, a fixed
+ * latency of about 17 ms whatever the depths. Low-latency mode centres it on
+ * the smallest delay the current depths can swing around instead, so latency
+ * is zero with modulation off and grows with depth.
+ *
+ * At control rate the LFOs are evaluated every kControlInterval samples and
+ * the delay modulation is interpolated linearly in between, instead of two
+ * sines per sample. The phases still advance per sample and a segment never
+ * spans a drift redraw, so the control points lie on the exact trajectory
+ * and switching in either direction is continuous.
  */
 class WowFlutter {
 public:
@@ -19,41 +32,115 @@ public:
     void prepare(float sampleRate, int /*maxBlockSize*/) {
         mSampleRate = std::max(sampleRate, 1.0f);
 
-        const float wowMaxSeconds = 0.01f;
-        const float flutterMaxSeconds = 0.0025f;
-        const float bufferMargin = 0.005f;
-
-        mWowDepthMaxSamples = mSampleRate * wowMaxSeconds;
-        mFlutterDepthMaxSamples = mSampleRate * flutterMaxSeconds;
+        mWowDepthMaxSamples = mSampleRate * kWowMaxSeconds;
+        mFlutterDepthMaxSamples = mSampleRate * kFlutterMaxSeconds;
 
-        const auto maxDelaySeconds = wowMaxSeconds + flutterMaxSeconds + bufferMargin;
-        const std::size_t minBuffer = 4u;
-        mDelayBufferLength = std::max<std::size_t>(static_cast<std::size_t>(mSampleRate * maxDelaySeconds), minBuffer);
+        mDelayBufferLength = delayBufferLengthFor(mSampleRate);
         mDelayBuffer.assign(mDelayBufferLength, 0.0f);
+        updateCentreTarget();
+        mCentreDelay = -1.0f;
         mWriteIndex = 0;
         // Re-seed deterministically so freshly-prepared instances are
         // reproducible (the module is documented as deterministic playback).
-        mRng.seed(kRngSeed);
+        mRngDraws = 0;
         randomizePhase();
 
         mPhaseDriftInterval = std::max(1, static_cast<int>(mSampleRate * 0.5f));
         mPhaseDriftCounter = mPhaseDriftInterval;
+        mWowDriftOffset = 0.0f;
         mCurrentModulation = 0.0f;
+        mControlCountdown = 0;
     }
 
     void reset() {
         std::fill(mDelayBuffer.begin(), mDelayBuffer.end(), 0.0f);
         mWriteIndex = 0;
-        mRng.seed(kRngSeed);
+        mRngDraws = 0;
         randomizePhase();
         mPhaseDriftCounter = mPhaseDriftInterval;
+        mWowDriftOffset = 0.0f;
         mCurrentModulation = 0.0f;
+        mCentreDelay = -1.0f;
+        mControlCountdown = 0;
     }
 
-    void setWowDepth(float depth) { mWowDepth = std::clamp(depth, 0.0f, 1.0f); }
-    void setFlutterDepth(float depth) { mFlutterDepth = std::clamp(depth, 0.0f, 1.0f); }
+    /**
+     * Reset, then move the LFOs to where they would be after `position`
+     * samples. The drift is redrawn once per drift interval, so this costs
+     * O(position / interval). The delay line is left empty for a pre-roll to fill.
+     */
+    void seek(int64_t position) {
+        reset();
+        const double wowInc = static_cast<double>(twoPi()) * mWowRate / mSampleRate;
+        const double flutterInc = static_cast<double>(twoPi()) * mFlutterRate / mSampleRate;
+        double wowPhase = mWowPhase;
+        double flutterPhase = mFlutterPhase;
+        int64_t remaining = std::max<int64_t>(position, 0);
+        while (remaining > 0) {
+            // The drift is redrawn on the mPhaseDriftCounter-th sample, before
+            // that sample's phase advance.
+            const int64_t untilDraw = mPhaseDriftCounter;
+            if (remaining < untilDraw) {
+                wowPhase += static_cast<double>(remaining) * (wowInc + mWowDriftOffset);
+                flutterPhase += static_cast<double>(remaining) * flutterInc;
+                mPhaseDriftCounter -= static_cast<int>(remaining);
+                break;
+            }
+            wowPhase += static_cast<double>(untilDraw - 1) * (wowInc + mWowDriftOffset);
+            mPhaseDriftCounter = 1;
+            updatePhaseDrift();
+            wowPhase += wowInc + mWowDriftOffset;
+            flutterPhase += static_cast<double>(untilDraw) * flutterInc;
+            remaining -= untilDraw;
+            wowPhase = std::fmod(wowPhase, static_cast<double>(twoPi()));
+            flutterPhase = std::fmod(flutterPhase, static_cast<double>(twoPi()));
+        }
+        mWowPhase = wrapPhase(std::fmod(wowPhase, static_cast<double>(twoPi())));
+        mFlutterPhase = wrapPhase(std::fmod(flutterPhase, static_cast<double>(twoPi())));
+    }
+
+    void setWowDepth(float depth) {
+        mWowDepth = std::clamp(depth, 0.0f, 1.0f);
+        updateCentreTarget();
+    }
+    void setFlutterDepth(float depth) {
+        mFlutterDepth = std::clamp(depth, 0.0f, 1.0f);
+        updateCentreTarget();
+    }
     void setWowRate(float hz) { mWowRate = std::max(hz, 0.0f); }
     void setFlutterRate(float hz) { mFlutterRate = std::max(hz, 0.0f); }
+    void setLowLatency(bool enabled) {
+        mLowLatency = enabled;
+        updateCentreTarget();
+    }
+
+    bool lowLatency() const { return mLowLatency; }
+
+    void setControlRate(bool enabled) {
+        mControlRate = enabled;
+        mControlCountdown = 0;
+    }
+
+    bool controlRate() const { return mControlRate; }
+
+    /** Delay in samples around which the read head is currently modulated. */
+    int latencySamples() const {
+        return latencyForDepths(mSampleRate, mWowDepth, mFlutterDepth, mLowLatency);
+    }
+
+    /**
+     * Latency of a prepared instance with the given settings, so hosts can
+     * query it without touching audio-thread state.
+     */
+    static int latencyForDepths(float sampleRate, float wowDepth, float flutterDepth, bool lowLatency) {
+        const float rate = std::max(sampleRate, 1.0f);
+        if (!lowLatency) {
+            return static_cast<int>(delayBufferLengthFor(rate)) - 2;
+        }
+        const float excursion = std::clamp(wowDepth, 0.0f, 1.0f) * rate * kWowMaxSeconds
+            + std::clamp(flutterDepth, 0.0f, 1.0f) * rate * kFlutterMaxSeconds;
+        return static_cast<int>(std::ceil(excursion));
+    }
 
     float processSample(float input) {
         if (mDelayBuffer.empty()) {
@@ -63,12 +150,11 @@ public:
         updatePhaseDrift();
         advancePhases();
 
-        const float wow = std::sin(mWowPhase) * (mWowDepth * mWowDepthMaxSamples);
-        const float flutter = std::sin(mFlutterPhase) * (mFlutterDepth * mFlutterDepthMaxSamples);
-        float modulationSamples = wow + flutter;
+        const float modulationSamples = mControlRate ? nextControlModulation() : modulationAt(mWowPhase, mFlutterPhase);
 
-        const float baseDelay = static_cast<float>(mDelayBufferLength - 2);
-        float readDelay = std::clamp(baseDelay + modulationSamples, 1.0f, static_cast<float>(mDelayBufferLength - 2));
+        const float baseDelay = centreDelay();
+        float readDelay = std::clamp(baseDelay + modulationSamples, mLowLatency ? 0.0f : 1.0f,
+                                     static_cast<float>(mDelayBufferLength - 2));
         mCurrentModulation = modulationSamples / mSampleRate;
 
         mDelayBuffer[mWriteIndex] = input;
@@ -104,17 +190,73 @@ public:
     float getCurrentModulation() const { return mCurrentModulation; }
 
     void randomizePhase() {
-        std::uniform_real_distribution<float> dist(0.0f, twoPi());
-        mWowPhase = dist(mRng);
-        mFlutterPhase = dist(mRng);
+        mWowPhase = nextRandom() * twoPi();
+        mFlutterPhase = nextRandom() * twoPi();
     }
 
 private:
+    static constexpr float kWowMaxSeconds = 0.01f;
+    static constexpr float kFlutterMaxSeconds = 0.0025f;
+    static constexpr float kBufferMarginSeconds = 0.005f;
+    // Largest change of the centre delay per sample when the target moves,
+    // i.e. a brief 1% speed change instead of a click.
+    static constexpr float kCentreGlidePerSample = 0.01f;
+    static constexpr int kControlInterval = 32;
+
     static constexpr float twoPi() { return 6.283185307179586476925286766559f; }
 
+    static std::size_t delayBufferLengthFor(float sampleRate) {
+        const float maxDelaySeconds = kWowMaxSeconds + kFlutterMaxSeconds + kBufferMarginSeconds;
+        const std::size_t minBuffer = 4u;
+        return std::max<std::size_t>(static_cast<std::size_t>(sampleRate * maxDelaySeconds), minBuffer);
+    }
+
+    void updateCentreTarget() { mCentreTarget = static_cast<float>(latencySamples()); }
+
+    /** Delay modulation in samples at the given LFO phases. */
+    float modulationAt(double wowPhase, double flutterPhase) const {
+        const float wow = std::sin(static_cast<float>(wowPhase)) * (mWowDepth * mWowDepthMaxSamples);
+        const float flutter = std::sin(static_cast<float>(flutterPhase)) * (mFlutterDepth * mFlutterDepthMaxSamples);
+        return wow + flutter;
+    }
+
+    /**
+     * The modulation for the sample whose phases were just advanced, at
+     * control rate. A control point evaluates it exactly, along with the end
+     * of the next segment; segments stop short of the next drift redraw, so
+     * that end is exactly where the per-sample phases will be.
+     */
+    float nextControlModulation() {
+        if (mControlCountdown > 0) {
+            --mControlCountdown;
+            mControlValue += mControlStep;
+            return mControlValue;
+        }
+        const int length = std::clamp(mPhaseDriftCounter - 1, 1, kControlInterval);
+        const double wowInc = static_cast<double>(twoPi()) * mWowRate / mSampleRate;
+        const double flutterInc = static_cast<double>(twoPi()) * mFlutterRate / mSampleRate;
+        mControlValue = modulationAt(mWowPhase, mFlutterPhase);
+        const float end = modulationAt(mWowPhase + length * (wowInc + mWowDriftOffset), mFlutterPhase + length * flutterInc);
+        mControlStep = (end - mControlValue) / static_cast<float>(length);
+        mControlCountdown = length - 1;
+        return mControlValue;
+    }
+
+    /** Current centre of the modulated read head, gliding towards its target. */
+    float centreDelay() {
+        const float target = mCentreTarget;
+        if (mCentreDelay < 0.0f) {
+            mCentreDelay = target;
+        } else if (mCentreDelay != target) {
+            const float step = std::clamp(target - mCentreDelay, -kCentreGlidePerSample, kCentreGlidePerSample);
+            mCentreDelay += step;
+        }
+        return mCentreDelay;
+    }
+
     void advancePhases() {
-        const float wowInc = twoPi() * mWowRate / mSampleRate;
-        const float flutterInc = twoPi() * mFlutterRate / mSampleRate;
+        const double wowInc = static_cast<double>(twoPi()) * mWowRate / mSampleRate;
+        const double flutterInc = static_cast<double>(twoPi()) * mFlutterRate / mSampleRate;
 
         mWowPhase = wrapPhase(mWowPhase + wowInc + mWowDriftOffset);
         mFlutterPhase = wrapPhase(mFlutterPhase + flutterInc);
@@ -122,18 +264,17 @@ private:
 
     void updatePhaseDrift() {
         if (--mPhaseDriftCounter <= 0) {
-            std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
             const float driftAmount = 0.002f;
-            mWowDriftOffset = dist(mRng) * driftAmount;
+            mWowDriftOffset = (2.0f * nextRandom() - 1.0f) * driftAmount;
             mPhaseDriftCounter = mPhaseDriftInterval;
         }
     }
 
-    static float wrapPhase(float phase) {
-        const float twoPiValue = twoPi();
+    static double wrapPhase(double phase) {
+        const double twoPiValue = twoPi();
         if (phase >= twoPiValue) {
             phase -= twoPiValue;
-        } else if (phase < 0.0f) {
+        } else if (phase < 0.0) {
             phase += twoPiValue;
         }
         return phase;
@@ -145,13 +286,15 @@ private:
     float mWowRate = 0.4f;
     float mFlutterRate = 5.0f;
 
-    float mWowPhase = 0.0f;
-    float mFlutterPhase = 0.0f;
+    // Phases accumulate in double so that hours of per-sample increments stay
+    // on the trajectory seek() computes in closed form.
+    double mWowPhase = 0.0;
+    double mFlutterPhase = 0.0;
     float mWowDepthMaxSamples = 0.0f;
     float mFlutterDepthMaxSamples = 0.0f;
     float mWowDriftOffset = 0.0f;
 
-    std::vector<float> mDelayBuffer;
+    ArenaVector<float> mDelayBuffer;
     std::size_t mDelayBufferLength = 0;
     std::size_t mWriteIndex = 0;
 
@@ -159,7 +302,18 @@ private:
     int mPhaseDriftCounter = 44100;
 
     float mCurrentModulation = 0.0f;
+    bool mLowLatency = false;
+    float mCentreTarget = 0.0f;
+    float mCentreDelay = -1.0f; // negative until the first sample snaps it to the target
+
+    bool mControlRate = false;
+    int mControlCountdown = 0; // interpolated samples left before the next control point
+    float mControlValue = 0.0f;
+    float mControlStep = 0.0f;
+
+    /** Uniform in [0, 1): the n-th draw depends only on the seed and n. */
+    float nextRandom() { return CounterRng::uniform(kRngSeed, mRngDraws++); }
 
     static constexpr std::uint32_t kRngSeed = 0x9E3779B9u;
-    std::mt19937 mRng{kRngSeed};
+    std::uint64_t mRngDraws = 0;
 };
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Small fork/join pool for splitting one audio callback across cores. Threads
+ * are spawned in start(), never on the audio path. run() publishes a job
+ * through a single atomic word, works on tasks itself and spin-joins; it never
+ * takes a lock. Idle workers spin briefly and then park on a condition
+ * variable. Because the calling thread claims tasks too, a worker that is late
+ * to wake only costs parallelism, never the deadline.
+ */
+class WorkerGroup {
+public:
+    static constexpr int kMaxTasks = 0xFFFF;
+
+    WorkerGroup() = default;
+    WorkerGroup(const WorkerGroup&) = delete;
+    WorkerGroup& operator=(const WorkerGroup&) = delete;
+
+    ~WorkerGroup() { stop(); }
+
+    /** Spawn `threadCount` helper threads (in addition to the caller of run()). */
+    void start(int threadCount) {
+        stop();
+        stopping_.store(false, std::memory_order_relaxed);
+        const int count = std::max(threadCount, 0);
+        threads_.reserve(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            threads_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    void stop() {
+        if (threads_.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_.store(true, std::memory_order_release);
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    int threadCount() const { return static_cast<int>(threads_.size()); }
+
+    /**
+     * Call `task(index)` for every index in [0, taskCount) and return once all
+     * of them have finished. Tasks may run on any worker or on the caller.
+     */
+    template <typename Task>
+    void run(int taskCount, Task& task) {
+        if (taskCount <= 0) {
+            return;
+        }
+        taskCount = std::min(taskCount, kMaxTasks);
+        if (threads_.empty() || taskCount == 1) {
+            for (int i = 0; i < taskCount; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        invoke_ = [](void* context, int index) { (*static_cast<Task*>(context))(index); };
+        context_ = &task;
+        completed_.store(0, std::memory_order_relaxed);
+        generation_ = (generation_ + 1) & 0xFFFFFFFFu;
+        claim_.store(packClaim(generation_, taskCount, 0), std::memory_order_release);
+        if (sleepers_.load(std::memory_order_acquire) > 0) {
+            // A futex wake, not a lock: the caller never blocks here.
+            wake_.notify_all();
+        }
+
+        while (runOneTask()) {
+        }
+        while (completed_.load(std::memory_order_acquire) < taskCount) {
+            cpuRelax();
+        }
+    }
+
+private:
+    // Claim word layout: generation (32 bits) | task count (16) | next index (16).
+    static uint64_t packClaim(uint64_t generation, int count, int next) {
+        return (generation << 32) | (static_cast<uint64_t>(count) << 16) | static_cast<uint64_t>(next);
+    }
+    static int claimCount(uint64_t word) { return static_cast<int>((word >> 16) & 0xFFFFu); }
+    static int claimNext(uint64_t word) { return static_cast<int>(word & 0xFFFFu); }
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    bool hasPendingTask() const {
+        const uint64_t word = claim_.load(std::memory_order_acquire);
+        return claimNext(word) < claimCount(word);
+    }
+
+    /** Claim and run one task of the current job; false when none is left. */
+    bool runOneTask() {
+        uint64_t word = claim_.load(std::memory_order_acquire);
+        while (claimNext(word) < claimCount(word)) {
+            if (claim_.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                // The job cannot be replaced until this task reports completion,
+                // so reading it after a successful claim is race-free.
+                invoke_(context_, claimNext(word));
+                completed_.fetch_add(1, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop() {
+        constexpr int kSpinIterations = 4096;
+        int spins = 0;
+        while (!stopping_.load(std::memory_order_acquire)) {
+            if (runOneTask()) {
+                spins = 0;
+                continue;
+            }
+            if (++spins < kSpinIterations) {
+                cpuRelax();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleepers_.fetch_add(1, std::memory_order_acq_rel);
+            // run() notifies without the mutex, so a wake can slip past us; the
+            // timeout bounds how long a worker can sit out a busy stream.
+            wake_.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                return stopping_.load(std::memory_order_acquire) || hasPendingTask();
+            });
+            sleepers_.fetch_sub(1, std::memory_order_acq_rel);
+            spins = 0;
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> sleepers_{0};
+
+    std::atomic<uint64_t> claim_{0};
+    std::atomic<int> completed_{0};
+    uint64_t generation_ = 0;
+    void (*invoke_)(void*, int) = nullptr;
+    void* context_ = nullptr;
+};
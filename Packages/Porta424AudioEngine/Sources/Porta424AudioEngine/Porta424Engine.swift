@@ -122,9 +122,28 @@ public final class Porta424Engine: ObservableObject {
     /// Sums live + tape before each strip's preGain.
     private var stripSourceSums: [AVAudioMixerNode] = []
 
+    /// Native reader over the committed takes, for rendering tape without the audio graph.
+    private var tapeReader: PortaTapeTimeline?
+    /// Largest block `tapeReader`'s varispeed is prepared for (0 = not yet).
+    private var varispeedMaxFrames = 0
+    /// Waveform overview over the committed takes' peak sidecars.
+    private var waveformOverview: PortaWaveformOverview?
+    /// Native mixer over the six strips, for rendering the mix without the node graph.
+    private var channelMixer: PortaChannelMixer?
+    /// Files to play for each source (path, size, date and session rate): itself, or its converted copy.
+    private var sessionRateSources: [String: URL] = [:]
+
     private var portaNode: AVAudioUnit?
     private var portaDSP: PortaDSPAudioUnit?
     private var lastTapeParams = PortaDSP.Params()
+    /// Preset morph set with `morphTape(from:to:position:)`; nil once plain parameters are set.
+    private var tapeMorph: (from: PortaDSP.Params, to: PortaDSP.Params, position: Float)?
+    /// Tape DSP deadline misses already logged by `tick()`.
+    private var reportedTapeOverruns = 0
+    private var tapeQuality = PortaDSP.Quality.high
+    private var tapeQualityGoverned = true
+    /// Tier the tape DSP rendered at when `tick()` last looked, for logging governor changes.
+    private var reportedTapeQuality = PortaDSP.Quality.high
     private var liveInputSplit: AVAudioMixerNode?
 
     /// Per-track record-source selectors (volume 0/1) — permanent graph wires.
@@ -139,6 +158,8 @@ public final class Porta424Engine: ObservableObject {
     private var playAnchorPosition: TimeInterval = 0
 
     private var activeWriters: [AVAudioFile?] = [nil, nil, nil, nil]
+    /// Peak pyramids of the takes being recorded, saved next to them on stop.
+    private var activePeaks: [PortaWaveformPeaks?] = [nil, nil, nil, nil]
     private var recordStartPosition: TimeInterval = 0
     private var graphBuilt = false
     private var processingFormat: AVAudioFormat?
@@ -182,9 +203,18 @@ public final class Porta424Engine: ObservableObject {
 
     public func setTapeParams(_ params: PortaDSP.Params) {
         lastTapeParams = params
+        tapeMorph = nil
         portaDSP?.updateParameters(params)
     }
 
+    /// Renders the tape color `position` (0...1) of the way from `presetA` to `presetB`, e.g. from a
+    /// crossfader. Moving the position only blends precompiled coefficients, so it is cheap and
+    /// click-free at any rate; `setTapeParams(_:)` ends the morph.
+    public func morphTape(from presetA: PortaDSP.Params, to presetB: PortaDSP.Params, position: Float) {
+        tapeMorph = (presetA, presetB, position)
+        portaDSP?.morph(from: presetA, to: presetB, position: position)
+    }
+
     public func readTapeMeters() -> [Float] {
         guard let portaDSP else { return tapeMetersDbFS }
         let levels = portaDSP.readMeters()
@@ -192,6 +222,35 @@ public final class Porta424Engine: ObservableObject {
         return tapeMetersDbFS
     }
 
+    /// Tone curve of the tape DSP's head bump and HF loss at `frequencies`, for drawing EQ-style curves.
+    public func tapeFrequencyResponse(at frequencies: [Float]) -> PortaDSP.FrequencyResponse? {
+        portaDSP?.frequencyResponse(at: frequencies)
+    }
+
+    /// How long the tape DSP's render calls take against their deadline, since the node was installed.
+    public var tapeTimingStats: PortaDSP.TimingStats? { portaDSP?.readTimingStats() }
+
+    /// Highest processing tier for the tape DSP. With `governed` (the default), the tier drops while the
+    /// render callback runs close to its deadline and returns once there is headroom again.
+    public func setTapeQuality(_ quality: PortaDSP.Quality, governed: Bool = true) {
+        tapeQuality = quality
+        tapeQualityGoverned = governed
+        reportedTapeQuality = quality
+        portaDSP?.setQuality(quality)
+        portaDSP?.setQualityGovernor(governed)
+    }
+
+    /// Tier the tape DSP renders at now, and the governor's view of its load.
+    public var tapeQualityState: PortaDSP.QualityState? { portaDSP?.readQualityState() }
+
+    /// Band levels of the tape output per channel (left, right), or nil until the tape DSP has rendered enough.
+    public func readTapeSpectrum(bands: Int = 32) -> [[Float]]? {
+        guard let portaDSP,
+              let left = portaDSP.readSpectrum(channel: 0, bands: bands),
+              let right = portaDSP.readSpectrum(channel: 1, bands: bands) else { return nil }
+        return [left, right]
+    }
+
     // MARK: - Graph
 
     private func buildGraphAsync() async throws {
@@ -244,6 +303,11 @@ public final class Porta424Engine: ObservableObject {
         portaNode = node
         portaDSP = unit
         unit.updateParameters(lastTapeParams)
+        if let tapeMorph {
+            unit.morph(from: tapeMorph.from, to: tapeMorph.to, position: tapeMorph.position)
+        }
+        unit.setQuality(tapeQuality)
+        unit.setQualityGovernor(tapeQualityGoverned)
         engine.attach(node)
 
         // Live input fan-out (silent on Simulator; device may attach HW later).
@@ -420,6 +484,7 @@ public final class Porta424Engine: ObservableObject {
         for (index, channel) in channels.enumerated() {
             updateStrip(index, channel)
         }
+        syncChannelMixer()
         applyTapeReturnMutes()
         applyMaster()
         rewireRecordBusses()
@@ -444,8 +509,7 @@ public final class Porta424Engine: ObservableObject {
         fx1.wetDryMix = min(max(master.effectReturn1 * 100, 0), 100)
         fx2.wetDryMix = min(max(master.effectReturn2 * 100, 0), 100)
         phonesMix.outputVolume = master.phonesLevel
-        let rate = 1.0 + Double((master.pitch - 0.5) * 0.24)
-        varispeed.rate = Float(rate)
+        varispeed.rate = Float(tapeSpeed)
     }
 
     private func updateStrip(_ index: Int, _ channel: ChannelState) {
@@ -559,6 +623,9 @@ public final class Porta424Engine: ObservableObject {
     public func seek(to position: TimeInterval) {
         transport.position = max(0, position)
         playAnchorPosition = transport.position
+        if let sampleRate = processingFormat?.sampleRate, sampleRate > 0 {
+            portaDSP?.setTapePosition(sampleIndex: Int64(transport.position * sampleRate))
+        }
         if transport.isPlaying && !transport.isPaused {
             startPlayersFromCurrentPosition()
         } else {
@@ -579,7 +646,7 @@ public final class Porta424Engine: ObservableObject {
         guard index == 5 || index == 7 else { return }
         let player = AVAudioPlayerNode()
         engine.attach(player)
-        let file = try AVAudioFile(forReading: url)
+        let file = try AVAudioFile(forReading: sessionRateURL(for: url))
         stripNodes[index == 5 ? 4 : 5].connectSource(player, format: file.processingFormat, to: engine)
         stereoSources[index] = player
         player.scheduleFile(file, at: nil, completionHandler: nil)
@@ -607,8 +674,10 @@ public final class Porta424Engine: ObservableObject {
                     interleaved: format.isInterleaved
                 )
                 activeWriters[i] = writer
+                activePeaks[i] = PortaWaveformPeaks(sampleRate: format.sampleRate)
             } catch {
                 activeWriters[i] = nil
+                activePeaks[i] = nil
                 print("Porta424: record open error: \(error)")
             }
         }
@@ -619,6 +688,9 @@ public final class Porta424Engine: ObservableObject {
             trackRecordBusses[i].installTap(onBus: 0, bufferSize: 2048, format: format) { [weak self] buffer, _ in
                 guard let self, self.transport.isRecording else { return }
                 try? self.activeWriters[i]?.write(from: buffer)
+                if let samples = buffer.floatChannelData?[0] {
+                    self.activePeaks[i]?.append(samples, frames: Int(buffer.frameLength), stride: buffer.stride)
+                }
             }
         }
     }
@@ -629,6 +701,8 @@ public final class Porta424Engine: ObservableObject {
             trackRecordBusses[i].removeTap(onBus: 0)
             guard let file = activeWriters[i] else { continue }
             let duration = format.sampleRate > 0 ? Double(file.length) / format.sampleRate : 0
+            activePeaks[i]?.save(nextTo: file.url)
+            activePeaks[i] = nil
             if duration > 0.0005 {
                 let region = TapeRegion(
                     url: file.url,
@@ -656,6 +730,215 @@ public final class Porta424Engine: ObservableObject {
 
     private func publishTapeTracks() {
         tapeTracks = TapeTimeline.trackStates(from: trackRegions)
+        syncTapeReader()
+        syncWaveformOverview()
+    }
+
+    // MARK: - Native tape reader
+
+    /// Renders the four tape tracks, interleaved, from `position` straight from memory-mapped takes, without
+    /// the audio graph or any file opens per seek; for offline bounces and headless use. When `dsp` is given,
+    /// the block also runs through it.
+    public func renderTape(from position: TimeInterval, frames: Int, through dsp: PortaDSP? = nil) -> [Float] {
+        let reader = nativeTapeReader()
+        var buffer = [Float](repeating: 0, count: max(0, frames) * reader.tracks)
+        let startFrame = Int64((max(0, position) * reader.sampleRate).rounded())
+        reader.render(position: startFrame, into: &buffer, frames: frames, through: dsp)
+        return buffer
+    }
+
+    /// Freezes the tape as `dsp` currently colours it into Caches, so `renderTape(from:frames:through:)` with
+    /// the same `dsp` copies those stretches back instead of processing them again. Segments a later edit does
+    /// not touch are found by the next freeze rather than rendered; until then the edit plays live.
+    /// - Returns: The number of segments frozen, or nil if the tape or settings changed meanwhile.
+    @discardableResult
+    public func freezeTape(through dsp: PortaDSP) -> Int? {
+        guard let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first else {
+            return nil
+        }
+        let directory = caches.appendingPathComponent("Porta424/Frozen", isDirectory: true)
+        let threads = max(1, ProcessInfo.processInfo.activeProcessorCount - 1)
+        return nativeTapeReader().freeze(through: dsp, in: directory, threads: threads)
+    }
+
+    /// How much of `renderTape(from:frames:through:)` came from the freeze, and the render time that saved.
+    public var tapeFreezeStats: PortaTapeTimeline.FreezeStats { tapeReader?.freezeStats ?? .init() }
+
+    /// Renders the four tape tracks like `renderTape(from:frames:through:)`, but at the tape speed set by
+    /// `master.pitch` (pitch and tempo together, as the capstan would), through the native varispeed.
+    /// `position` moves on by the tape consumed, so feeding it back continues seamlessly and speed changes
+    /// glide across the next block.
+    public func renderTape(at position: inout TimeInterval, frames: Int, through dsp: PortaDSP? = nil) -> [Float] {
+        let reader = nativeTapeReader()
+        var buffer = [Float](repeating: 0, count: max(0, frames) * reader.tracks)
+        guard frames > 0 else { return buffer }
+        if varispeedMaxFrames < frames {
+            reader.prepareVarispeed(maxFrames: frames)
+            varispeedMaxFrames = frames
+        }
+        let next = reader.render(position: max(0, position) * reader.sampleRate, rate: tapeSpeed,
+                                 into: &buffer, frames: frames, through: dsp)
+        position = next / reader.sampleRate
+        return buffer
+    }
+
+    /// Playback speed from the pitch knob: ±12% around unity.
+    private var tapeSpeed: Double { 1.0 + Double((master.pitch - 0.5) * 0.24) }
+
+    private func nativeTapeReader() -> PortaTapeTimeline {
+        let sampleRate = (processingFormat ?? resolveProcessingFormat()).sampleRate
+        if let tapeReader, tapeReader.sampleRate == sampleRate {
+            return tapeReader
+        }
+        let reader = PortaTapeTimeline(sampleRate: sampleRate, tracks: trackRegions.count)
+        tapeReader = reader
+        varispeedMaxFrames = 0
+        syncTapeReader()
+        return reader
+    }
+
+    private func syncTapeReader() {
+        guard let tapeReader else { return }
+        tapeReader.setRegions(nativeTapeRegions())
+    }
+
+    private func nativeTapeRegions() -> [PortaTapeTimeline.Region] {
+        trackRegions.enumerated().flatMap { track, regions in
+            regions.map {
+                PortaTapeTimeline.Region(url: sessionRateURL(for: $0.url), track: track, start: $0.start,
+                                         duration: $0.duration, fileOffset: $0.fileOffset, gain: $0.gain)
+            }
+        }
+    }
+
+    // MARK: - Native mix
+
+    /// Renders the stereo mix of the tape tracks at the current tape speed, like `renderTape(at:frames:through:)`
+    /// feeding strips 1–4, through the native channel-strip mixer: every strip's trim, EQ, fader, pan and
+    /// assign in one pass instead of nine mixer nodes and an EQ unit per strip. Returns the L/R group buses
+    /// after the stereo fader; `dsp`, when given, colours the tape tracks first.
+    public func renderMix(at position: inout TimeInterval, frames: Int,
+                          through dsp: PortaDSP? = nil) -> (left: [Float], right: [Float]) {
+        let tape = renderTape(at: &position, frames: frames, through: dsp)
+        let tracks = tape.count / max(frames, 1)
+        let mixer = nativeChannelMixer(maxFrames: frames)
+        var left: [Float] = []
+        var right: [Float] = []
+        tape.withUnsafeBufferPointer { tapeBuffer in
+            var offset = 0
+            while offset < frames {
+                let count = min(mixer.maxFrames, frames - offset)
+                let start = tapeBuffer.baseAddress.map { $0 + offset * tracks }
+                let inputs: [UnsafePointer<Float>?] = (0..<mixer.stripChannels.count).map { strip in
+                    strip < min(4, tracks) ? start.map { $0 + strip } : nil
+                }
+                let strides = mixer.stripChannels.indices.map { $0 < 4 ? tracks : 2 }
+                var buses = PortaChannelMixer.Buses(frames: count)
+                buses.groupL.withUnsafeMutableBufferPointer { gl in
+                    buses.groupR.withUnsafeMutableBufferPointer { gr in
+                        mixer.process(inputs: inputs, strides: strides, frames: count,
+                                      into: .init(groupL: gl.baseAddress, groupR: gr.baseAddress))
+                    }
+                }
+                left += buses.groupL.map { $0 * master.stereoFader }
+                right += buses.groupR.map { $0 * master.stereoFader }
+                offset += count
+            }
+        }
+        return (left, right)
+    }
+
+    private func nativeChannelMixer(maxFrames: Int) -> PortaChannelMixer {
+        let sampleRate = (processingFormat ?? resolveProcessingFormat()).sampleRate
+        if let channelMixer, channelMixer.sampleRate == sampleRate {
+            return channelMixer
+        }
+        // Blocks beyond this are mixed in pieces.
+        let mixer = PortaChannelMixer(sampleRate: sampleRate, maxFrames: max(maxFrames, 4_096),
+                                      stripChannels: channels.map { $0.isStereo ? 2 : 1 })!
+        channelMixer = mixer
+        syncChannelMixer()
+        return mixer
+    }
+
+    private func syncChannelMixer() {
+        guard let channelMixer else { return }
+        for (index, channel) in channels.enumerated() where index < channelMixer.stripChannels.count {
+            var strip = PortaChannelMixer.Strip()
+            strip.trim = channel.trim
+            strip.hiEQ = channel.hiEQ
+            strip.midEQ = channel.midEQ
+            strip.loEQ = channel.loEQ
+            strip.aux1 = channel.aux1
+            strip.aux2 = channel.aux2
+            strip.tapeCue = channel.tapeCue
+            strip.pan = channel.pan
+            strip.fader = channel.fader
+            strip.mute = channel.mute
+            strip.assignL = channel.assignL
+            strip.assignR = channel.assignR
+            channelMixer.setStrip(index, strip)
+        }
+    }
+
+    // MARK: - Sample-rate conversion
+
+    /// `url`, or when it is at another sample rate than the session, a copy converted once with the native
+    /// polyphase resampler and kept in Caches. The copy is named after the source's path, size, modification
+    /// date and the target rate, so an edited source or a new session rate converts afresh. Falls back to
+    /// `url` (left to the graph's converter) if the file cannot be read or converted.
+    private func sessionRateURL(for url: URL) -> URL {
+        let sampleRate = (processingFormat ?? resolveProcessingFormat()).sampleRate
+        let values = try? url.resourceValues(forKeys: [.fileSizeKey, .contentModificationDateKey])
+        let identity = "\(url.standardizedFileURL.path)|\(values?.fileSize ?? 0)|"
+            + "\(values?.contentModificationDate?.timeIntervalSince1970 ?? 0)|\(sampleRate)"
+        if let known = sessionRateSources[identity] {
+            return known
+        }
+        guard sampleRate > 0,
+              let fileRate = try? AVAudioFile(forReading: url).fileFormat.sampleRate,
+              fileRate != sampleRate,
+              let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first
+        else {
+            sessionRateSources[identity] = url
+            return url
+        }
+
+        // FNV-1a: stable across launches, unlike `hashValue`.
+        let digest = identity.utf8.reduce(UInt64(0xcbf2_9ce4_8422_2325)) { ($0 ^ UInt64($1)) &* 0x100_0000_01b3 }
+        let directory = caches.appendingPathComponent("Porta424/Resampled", isDirectory: true)
+        let converted = directory.appendingPathComponent(
+            "\(url.deletingPathExtension().lastPathComponent)_\(String(digest, radix: 16)).wav")
+        if !FileManager.default.fileExists(atPath: converted.path) {
+            try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+            guard PortaSampleRateConverter.convertFile(at: url, to: converted, sampleRate: sampleRate) else {
+                print("Porta424: could not convert \(url.lastPathComponent) to \(Int(sampleRate)) Hz")
+                return url
+            }
+        }
+        sessionRateSources[identity] = converted
+        return converted
+    }
+
+    // MARK: - Waveform overview
+
+    /// Min/max/RMS of `track` between two tape positions in `bins` equal bins, read from the peak sidecars
+    /// written next to each take when recording stops, so drawing any zoom never decodes audio. Merges
+    /// across region boundaries; gaps, and takes without a sidecar, read as silence.
+    public func tapeWaveform(track: Int, from start: TimeInterval, to end: TimeInterval,
+                             bins: Int) -> PortaWaveformBins? {
+        let sampleRate = (processingFormat ?? resolveProcessingFormat()).sampleRate
+        if waveformOverview?.sampleRate != sampleRate {
+            waveformOverview = PortaWaveformOverview(sampleRate: sampleRate, tracks: trackRegions.count)
+            syncWaveformOverview()
+        }
+        let range = Int64((max(0, start) * sampleRate).rounded())..<Int64((max(0, end) * sampleRate).rounded())
+        return waveformOverview?.bins(track: track, range, bins: bins)
+    }
+
+    private func syncWaveformOverview() {
+        guard let waveformOverview else { return }
+        waveformOverview.setRegions(nativeTapeRegions())
     }
 
     /// Clear all tape on every track (new cassette).
@@ -688,6 +971,11 @@ public final class Porta424Engine: ObservableObject {
             try engine.start()
             isRunning = true
             print("Porta424: engine restarted after pause/stop")
+            if let timing = tapeTimingStats, timing.calls > 0 {
+                print(String(format: "Porta424: tape DSP load mean %.0f%%, p99 %.0f%%, worst %.0f%%, %d/%d deadlines missed",
+                             timing.meanLoad * 100, timing.loadPercentile(0.99) * 100, timing.maxLoad * 100,
+                             timing.overruns, timing.calls))
+            }
             return true
         } catch {
             print("Porta424: engine restart failed: \(error)")
@@ -779,7 +1067,7 @@ public final class Porta424Engine: ObservableObject {
             let playDuration = region.end - playFrom
 
             do {
-                let file = try AVAudioFile(forReading: region.url)
+                let file = try AVAudioFile(forReading: sessionRateURL(for: region.url))
                 let sampleRate = file.processingFormat.sampleRate
                 let startFrame = AVAudioFramePosition(max(0, fileOffsetSec) * sampleRate)
                 var frames = AVAudioFrameCount(playDuration * sampleRate)
@@ -840,6 +1128,24 @@ public final class Porta424Engine: ObservableObject {
         }
         // Keep tape meters fresh for UI polls.
         _ = readTapeMeters()
+        reportTapeOverruns()
+        reportTapeQuality()
+    }
+
+    /// Logs deadline misses as they happen, so an I/O overload that stops the engine has a cause on record.
+    private func reportTapeOverruns() {
+        guard let timing = tapeTimingStats, timing.overruns > reportedTapeOverruns else { return }
+        print(String(format: "Porta424: tape DSP missed %d deadlines (worst %.0f%% of budget)",
+                     timing.overruns - reportedTapeOverruns, timing.maxLoad * 100))
+        reportedTapeOverruns = timing.overruns
+    }
+
+    /// Logs the governor's tier changes, so a drop in tape quality is explained in the log.
+    private func reportTapeQuality() {
+        guard let state = tapeQualityState, state.quality != reportedTapeQuality else { return }
+        print("Porta424: tape DSP quality \(reportedTapeQuality) -> \(state.quality)"
+              + " (load \(Int(state.smoothedLoad * 100))% of budget)")
+        reportedTapeQuality = state.quality
     }
 
     private func updateCounterString() {
@@ -1,3 +1,6 @@
+#if canImport(AVFoundation)
+import AVFoundation
+#endif
 import Dispatch
 import XCTest
 @testable import PortaDSPKit
@@ -36,6 +39,670 @@ final class RealtimeBenchmarkTests: XCTestCase {
         #endif
     }
 
+    /// Compares oversampling only the saturation stage against the old workaround
+    /// of running the whole chain at twice the session rate.
+    func testSaturationOversamplingVersusDoubleRateChain() {
+        let seconds = 10.0
+        let baseRate = Double(TestConfig.sampleRate)
+
+        func measure(sampleRate: Double, oversampling: Int) -> Double {
+            let frames = Int(seconds * sampleRate)
+            var buffer = (0..<(frames * TestConfig.channels)).map { index -> Float in
+                0.5 * sinf(Float(index / TestConfig.channels) * 0.031)
+            }
+            let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: TestConfig.maxBlock, tracks: TestConfig.channels)
+            var params = PortaDSP.Params()
+            params.satDriveDb = 12.0
+            dsp.update(params)
+            dsp.setSaturationOversampling(oversampling)
+
+            let start = DispatchTime.now()
+            dsp.processInterleaved(buffer: &buffer, frames: frames, channels: TestConfig.channels)
+            let end = DispatchTime.now()
+            return Double(end.uptimeNanoseconds - start.uptimeNanoseconds) / 1_000_000_000.0
+        }
+
+        let baseline = measure(sampleRate: baseRate, oversampling: 1)
+        let stageOversampled = measure(sampleRate: baseRate, oversampling: 2)
+        let stageOversampled4x = measure(sampleRate: baseRate, oversampling: 4)
+        let doubleRateChain = measure(sampleRate: baseRate * 2.0, oversampling: 1)
+
+        print(String(format: "[PortaDSP] %.0fs stereo: 1x %.3fs, saturation 2x %.3fs, saturation 4x %.3fs, whole chain @%.0fHz %.3fs",
+                     seconds,
+                     baseline,
+                     stageOversampled,
+                     stageOversampled4x,
+                     baseRate * 2.0,
+                     doubleRateChain))
+
+        XCTAssertLessThan(stageOversampled, doubleRateChain, "Oversampling one stage should be cheaper than doubling the whole chain")
+    }
+
+    /// Dropouts skip idle stretches entirely, so the default sparse rate should
+    /// cost a small fraction of a session where the envelope is always active.
+    func testDropoutsIdleFastPath() {
+        let frames = 10 * 60 * TestConfig.sampleRate
+
+        func nanosecondsPerFrame(ratePerMinute: Float) -> Double {
+            let start = DispatchTime.now()
+            _ = PortaDSPTesting.countDropouts(
+                frames: frames,
+                blockSize: TestConfig.maxBlock,
+                sampleRate: Float(TestConfig.sampleRate),
+                dropoutRatePerMinute: ratePerMinute,
+                seed: 0x5EED
+            )
+            let end = DispatchTime.now()
+            return Double(end.uptimeNanoseconds - start.uptimeNanoseconds) / Double(frames)
+        }
+
+        let sparse = nanosecondsPerFrame(ratePerMinute: 0.2)
+        let dense = nanosecondsPerFrame(ratePerMinute: 6_000)
+
+        print(String(format: "[PortaDSP] Dropouts: %.3f ns/frame at 0.2/min, %.3f ns/frame at 6000/min", sparse, dense))
+
+        XCTAssertLessThan(sparse, dense * 0.1, "Idle frames should not pay the per-sample envelope cost")
+    }
+
+    /// Per-track cost should stay roughly flat from 4 up to 64 tracks.
+    func testTrackCountScaling() {
+        let blocks = 2_000
+        let frames = TestConfig.maxBlock
+        var perTrackNanoseconds: [Int: Double] = [:]
+
+        for tracks in [1, 2, 4, 8, 16, 24, 32, 64] {
+            let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: frames, tracks: tracks)
+            dsp.update(PortaDSP.Params())
+            var buffer = (0..<(frames * tracks)).map { index -> Float in
+                0.3 * sinf(Float(index / tracks) * 0.01 + Float(index % tracks))
+            }
+
+            let start = DispatchTime.now()
+            for _ in 0..<blocks {
+                dsp.processInterleaved(buffer: &buffer, frames: frames, channels: tracks)
+            }
+            let end = DispatchTime.now()
+
+            let elapsed = Double(end.uptimeNanoseconds - start.uptimeNanoseconds)
+            perTrackNanoseconds[tracks] = elapsed / Double(blocks * frames * tracks)
+            print(String(format: "[PortaDSP] %2d tracks: %.2f ns per track-sample", tracks, perTrackNanoseconds[tracks]!))
+        }
+
+        if let four = perTrackNanoseconds[4], let many = perTrackNanoseconds[24] {
+            XCTAssertLessThan(many, four * 1.5, "Per-track cost should not grow with the track count")
+        }
+    }
+
+    /// Callback time per 256-frame block with and without worker threads, to
+    /// locate the track count where splitting a block across cores pays off.
+    func testParallelCallbackLatencyByTrackCount() {
+        let frames = 256
+        let blocks = 1_000
+        let workers = max(ProcessInfo.processInfo.activeProcessorCount - 1, 0)
+        var serialAt64 = 0.0
+        var parallelAt64 = 0.0
+
+        for tracks in [2, 4, 8, 16, 24, 32, 64] {
+            var results: [Double] = []
+            for workerThreads in [0, workers] {
+                let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: frames, tracks: tracks,
+                                   workerThreads: workerThreads)
+                dsp.update(PortaDSP.Params())
+                var buffer = (0..<(frames * tracks)).map { index -> Float in
+                    0.3 * sinf(Float(index / tracks) * 0.01 + Float(index % tracks))
+                }
+
+                var worst: UInt64 = 0
+                var total: UInt64 = 0
+                for _ in 0..<blocks {
+                    let start = DispatchTime.now().uptimeNanoseconds
+                    dsp.processInterleaved(buffer: &buffer, frames: frames, channels: tracks)
+                    let elapsed = DispatchTime.now().uptimeNanoseconds - start
+                    worst = max(worst, elapsed)
+                    total += elapsed
+                }
+                let meanMicroseconds = Double(total) / Double(blocks) / 1_000.0
+                results.append(meanMicroseconds)
+                print(String(format: "[PortaDSP] %2d tracks, %d workers: mean %.1f us, worst %.1f us per callback",
+                             tracks, workerThreads, meanMicroseconds, Double(worst) / 1_000.0))
+            }
+            if tracks == 64 {
+                serialAt64 = results[0]
+                parallelAt64 = results[1]
+            }
+        }
+
+        if workers >= 3 {
+            XCTAssertLessThan(parallelAt64, serialAt64 * 0.8, "Worker threads should shorten wide callbacks")
+        }
+    }
+
+    /// Speed-up of the chunked offline render over a sequential pass for an
+    /// increasing number of threads.
+    func testChunkedOfflineRenderSpeedup() {
+        let channels = TestConfig.channels
+        let frames = 120 * TestConfig.sampleRate
+        let input = makeStereoProgram(frames: frames, channels: channels)
+        let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: channels)
+        dsp.update(PortaDSP.Params())
+
+        func seconds(threads: Int, chunkFrames: Int) -> Double {
+            let start = DispatchTime.now()
+            _ = dsp.renderOffline(input: input, channels: channels, chunkFrames: chunkFrames,
+                                  prerollFrames: TestConfig.sampleRate, threads: threads)
+            return Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000_000_000.0
+        }
+
+        let sequential = seconds(threads: 1, chunkFrames: 0)
+        let cores = ProcessInfo.processInfo.activeProcessorCount
+        for threads in [1, 2, 4, 8] where threads <= cores {
+            let elapsed = seconds(threads: threads, chunkFrames: 10 * TestConfig.sampleRate)
+            print(String(format: "[PortaDSP] 120 s x %d tracks offline, %d threads: %.3fs (%.2fx)",
+                         channels, threads, elapsed, sequential / elapsed))
+        }
+    }
+
+    /// Per-sample cost of the chain at each width with a fixed-width kernel
+    /// (1, 2, 4, 8) and at neighbouring widths that take the generic one.
+    func testChannelKernelSpecializations() {
+        let blocks = 400
+        for channels in [1, 2, 3, 4, 6, 8] {
+            let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: channels)
+            dsp.update(PortaDSP.Params())
+            var block = [Float](repeating: 0, count: TestConfig.maxBlock * channels)
+            for i in block.indices { block[i] = 0.25 * sinf(Float(i) * 0.01) }
+
+            let start = DispatchTime.now()
+            for _ in 0..<blocks {
+                dsp.processInterleaved(buffer: &block, frames: TestConfig.maxBlock, channels: channels)
+            }
+            let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds)
+            let kernel = [1, 2, 4, 8].contains(channels) ? "fixed" : "generic"
+            print(String(format: "[PortaDSP] %d tracks (%@ kernel): %.2f ns/sample",
+                         channels, kernel, elapsed / Double(blocks * TestConfig.maxBlock * channels)))
+        }
+    }
+
+    /// Many stereo instances rendered round-robin, as in a large session, with
+    /// the memory each one owns next to the tables they all share.
+    func testManyInstancesShareTables() {
+        let instances = 256
+        let rounds = 20
+        let dsps = (0..<instances).map { _ in
+            PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: TestConfig.channels)
+        }
+        var block = [Float](repeating: 0.1, count: TestConfig.maxBlock * TestConfig.channels)
+
+        let start = DispatchTime.now()
+        for _ in 0..<rounds {
+            for dsp in dsps {
+                dsp.processInterleaved(buffer: &block, frames: TestConfig.maxBlock, channels: TestConfig.channels)
+            }
+        }
+        let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000.0
+
+        print(String(format: "[PortaDSP] %d instances: %d bytes each, %d bytes of shared tables, %.1fus per block",
+                     instances, dsps[0].memoryFootprint, PortaDSP.sharedTableBytes,
+                     elapsed / Double(instances * rounds)))
+    }
+
+    /// Render-thread cost of the spectrum tap (one copy per block) at 8 tracks,
+    /// and the cost of a read on the meter thread.
+    func testAnalyzerCaptureCost() {
+        let tracks = 8
+        let blocks = 2_000
+        var block = [Float](repeating: 0, count: TestConfig.maxBlock * tracks)
+        for i in block.indices { block[i] = 0.25 * sinf(Float(i) * 0.01) }
+
+        func perBlock(_ dsp: PortaDSP) -> Double {
+            let start = DispatchTime.now()
+            for _ in 0..<blocks {
+                dsp.processInterleaved(buffer: &block, frames: TestConfig.maxBlock, channels: tracks)
+            }
+            return Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000.0 / Double(blocks)
+        }
+
+        let plain = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: tracks)
+        let tapped = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: tracks)
+        XCTAssertTrue(tapped.enableAnalyzer(fftSize: 4096))
+        let withoutTap = perBlock(plain)
+        let withTap = perBlock(tapped)
+
+        let reads = 200
+        let start = DispatchTime.now()
+        for _ in 0..<reads {
+            _ = tapped.readSpectrum(channel: 0, bands: 64)
+        }
+        let readTime = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000.0 / Double(reads)
+
+        print(String(format: "[PortaDSP] 8 tracks: %.2fus per block without analyzer, %.2fus with; 4096-point read %.1fus",
+                     withoutTap, withTap, readTime))
+    }
+
+    /// Blocks rendered from random timeline positions over heavily punched
+    /// tracks: every block is a seek, and none opens a file.
+    func testTimelineRandomSeekRender() throws {
+        let directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(at: directory) }
+
+        var take = Data()
+        func append<T: FixedWidthInteger>(_ x: T) { withUnsafeBytes(of: x.littleEndian) { take.append(contentsOf: $0) } }
+        let takeFrames = 10 * TestConfig.sampleRate
+        take.append(contentsOf: Array("RIFF".utf8)); append(UInt32(36 + takeFrames * 2))
+        take.append(contentsOf: Array("WAVEfmt ".utf8)); append(UInt32(16))
+        append(UInt16(1)); append(UInt16(1)); append(UInt32(TestConfig.sampleRate)); append(UInt32(TestConfig.sampleRate * 2))
+        append(UInt16(2)); append(UInt16(16))
+        take.append(contentsOf: Array("data".utf8)); append(UInt32(takeFrames * 2))
+        for i in 0..<takeFrames { append(Int16(truncatingIfNeeded: i)) }
+        let url = directory.appendingPathComponent("take.wav")
+        try take.write(to: url)
+
+        let punchesPerTrack = 2_000
+        let timeline = PortaTapeTimeline(sampleRate: Double(TestConfig.sampleRate), tracks: 4)
+        let regions = (0..<4).flatMap { track in
+            (0..<punchesPerTrack).map { i in
+                PortaTapeTimeline.Region(url: url, track: track, start: Double(i) * 0.5, duration: 0.45,
+                                         fileOffset: Double(i % 10))
+            }
+        }
+        timeline.setRegions(regions)
+
+        let blocks = 50_000
+        let span = Int64(Double(punchesPerTrack) * 0.5 * Double(TestConfig.sampleRate))
+        var buffer = [Float](repeating: 0, count: TestConfig.maxBlock * 4)
+        var generator = SystemRandomNumberGenerator()
+        let positions = (0..<blocks).map { _ in Int64.random(in: 0..<span, using: &generator) }
+        let start = DispatchTime.now()
+        for position in positions {
+            timeline.render(position: position, into: &buffer, frames: TestConfig.maxBlock)
+        }
+        let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000.0
+
+        print(String(format: "[PortaDSP] 4 tracks x %d regions: %.2fus per %d-frame block at a random position",
+                     punchesPerTrack, elapsed / Double(blocks), TestConfig.maxBlock))
+    }
+
+    /// Playing a 4-track tape through the chain live against playing it back
+    /// from its freeze, plus what the freeze itself costs and the hit rate
+    /// and savings the counters report.
+    func testFrozenTapeVersusLiveProcessing() throws {
+        let directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(at: directory) }
+
+        var take = Data()
+        func append<T: FixedWidthInteger>(_ x: T) { withUnsafeBytes(of: x.littleEndian) { take.append(contentsOf: $0) } }
+        let seconds = 30
+        let takeFrames = seconds * TestConfig.sampleRate
+        take.append(contentsOf: Array("RIFF".utf8)); append(UInt32(36 + takeFrames * 2))
+        take.append(contentsOf: Array("WAVEfmt ".utf8)); append(UInt32(16))
+        append(UInt16(1)); append(UInt16(1)); append(UInt32(TestConfig.sampleRate)); append(UInt32(TestConfig.sampleRate * 2))
+        append(UInt16(2)); append(UInt16(16))
+        take.append(contentsOf: Array("data".utf8)); append(UInt32(takeFrames * 2))
+        for i in 0..<takeFrames { append(Int16(8_000 * sin(Double(i) * 0.05))) }
+        let url = directory.appendingPathComponent("take.wav")
+        try take.write(to: url)
+
+        let timeline = PortaTapeTimeline(sampleRate: Double(TestConfig.sampleRate), tracks: 4)
+        timeline.setRegions((0..<4).map { .init(url: url, track: $0, start: 0, duration: Double(seconds)) })
+        let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: 4)
+        var buffer = [Float](repeating: 0, count: TestConfig.maxBlock * 4)
+        func pass() -> Double {
+            let start = DispatchTime.now()
+            for position in stride(from: 0, to: takeFrames - TestConfig.maxBlock, by: TestConfig.maxBlock) {
+                timeline.render(position: Int64(position), into: &buffer, frames: TestConfig.maxBlock, through: dsp)
+            }
+            return Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1e9
+        }
+
+        let live = pass()
+        var start = DispatchTime.now()
+        timeline.freeze(through: dsp, in: directory.appendingPathComponent("Frozen"), threads: 4)
+        let firstFreeze = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1e9
+        start = DispatchTime.now()
+        timeline.freeze(through: dsp, in: directory.appendingPathComponent("Frozen"), threads: 4)
+        let refreeze = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1e9
+        let frozen = pass()
+        let stats = timeline.freezeStats
+
+        print(String(format: "[PortaDSP] %ds x 4 tracks: live %.1fms, frozen %.1fms (%.1fx); freeze %.0fms, "
+                     + "unchanged refreeze %.1fms; hit rate %.0f%%, %.1fms saved", seconds, live * 1e3,
+                     frozen * 1e3, live / frozen, firstFreeze * 1e3, refreeze * 1e3, stats.hitRate * 100,
+                     stats.savedSeconds * 1e3))
+    }
+
+    /// Varispeed interpolation cost per output sample across the speed range
+    /// and quality tiers, on an empty 4-track timeline so tape reads are
+    /// nearly free.
+    func testVarispeedNanosecondsPerSample() {
+        let tracks = 4
+        let frames = TestConfig.maxBlock
+        let blocks = 2_000
+        var buffer = [Float](repeating: 0, count: frames * tracks)
+        for quality in [PortaTapeTimeline.VarispeedQuality.eco, .standard, .high] {
+            let timeline = PortaTapeTimeline(sampleRate: Double(TestConfig.sampleRate), tracks: tracks)
+            timeline.prepareVarispeed(maxFrames: frames, quality: quality)
+            for rate in [0.25, 0.5, 1.0, 1.5, 2.0] {
+                var position = 0.0
+                position = timeline.render(position: position, rate: rate, into: &buffer, frames: frames)
+                let start = DispatchTime.now()
+                for _ in 0..<blocks {
+                    position = timeline.render(position: position, rate: rate, into: &buffer, frames: frames)
+                }
+                let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds)
+                print(String(format: "[PortaDSP] varispeed %@ x%.2f: %.2f ns/sample", "\(quality)", rate,
+                             elapsed / Double(blocks * frames * tracks)))
+            }
+        }
+    }
+
+    /// Stereo sample-rate conversion cost per output sample: the rational
+    /// 44.1k <-> 48k paths against an irrational ratio that blends kernel rows.
+    func testSampleRateConversionNanosecondsPerSample() throws {
+        let frames = 4_096
+        let blocks = 200
+        let input = (0..<(frames * 2)).map { sinf(Float($0 / 2) * 0.03) }
+        for (inRate, outRate) in [(44_100.0, 48_000.0), (48_000.0, 44_100.0), (44_100.0, 47_999.5)] {
+            for quality in [PortaSampleRateConverter.Quality.eco, .standard, .high] {
+                let converter = try XCTUnwrap(PortaSampleRateConverter(from: inRate, to: outRate,
+                                                                       maxInputFrames: frames, quality: quality))
+                var produced = converter.process(input).count
+                produced = 0
+                let start = DispatchTime.now()
+                for _ in 0..<blocks { produced += converter.process(input).count }
+                let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds)
+                print(String(format: "[PortaDSP] SRC %.1fk -> %.1fk %@: %.2f ns/sample", inRate / 1_000,
+                             outRate / 1_000, "\(quality)", elapsed / Double(produced)))
+            }
+        }
+    }
+
+    #if canImport(AVFoundation)
+    /// The console's strips as a node graph (eight mixer nodes and a 3-band EQ
+    /// unit each, wired as ChannelStripNode does) against the fused native
+    /// mixer over the same six strips and five buses, per block.
+    func testChannelStripGraphVersusFusedMixer() throws {
+        let frames = TestConfig.maxBlock
+        let blocks = 2_000
+        let stripChannels = [1, 1, 1, 1, 2, 2]
+        let format = AVAudioFormat(standardFormatWithSampleRate: Double(TestConfig.sampleRate), channels: 2)!
+
+        let engine = AVAudioEngine()
+        try engine.enableManualRenderingMode(.offline, format: format, maximumFrameCount: AVAudioFrameCount(frames))
+        let buses = (0..<5).map { _ in AVAudioMixerNode() }
+        buses.forEach { engine.attach($0) }
+        func feed(_ source: AVAudioNode, into destinations: [AVAudioMixerNode]) {
+            let points = destinations.map { AVAudioConnectionPoint(node: $0, bus: $0.nextAvailableInputBus) }
+            engine.connect(source, to: points, fromBus: 0, format: format)
+        }
+        var nodes = buses.count
+        for _ in stripChannels {
+            let source = AVAudioSourceNode { _, _, frameCount, bufferList in
+                for buffer in UnsafeMutableAudioBufferListPointer(bufferList) {
+                    let samples = buffer.mData!.assumingMemoryBound(to: Float.self)
+                    for i in 0..<Int(frameCount) { samples[i] = sinf(Float(i) * 0.03) }
+                }
+                return noErr
+            }
+            let preGain = AVAudioMixerNode()
+            let eq = AVAudioUnitEQ(numberOfBands: 3)
+            let postEQ = AVAudioMixerNode()
+            let main = AVAudioMixerNode()
+            let sends = (0..<5).map { _ in AVAudioMixerNode() } // group L/R, FX1, FX2, cue
+            ([source, preGain, eq, postEQ, main] + sends).forEach { engine.attach($0) }
+            engine.connect(source, to: preGain, format: format)
+            engine.connect(preGain, to: eq, format: format)
+            engine.connect(eq, to: postEQ, format: format)
+            feed(postEQ, into: [main, sends[2], sends[3], sends[4]])
+            feed(main, into: [sends[0], sends[1]])
+            for (send, bus) in zip(sends, buses) { feed(send, into: [bus]) }
+            nodes += 9 // the source stands in for the engine's live + tape sum
+        }
+        buses.forEach { feed($0, into: [engine.mainMixerNode]) }
+
+        let output = AVAudioPCMBuffer(pcmFormat: engine.manualRenderingFormat, frameCapacity: AVAudioFrameCount(frames))!
+        try engine.start()
+        _ = try engine.renderOffline(AVAudioFrameCount(frames), to: output)
+        var start = DispatchTime.now()
+        for _ in 0..<blocks { _ = try engine.renderOffline(AVAudioFrameCount(frames), to: output) }
+        let graph = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000.0 / Double(blocks)
+        engine.stop()
+
+        let mixer = try XCTUnwrap(PortaChannelMixer(sampleRate: Double(TestConfig.sampleRate), maxFrames: frames,
+                                                    stripChannels: stripChannels))
+        var strip = PortaChannelMixer.Strip()
+        strip.loEQ = 0.6
+        strip.aux1 = 0.3
+        strip.aux2 = 0.2
+        strip.tapeCue = 0.1
+        stripChannels.indices.forEach { mixer.setStrip($0, strip) }
+        let source = (0..<(frames * 2)).map { sinf(Float($0 / 2) * 0.03) }
+        var bus = [[Float]](repeating: [Float](repeating: 0, count: frames), count: 6)
+        let fused: Double = source.withUnsafeBufferPointer { input in
+            let inputs = [UnsafePointer<Float>?](repeating: input.baseAddress, count: stripChannels.count)
+            return bus[0].withUnsafeMutableBufferPointer { gl in
+                bus[1].withUnsafeMutableBufferPointer { gr in
+                    bus[2].withUnsafeMutableBufferPointer { f1 in
+                        bus[3].withUnsafeMutableBufferPointer { f2 in
+                            bus[4].withUnsafeMutableBufferPointer { cl in
+                                bus[5].withUnsafeMutableBufferPointer { cr in
+                                    let pointers = PortaChannelMixer.BusPointers(
+                                        groupL: gl.baseAddress, groupR: gr.baseAddress, fx1: f1.baseAddress,
+                                        fx2: f2.baseAddress, cueL: cl.baseAddress, cueR: cr.baseAddress)
+                                    start = DispatchTime.now()
+                                    for _ in 0..<blocks {
+                                        mixer.process(inputs: inputs, strides: stripChannels, frames: frames,
+                                                      into: pointers)
+                                    }
+                                    return Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds)
+                                        / 1_000.0 / Double(blocks)
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        print(String(format: "[PortaDSP] 6 strips, %d-frame block: %d-node graph %.1fus, fused mixer %.1fus (%.1fx)",
+                     frames, nodes, graph, fused, graph / fused))
+    }
+    #endif
+
+    /// Overview queries at three zooms over a track of many short takes: the
+    /// cost should follow the number of bins, not the length of the range.
+    func testWaveformOverviewQuery() throws {
+        let directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(at: directory) }
+
+        let sampleRate = Double(TestConfig.sampleRate)
+        let takeURL = directory.appendingPathComponent("take.caf")
+        let peaks = PortaWaveformPeaks(sampleRate: sampleRate)
+        var block = [Float](repeating: 0, count: TestConfig.maxBlock)
+        for b in 0..<(600 * TestConfig.sampleRate / TestConfig.maxBlock) {
+            for i in 0..<block.count { block[i] = sinf(Float(b * block.count + i) * 0.01) }
+            peaks.append(block, frames: block.count)
+        }
+        XCTAssertTrue(peaks.save(nextTo: takeURL))
+
+        let overview = PortaWaveformOverview(sampleRate: sampleRate, tracks: 1)
+        overview.setRegions((0..<1_000).map {
+            PortaTapeTimeline.Region(url: takeURL, track: 0, start: Double($0) * 3, duration: 2.5,
+                                     fileOffset: Double($0 % 200))
+        })
+
+        let bins = 2_000
+        for seconds in [1.0, 60.0, 3_000.0] {
+            let range = 0..<Int64(seconds * sampleRate)
+            let iterations = 200
+            let start = DispatchTime.now()
+            for _ in 0..<iterations { _ = overview.bins(track: 0, range, bins: bins) }
+            let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000.0
+            print(String(format: "[PortaDSP] overview %d bins over %.0fs: %.1fus", bins, seconds,
+                         elapsed / Double(iterations)))
+        }
+    }
+
+    /// 16-bit file-style processing through the fused entry point against
+    /// converting the whole buffer to float and back in separate passes.
+    func testInt16FusedVersusSeparatePasses() {
+        let channels = TestConfig.channels
+        let frames = 30 * TestConfig.sampleRate
+        let source = (0..<(frames * channels)).map { Int16(truncatingIfNeeded: Int(10_000 * sin(0.001 * Double($0)))) }
+
+        func seconds(_ body: () -> Void) -> Double {
+            let start = DispatchTime.now()
+            body()
+            return Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000_000_000.0
+        }
+
+        let fusedDSP = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: channels)
+        var fused = source
+        let fusedTime = seconds {
+            fusedDSP.processInt16(buffer: &fused, frames: frames, channels: channels)
+        }
+
+        let floatDSP = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: channels)
+        var separate = source
+        let separateTime = seconds {
+            var buffer = separate.map { Float($0) / 32_768 }
+            var block = [Float](repeating: 0, count: TestConfig.maxBlock * channels)
+            var frame = 0
+            while frame < frames {
+                let count = min(TestConfig.maxBlock, frames - frame)
+                let range = (frame * channels)..<((frame + count) * channels)
+                block.replaceSubrange(0..<range.count, with: buffer[range])
+                floatDSP.processInterleaved(buffer: &block, frames: count, channels: channels)
+                buffer.replaceSubrange(range, with: block[0..<range.count])
+                frame += count
+            }
+            separate = buffer.map { Int16(max(-32_768, min(32_767, ($0 * 32_768).rounded()))) }
+        }
+
+        print(String(format: "[PortaDSP] 30 s stereo int16: fused %.3fs, separate passes %.3fs", fusedTime, separateTime))
+    }
+
+    /// Cost of getting a ready 8-track instance by creating one, by taking one
+    /// from a pool, and by resetting one in place.
+    func testInstanceCreationVersusReuse() {
+        let iterations = 200
+        let tracks = 8
+        let sampleRate = Double(TestConfig.sampleRate)
+
+        func microseconds(_ body: () -> Void) -> Double {
+            let start = DispatchTime.now()
+            for _ in 0..<iterations { body() }
+            let elapsed = DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds
+            return Double(elapsed) / 1_000.0 / Double(iterations)
+        }
+
+        let created = microseconds {
+            _ = PortaDSP(sampleRate: sampleRate, maxBlock: TestConfig.maxBlock, tracks: tracks)
+        }
+        let pool = PortaDSPPool(maxIdle: 1)
+        let pooled = microseconds {
+            _ = pool.acquire(sampleRate: sampleRate, maxBlock: TestConfig.maxBlock, tracks: tracks)
+        }
+        let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: TestConfig.maxBlock, tracks: tracks)
+        var block = [Float](repeating: 0, count: TestConfig.maxBlock * tracks)
+        let resetOnly = microseconds {
+            dsp.reset()
+            dsp.processInterleaved(buffer: &block, frames: 1, channels: tracks)
+        }
+
+        print(String(format: "[PortaDSP] 8-track instance: create %.1fus, pool %.1fus, reset %.1fus",
+                     created, pooled, resetOnly))
+    }
+
+    /// What the always-on callback timing sees per call against the wall
+    /// clock around the call, for small and large blocks. The gap holds the
+    /// timing's own clock reads and bookkeeping (plus the Swift call).
+    func testCallbackTimingOverhead() {
+        let channels = TestConfig.channels
+        for frames in [16, 64, TestConfig.maxBlock] {
+            let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: TestConfig.maxBlock, tracks: channels)
+            var block = makeStereoProgram(frames: frames, channels: channels)
+            let calls = max(1, 4 * TestConfig.sampleRate / frames)
+            let start = DispatchTime.now()
+            for _ in 0..<calls {
+                dsp.processInterleaved(buffer: &block, frames: frames, channels: channels)
+            }
+            let wall = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / Double(calls)
+            let timing = dsp.timingStats
+            let busy = timing.busySeconds * 1e9 / Double(timing.calls)
+            print(String(format: "[PortaDSP] %d-frame calls: %.0fns timed, %.0fns outside (%.2f%%), mean load %.1f%%",
+                         frames, busy, wall - busy, 100 * (wall - busy) / wall, timing.meanLoad * 100))
+        }
+    }
+
+    func testQualityTierCost() {
+        let channels = TestConfig.channels
+        let frames = TestConfig.maxBlock
+        let input = makeStereoProgram(frames: frames, channels: channels)
+        var reference: [Float] = []
+        for quality in [PortaDSP.Quality.high, .standard, .eco] {
+            let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: frames, tracks: channels)
+            var params = PortaDSP.Params()
+            params.hissLevelDbFS = -120
+            params.dropoutRatePerMin = 0
+            dsp.update(params)
+            dsp.setQuality(quality)
+            var block = input
+            dsp.processInterleaved(buffer: &block, frames: frames, channels: channels)
+            let calls = 8 * TestConfig.sampleRate / frames
+            var last = block
+            let start = DispatchTime.now()
+            for _ in 0..<calls {
+                block = input
+                dsp.processInterleaved(buffer: &block, frames: frames, channels: channels)
+                last = block
+            }
+            let nanos = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds)
+            if quality == .high { reference = last }
+            let worst = zip(last, reference).reduce(Float(0)) { max($0, abs($1.0 - $1.1)) }
+            print(String(format: "[PortaDSP] quality %@: %.1fns/frame, max diff from high %.1f dB",
+                         "\(quality)", nanos / Double(calls * frames), 20 * log10(max(worst, 1e-12))))
+        }
+    }
+
+    func testPresetMorphCost() {
+        let channels = TestConfig.channels
+        let frames = TestConfig.maxBlock
+        let input = makeStereoProgram(frames: frames, channels: channels)
+        let presetA = PortaPreset.cleanCassette.parameters
+        let presetB = PortaPreset.loFiWarble.parameters
+        let calls = 8 * TestConfig.sampleRate / frames
+        // A static preset, a morph swept every block, and the same sweep pushed as blended params.
+        for mode in ["static", "morph", "update"] {
+            let dsp = PortaDSP(sampleRate: Double(TestConfig.sampleRate), maxBlock: frames, tracks: channels)
+            dsp.update(presetA)
+            var block = input
+            let start = DispatchTime.now()
+            for call in 0..<calls {
+                let position = Float(call % 200) / 199
+                switch mode {
+                case "morph":
+                    dsp.morph(from: presetA, to: presetB, position: position)
+                case "update":
+                    var blended = presetA
+                    blended.headBumpGainDb += (presetB.headBumpGainDb - presetA.headBumpGainDb) * position
+                    blended.headBumpFreqHz += (presetB.headBumpFreqHz - presetA.headBumpFreqHz) * position
+                    blended.satDriveDb += (presetB.satDriveDb - presetA.satDriveDb) * position
+                    blended.lpfCutoffHz += (presetB.lpfCutoffHz - presetA.lpfCutoffHz) * position
+                    blended.azimuthJitterMs += (presetB.azimuthJitterMs - presetA.azimuthJitterMs) * position
+                    dsp.update(blended)
+                default:
+                    break
+                }
+                block = input
+                dsp.processInterleaved(buffer: &block, frames: frames, channels: channels)
+            }
+            let nanos = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds)
+            print(String(format: "[PortaDSP] preset %@: %.1fns/frame", mode, nanos / Double(calls * frames)))
+        }
+    }
+
     private func makeStereoProgram(frames: Int, channels: Int) -> [Float] {
         precondition(channels == 2, "Benchmark assumes stereo processing")
         var result = [Float](repeating: 0.0, count: frames * channels)
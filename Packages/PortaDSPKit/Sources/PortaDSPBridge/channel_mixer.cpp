@@ -0,0 +1,121 @@
+#include "PortaDSPBridge.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "../../../../DSPCore/include/modules/channel_strip_mixer.h"
+
+namespace {
+
+struct PortaMixer {
+    ChannelStripMixer mixer;
+    // Written by any thread, picked up at the start of each block.
+    std::atomic<porta_strip_t> pending[ChannelStripMixer::kMaxStrips];
+    std::atomic<float> peaks[ChannelStripMixer::kMaxStrips];
+    int lastFrames = 0;
+};
+
+ChannelStripSettings toSettings(const porta_strip_t& s) {
+    ChannelStripSettings settings;
+    settings.trim = s.trim;
+    settings.hiEQ = s.hiEQ;
+    settings.midEQ = s.midEQ;
+    settings.loEQ = s.loEQ;
+    settings.aux1 = s.aux1;
+    settings.aux2 = s.aux2;
+    settings.tapeCue = s.tapeCue;
+    settings.pan = s.pan;
+    settings.fader = s.fader;
+    settings.mute = s.mute != 0;
+    settings.assignL = s.assignL != 0;
+    settings.assignR = s.assignR != 0;
+    return settings;
+}
+
+porta_strip_t fromSettings(const ChannelStripSettings& s) {
+    return {s.trim, s.hiEQ, s.midEQ, s.loEQ, s.aux1, s.aux2, s.tapeCue, s.pan, s.fader,
+            s.mute ? 1 : 0, s.assignL ? 1 : 0, s.assignR ? 1 : 0};
+}
+
+} // namespace
+
+extern "C" {
+
+porta_mixer_handle porta_mixer_create(double sampleRate, int maxFrames, const int* stripChannels, int strips) {
+    if (sampleRate <= 0.0 || maxFrames < 1 || strips < 1 || strips > PORTA_MIXER_MAX_STRIPS) {
+        return nullptr;
+    }
+    auto* m = new PortaMixer;
+    m->mixer.prepare(static_cast<float>(sampleRate), maxFrames, stripChannels, strips);
+    for (int s = 0; s < ChannelStripMixer::kMaxStrips; ++s) {
+        m->pending[s].store(fromSettings(ChannelStripSettings{}), std::memory_order_relaxed);
+        m->peaks[s].store(0.0f, std::memory_order_relaxed);
+    }
+    return m;
+}
+
+void porta_mixer_destroy(porta_mixer_handle m) {
+    delete static_cast<PortaMixer*>(m);
+}
+
+void porta_mixer_set_strip(porta_mixer_handle m, int strip, const porta_strip_t* settings) {
+    auto* mixer = static_cast<PortaMixer*>(m);
+    if (!mixer || !settings || strip < 0 || strip >= mixer->mixer.strips()) {
+        return;
+    }
+    mixer->pending[strip].store(*settings, std::memory_order_release);
+}
+
+int porta_mixer_process(porta_mixer_handle m, const float* const* inputs, const int* strides, int frames,
+                        const porta_mixer_buses_t* buses) {
+    auto* mixer = static_cast<PortaMixer*>(m);
+    if (!mixer || frames < 0 || frames > mixer->mixer.maxFrames()) {
+        return -1;
+    }
+    const int strips = mixer->mixer.strips();
+    StripInput sources[ChannelStripMixer::kMaxStrips];
+    for (int s = 0; s < strips; ++s) {
+        mixer->mixer.setStrip(s, toSettings(mixer->pending[s].load(std::memory_order_acquire)));
+        sources[s].samples = inputs ? inputs[s] : nullptr;
+        sources[s].stride = strides ? strides[s] : mixer->mixer.channels(s);
+    }
+    MixerBuses out;
+    if (buses) {
+        out.groupL = buses->groupL;
+        out.groupR = buses->groupR;
+        out.fx1 = buses->fx1;
+        out.fx2 = buses->fx2;
+        out.cueL = buses->cueL;
+        out.cueR = buses->cueR;
+    }
+    mixer->mixer.process(sources, frames, out);
+    mixer->lastFrames = frames;
+    for (int s = 0; s < strips; ++s) {
+        mixer->peaks[s].store(mixer->mixer.peak(s), std::memory_order_relaxed);
+    }
+    return 0;
+}
+
+int porta_mixer_copy_direct(porta_mixer_handle m, int strip, float* out, int frames) {
+    auto* mixer = static_cast<PortaMixer*>(m);
+    if (!mixer || !out || strip < 0 || strip >= mixer->mixer.strips()) {
+        return 0;
+    }
+    const int count = std::clamp(frames, 0, mixer->lastFrames);
+    std::copy(mixer->mixer.direct(strip), mixer->mixer.direct(strip) + count, out);
+    return count;
+}
+
+int porta_mixer_read_peaks(porta_mixer_handle m, float* outPeaks, int maxStrips) {
+    auto* mixer = static_cast<PortaMixer*>(m);
+    if (!mixer || !outPeaks) {
+        return 0;
+    }
+    const int count = std::clamp(maxStrips, 0, mixer->mixer.strips());
+    for (int s = 0; s < count; ++s) {
+        outPeaks[s] = mixer->peaks[s].load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+} // extern "C"
@@ -1,5 +1,6 @@
 
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 #include "dsp_passthrough.h"
 
@@ -9,6 +10,14 @@ extern "C" {
 
 typedef void* porta_dsp_handle;
 
+// Largest track (channel) count a single handle processes. Buffers with more
+// channels are passed through untouched.
+#define PORTA_MAX_TRACKS 64
+
+// Handles created with worker threads split blocks of at least this many
+// channels across cores; narrower blocks always render on the calling thread.
+#define PORTA_PARALLEL_MIN_TRACKS 8
+
 typedef struct {
     float wowDepth;
     float flutterDepth;
@@ -20,28 +29,371 @@ typedef struct {
     float azimuthJitterMs;
     float crosstalkDb;
     float dropoutRatePerMin;
-    int   nrTrack4Bypass; // 0/1
+    int   nrTrack4Bypass; // 0/1, shorthand for bit 3 of the NR bypass mask
 } porta_params_t;
 
+// Deeper azimuth jitter is clamped to this. Handles size their azimuth delay
+// lines for it when created or reconfigured, so no setting or morph resizes
+// them while audio runs.
+#define PORTA_MAX_AZIMUTH_JITTER_MS 2.0f
+
 porta_dsp_handle porta_create(double sampleRate, int maxBlock, int tracks);
+// Like porta_create, but also spawns up to `workerThreads` helper threads
+// (capped at cores - 1) that render pair-aligned slices of wide blocks
+// alongside the audio thread. Output is identical to a handle without workers.
+porta_dsp_handle porta_create_with_workers(double sampleRate, int maxBlock, int tracks, int workerThreads);
 void porta_destroy(porta_dsp_handle h);
 
+// Bytes of DSP state owned by h. All of it is carved from one cache-line-aligned
+// block allocated at create time. The figure only grows when later blocks need
+// more channels or frames than the handle was created for, or when parameters
+// need longer delay lines than the defaults.
+size_t porta_get_memory_footprint(porta_dsp_handle h);
+
+// Bytes held by read-only lookup tables shared by every handle in the process
+// (one copy per distinct configuration); not included in any handle's footprint.
+size_t porta_get_shared_table_bytes(void);
+
+// Clear all DSP state before the next processed block, as if h had just been
+// created, without freeing or reallocating anything. Settings are kept. Safe
+// to call from any thread.
+void porta_reset(porta_dsp_handle h);
+
+// Change the sample rate, maximum block size and track count in place, reusing
+// the existing buffers where they are large enough, and reset as porta_reset
+// does. Like porta_destroy, must not run concurrently with processing on h.
+// Returns 0 on success.
+int porta_reconfigure(porta_dsp_handle h, double sampleRate, int maxBlock, int tracks);
+
+// A pool of idle handles for hosts that create and drop instances often.
+// Acquire returns an idle handle with the same layout after a reset, else any
+// idle handle reconfigured, else a new one; either way it behaves like a
+// freshly created handle with default settings. Release keeps up to `maxIdle`
+// handles for reuse and destroys the rest. Acquire and release are
+// thread-safe but not realtime-safe.
+typedef void* porta_pool_handle;
+porta_pool_handle porta_pool_create(int maxIdle);
+porta_dsp_handle porta_pool_acquire(porta_pool_handle pool, double sampleRate, int maxBlock, int tracks);
+void porta_pool_release(porta_pool_handle pool, porta_dsp_handle h);
+// Destroys the idle handles. Handles still acquired must be destroyed by the caller.
+void porta_pool_destroy(porta_pool_handle pool);
+
 // Thread-safe atomic swap of parameters
 void porta_update_params(porta_dsp_handle h, const porta_params_t* p);
 
+// Render between two presets: position 0 is presetA, 1 is presetB. Each new
+// pair is compiled once to stage coefficients and targets; after that a call
+// only moves the position, and the audio thread blends the compiled sets per
+// block, gliding to the requested position over about 20 ms, without
+// redesigning filters. The azimuth delay lines already fit any jitter depth
+// up to PORTA_MAX_AZIMUTH_JITTER_MS, so the audio thread does not allocate
+// for a new pair either. Switches (track 4 NR bypass) follow the nearer
+// preset. Safe while audio runs; porta_update_params ends the morph.
+// Returns -1 for a null handle or preset.
+int porta_morph(porta_dsp_handle h, const porta_params_t* presetA, const porta_params_t* presetB, float position);
+
 // Process in-place (interleaved float32 stereo for simplicity in stub)
 void porta_process_interleaved(porta_dsp_handle h, float* interleaved, int frames, int channels);
 
-// Simple meter readback (RMS in dBFS for up to 8 channels)
+// Callback timing, always on: every porta_process_interleaved call (the
+// integer entry points make one per block-sized tile) is timed against its
+// real-time budget of frames / sampleRate. Load is time over budget; the
+// histogram has four buckets per octave of load, bucket b starting at
+// porta_timing_bucket_floor(b) = 2^((b - 24) / 4), so bucket 24 starts at
+// the deadline. The first and last buckets also hold everything below and
+// above. An overrun is a call that took longer than its budget. Counters
+// only grow (until a pool hands the handle out again); subtract two reads
+// for an interval. Reading takes no lock and is safe from any thread while
+// audio runs, though a read can land between two counters of one call.
+// Recording costs two clock reads and a few stores per call.
+#define PORTA_TIMING_BUCKETS 32
+typedef struct {
+    uint64_t calls;
+    uint64_t overruns;
+    uint64_t busyNanos;   // time spent in the calls
+    uint64_t budgetNanos; // sum of their budgets
+    float maxLoad;        // worst call
+    float lastLoad;       // newest call
+    uint64_t histogram[PORTA_TIMING_BUCKETS];
+} porta_timing_stats_t;
+int porta_get_timing_stats(porta_dsp_handle h, porta_timing_stats_t* out);
+float porta_timing_bucket_floor(int bucket);
+
+// Quality tiers trade accuracy for CPU in the costliest stages. High runs
+// every stage exactly and is the default. Standard reads the saturation
+// curve from a table (error under 2e-6) and evaluates the wow/flutter and
+// azimuth LFOs every 32 samples, interpolating in between. Eco also draws
+// hiss every other frame (its top octave rolls off) and updates the
+// noise-reduction gain every 16 frames. A tier change takes effect at the
+// next block and is continuous, so it can be made while audio runs.
+#define PORTA_QUALITY_ECO 0
+#define PORTA_QUALITY_STANDARD 1
+#define PORTA_QUALITY_HIGH 2
+void porta_set_quality(porta_dsp_handle h, int tier);
+
+// With the governor enabled, the tier follows the callback load instead:
+// a missed deadline or a smoothed load over 80% of the budget steps it down,
+// and a load under 45% held for several seconds steps it back up, never
+// above the tier set with porta_set_quality. Off by default; enabling it
+// starts from that tier.
+void porta_set_quality_governor(porta_dsp_handle h, int enabled);
+
+typedef struct {
+    int tier;           // tier blocks are rendered at now
+    float smoothedLoad; // the governor's average load, 0 while it is off
+    uint64_t stepsDown; // governor changes since it was enabled
+    uint64_t stepsUp;
+} porta_quality_state_t;
+int porta_get_quality_state(porta_dsp_handle h, porta_quality_state_t* out);
+
+// Process interleaved integer PCM in place: 16-bit, packed little-endian
+// 24-bit (3 bytes per sample) or 32-bit. Samples are converted to float and
+// back one block at a time inside the call. With `dither` non-zero, TPDF
+// dither of +-1 LSB is added before rounding to the output word length.
+void porta_process_int16(porta_dsp_handle h, int16_t* interleaved, int frames, int channels, int dither);
+void porta_process_int24(porta_dsp_handle h, uint8_t* interleaved, int frames, int channels, int dither);
+void porta_process_int32(porta_dsp_handle h, int32_t* interleaved, int frames, int channels, int dither);
+
+// Run the saturation nonlinearity at 1 (off), 2, 4 or 8 times the base rate.
+// Safe to call while audio is running; other values snap to the nearest factor below.
+void porta_set_saturation_oversampling(porta_dsp_handle h, int factor);
+
+// Latency in samples added by the saturation oversampling filters.
+int porta_get_saturation_latency_samples(porta_dsp_handle h);
+
+// Centre the wow/flutter read head on the smallest delay the current depths
+// need (about 17 ms less at default settings) for live input monitoring.
+void porta_set_low_latency(porta_dsp_handle h, int enabled);
+
+// Total processing delay in samples (saturation oversampling, wow/flutter and
+// azimuth) for host delay compensation. Re-query after parameter changes.
+int porta_get_latency_samples(porta_dsp_handle h);
+
+// Jump to tape position `sampleIndex` (frames from the start) at the next
+// processed block. Hiss, dropouts and wow/flutter/azimuth modulation are a
+// function of absolute position, so output after a seek matches an unbroken
+// render from zero; filters and envelopes carry on from their current state.
+void porta_set_position(porta_dsp_handle h, int64_t sampleIndex);
+
+// Bypass noise reduction per track: bit n bypasses track n (up to PORTA_MAX_TRACKS).
+// Combined with nrTrack4Bypass, which always maps to track index 3.
+void porta_set_nr_bypass_mask(porta_dsp_handle h, uint64_t mask);
+
+// Offline render of `frames` interleaved frames using h's current settings,
+// split into chunks of `chunkFrames` rendered concurrently on `threads`
+// threads. Each chunk starts from position-derived modulation and noise state
+// at `prerollFrames` before its start and renders that stretch of input to
+// settle filters and envelopes before keeping output. `h` is only read;
+// `input` and `output` must not overlap. Returns 0 on success.
+int porta_render_offline(porta_dsp_handle h, const float* input, float* output, int64_t frames, int channels,
+                         int chunkFrames, int prerollFrames, int threads);
+// As porta_render_offline for input that starts at tape frame `position`,
+// so hiss, dropouts and modulation match playback of the same stretch.
+int porta_render_offline_at(porta_dsp_handle h, int64_t position, const float* input, float* output, int64_t frames,
+                            int channels, int chunkFrames, int prerollFrames, int threads);
+
+// Digest of everything besides input and tape position that shapes h's
+// output: sample rate, parameters, NR bypass mask, saturation oversampling,
+// low-latency mode and quality tier. It changes whenever one of them does,
+// as requested rather than as applied (the tier as the governor last chose
+// it, when on). Cheap and safe to call from any thread.
+uint64_t porta_get_settings_hash(porta_dsp_handle h);
+
+// Multitrack tape playback straight from memory-mapped takes (CAF or WAV,
+// integer or float linear PCM). A timeline renders `tracks` interleaved
+// channels for any frame position; each track reads channel 0 of its takes.
+// Regions are looked up by binary search, so seeking costs nothing and no
+// file is opened after porta_timeline_set_regions, which maps new takes
+// (reusing existing mappings), starts reading their pages in and hands the
+// new timeline to the render thread without locking. Takes must have the
+// timeline's sample rate. Set returns the number of regions kept.
+typedef void* porta_timeline_handle;
+typedef struct {
+    const char* path;
+    int track;          // 0-based
+    double start;       // timeline seconds
+    double duration;    // seconds
+    double fileOffset;  // seconds into the take where the region begins
+    float gain;
+} porta_tape_region_t;
+porta_timeline_handle porta_timeline_create(double sampleRate, int tracks);
+void porta_timeline_destroy(porta_timeline_handle t);
+int porta_timeline_set_regions(porta_timeline_handle t, const porta_tape_region_t* regions, int count);
+// Realtime-safe: gaps are silence.
+void porta_timeline_render(porta_timeline_handle t, int64_t position, float* interleaved, int frames);
+// Render, then run the block through h, moving h's tape position along on seeks.
+void porta_timeline_process(porta_timeline_handle t, porta_dsp_handle h, int64_t position, float* interleaved, int frames);
+
+// Freeze: the timeline's processed output cached on disk. Freeze renders
+// the newest timeline through h's current settings in segments of
+// PORTA_FREEZE_SEGMENT_FRAMES for every track, on up to `threads` threads,
+// into 32-bit float WAVs in `directory` (which must exist). Each file is
+// named after a hash of the regions reaching into its segment and a
+// pre-roll before it (takes, positions, gains), porta_get_settings_hash(h)
+// and the chain's fixed noise seeds, so a segment already on disk is mapped
+// instead of rendered: after an edit only the segments it touches render
+// again. From then on porta_timeline_process copies blocks that lie in
+// frozen segments from the mapped files rather than reading takes and
+// running h, as long as h's settings and the regions are the ones frozen;
+// any change plays live from the next block, as after a seek. h runs again
+// for a pre-roll before frozen coverage ends so it has settled when it
+// takes over. Varispeed playback always runs live. Freeze blocks, so call
+// it off the render thread with the handle that plays; it returns the
+// number of segments now frozen, or -1 if the regions or settings changed
+// while it ran. Unfreeze drops them all (the files stay).
+#define PORTA_FREEZE_SEGMENT_FRAMES 131072
+typedef struct {
+    uint64_t frozenBlocks; // processed blocks copied from the freeze
+    uint64_t liveBlocks;   // processed blocks run through the handle
+    uint64_t frozenFrames;
+    uint64_t liveFrames;
+    uint64_t frozenNanos; // render-thread time spent on each kind
+    uint64_t liveNanos;
+    uint64_t segmentsRendered; // by all freezes so far
+    uint64_t segmentsReused;
+} porta_freeze_stats_t;
+int porta_timeline_freeze(porta_timeline_handle t, porta_dsp_handle h, const char* directory, int threads);
+void porta_timeline_unfreeze(porta_timeline_handle t);
+void porta_timeline_get_freeze_stats(porta_timeline_handle t, porta_freeze_stats_t* out);
+
+// Varispeed playback: tape speed (pitch and tempo together) from 0.25 to 2.0
+// through a polyphase windowed-sinc interpolator. Prepare allocates for
+// blocks of up to `maxFrames` at one of the quality tiers below; call it off
+// the render thread. Process renders `frames` frames starting at tape frame
+// `position` (fractional), gliding from the previous block's rate to `rate`,
+// runs them through h when not null and returns the tape position the next
+// block continues from. Passing any other position seeks, which primes the
+// interpolator from the tape so output starts without a fade. Realtime-safe
+// once prepared; unprepared timelines write silence.
+#define PORTA_VARISPEED_ECO 0
+#define PORTA_VARISPEED_STANDARD 1
+#define PORTA_VARISPEED_HIGH 2
+int porta_timeline_prepare_varispeed(porta_timeline_handle t, int maxFrames, int quality);
+double porta_timeline_process_varispeed(porta_timeline_handle t, porta_dsp_handle h, double position, double rate,
+                                        float* interleaved, int frames);
+
+// Sample-rate conversion with a polyphase windowed-sinc FIR (quality as for
+// varispeed). Whole-number rate pairs use exact rational phases (44.1k <->
+// 48k is 160/147), other ratios interpolate between kernel rows, and equal
+// rates copy. Output frame k sits at input time k * inRate / outRate, so no
+// delay compensation is needed; flush emits the tail for a total of
+// ceil(inputFrames * outRate / inRate) frames. Process takes up to
+// `maxInputFrames` interleaved frames and returns the frames written; give
+// it porta_src_max_output frames of room. Realtime-safe after create.
+typedef void* porta_src_handle;
+porta_src_handle porta_src_create(double inRate, double outRate, int channels, int maxInputFrames, int quality);
+void porta_src_destroy(porta_src_handle s);
+void porta_src_reset(porta_src_handle s);
+int porta_src_max_output(porta_src_handle s, int inputFrames);
+int porta_src_process(porta_src_handle s, const float* input, int inputFrames, float* output, int outputCapacity);
+int porta_src_flush(porta_src_handle s, float* output, int outputCapacity);
+
+// Convert a take or import (any format the timeline reads) to `outRate`,
+// writing a 32-bit float WAV with the same channels. The file appears at
+// `outPath` only once complete, so it can serve as a cache entry. Returns 0
+// on success, -1 if the input cannot be read or the output written.
+int porta_src_convert_file(const char* inPath, const char* outPath, double outRate, int quality);
+
+// Fused channel-strip mixer: every strip's trim, 3-band EQ, aux/cue sends,
+// fader, pan and group assign in one pass, onto planar buses (group L/R,
+// mono FX1/FX2 sends, cue L/R). Knob values are normalised as in the app's
+// ChannelState (0...1, 0.5 = centre). Strips are mono or stereo; input s is
+// read at inputs[s][i * strides[s] + channel], and a null input is silence.
+// Set strips from any thread; changes ramp in on the next processed block.
+// Process writes every non-null bus and returns 0, or -1 for a bad handle or
+// frame count. Realtime-safe after create.
+#define PORTA_MIXER_MAX_STRIPS 8
+typedef struct {
+    float trim, hiEQ, midEQ, loEQ;
+    float aux1, aux2, tapeCue;
+    float pan, fader;
+    int mute, assignL, assignR;
+} porta_strip_t;
+typedef struct {
+    float* groupL;
+    float* groupR;
+    float* fx1;
+    float* fx2;
+    float* cueL;
+    float* cueR;
+} porta_mixer_buses_t;
+typedef void* porta_mixer_handle;
+porta_mixer_handle porta_mixer_create(double sampleRate, int maxFrames, const int* stripChannels, int strips);
+void porta_mixer_destroy(porta_mixer_handle m);
+void porta_mixer_set_strip(porta_mixer_handle m, int strip, const porta_strip_t* settings);
+int porta_mixer_process(porta_mixer_handle m, const float* const* inputs, const int* strides, int frames, const porta_mixer_buses_t* buses);
+// Post-EQ, pre-fader signal of `strip` from the last block (stereo summed),
+// as fed to DIRECT recording; copies up to `frames` frames, returns the count.
+int porta_mixer_copy_direct(porta_mixer_handle m, int strip, float* out, int frames);
+// Post-fader peak of each strip over the last block (linear); returns the count written.
+int porta_mixer_read_peaks(porta_mixer_handle m, float* outPeaks, int maxStrips);
+
+// Waveform peaks. A builder collects min/max/RMS bins of 256, 4096 and 65536
+// frames from the blocks of one take as they are recorded, and saves them as
+// a sidecar next to the take (its path with ".peaks" appended). Appending
+// allocates as bins fill, so call it from the recording tap rather than the
+// render thread. Query returns `bins` equal bins of frames [start, end) of
+// the take without touching its audio. Save and query return 0 on success.
+typedef void* porta_peaks_handle;
+porta_peaks_handle porta_peaks_create(double sampleRate);
+void porta_peaks_destroy(porta_peaks_handle p);
+void porta_peaks_append(porta_peaks_handle p, const float* samples, int frames, int stride);
+int64_t porta_peaks_frames(porta_peaks_handle p);
+int porta_peaks_save(porta_peaks_handle p, const char* takePath);
+int porta_peaks_query(porta_peaks_handle p, int64_t start, int64_t end, int bins, float* outMin, float* outMax,
+                      float* outRms);
+
+// Tape-wide overview from the sidecars of the regions' takes, laid out as a
+// timeline plays them. Set returns the number of regions whose sidecar was
+// found. Query fills `bins` equal bins of one track between two timeline
+// frames, merging across region boundaries; gaps read as silence. Cost grows
+// with the number of bins and regions crossed, not the length of the range.
+typedef void* porta_overview_handle;
+porta_overview_handle porta_overview_create(double sampleRate, int tracks);
+void porta_overview_destroy(porta_overview_handle o);
+int porta_overview_set_regions(porta_overview_handle o, const porta_tape_region_t* regions, int count);
+int porta_overview_query(porta_overview_handle o, int track, int64_t start, int64_t end, int bins, float* outMin,
+                         float* outMax, float* outRms);
+
+// Simple meter readback (RMS in dBFS for up to PORTA_MAX_TRACKS channels)
 int porta_get_meters_dbfs(porta_dsp_handle h, float* outDbfs, int maxChannels);
 
+// Magnitude (dB) and phase (radians) at `n` frequencies of the linear tone
+// stages, head bump then HF loss, from the coefficients the last processed
+// block ran with (the smoothers included), without rendering anything or
+// touching audio-thread state. Saturation, noise, dropouts and the compander
+// are not included. `outPhase` may be null. Safe to call from any thread;
+// allocates. Returns 0 on success.
+int porta_get_frequency_response(porta_dsp_handle h, const float* freqsHz, float* outMagDb, float* outPhase, int n);
+
+// Spectrum tap for meter views. Enabling allocates a capture ring (off the
+// audio thread); from then on each processed block is copied into it and
+// nothing more. porta_analyzer_read windows and transforms the newest
+// `fftSize` frames of one channel on the calling thread and writes `bands`
+// log-spaced band levels from 20 Hz to Nyquist, in dBFS on the meter scale
+// (a signal's bands sum to its RMS). Enable returns 0 on success, including
+// when already enabled at the same size, and -1 for an unsupported size or a
+// different one; sizes are powers of two. Read returns the bands written, or
+// 0 until enough audio has been captured.
+#define PORTA_ANALYZER_MIN_FFT 256
+#define PORTA_ANALYZER_MAX_FFT 16384
+int porta_analyzer_enable(porta_dsp_handle h, int fftSize);
+int porta_analyzer_read(porta_dsp_handle h, int channel, float* outBandsDb, int bands);
+
 float porta_test_saturation(float sample, float driveDb);
+void porta_test_saturation_block(const float* input, float* output, int frames, float sampleRate, float driveDb, int oversampling);
+// Compander gain for a detector level, from the shared table or the exact curve.
+float porta_test_compander_gain(float envelope, int useTable);
 void porta_test_head_bump(const float* input, float* output, int frames, float sampleRate, float gainDb, float freqHz);
+// Head-bump biquad {b0, b1, b2, a1, a2} for a setting, from the shared table or the exact design.
+void porta_test_head_bump_design(float sampleRate, float freqHz, float gainDb, int useTable, float* outCoefficients);
 void porta_test_wow_flutter(const float* input, float* output, int frames, float sampleRate, float wowDepth, float flutterDepth, float wowRate, float flutterRate);
 // Test helpers for DSP validation.
 void porta_test_render_hiss(float* out, int frames, int channels, float sampleRate, float hissLevelDbFS, uint64_t seed);
 void porta_test_apply_hf_loss(const float* input, float* output, int frames, int channels, float sampleRate, float cutoffHz);
 void porta_test_apply_dropouts(float* interleaved, int frames, int channels, float sampleRate, float dropoutRatePerMin, int dropoutLengthSamples, uint32_t seed);
+// Runs the dropout scheduler over `frames` mono frames and returns how many events fired.
+int porta_test_count_dropouts(int frames, int blockSize, float sampleRate, float dropoutRatePerMin, uint32_t seed);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -2,26 +2,41 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #include "../../../../DSPCore/dsp_context.h"
+#include "../../../../DSPCore/worker_group.h"
+#include "../../../../DSPCore/include/modules/arena.h"
 #include "../../../../DSPCore/include/modules/azimuth.h"
+#include "../../../../DSPCore/include/modules/callback_timing.h"
+#include "../../../../DSPCore/include/modules/channel_kernels.h"
 #include "../../../../DSPCore/include/modules/compander.h"
+#include "../../../../DSPCore/include/modules/content_hash.h"
 #include "../../../../DSPCore/include/modules/crosstalk.h"
 #include "../../../../DSPCore/include/modules/dropouts.h"
+#include "../../../../DSPCore/include/modules/frequency_response.h"
 #include "../../../../DSPCore/include/modules/head_bump.h"
 #include "../../../../DSPCore/include/modules/hf_loss.h"
 #include "../../../../DSPCore/include/modules/hiss.h"
+#include "../../../../DSPCore/include/modules/oversampler.h"
+#include "../../../../DSPCore/include/modules/pcm_convert.h"
+#include "../../../../DSPCore/include/modules/quality_governor.h"
+#include "../../../../DSPCore/include/modules/spectrum_analyzer.h"
+#include "../../../../DSPCore/include/modules/table_cache.h"
+#include "../../../../DSPCore/include/modules/tanh_table.h"
 #include "../../../../DSPCore/include/modules/wow_flutter.h"
+#include "saturation_trim_table.h"
 
 namespace {
 
 struct SaturationStage {
-    void prepare(float /*sampleRate*/, int /*channels*/) {
+    void prepare(float /*sampleRate*/, int channels, int maxBlock) {
         driveLinearState_ = 1.0f;
         trimState_ = 1.0f;
         targetDriveLinear_ = 1.0f;
@@ -29,21 +44,68 @@ struct SaturationStage {
         processedSamples_ = 0;
         blockSamples_ = 1;
         bypass_ = true;
+
+        maxBlock_ = std::max(maxBlock, 1);
+        oversamplers_.resize(static_cast<size_t>(std::max(channels, 1)));
+        for (auto& os : oversamplers_) {
+            os.prepare(maxBlock_);
+            os.setFactor(oversamplingFactor_);
+            os.reset();
+        }
+        channelScratch_.assign(static_cast<size_t>(maxBlock_), 0.0f);
+        if (!tanhTable_) {
+            tanhTable_ = SharedTableCache<TanhTable>::acquire(TanhTable::Key{});
+        }
+    }
+
+    /**
+     * Run the nonlinearity at 1x, 2x, 4x or 8x the base rate. Buffers are sized
+     * for 8x in prepare(), so this never allocates and may be called per block.
+     */
+    void setOversamplingFactor(int factor) {
+        oversamplingFactor_ = Oversampler::snapFactor(factor);
+        for (auto& os : oversamplers_) {
+            os.setFactor(oversamplingFactor_);
+        }
     }
 
-    void setDriveDb(float driveDb) {
+    int oversamplingFactor() const { return oversamplingFactor_; }
+
+    int latencySamples() const { return Oversampler::latencyForFactor(oversamplingFactor_); }
+
+    /** Read tanh from the shared table (error under 2e-6) instead of computing it. */
+    void setTableShaping(bool enabled) { tableShaping_ = enabled; }
+
+    bool tableShaping() const { return tableShaping_; }
+
+    /** Drive and make-up gain targets; bypass passes the input through untouched. */
+    struct Drive {
+        float linear = 1.0f;
+        float trim = 1.0f;
+        bool bypass = true;
+    };
+
+    /** What setDriveDb(`driveDb`) targets, e.g. to precompute a morph. */
+    static Drive driveFor(float driveDb) {
         if (!std::isfinite(driveDb)) {
             driveDb = 0.0f;
         }
-        const bool newBypass = std::fabs(driveDb) < 1.0e-3f;
-        if (newBypass) {
-            targetDriveLinear_ = 1.0f;
-            targetTrim_ = 1.0f;
-        } else {
-            targetDriveLinear_ = std::max(dbToLinear(driveDb), 1.0e-6f);
-            targetTrim_ = computeTrim(driveDb);
+        Drive drive;
+        drive.bypass = std::fabs(driveDb) < 1.0e-3f;
+        if (!drive.bypass) {
+            drive.linear = std::max(dbToLinear(driveDb), 1.0e-6f);
+            drive.trim = computeTrim(driveDb);
         }
-        bypass_ = newBypass;
+        return drive;
+    }
+
+    void setDriveDb(float driveDb) { setDrive(driveFor(driveDb)); }
+
+    /** Target a drive from driveFor(), or a blend of two; it ramps across the next block. */
+    void setDrive(const Drive& drive) {
+        targetDriveLinear_ = drive.linear;
+        targetTrim_ = drive.trim;
+        bypass_ = drive.bypass;
     }
 
     void startBlock(int frames) {
@@ -67,51 +129,133 @@ struct SaturationStage {
         return shaped * trimState_;
     }
 
+    /**
+     * Saturate an interleaved block. At 1x this is the per-sample path above;
+     * when oversampled, each channel is upsampled, shaped with a per-frame
+     * drive/trim ramp and decimated again. The filters stay in circuit while
+     * bypassed so the reported latency never changes with the drive setting.
+     */
+    void process(float* interleaved, int frames, int channels) {
+        startBlock(frames);
+        const float driveStart = driveLinearState_;
+        const float trimStart = trimState_;
+
+        if (oversamplingFactor_ <= 1 || static_cast<int>(oversamplers_.size()) < channels) {
+            // The ramp advances once per frame so every channel (and every
+            // track group) sees the same drive at the same frame.
+            if (!bypass_) {
+                if (channels != kernelWidth_ || tableShaping_ != kernelTable_) {
+                    kernelWidth_ = channels;
+                    kernelTable_ = tableShaping_;
+                    kernel_ = selectChannelKernel(channels, [this](auto w) -> Kernel {
+                        constexpr int width = decltype(w)::value;
+                        return tableShaping_ ? &SaturationStage::shapeFrames<width, true>
+                                             : &SaturationStage::shapeFrames<width, false>;
+                    });
+                }
+                kernel_(interleaved, frames, channels, driveStart, driveStep_, trimStart, trimStep_, *tanhTable_);
+            }
+            finishBlock(driveStart, trimStart, frames);
+            return;
+        }
+
+        if (tableShaping_) {
+            processOversampled<true>(interleaved, frames, channels, driveStart, trimStart);
+        } else {
+            processOversampled<false>(interleaved, frames, channels, driveStart, trimStart);
+        }
+        finishBlock(driveStart, trimStart, frames);
+    }
+
 private:
-    static float dbToLinear(float db) {
-        return std::pow(10.0f, db / 20.0f);
+    using Kernel = void (*)(float*, int, int, float, float, float, float, const TanhTable&);
+
+    template <bool Table>
+    static float shape(const TanhTable& table, float x) {
+        if constexpr (Table) {
+            return table(x);
+        } else {
+            (void)table;
+            return std::tanh(x);
+        }
     }
 
-    static float computeTrim(float driveDb) {
-        constexpr int kTableSize = 64;
-        constexpr float kMinDb = -60.0f;
-        constexpr float kMaxDb = 40.0f;
-        constexpr float kStepDb = (kMaxDb - kMinDb) / (kTableSize - 1);
-
-        static std::once_flag once;
-        static float table[kTableSize];
-        std::call_once(once, [] {
-            for (int i = 0; i < kTableSize; ++i) {
-                float db = kMinDb + kStepDb * static_cast<float>(i);
-                const float linear = dbToLinear(db);
-                // RMS of tanh() drive for a sine wave.
-                constexpr int kSineSamples = 2048;
-                double acc = 0.0;
-                const double omega = 2.0 * std::acos(-1.0) / static_cast<double>(kSineSamples);
-                for (int n = 0; n < kSineSamples; ++n) {
-                    const double phase = omega * (n + 0.5);
-                    const double x = std::sin(phase);
-                    const double y = std::tanh(static_cast<double>(linear) * x);
-                    acc += y * y;
+    template <bool Table>
+    void processOversampled(float* interleaved, int frames, int channels, float driveStart, float trimStart) {
+        const bool bypass = bypass_;
+        const TanhTable& table = *tanhTable_;
+        const int factor = oversamplingFactor_;
+        for (int c = 0; c < channels; ++c) {
+            Oversampler& os = oversamplers_[static_cast<size_t>(c)];
+            for (int start = 0; start < frames; start += maxBlock_) {
+                const int chunk = std::min(maxBlock_, frames - start);
+                float* scratch = channelScratch_.data();
+                for (int i = 0; i < chunk; ++i) {
+                    scratch[i] = interleaved[(start + i) * channels + c];
+                }
+                os.process(scratch, chunk, [&](float* highRate, int count, int offset) {
+                    if (bypass) {
+                        return;
+                    }
+                    const int baseFrames = count / factor;
+                    for (int i = 0; i < baseFrames; ++i) {
+                        const float ramp = static_cast<float>(start + offset + i + 1);
+                        const float drive = driveStart + driveStep_ * ramp;
+                        const float trim = trimStart + trimStep_ * ramp;
+                        float* samples = highRate + i * factor;
+                        for (int k = 0; k < factor; ++k) {
+                            samples[k] = shape<Table>(table, drive * samples[k]) * trim;
+                        }
+                    }
+                });
+                for (int i = 0; i < chunk; ++i) {
+                    interleaved[(start + i) * channels + c] = scratch[i];
                 }
-                const double rmsOut = std::sqrt(acc / static_cast<double>(kSineSamples));
-                constexpr double rmsIn = 0.7071067811865476; // RMS of a full-scale sine wave
-                table[i] = rmsOut > 1e-12 ? static_cast<float>(rmsIn / rmsOut) : 1.0f;
             }
-        });
+        }
+    }
 
-        if (driveDb <= kMinDb) {
-            return table[0];
+    template <int Width, bool Table>
+    static void shapeFrames(float* interleaved, int frames, int channels, float driveStart, float driveStep,
+                            float trimStart, float trimStep, const TanhTable& table) {
+        const int lanes = kernelLanes<Width>(channels);
+        for (int frame = 0; frame < frames; ++frame) {
+            const float ramp = static_cast<float>(frame + 1);
+            const float drive = driveStart + driveStep * ramp;
+            const float trim = trimStart + trimStep * ramp;
+            float* samples = interleaved + frame * lanes;
+            for (int c = 0; c < lanes; ++c) {
+                samples[c] = shape<Table>(table, drive * samples[c]) * trim;
+            }
         }
-        if (driveDb >= kMaxDb) {
-            return table[kTableSize - 1];
+    }
+
+    void finishBlock(float driveStart, float trimStart, int frames) {
+        driveLinearState_ = driveStart + driveStep_ * static_cast<float>(frames);
+        trimState_ = trimStart + trimStep_ * static_cast<float>(frames);
+        processedSamples_ = blockSamples_;
+    }
+
+    static float dbToLinear(float db) {
+        return std::pow(10.0f, db / 20.0f);
+    }
+
+    /** Make-up gain for `driveDb`, interpolated from the pre-generated table. */
+    static float computeTrim(float driveDb) {
+        constexpr float kStepDb =
+            (kSaturationTrimMaxDb - kSaturationTrimMinDb) / static_cast<float>(kSaturationTrimTableSize - 1);
+        if (driveDb <= kSaturationTrimMinDb) {
+            return kSaturationTrimTable[0];
+        }
+        if (driveDb >= kSaturationTrimMaxDb) {
+            return kSaturationTrimTable[kSaturationTrimTableSize - 1];
         }
 
-        const float position = (driveDb - kMinDb) / kStepDb;
-        const int index = static_cast<int>(std::floor(position));
+        const float position = (driveDb - kSaturationTrimMinDb) / kStepDb;
+        const int index = std::min(static_cast<int>(position), kSaturationTrimTableSize - 2);
         const float frac = position - static_cast<float>(index);
-        const float a = table[index];
-        const float b = table[index + 1];
+        const float a = kSaturationTrimTable[index];
+        const float b = kSaturationTrimTable[index + 1];
         return a + (b - a) * frac;
     }
 
@@ -124,30 +268,272 @@ private:
     int blockSamples_ = 1;
     int processedSamples_ = 0;
     bool bypass_ = true;
+
+    Kernel kernel_ = &SaturationStage::shapeFrames<0, false>;
+    int kernelWidth_ = 0;
+    bool kernelTable_ = false;
+    bool tableShaping_ = false;
+    // Shared by every stage; acquired in prepare().
+    std::shared_ptr<const TanhTable> tanhTable_;
+
+    int oversamplingFactor_ = 1;
+    int maxBlock_ = 1;
+    ArenaVector<Oversampler> oversamplers_;
+    ArenaVector<float> channelScratch_;
+};
+
+// Crosstalk and azimuth pair adjacent tracks, so the stages from the
+// compander onwards only couple channels within a pair. A TrackGroup owns a
+// private copy of that per-track chain for a pair-aligned slice of the
+// tracks, which lets slices render on different cores. Every stage derives
+// its state from the absolute track index, so the result does not depend on
+// how the tracks are sliced.
+struct TrackGroup {
+    int firstChannel = 0;
+    int channelCount = 0;
+    int quality = -1; // tier the stages are set up for; -1 until the first block
+
+    DSPContext dsp;
+    ArenaVector<WowFlutter> wowFlutter;
+    HeadBump headBump;
+    SaturationStage saturation;
+    HFLoss hfLoss;
+    Hiss hiss;
+    // One azimuth model per adjacent track pair (0/1, 2/3, ...); crosstalk is
+    // stateless, so a single instance serves every pair.
+    ArenaVector<Azimuth> azimuth;
+    Crosstalk crosstalk;
+
+    ArenaVector<float> interleaved; // the slice's own frames when the tracks are split
+    ArenaVector<float> channelScratch;
+    ArenaVector<float> tempLeft;
+    ArenaVector<float> tempRight;
 };
 
+/** Add each track's squared samples to `acc`, for the RMS meters. */
+template <int Width>
+void accumulateSquares(float* acc, const float* interleaved, int frames, int channels) {
+    const int lanes = kernelLanes<Width>(channels);
+    for (int frame = 0; frame < frames; ++frame) {
+        const float* x = interleaved + frame * lanes;
+        for (int c = 0; c < lanes; ++c) {
+            acc[c] += x[c] * x[c];
+        }
+    }
+}
+
+using MeterKernel = void (*)(float*, const float*, int, int);
+
+/**
+ * Coefficients of the linear tone stages (head bump and HF loss) as the audio
+ * thread last ran them, for porta_get_frequency_response. A sequence lock:
+ * the writer never waits, and a reader that overlaps a publish retries.
+ */
+class ToneStageSnapshot {
+public:
+    struct Values {
+        float sampleRate = 48000.0f;
+        BiquadCoefficients headBump;
+        float hfLoss = 1.0f;
+    };
+
+    void publish(const Values& v) {
+        const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        const float packed[kCount] = {v.sampleRate, v.headBump.b0, v.headBump.b1, v.headBump.b2,
+                                      v.headBump.a1, v.headBump.a2, v.hfLoss};
+        for (int i = 0; i < kCount; ++i) {
+            values_[i].store(packed[i], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    Values read() const {
+        float packed[kCount];
+        for (;;) {
+            const uint32_t before = sequence_.load(std::memory_order_acquire);
+            for (int i = 0; i < kCount; ++i) {
+                packed[i] = values_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((before & 1u) == 0 && sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        Values v;
+        v.sampleRate = packed[0];
+        v.headBump = {packed[1], packed[2], packed[3], packed[4], packed[5]};
+        v.hfLoss = packed[6];
+        return v;
+    }
+
+private:
+    static constexpr int kCount = 7;
+    std::atomic<uint32_t> sequence_{0};
+    std::atomic<float> values_[kCount] = {};
+};
+
+/** One preset compiled to stage targets at a handle's sample rate, for porta_morph. */
+struct MorphTargets {
+    BiquadCoefficients headBump;
+    float hfLoss = 1.0f;
+    SaturationStage::Drive drive;
+    float hissLevel = 0.0f;
+    float crosstalk = 0.0f;
+    float azimuthJitterSamples = 0.0f;
+    float wowDepth = 0.0f;
+    float flutterDepth = 0.0f;
+};
+
+/**
+ * The two compiled presets of a morph, handed from porta_morph to the audio
+ * thread. A sequence lock like ToneStageSnapshot, but read by the audio
+ * thread: a read that overlaps a publish fails instead of retrying, and the
+ * reader keeps the pair it had for another block.
+ */
+class MorphSnapshot {
+public:
+    struct Pair {
+        MorphTargets a;
+        MorphTargets b;
+    };
+
+    void publish(const Pair& pair) {
+        const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        pack(pair.a, 0);
+        pack(pair.b, kPerPreset);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * Copy the pair into `pair` if one was published since the read that
+     * left `seen` (0 before the first); false if not, or if the read was torn.
+     */
+    bool tryRead(Pair& pair, uint32_t& seen) const {
+        const uint32_t before = sequence_.load(std::memory_order_acquire);
+        if (before == seen || (before & 1u) != 0) {
+            return false;
+        }
+        float packed[2 * kPerPreset];
+        for (int i = 0; i < 2 * kPerPreset; ++i) {
+            packed[i] = values_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        pair.a = unpack(packed);
+        pair.b = unpack(packed + kPerPreset);
+        seen = before;
+        return true;
+    }
+
+private:
+    static constexpr int kPerPreset = 14;
+
+    void pack(const MorphTargets& t, int offset) {
+        const float packed[kPerPreset] = {t.headBump.b0, t.headBump.b1, t.headBump.b2, t.headBump.a1,
+                                          t.headBump.a2, t.hfLoss, t.drive.linear, t.drive.trim,
+                                          t.drive.bypass ? 1.0f : 0.0f, t.hissLevel, t.crosstalk,
+                                          t.azimuthJitterSamples, t.wowDepth, t.flutterDepth};
+        for (int i = 0; i < kPerPreset; ++i) {
+            values_[offset + i].store(packed[i], std::memory_order_relaxed);
+        }
+    }
+
+    static MorphTargets unpack(const float* p) {
+        MorphTargets t;
+        t.headBump = {p[0], p[1], p[2], p[3], p[4]};
+        t.hfLoss = p[5];
+        t.drive = {p[6], p[7], p[8] != 0.0f};
+        t.hissLevel = p[9];
+        t.crosstalk = p[10];
+        t.azimuthJitterSamples = p[11];
+        t.wowDepth = p[12];
+        t.flutterDepth = p[13];
+        return t;
+    }
+
+    std::atomic<uint32_t> sequence_{0};
+    std::atomic<float> values_[2 * kPerPreset] = {};
+};
+
+// A context lives at the start of its own arena, and every container in it,
+// down to the module buffers, is carved from the same block.
 struct PortaStubContext {
+    Arena* arena = nullptr;
     double sampleRate = 48000.0;
     int maxBlock = 512;
     int maxTracks = 2;
+    int workerThreads = 0;
 
     std::atomic<porta_params_t> params;
     porta_params_t currentParams{};
+    std::atomic<int> saturationOversampling{1};
+    std::atomic<uint64_t> nrBypassMask{0};
+    std::atomic<bool> lowLatency{false};
+    // Tape position requested by porta_set_position, applied at the next block.
+    std::atomic<int64_t> pendingPosition{-1};
+    // Set by porta_reset, applied at the next block.
+    std::atomic<bool> pendingReset{false};
 
-    DSPContext dsp;
-    std::vector<WowFlutter> wowFlutter;
-    HeadBump headBump;
-    SaturationStage saturation;
-    HFLoss hfLoss;
-    Hiss hiss;
-    Azimuth azimuth;
-    Crosstalk crosstalk;
+    // Sized once for the most slices the worker count allows; only the first
+    // groupCount are active for the current channel layout.
+    ArenaVector<TrackGroup> groups;
+    int groupCount = 1;
+    WorkerGroup workers;
 
-    std::vector<float> channelScratch;
-    std::vector<float> tempLeft;
-    std::vector<float> tempRight;
-    std::vector<float> rmsAcc;
-    std::vector<int> rmsCount;
+    // Per-block job handed to the worker group.
+    float* blockInterleaved = nullptr;
+    int blockFrames = 0;
+    int blockChannels = 0;
+    DSPContext::Parameters blockDspParams;
+
+    ArenaVector<float> rmsAcc;
+    ArenaVector<int> rmsCount;
+    MeterKernel meterKernel = &accumulateSquares<0>;
+    int meterKernelWidth = 0;
+
+    // Float tile the integer PCM entry points convert into and out of, one
+    // block at a time, and the position of their dither stream.
+    ArenaVector<float> pcmTile;
+    uint64_t ditherCounter = 0;
+
+    ToneStageSnapshot toneStages;
+
+    // Spectrum tap, heap-allocated by porta_analyzer_enable. Once published it
+    // stays until the handle is destroyed, reconfigured or pooled.
+    std::atomic<SpectrumAnalyzer*> analyzer{nullptr};
+
+    // Time each porta_process_interleaved call takes against its budget.
+    CallbackTiming timing;
+
+    // Quality tier requested by the host and, when the governor is on, the
+    // ceiling it works under. `governing` is the audio thread's view of
+    // governorEnabled, so it can start the governor afresh when switched on.
+    std::atomic<int> quality{PORTA_QUALITY_HIGH};
+    std::atomic<bool> governorEnabled{false};
+    QualityGovernor governor;
+    bool governing = false;
+
+    // Preset morph (porta_morph): both presets compiled to stage targets and
+    // where between them to render. porta_morph callers are serialised by
+    // morphMutex, which also guards the presets last compiled. The audio
+    // thread keeps the last pair it read whole and glides its own position
+    // towards the requested one; a negative position snaps at the next block.
+    mutable std::mutex morphMutex;
+    porta_params_t morphPresets[2] = {};
+    bool morphCompiled = false;
+    MorphSnapshot morph;
+    std::atomic<float> morphPosition{0.0f};
+    std::atomic<bool> morphing{false};
+    MorphSnapshot::Pair morphPair;
+    uint32_t morphSequence = 0;
+    float morphSmoothed = -1.0f;
 
     int currentChannels = 0;
 };
@@ -168,103 +554,827 @@ porta_params_t makeDefaultParams() {
     return p;
 }
 
-void updateModuleParameters(PortaStubContext& ctx, const porta_params_t& p) {
-    ctx.headBump.setParams(p.headBumpFreqHz, p.headBumpGainDb);
-    ctx.saturation.setDriveDb(p.satDriveDb);
+float azimuthJitterSamples(double sampleRate, float jitterMs) {
+    if (std::isfinite(jitterMs) && jitterMs > 0.0f) {
+        return static_cast<float>(sampleRate) * (std::min(jitterMs, PORTA_MAX_AZIMUTH_JITTER_MS) * 0.001f);
+    }
+    return 0.0f;
+}
+
+float azimuthJitterSamples(double sampleRate, const porta_params_t& p) {
+    return azimuthJitterSamples(sampleRate, p.azimuthJitterMs);
+}
+
+void updateGroupParameters(TrackGroup& group, double sampleRate, const porta_params_t& p) {
+    group.headBump.setParams(p.headBumpFreqHz, p.headBumpGainDb);
+    group.saturation.setDriveDb(p.satDriveDb);
     float cutoffHz = p.lpfCutoffHz;
     if (!std::isfinite(cutoffHz) || cutoffHz <= 0.0f) {
-        cutoffHz = static_cast<float>(ctx.sampleRate) * 0.45f;
+        cutoffHz = static_cast<float>(sampleRate) * 0.45f;
     }
-    ctx.hfLoss.setCutoff(cutoffHz);
-    ctx.hiss.setLevelDbFS(p.hissLevelDbFS);
-    ctx.crosstalk.setAmountDb(p.crosstalkDb);
+    group.hfLoss.setCutoff(cutoffHz);
+    group.hiss.setLevelDbFS(p.hissLevelDbFS);
+    group.crosstalk.setAmountDb(p.crosstalkDb);
 
-    float jitterDepthSamples = 0.0f;
-    if (std::isfinite(p.azimuthJitterMs) && p.azimuthJitterMs > 0.0f) {
-        jitterDepthSamples = static_cast<float>(ctx.sampleRate) * (p.azimuthJitterMs * 0.001f);
+    const float jitterDepthSamples = azimuthJitterSamples(sampleRate, p);
+    for (auto& azimuth : group.azimuth) {
+        azimuth.setBaseOffsetSamples(0.0f);
+        azimuth.setJitterDepthSamples(jitterDepthSamples);
+        azimuth.setJitterRateHz(0.5f);
     }
-    ctx.azimuth.setBaseOffsetSamples(0.0f);
-    ctx.azimuth.setJitterDepthSamples(jitterDepthSamples);
-    ctx.azimuth.setJitterRateHz(0.5f);
 
-    for (auto& wf : ctx.wowFlutter) {
+    for (auto& wf : group.wowFlutter) {
         wf.setWowDepth(p.wowDepth);
         wf.setFlutterDepth(p.flutterDepth);
     }
 }
 
-void ensureChannelCapacity(PortaStubContext& ctx, int channels, int frames) {
+/** Switch every stage of `group` to the variants of `tier`. */
+void applyQuality(TrackGroup& group, int tier) {
+    const bool standard = tier <= PORTA_QUALITY_STANDARD;
+    const bool eco = tier <= PORTA_QUALITY_ECO;
+    group.saturation.setTableShaping(standard);
+    for (auto& wf : group.wowFlutter) {
+        wf.setControlRate(standard);
+    }
+    for (auto& azimuth : group.azimuth) {
+        azimuth.setControlRate(standard);
+    }
+    group.hiss.setHalfRate(eco);
+    group.dsp.setControlRateGain(eco);
+    group.quality = tier;
+}
+
+/** The tier blocks render at: the host's, or the governor's when it is on. */
+int activeQuality(const PortaStubContext& ctx) {
+    const int requested = ctx.quality.load(std::memory_order_acquire);
+    if (!ctx.governorEnabled.load(std::memory_order_acquire)) {
+        return requested;
+    }
+    return std::min(requested, ctx.governor.tier());
+}
+
+void updateModuleParameters(PortaStubContext& ctx, const porta_params_t& p) {
+    for (int g = 0; g < ctx.groupCount; ++g) {
+        updateGroupParameters(ctx.groups[static_cast<size_t>(g)], ctx.sampleRate, p);
+    }
+}
+
+/** `p` compiled to the targets its stages would design, at the context's sample rate. */
+MorphTargets compileMorphTargets(const PortaStubContext& ctx, const porta_params_t& p) {
+    const TrackGroup& group = ctx.groups[0];
+    MorphTargets t;
+    t.headBump = group.headBump.design(p.headBumpFreqHz, p.headBumpGainDb);
+    float cutoffHz = p.lpfCutoffHz;
+    if (!std::isfinite(cutoffHz) || cutoffHz <= 0.0f) {
+        cutoffHz = static_cast<float>(ctx.sampleRate) * 0.45f;
+    }
+    t.hfLoss = group.hfLoss.coefficientFor(cutoffHz);
+    t.drive = SaturationStage::driveFor(p.satDriveDb);
+    t.hissLevel = p.hissLevelDbFS <= -200.0f ? 0.0f : std::pow(10.0f, p.hissLevelDbFS * 0.05f);
+    t.crosstalk = std::pow(10.0f, p.crosstalkDb / 20.0f);
+    t.azimuthJitterSamples = azimuthJitterSamples(ctx.sampleRate, p);
+    t.wowDepth = p.wowDepth;
+    t.flutterDepth = p.flutterDepth;
+    return t;
+}
+
+/**
+ * `x` blended toward `y` by `t`, exactly `x` and `y` at the ends: in float,
+ * x + (y - x) * 1 can miss `y` by an ulp, enough to move a ceil'd delay.
+ */
+float morphMix(float x, float y, float t) {
+    return t >= 1.0f ? y : t <= 0.0f ? x : x + (y - x) * t;
+}
+
+/** The settings a morph at `t` stands for: every value blended, switches from the nearer preset. */
+porta_params_t blendParams(const porta_params_t& a, const porta_params_t& b, float t) {
+    const auto mix = [t](float x, float y) { return morphMix(x, y, t); };
+    porta_params_t p = t < 0.5f ? a : b;
+    p.wowDepth = mix(a.wowDepth, b.wowDepth);
+    p.flutterDepth = mix(a.flutterDepth, b.flutterDepth);
+    p.headBumpGainDb = mix(a.headBumpGainDb, b.headBumpGainDb);
+    p.headBumpFreqHz = mix(a.headBumpFreqHz, b.headBumpFreqHz);
+    p.satDriveDb = mix(a.satDriveDb, b.satDriveDb);
+    p.hissLevelDbFS = mix(a.hissLevelDbFS, b.hissLevelDbFS);
+    p.lpfCutoffHz = mix(a.lpfCutoffHz, b.lpfCutoffHz);
+    p.azimuthJitterMs = mix(a.azimuthJitterMs, b.azimuthJitterMs);
+    p.crosstalkDb = mix(a.crosstalkDb, b.crosstalkDb);
+    p.dropoutRatePerMin = mix(a.dropoutRatePerMin, b.dropoutRatePerMin);
+    return p;
+}
+
+/** Point every stage of `group` at the blend of two compiled presets: arithmetic only, no design. */
+void applyMorphTargets(TrackGroup& group, const MorphTargets& a, const MorphTargets& b, float t) {
+    const auto mix = [t](float x, float y) { return morphMix(x, y, t); };
+    group.headBump.setCoefficients({mix(a.headBump.b0, b.headBump.b0), mix(a.headBump.b1, b.headBump.b1),
+                                    mix(a.headBump.b2, b.headBump.b2), mix(a.headBump.a1, b.headBump.a1),
+                                    mix(a.headBump.a2, b.headBump.a2)});
+    group.hfLoss.setCoefficient(mix(a.hfLoss, b.hfLoss));
+    // A bypassed end is unity drive and trim; it only bypasses once reached,
+    // so the blend on the way there is continuous.
+    SaturationStage::Drive drive;
+    drive.linear = mix(a.drive.linear, b.drive.linear);
+    drive.trim = mix(a.drive.trim, b.drive.trim);
+    drive.bypass = (a.drive.bypass && b.drive.bypass) || (t <= 0.0f && a.drive.bypass) || (t >= 1.0f && b.drive.bypass);
+    group.saturation.setDrive(drive);
+    group.hiss.setLevelLinear(mix(a.hissLevel, b.hissLevel));
+    group.crosstalk.setGain(mix(a.crosstalk, b.crosstalk));
+    const float jitter = mix(a.azimuthJitterSamples, b.azimuthJitterSamples);
+    for (auto& azimuth : group.azimuth) {
+        azimuth.setJitterDepthSamples(jitter);
+    }
+    const float wow = mix(a.wowDepth, b.wowDepth);
+    const float flutter = mix(a.flutterDepth, b.flutterDepth);
+    for (auto& wf : group.wowFlutter) {
+        wf.setWowDepth(wow);
+        wf.setFlutterDepth(flutter);
+    }
+}
+
+/**
+ * Audio thread: update the stage targets for the next `frames` from the
+ * morph, gliding the position with a 20 ms time constant so a jump in the
+ * requested position becomes a sweep. Until a compiled pair has been read
+ * the blended `params` are designed as usual.
+ */
+void applyMorph(PortaStubContext& ctx, const porta_params_t& params, int frames) {
+    ctx.morph.tryRead(ctx.morphPair, ctx.morphSequence);
+    if (ctx.morphSequence == 0) {
+        updateModuleParameters(ctx, params);
+        return;
+    }
+    constexpr double kMorphSmoothingSeconds = 0.02;
+    const float target = ctx.morphPosition.load(std::memory_order_acquire);
+    if (ctx.morphSmoothed < 0.0f) {
+        ctx.morphSmoothed = target;
+    } else {
+        const auto alpha = static_cast<float>(1.0 - std::exp(-frames / (ctx.sampleRate * kMorphSmoothingSeconds)));
+        ctx.morphSmoothed += alpha * (target - ctx.morphSmoothed);
+        if (std::fabs(target - ctx.morphSmoothed) < 1.0e-4f) {
+            ctx.morphSmoothed = target;
+        }
+    }
+    for (int g = 0; g < ctx.groupCount; ++g) {
+        applyMorphTargets(ctx.groups[static_cast<size_t>(g)], ctx.morphPair.a, ctx.morphPair.b, ctx.morphSmoothed);
+    }
+}
+
+int trackPairCount(int channels) {
+    return std::max(channels / 2, 1);
+}
+
+/**
+ * Number of slices to split `channels` tracks into: one below the crossover
+ * or without workers, otherwise one per participating thread, capped at one
+ * pair per slice.
+ */
+int trackGroupCount(const PortaStubContext& ctx, int channels) {
+    if (ctx.workerThreads == 0 || channels < PORTA_PARALLEL_MIN_TRACKS) {
+        return 1;
+    }
+    return std::min(ctx.workerThreads + 1, trackPairCount(channels));
+}
+
+void prepareTrackGroup(TrackGroup& group, double sampleRate, int maxBlock, int firstChannel, int channelCount) {
+    const float rate = static_cast<float>(sampleRate);
+    group.firstChannel = firstChannel;
+    group.channelCount = channelCount;
+    group.quality = -1;
+
+    // Prepared in processing order, so on first allocation each stage's
+    // buffers sit right after those of the stage before it.
+    group.interleaved.assign(static_cast<size_t>(channelCount) * static_cast<size_t>(maxBlock), 0.0f);
+    group.dsp.prepare(sampleRate, channelCount);
+
+    group.channelScratch.assign(static_cast<size_t>(channelCount) * static_cast<size_t>(maxBlock), 0.0f);
+    group.wowFlutter.resize(static_cast<size_t>(channelCount));
+    for (auto& wf : group.wowFlutter) {
+        wf.prepare(rate, maxBlock);
+    }
+
+    group.headBump.prepare(rate, channelCount);
+    group.saturation.prepare(rate, channelCount, maxBlock);
+    group.hfLoss.prepare(rate, channelCount);
+    group.hiss.prepare(rate, channelCount, firstChannel);
+
+    group.tempLeft.assign(static_cast<size_t>(maxBlock), 0.0f);
+    group.tempRight.assign(static_cast<size_t>(maxBlock), 0.0f);
+    group.crosstalk.prepare(rate, maxBlock);
+
+    const int firstPair = firstChannel / 2;
+    group.azimuth.resize(static_cast<size_t>(trackPairCount(channelCount)));
+    for (size_t pair = 0; pair < group.azimuth.size(); ++pair) {
+        // Room for the deepest jitter up front, so no setting or morph
+        // resizes the delay lines on the audio thread.
+        group.azimuth[pair].prepare(rate, maxBlock, azimuthJitterSamples(rate, PORTA_MAX_AZIMUTH_JITTER_MS));
+        // Spread the jitter LFOs by the golden angle so pairs do not wobble in
+        // lockstep; pair 0 keeps the original zero phase.
+        group.azimuth[pair].setLfoPhase(2.39996323f * static_cast<float>(firstPair + static_cast<int>(pair)));
+        group.azimuth[pair].reset();
+    }
+}
+
+/** Slice `channels` tracks into pair-aligned groups and prepare each one. */
+void prepareTrackGroups(PortaStubContext& ctx, int channels) {
+    // Elements created here bind their own buffers to the context's arena.
+    ArenaScope scope(ctx.arena);
+    const int groupCount = trackGroupCount(ctx, channels);
+    const int pairs = channels / 2;
+    ctx.groupCount = groupCount;
+    int firstPair = 0;
+    for (int g = 0; g < groupCount; ++g) {
+        const int lastPair = pairs * (g + 1) / groupCount;
+        const int firstChannel = 2 * firstPair;
+        // The last slice also takes an odd, unpaired final track.
+        const int endChannel = g + 1 == groupCount ? channels : 2 * lastPair;
+        prepareTrackGroup(ctx.groups[static_cast<size_t>(g)], ctx.sampleRate, ctx.maxBlock, firstChannel,
+                          endChannel - firstChannel);
+        firstPair = lastPair;
+    }
+    updateModuleParameters(ctx, ctx.currentParams);
+}
+
+void ensureChannelCapacity(PortaStubContext& ctx, int channels) {
     if (ctx.currentChannels == channels) {
         return;
     }
     ctx.currentChannels = channels;
+    prepareTrackGroups(ctx, channels);
+    ctx.rmsAcc.assign(static_cast<size_t>(channels), 0.0f);
+    ctx.rmsCount.assign(static_cast<size_t>(channels), 0);
+}
 
-    ctx.headBump.prepare(static_cast<float>(ctx.sampleRate), channels);
-    ctx.saturation.prepare(static_cast<float>(ctx.sampleRate), channels);
-    ctx.hfLoss.prepare(static_cast<float>(ctx.sampleRate), channels);
-    ctx.hiss.prepare(static_cast<float>(ctx.sampleRate), channels);
-    ctx.wowFlutter.resize(static_cast<size_t>(channels));
-    for (auto& wf : ctx.wowFlutter) {
-        wf.prepare(static_cast<float>(ctx.sampleRate), ctx.maxBlock);
-    }
-    ctx.channelScratch.resize(static_cast<size_t>(channels) * static_cast<size_t>(frames));
+/** One block at the handle's track count, and at least one frame at any width. */
+size_t pcmTileSamples(const PortaStubContext& ctx) {
+    return std::max(static_cast<size_t>(ctx.maxBlock) * static_cast<size_t>(ctx.maxTracks),
+                    static_cast<size_t>(PORTA_MAX_TRACKS));
+}
+
+/** Publish the first slice's tone-stage coefficients; every slice runs the same ones. */
+void publishToneStages(PortaStubContext& ctx) {
+    const TrackGroup& group = ctx.groups[0];
+    ToneStageSnapshot::Values values;
+    values.sampleRate = static_cast<float>(ctx.sampleRate);
+    values.headBump = group.headBump.coefficients();
+    values.hfLoss = group.hfLoss.coefficient();
+    ctx.toneStages.publish(values);
+}
+
+/**
+ * Put every stage back in the state porta_create leaves it in, reusing the
+ * existing buffers. Settings are kept; as after creation, the smoothers start
+ * from the default parameters and glide to them from the next block on.
+ */
+void restartContext(PortaStubContext& ctx, int channels) {
+    ctx.currentParams = makeDefaultParams();
+    ctx.currentChannels = channels;
+    prepareTrackGroups(ctx, channels);
     ctx.rmsAcc.assign(static_cast<size_t>(channels), 0.0f);
     ctx.rmsCount.assign(static_cast<size_t>(channels), 0);
+    ctx.pcmTile.assign(pcmTileSamples(ctx), 0.0f);
+    ctx.ditherCounter = 0;
+    ctx.morphSmoothed = -1.0f;
+    publishToneStages(ctx);
+}
+
+/** Free the spectrum analyzer, if any. Only when nothing is processing on ctx. */
+void releaseAnalyzer(PortaStubContext& ctx) {
+    delete ctx.analyzer.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+/** Return the host-facing settings of a recycled context to their defaults. */
+void restoreDefaultSettings(PortaStubContext& ctx) {
+    releaseAnalyzer(ctx);
+    ctx.params.store(makeDefaultParams(), std::memory_order_relaxed);
+    ctx.saturationOversampling.store(1, std::memory_order_relaxed);
+    ctx.nrBypassMask.store(0, std::memory_order_relaxed);
+    ctx.lowLatency.store(false, std::memory_order_relaxed);
+    ctx.pendingPosition.store(-1, std::memory_order_relaxed);
+    ctx.pendingReset.store(false, std::memory_order_relaxed);
+    ctx.timing.reset();
+    ctx.quality.store(PORTA_QUALITY_HIGH, std::memory_order_relaxed);
+    ctx.governorEnabled.store(false, std::memory_order_relaxed);
+    ctx.governor.reset(PORTA_QUALITY_HIGH);
+    ctx.governing = false;
+    std::lock_guard<std::mutex> lock(ctx.morphMutex);
+    ctx.morphing.store(false, std::memory_order_relaxed);
+    ctx.morphCompiled = false;
 }
 
-void ensureFrameCapacity(PortaStubContext& ctx, int frames, int channels) {
-    if (ctx.channelScratch.size() < static_cast<size_t>(frames) * static_cast<size_t>(channels)) {
-        ctx.channelScratch.resize(static_cast<size_t>(frames) * static_cast<size_t>(channels));
+void ensureFrameCapacity(TrackGroup& group, int frames) {
+    const size_t samples = static_cast<size_t>(frames) * static_cast<size_t>(group.channelCount);
+    if (group.interleaved.size() < samples) {
+        group.interleaved.resize(samples);
+    }
+    if (group.channelScratch.size() < samples) {
+        group.channelScratch.resize(samples);
     }
-    if (ctx.tempLeft.size() < static_cast<size_t>(frames)) {
-        ctx.tempLeft.resize(static_cast<size_t>(frames));
+    if (group.tempLeft.size() < static_cast<size_t>(frames)) {
+        group.tempLeft.resize(static_cast<size_t>(frames));
     }
-    if (ctx.tempRight.size() < static_cast<size_t>(frames)) {
-        ctx.tempRight.resize(static_cast<size_t>(frames));
+    if (group.tempRight.size() < static_cast<size_t>(frames)) {
+        group.tempRight.resize(static_cast<size_t>(frames));
     }
 }
 
-} // namespace
+/** Run the per-track chain over one group's slice of an interleaved block. */
+void processTrackGroup(TrackGroup& group, float* interleaved, int frames, int channels,
+                       const DSPContext::Parameters& dspParams) {
+    const bool split = group.channelCount != channels;
+    float* io = interleaved;
+    const int width = group.channelCount;
+    if (split) {
+        io = group.interleaved.data();
+        for (int i = 0; i < frames; ++i) {
+            std::memcpy(io + i * width, interleaved + i * channels + group.firstChannel, sizeof(float) * width);
+        }
+    }
 
-extern "C" {
+    DSPContext::Parameters groupParams = dspParams;
+    groupParams.nrBypassMask = group.firstChannel < 64 ? dspParams.nrBypassMask >> group.firstChannel : 0;
+    group.dsp.process(io, frames, width, groupParams);
 
-porta_dsp_handle porta_create(double sampleRate, int maxBlock, int tracks) {
-    auto* ctx = new PortaStubContext();
-    ctx->sampleRate = sampleRate > 1.0 ? sampleRate : 1.0;
-    ctx->maxBlock = std::max(maxBlock, 1);
-    ctx->maxTracks = std::max(tracks, 1);
+    if (!group.wowFlutter.empty()) {
+        for (int c = 0; c < width; ++c) {
+            float* scratch = group.channelScratch.data() + static_cast<size_t>(c) * static_cast<size_t>(frames);
+            for (int i = 0; i < frames; ++i) {
+                scratch[i] = io[i * width + c];
+            }
+            group.wowFlutter[static_cast<size_t>(c)].process(scratch, static_cast<std::size_t>(frames));
+            for (int i = 0; i < frames; ++i) {
+                io[i * width + c] = scratch[i];
+            }
+        }
+    }
 
-    porta_params_t defaults = makeDefaultParams();
-    ctx->params.store(defaults, std::memory_order_relaxed);
-    ctx->currentParams = defaults;
+    group.headBump.process(io, frames, width);
+    group.saturation.process(io, frames, width);
+    group.hfLoss.process(io, frames, width);
+    group.hiss.process(io, frames, width);
 
-    ctx->dsp.prepare(ctx->sampleRate, ctx->maxTracks);
-    ctx->headBump.prepare(static_cast<float>(ctx->sampleRate), ctx->maxTracks);
-    ctx->saturation.prepare(static_cast<float>(ctx->sampleRate), ctx->maxTracks);
-    ctx->hfLoss.prepare(static_cast<float>(ctx->sampleRate), ctx->maxTracks);
-    ctx->hiss.prepare(static_cast<float>(ctx->sampleRate), ctx->maxTracks);
-    ctx->azimuth.prepare(static_cast<float>(ctx->sampleRate), ctx->maxBlock);
-    ctx->crosstalk.prepare(static_cast<float>(ctx->sampleRate), ctx->maxBlock);
+    // Adjacent tracks share a head gap, so bleed and azimuth error act on
+    // pairs (0/1, 2/3, ...). An odd final track has no partner and is left as is.
+    for (int pair = 0; pair < width / 2; ++pair) {
+        const int left = 2 * pair;
+        const int right = left + 1;
+        for (int i = 0; i < frames; ++i) {
+            group.tempLeft[static_cast<size_t>(i)] = io[i * width + left];
+            group.tempRight[static_cast<size_t>(i)] = io[i * width + right];
+        }
+        group.crosstalk.process(group.tempLeft.data(), group.tempRight.data(), frames);
+        group.azimuth[static_cast<size_t>(pair)].process(group.tempLeft.data(), group.tempRight.data(), frames);
+        for (int i = 0; i < frames; ++i) {
+            io[i * width + left] = group.tempLeft[static_cast<size_t>(i)];
+            io[i * width + right] = group.tempRight[static_cast<size_t>(i)];
+        }
+    }
 
-    ctx->wowFlutter.resize(static_cast<size_t>(ctx->maxTracks));
-    for (auto& wf : ctx->wowFlutter) {
-        wf.prepare(static_cast<float>(ctx->sampleRate), ctx->maxBlock);
+    if (split) {
+        for (int i = 0; i < frames; ++i) {
+            std::memcpy(interleaved + i * channels + group.firstChannel, io + i * width, sizeof(float) * width);
+        }
     }
+}
 
+DSPContext::Parameters makeDspParameters(const PortaStubContext& ctx, const porta_params_t& params) {
+    DSPContext::Parameters dspParams;
+    dspParams.dropoutRatePerMin = params.dropoutRatePerMin;
+    dspParams.nrBypassMask = ctx.nrBypassMask.load(std::memory_order_acquire);
+    if (params.nrTrack4Bypass != 0) {
+        dspParams.nrBypassMask |= uint64_t{1} << 3;
+    }
+    return dspParams;
+}
+
+/**
+ * Move the position-derived state (dropout schedule, hiss streams, wow/flutter
+ * and azimuth LFOs) to absolute frame `position` for the current parameters.
+ * Delay lines are cleared; filters, envelopes and smoothers keep whatever
+ * state they have and need a pre-roll to settle.
+ */
+void seekContext(PortaStubContext& ctx, int64_t position) {
+    const porta_params_t params = ctx.params.load(std::memory_order_acquire);
+    ctx.morphSmoothed = -1.0f;
+    if (ctx.morphing.load(std::memory_order_acquire)) {
+        applyMorph(ctx, params, 0);
+    } else {
+        updateModuleParameters(ctx, params);
+    }
+    ctx.currentParams = params;
+    const DSPContext::Parameters dspParams = makeDspParameters(ctx, params);
+    for (int g = 0; g < ctx.groupCount; ++g) {
+        TrackGroup& group = ctx.groups[static_cast<size_t>(g)];
+        group.dsp.seek(position, dspParams);
+        group.hiss.seek(static_cast<uint64_t>(position));
+        for (auto& wf : group.wowFlutter) {
+            wf.seek(position);
+        }
+        for (auto& azimuth : group.azimuth) {
+            azimuth.seek(position);
+        }
+    }
+}
+
+struct ContextConfig {
+    double sampleRate = 48000.0;
+    int maxBlock = 512;
+    int maxTracks = 2;
+    int workerThreads = 0;
+
+    bool operator==(const ContextConfig& other) const {
+        return sampleRate == other.sampleRate && maxBlock == other.maxBlock && maxTracks == other.maxTracks
+            && workerThreads == other.workerThreads;
+    }
+};
+
+/** The layout a handle gets for a create, reconfigure or pool request, with out-of-range values clamped. */
+ContextConfig clampedLayout(double sampleRate, int maxBlock, int tracks) {
+    ContextConfig layout;
+    layout.sampleRate = sampleRate > 1.0 ? sampleRate : 1.0;
+    layout.maxBlock = std::max(maxBlock, 1);
+    layout.maxTracks = std::clamp(tracks, 1, PORTA_MAX_TRACKS);
+    return layout;
+}
+
+static_assert(alignof(PortaStubContext) <= Arena::kAlignment, "The context must fit the arena's alignment");
+
+const size_t kArenaHeaderBytes = Arena::roundUp(sizeof(Arena));
+
+/**
+ * Construct a context, and everything it owns, inside `arena`. Worker threads
+ * are not started here, so this can also run against an empty arena just to
+ * measure the footprint.
+ */
+PortaStubContext* buildContext(Arena& arena, const ContextConfig& config) {
+    ArenaScope scope(&arena);
+    auto* ctx = new (arena.allocate(sizeof(PortaStubContext))) PortaStubContext();
+    ctx->arena = &arena;
+    ctx->sampleRate = config.sampleRate;
+    ctx->maxBlock = config.maxBlock;
+    ctx->maxTracks = config.maxTracks;
+    ctx->workerThreads = config.workerThreads;
+
+    porta_params_t defaults = makeDefaultParams();
+    ctx->params.store(defaults, std::memory_order_relaxed);
+    ctx->currentParams = defaults;
+
+    ctx->groups.resize(static_cast<size_t>(config.workerThreads + 1));
     ctx->currentChannels = ctx->maxTracks;
-    ctx->channelScratch.resize(static_cast<size_t>(ctx->maxTracks) * static_cast<size_t>(ctx->maxBlock));
-    ctx->tempLeft.resize(static_cast<size_t>(ctx->maxBlock));
-    ctx->tempRight.resize(static_cast<size_t>(ctx->maxBlock));
+    prepareTrackGroups(*ctx, ctx->maxTracks);
     ctx->rmsAcc.assign(static_cast<size_t>(ctx->maxTracks), 0.0f);
     ctx->rmsCount.assign(static_cast<size_t>(ctx->maxTracks), 0);
+    ctx->pcmTile.assign(pcmTileSamples(*ctx), 0.0f);
+    publishToneStages(*ctx);
+    return ctx;
+}
 
-    updateModuleParameters(*ctx, defaults);
+void destroyContext(PortaStubContext* ctx) {
+    Arena* arena = ctx->arena;
+    releaseAnalyzer(*ctx);
+    ctx->~PortaStubContext();
+    arena->deallocate(ctx, sizeof(PortaStubContext));
+}
+
+/**
+ * Arena bytes a context with `config` needs. The first context of a
+ * configuration is built once over an empty arena to measure it; later ones
+ * reuse the result, so creating them costs a single allocation.
+ */
+size_t contextFootprint(const ContextConfig& config) {
+    static std::mutex mutex;
+    static std::vector<std::pair<ContextConfig, size_t>> cache;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : cache) {
+            if (entry.first == config) {
+                return entry.second;
+            }
+        }
+    }
+
+    size_t bytes = 0;
+    {
+        Arena probe;
+        destroyContext(buildContext(probe, config));
+        bytes = probe.peak();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.emplace_back(config, bytes);
+    return bytes;
+}
+
+/** Idle handles kept for porta_pool_acquire. */
+struct PortaPool {
+    std::mutex mutex;
+    std::vector<PortaStubContext*> idle;
+    int maxIdle = 0;
+};
+
+/** A fresh single-threaded context with the same configuration as `source`. */
+PortaStubContext* cloneConfiguration(const PortaStubContext& source, int channels) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(
+        porta_create_with_workers(source.sampleRate, source.maxBlock, channels, 0));
+    ctx->params.store(source.params.load(std::memory_order_acquire), std::memory_order_relaxed);
+    ctx->saturationOversampling.store(source.saturationOversampling.load(std::memory_order_acquire),
+                                      std::memory_order_relaxed);
+    ctx->nrBypassMask.store(source.nrBypassMask.load(std::memory_order_acquire), std::memory_order_relaxed);
+    ctx->lowLatency.store(source.lowLatency.load(std::memory_order_acquire), std::memory_order_relaxed);
+    // A governed tier is frozen at its current value: renders must not depend on timing.
+    ctx->quality.store(activeQuality(source), std::memory_order_relaxed);
+    // A morph carries over at its requested position, which the clone starts at.
+    std::lock_guard<std::mutex> lock(source.morphMutex);
+    if (source.morphing.load(std::memory_order_acquire)) {
+        porta_morph(ctx, &source.morphPresets[0], &source.morphPresets[1],
+                    source.morphPosition.load(std::memory_order_acquire));
+    }
+    return ctx;
+}
+
+/** Render [start, end) of `input` into `output` in blocks of the context's maxBlock. */
+void renderRange(PortaStubContext& ctx, const float* input, float* output, int64_t start, int64_t end, int channels) {
+    const size_t stride = static_cast<size_t>(channels);
+    for (int64_t frame = start; frame < end; frame += ctx.maxBlock) {
+        const int count = static_cast<int>(std::min<int64_t>(ctx.maxBlock, end - frame));
+        const size_t offset = static_cast<size_t>(frame) * stride;
+        std::memcpy(output + offset, input + offset, sizeof(float) * stride * static_cast<size_t>(count));
+        porta_process_interleaved(&ctx, output + offset, count, channels);
+    }
+}
+
+constexpr uint64_t kDitherKey = 0x5D1A0C3F9B2E7461ULL;
+
+/**
+ * Run an integer PCM buffer through the chain in place, one tile of at most
+ * a block at a time: each tile is converted to float, processed while it is
+ * still in cache and quantised straight back, so there is no full-length
+ * float copy and no separate conversion pass over the buffer.
+ */
+template <typename Format>
+void processPcm(porta_dsp_handle h, void* samples, int frames, int channels, int dither) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx || !samples || frames <= 0 || channels <= 0 || channels > PORTA_MAX_TRACKS) {
+        return;
+    }
+    auto* bytes = static_cast<uint8_t*>(samples);
+    float* tile = ctx->pcmTile.data();
+    const int tileFrames = std::min(ctx->maxBlock, static_cast<int>(ctx->pcmTile.size()) / channels);
+    for (int start = 0; start < frames; start += tileFrames) {
+        const int count = std::min(tileFrames, frames - start);
+        const size_t tileSamples = static_cast<size_t>(count) * static_cast<size_t>(channels);
+        uint8_t* chunk = bytes + static_cast<size_t>(start) * static_cast<size_t>(channels) * Format::kBytes;
+        pcmToFloat<Format>(chunk, tile, tileSamples);
+        porta_process_interleaved(h, tile, count, channels);
+        floatToPcm<Format>(tile, chunk, tileSamples, dither != 0, kDitherKey, ctx->ditherCounter);
+    }
+}
+
+/** The whole chain over one interleaved block, then the meters and the analyzer tap. */
+void processBlock(PortaStubContext& ctx, float* interleaved, int frames, int channels) {
+    ensureChannelCapacity(ctx, channels);
+
+    if (ctx.pendingReset.exchange(false, std::memory_order_acq_rel)) {
+        restartContext(ctx, channels);
+    }
+    const int64_t position = ctx.pendingPosition.exchange(-1, std::memory_order_acq_rel);
+    if (position >= 0) {
+        seekContext(ctx, position);
+    }
+
+    porta_params_t params = ctx.params.load(std::memory_order_acquire);
+    if (ctx.morphing.load(std::memory_order_acquire)) {
+        applyMorph(ctx, params, frames);
+    } else {
+        updateModuleParameters(ctx, params);
+        ctx.morphSmoothed = -1.0f;
+    }
+    ctx.currentParams = params;
+
+    const int oversampling = ctx.saturationOversampling.load(std::memory_order_acquire);
+    const bool lowLatency = ctx.lowLatency.load(std::memory_order_acquire);
+    const bool governed = ctx.governorEnabled.load(std::memory_order_acquire);
+    if (governed && !ctx.governing) {
+        ctx.governor.reset(ctx.quality.load(std::memory_order_acquire));
+    }
+    ctx.governing = governed;
+    const int quality = activeQuality(ctx);
+    for (int g = 0; g < ctx.groupCount; ++g) {
+        TrackGroup& group = ctx.groups[static_cast<size_t>(g)];
+        ensureFrameCapacity(group, frames);
+        if (oversampling != group.saturation.oversamplingFactor()) {
+            group.saturation.setOversamplingFactor(oversampling);
+        }
+        if (quality != group.quality) {
+            applyQuality(group, quality);
+        }
+        for (auto& wf : group.wowFlutter) {
+            if (wf.lowLatency() != lowLatency) {
+                wf.setLowLatency(lowLatency);
+            }
+        }
+    }
+
+    ctx.blockDspParams = makeDspParameters(ctx, params);
+    ctx.blockInterleaved = interleaved;
+    ctx.blockFrames = frames;
+    ctx.blockChannels = channels;
+
+    auto renderGroup = [&ctx](int index) {
+        processTrackGroup(ctx.groups[static_cast<size_t>(index)], ctx.blockInterleaved, ctx.blockFrames,
+                          ctx.blockChannels, ctx.blockDspParams);
+    };
+    ctx.workers.run(ctx.groupCount, renderGroup);
+    publishToneStages(ctx);
+
+    if (ctx.rmsAcc.size() < static_cast<size_t>(channels)) {
+        ctx.rmsAcc.resize(static_cast<size_t>(channels), 0.0f);
+        ctx.rmsCount.resize(static_cast<size_t>(channels), 0);
+    }
+
+    if (channels != ctx.meterKernelWidth) {
+        ctx.meterKernelWidth = channels;
+        ctx.meterKernel = selectChannelKernel(channels, [](auto w) -> MeterKernel {
+            return &accumulateSquares<decltype(w)::value>;
+        });
+    }
+    ctx.meterKernel(ctx.rmsAcc.data(), interleaved, frames, channels);
+    for (int c = 0; c < channels; ++c) {
+        ctx.rmsCount[static_cast<size_t>(c)] += frames;
+    }
+
+    if (SpectrumAnalyzer* analyzer = ctx.analyzer.load(std::memory_order_acquire)) {
+        analyzer->capture(interleaved, frames, channels);
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+porta_dsp_handle porta_create(double sampleRate, int maxBlock, int tracks) {
+    return porta_create_with_workers(sampleRate, maxBlock, tracks, 0);
+}
+
+porta_dsp_handle porta_create_with_workers(double sampleRate, int maxBlock, int tracks, int workerThreads) {
+    ContextConfig config = clampedLayout(sampleRate, maxBlock, tracks);
+
+    // Never more workers than there are track pairs to hand out, nor more
+    // threads than cores: a spinning helper on a busy core only steals time.
+    int maxWorkers = PORTA_MAX_TRACKS / 2 - 1;
+    const unsigned cores = std::thread::hardware_concurrency();
+    if (cores > 0) {
+        maxWorkers = std::min(maxWorkers, static_cast<int>(cores) - 1);
+    }
+    config.workerThreads = std::clamp(workerThreads, 0, maxWorkers);
+
+    // The arena header and the context share one block.
+    const size_t bytes = contextFootprint(config);
+    void* block = Arena::allocateBlock(kArenaHeaderBytes + bytes);
+    auto* arena = new (block) Arena(static_cast<unsigned char*>(block) + kArenaHeaderBytes, bytes);
+    PortaStubContext* ctx = buildContext(*arena, config);
+    ctx->workers.start(config.workerThreads);
     return reinterpret_cast<porta_dsp_handle>(ctx);
 }
 
 void porta_destroy(porta_dsp_handle h) {
     auto* ctx = reinterpret_cast<PortaStubContext*>(h);
-    delete ctx;
+    if (!ctx) {
+        return;
+    }
+    Arena* arena = ctx->arena;
+    destroyContext(ctx);
+    arena->~Arena();
+    Arena::freeBlock(arena);
+}
+
+size_t porta_get_memory_footprint(porta_dsp_handle h) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx) {
+        return 0;
+    }
+    size_t bytes = kArenaHeaderBytes + ctx->arena->capacity() + ctx->arena->heapBytes();
+    if (const SpectrumAnalyzer* analyzer = ctx->analyzer.load(std::memory_order_acquire)) {
+        bytes += analyzer->bytes();
+    }
+    return bytes;
+}
+
+size_t porta_get_shared_table_bytes(void) {
+    return sharedTableBytes().load(std::memory_order_relaxed);
+}
+
+void porta_reset(porta_dsp_handle h) {
+    if (!h) {
+        return;
+    }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->pendingReset.store(true, std::memory_order_release);
+}
+
+int porta_reconfigure(porta_dsp_handle h, double sampleRate, int maxBlock, int tracks) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx) {
+        return -1;
+    }
+    const ContextConfig layout = clampedLayout(sampleRate, maxBlock, tracks);
+    ctx->sampleRate = layout.sampleRate;
+    ctx->maxBlock = layout.maxBlock;
+    ctx->maxTracks = layout.maxTracks;
+    ctx->pendingPosition.store(-1, std::memory_order_relaxed);
+    ctx->pendingReset.store(false, std::memory_order_relaxed);
+    // Buffers that are already large enough are reused in place; larger ones
+    // come from whatever room the arena has left, then from the heap.
+    restartContext(*ctx, ctx->maxTracks);
+    {
+        // Compiled morph targets are designed for the old sample rate.
+        std::lock_guard<std::mutex> lock(ctx->morphMutex);
+        if (ctx->morphCompiled) {
+            ctx->morph.publish({compileMorphTargets(*ctx, ctx->morphPresets[0]),
+                                compileMorphTargets(*ctx, ctx->morphPresets[1])});
+        }
+    }
+    // An enabled analyzer keeps its size but follows the new track count.
+    SpectrumAnalyzer* analyzer = ctx->analyzer.load(std::memory_order_acquire);
+    if (analyzer && analyzer->channels() != ctx->maxTracks) {
+        const int fftSize = analyzer->fftSize();
+        releaseAnalyzer(*ctx);
+        ctx->analyzer.store(new SpectrumAnalyzer(fftSize, ctx->maxTracks), std::memory_order_release);
+    }
+    return 0;
+}
+
+porta_pool_handle porta_pool_create(int maxIdle) {
+    auto* pool = new PortaPool();
+    pool->maxIdle = std::max(maxIdle, 0);
+    pool->idle.reserve(static_cast<size_t>(pool->maxIdle));
+    return reinterpret_cast<porta_pool_handle>(pool);
+}
+
+porta_dsp_handle porta_pool_acquire(porta_pool_handle p, double sampleRate, int maxBlock, int tracks) {
+    auto* pool = reinterpret_cast<PortaPool*>(p);
+    if (!pool) {
+        return porta_create(sampleRate, maxBlock, tracks);
+    }
+
+    // Match on the layout the request would get, as idle handles store theirs clamped.
+    const ContextConfig layout = clampedLayout(sampleRate, maxBlock, tracks);
+    PortaStubContext* ctx = nullptr;
+    bool exactMatch = false;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        // Prefer an idle handle with the same layout: it only needs a reset.
+        auto match = std::find_if(pool->idle.begin(), pool->idle.end(), [&](const PortaStubContext* idle) {
+            return idle->sampleRate == layout.sampleRate && idle->maxBlock == layout.maxBlock
+                && idle->maxTracks == layout.maxTracks;
+        });
+        if (match == pool->idle.end() && !pool->idle.empty()) {
+            match = pool->idle.end() - 1;
+        } else {
+            exactMatch = match != pool->idle.end();
+        }
+        if (match != pool->idle.end()) {
+            ctx = *match;
+            pool->idle.erase(match);
+        }
+    }
+
+    if (!ctx) {
+        return porta_create(sampleRate, maxBlock, tracks);
+    }
+    restoreDefaultSettings(*ctx);
+    if (exactMatch) {
+        restartContext(*ctx, ctx->maxTracks);
+    } else {
+        porta_reconfigure(ctx, sampleRate, maxBlock, tracks);
+    }
+    return reinterpret_cast<porta_dsp_handle>(ctx);
+}
+
+void porta_pool_release(porta_pool_handle p, porta_dsp_handle h) {
+    auto* pool = reinterpret_cast<PortaPool*>(p);
+    if (!h) {
+        return;
+    }
+    if (pool) {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (static_cast<int>(pool->idle.size()) < pool->maxIdle) {
+            pool->idle.push_back(reinterpret_cast<PortaStubContext*>(h));
+            return;
+        }
+    }
+    porta_destroy(h);
+}
+
+void porta_pool_destroy(porta_pool_handle p) {
+    auto* pool = reinterpret_cast<PortaPool*>(p);
+    if (!pool) {
+        return;
+    }
+    for (PortaStubContext* ctx : pool->idle) {
+        porta_destroy(ctx);
+    }
+    delete pool;
 }
 
 void porta_update_params(porta_dsp_handle h, const porta_params_t* p) {
@@ -273,83 +1383,247 @@ void porta_update_params(porta_dsp_handle h, const porta_params_t* p) {
     }
     auto* ctx = reinterpret_cast<PortaStubContext*>(h);
     ctx->params.store(*p, std::memory_order_release);
+    ctx->morphing.store(false, std::memory_order_release);
+}
+
+int porta_morph(porta_dsp_handle h, const porta_params_t* presetA, const porta_params_t* presetB, float position) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx || !presetA || !presetB) {
+        return -1;
+    }
+    const float t = std::isfinite(position) ? std::clamp(position, 0.0f, 1.0f) : 0.0f;
+    std::lock_guard<std::mutex> lock(ctx->morphMutex);
+    if (!ctx->morphCompiled || std::memcmp(presetA, &ctx->morphPresets[0], sizeof(porta_params_t)) != 0 ||
+        std::memcmp(presetB, &ctx->morphPresets[1], sizeof(porta_params_t)) != 0) {
+        ctx->morph.publish({compileMorphTargets(*ctx, *presetA), compileMorphTargets(*ctx, *presetB)});
+        ctx->morphPresets[0] = *presetA;
+        ctx->morphPresets[1] = *presetB;
+        ctx->morphCompiled = true;
+    }
+    // The rest of the API (latency, settings hash, clones) sees the blend.
+    ctx->params.store(blendParams(*presetA, *presetB, t), std::memory_order_release);
+    ctx->morphPosition.store(t, std::memory_order_release);
+    ctx->morphing.store(true, std::memory_order_release);
+    return 0;
 }
 
 void porta_process_interleaved(porta_dsp_handle h, float* interleaved, int frames, int channels) {
     auto* ctx = reinterpret_cast<PortaStubContext*>(h);
-    if (!ctx || !interleaved || frames <= 0 || channels <= 0) {
+    if (!ctx || !interleaved || frames <= 0 || channels <= 0 || channels > PORTA_MAX_TRACKS) {
+        return;
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    processBlock(*ctx, interleaved, frames, channels);
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+    const double budget = static_cast<double>(frames) * 1.0e9 / ctx->sampleRate;
+    ctx->timing.record(static_cast<uint64_t>(nanos.count()), static_cast<uint64_t>(budget));
+    if (ctx->governing) {
+        const float load = static_cast<float>(static_cast<double>(nanos.count()) / budget);
+        ctx->governor.update(load, budget * 1.0e-9, ctx->quality.load(std::memory_order_relaxed));
+    }
+}
+
+int porta_get_timing_stats(porta_dsp_handle h, porta_timing_stats_t* out) {
+    const auto* ctx = reinterpret_cast<const PortaStubContext*>(h);
+    if (!ctx || !out) {
+        return -1;
+    }
+    const CallbackTiming::Snapshot timing = ctx->timing.read();
+    out->calls = timing.calls;
+    out->overruns = timing.overruns;
+    out->busyNanos = timing.busyNanos;
+    out->budgetNanos = timing.budgetNanos;
+    out->maxLoad = timing.maxLoad;
+    out->lastLoad = timing.lastLoad;
+    std::copy(std::begin(timing.histogram), std::end(timing.histogram), out->histogram);
+    return 0;
+}
+
+float porta_timing_bucket_floor(int bucket) {
+    return CallbackTiming::bucketFloor(std::clamp(bucket, 0, PORTA_TIMING_BUCKETS - 1));
+}
+
+void porta_set_quality(porta_dsp_handle h, int tier) {
+    if (!h) {
+        return;
+    }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->quality.store(std::clamp(tier, PORTA_QUALITY_ECO, PORTA_QUALITY_HIGH), std::memory_order_release);
+}
+
+void porta_set_quality_governor(porta_dsp_handle h, int enabled) {
+    if (!h) {
         return;
     }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->governorEnabled.store(enabled != 0, std::memory_order_release);
+}
 
-    ensureChannelCapacity(*ctx, channels, frames);
-    ensureFrameCapacity(*ctx, frames, channels);
+int porta_get_quality_state(porta_dsp_handle h, porta_quality_state_t* out) {
+    const auto* ctx = reinterpret_cast<const PortaStubContext*>(h);
+    if (!ctx || !out) {
+        return -1;
+    }
+    const QualityGovernor::State governor = ctx->governor.read();
+    const bool governed = ctx->governorEnabled.load(std::memory_order_acquire);
+    out->tier = activeQuality(*ctx);
+    out->smoothedLoad = governed ? governor.smoothedLoad : 0.0f;
+    out->stepsDown = governor.stepsDown;
+    out->stepsUp = governor.stepsUp;
+    return 0;
+}
 
-    porta_params_t params = ctx->params.load(std::memory_order_acquire);
-    updateModuleParameters(*ctx, params);
-    ctx->currentParams = params;
+void porta_process_int16(porta_dsp_handle h, int16_t* interleaved, int frames, int channels, int dither) {
+    processPcm<Pcm16>(h, interleaved, frames, channels, dither);
+}
 
-    DSPContext::Parameters dspParams;
-    dspParams.dropoutRatePerMin = params.dropoutRatePerMin;
-    dspParams.nrTrack4Bypass = params.nrTrack4Bypass != 0;
-    ctx->dsp.process(interleaved, frames, channels, dspParams);
+void porta_process_int24(porta_dsp_handle h, uint8_t* interleaved, int frames, int channels, int dither) {
+    processPcm<Pcm24>(h, interleaved, frames, channels, dither);
+}
 
-    if (!ctx->wowFlutter.empty()) {
-        for (int c = 0; c < channels; ++c) {
-            float* scratch = ctx->channelScratch.data() + static_cast<size_t>(c) * static_cast<size_t>(frames);
-            for (int i = 0; i < frames; ++i) {
-                scratch[i] = interleaved[i * channels + c];
-            }
-            ctx->wowFlutter[static_cast<size_t>(c)].process(scratch, static_cast<std::size_t>(frames));
-            for (int i = 0; i < frames; ++i) {
-                interleaved[i * channels + c] = scratch[i];
-            }
-        }
+void porta_process_int32(porta_dsp_handle h, int32_t* interleaved, int frames, int channels, int dither) {
+    processPcm<Pcm32>(h, interleaved, frames, channels, dither);
+}
+
+void porta_set_saturation_oversampling(porta_dsp_handle h, int factor) {
+    if (!h) {
+        return;
     }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->saturationOversampling.store(Oversampler::snapFactor(factor), std::memory_order_release);
+}
 
-    for (int frame = 0; frame < frames; ++frame) {
-        for (int c = 0; c < channels; ++c) {
-            const int idx = frame * channels + c;
-            interleaved[idx] = ctx->headBump.processSample(interleaved[idx], c);
-        }
+int porta_get_saturation_latency_samples(porta_dsp_handle h) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx) {
+        return 0;
     }
+    return Oversampler::latencyForFactor(ctx->saturationOversampling.load(std::memory_order_acquire));
+}
 
-    ctx->saturation.startBlock(frames);
-    for (int frame = 0; frame < frames; ++frame) {
-        for (int c = 0; c < channels; ++c) {
-            const int idx = frame * channels + c;
-            interleaved[idx] = ctx->saturation.processSample(interleaved[idx]);
+void porta_set_low_latency(porta_dsp_handle h, int enabled) {
+    if (!h) {
+        return;
+    }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->lowLatency.store(enabled != 0, std::memory_order_release);
+}
+
+int porta_get_latency_samples(porta_dsp_handle h) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx) {
+        return 0;
+    }
+    // Derived from the latest requested settings rather than the live modules,
+    // so this never reads state the audio thread is writing.
+    const porta_params_t p = ctx->params.load(std::memory_order_acquire);
+    const bool lowLatency = ctx->lowLatency.load(std::memory_order_acquire);
+    int latency = Oversampler::latencyForFactor(ctx->saturationOversampling.load(std::memory_order_acquire));
+    latency += WowFlutter::latencyForDepths(static_cast<float>(ctx->sampleRate), p.wowDepth, p.flutterDepth, lowLatency);
+    if (ctx->maxTracks >= 2) {
+        float jitterSamples = azimuthJitterSamples(ctx->sampleRate, p);
+        if (ctx->morphing.load(std::memory_order_acquire)) {
+            // The audio thread blends the presets' depths in samples, which
+            // can round differently from converting the blended milliseconds.
+            std::lock_guard<std::mutex> lock(ctx->morphMutex);
+            if (ctx->morphing.load(std::memory_order_relaxed)) {
+                jitterSamples = morphMix(azimuthJitterSamples(ctx->sampleRate, ctx->morphPresets[0]),
+                                         azimuthJitterSamples(ctx->sampleRate, ctx->morphPresets[1]),
+                                         ctx->morphPosition.load(std::memory_order_acquire));
+            }
         }
+        latency += Azimuth::latencyForOffsets(0.0f, jitterSamples);
     }
+    return latency;
+}
 
-    ctx->hfLoss.process(interleaved, frames, channels);
-    ctx->hiss.process(interleaved, frames, channels);
+void porta_set_position(porta_dsp_handle h, int64_t sampleIndex) {
+    if (!h || sampleIndex < 0) {
+        return;
+    }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->pendingPosition.store(sampleIndex, std::memory_order_release);
+}
 
-    if (channels >= 2) {
-        for (int i = 0; i < frames; ++i) {
-            ctx->tempLeft[static_cast<size_t>(i)] = interleaved[i * channels + 0];
-            ctx->tempRight[static_cast<size_t>(i)] = interleaved[i * channels + 1];
-        }
-        ctx->crosstalk.process(ctx->tempLeft.data(), ctx->tempRight.data(), frames);
-        ctx->azimuth.process(ctx->tempLeft.data(), ctx->tempRight.data(), frames);
-        for (int i = 0; i < frames; ++i) {
-            interleaved[i * channels + 0] = ctx->tempLeft[static_cast<size_t>(i)];
-            interleaved[i * channels + 1] = ctx->tempRight[static_cast<size_t>(i)];
-        }
+void porta_set_nr_bypass_mask(porta_dsp_handle h, uint64_t mask) {
+    if (!h) {
+        return;
     }
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    ctx->nrBypassMask.store(mask, std::memory_order_release);
+}
 
-    if (ctx->rmsAcc.size() < static_cast<size_t>(channels)) {
-        ctx->rmsAcc.resize(static_cast<size_t>(channels), 0.0f);
-        ctx->rmsCount.resize(static_cast<size_t>(channels), 0);
+uint64_t porta_get_settings_hash(porta_dsp_handle h) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx) {
+        return 0;
     }
+    // The noise and modulation seeds are fixed at prepare, so they belong
+    // to the build rather than the settings.
+    ContentHash hash;
+    hash.add(ctx->sampleRate);
+    hash.add(ctx->params.load(std::memory_order_acquire));
+    hash.add(ctx->nrBypassMask.load(std::memory_order_acquire));
+    hash.add(ctx->saturationOversampling.load(std::memory_order_acquire));
+    hash.add(ctx->lowLatency.load(std::memory_order_acquire));
+    hash.add(activeQuality(*ctx));
+    // A morph renders blended coefficients, which differ slightly from a design at the blended settings.
+    std::lock_guard<std::mutex> lock(ctx->morphMutex);
+    if (ctx->morphing.load(std::memory_order_acquire)) {
+        hash.add(ctx->morphPresets[0]);
+        hash.add(ctx->morphPresets[1]);
+    }
+    return hash.value;
+}
 
-    for (int frame = 0; frame < frames; ++frame) {
-        for (int c = 0; c < channels; ++c) {
-            const int idx = frame * channels + c;
-            const float sample = interleaved[idx];
-            ctx->rmsAcc[static_cast<size_t>(c)] += sample * sample;
-            ctx->rmsCount[static_cast<size_t>(c)] += 1;
+int porta_render_offline(porta_dsp_handle h, const float* input, float* output, int64_t frames, int channels,
+                         int chunkFrames, int prerollFrames, int threads) {
+    return porta_render_offline_at(h, 0, input, output, frames, channels, chunkFrames, prerollFrames, threads);
+}
+
+int porta_render_offline_at(porta_dsp_handle h, int64_t position, const float* input, float* output, int64_t frames,
+                            int channels, int chunkFrames, int prerollFrames, int threads) {
+    auto* source = reinterpret_cast<PortaStubContext*>(h);
+    if (!source || position < 0 || !input || !output || frames <= 0 || channels <= 0 ||
+        channels > PORTA_MAX_TRACKS) {
+        return -1;
+    }
+    const int64_t chunk = chunkFrames > 0 ? chunkFrames : frames;
+    const int64_t preroll = std::max(prerollFrames, 0);
+    const int64_t chunkCount = (frames + chunk - 1) / chunk;
+    const int threadCount = static_cast<int>(std::clamp<int64_t>(threads, 1, chunkCount));
+
+    std::atomic<int64_t> nextChunk{0};
+    auto worker = [&] {
+        // Pre-roll output is thrown away, so it goes to a private scratch buffer.
+        std::vector<float> scratch;
+        for (int64_t index = nextChunk.fetch_add(1); index < chunkCount; index = nextChunk.fetch_add(1)) {
+            const int64_t start = index * chunk;
+            const int64_t end = std::min(frames, start + chunk);
+            const int64_t warmStart = std::max<int64_t>(0, start - preroll);
+
+            PortaStubContext* ctx = cloneConfiguration(*source, channels);
+            seekContext(*ctx, position + warmStart);
+            if (warmStart < start) {
+                const size_t offset = static_cast<size_t>(warmStart) * static_cast<size_t>(channels);
+                scratch.resize(static_cast<size_t>(start - warmStart) * static_cast<size_t>(channels));
+                renderRange(*ctx, input + offset, scratch.data(), 0, start - warmStart, channels);
+            }
+            renderRange(*ctx, input, output, start, end, channels);
+            porta_destroy(ctx);
         }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(static_cast<size_t>(threadCount - 1));
+    for (int t = 1; t < threadCount; ++t) {
+        pool.emplace_back(worker);
     }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return 0;
 }
 
 int porta_get_meters_dbfs(porta_dsp_handle h, float* outDbfs, int maxChannels) {
@@ -372,14 +1646,86 @@ int porta_get_meters_dbfs(porta_dsp_handle h, float* outDbfs, int maxChannels) {
     return available;
 }
 
+int porta_get_frequency_response(porta_dsp_handle h, const float* freqsHz, float* outMagDb, float* outPhase, int n) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx || !freqsHz || !outMagDb || n <= 0) {
+        return -1;
+    }
+    const ToneStageSnapshot::Values stages = ctx->toneStages.read();
+    FrequencyResponse response;
+    response.prepare(freqsHz, n, stages.sampleRate);
+    response.applyBiquad(stages.headBump);
+    HFLoss::applyResponse(response, stages.hfLoss);
+    response.read(outMagDb, outPhase);
+    return 0;
+}
+
+int porta_analyzer_enable(porta_dsp_handle h, int fftSize) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx || fftSize < PORTA_ANALYZER_MIN_FFT || fftSize > PORTA_ANALYZER_MAX_FFT ||
+        !RealFft::validSize(fftSize)) {
+        return -1;
+    }
+    static std::mutex enableMutex;
+    std::lock_guard<std::mutex> lock(enableMutex);
+    if (const SpectrumAnalyzer* existing = ctx->analyzer.load(std::memory_order_acquire)) {
+        return existing->fftSize() == fftSize ? 0 : -1;
+    }
+    ctx->analyzer.store(new SpectrumAnalyzer(fftSize, ctx->maxTracks), std::memory_order_release);
+    return 0;
+}
+
+int porta_analyzer_read(porta_dsp_handle h, int channel, float* outBandsDb, int bands) {
+    auto* ctx = reinterpret_cast<PortaStubContext*>(h);
+    if (!ctx) {
+        return 0;
+    }
+    SpectrumAnalyzer* analyzer = ctx->analyzer.load(std::memory_order_acquire);
+    if (!analyzer) {
+        return 0;
+    }
+    return analyzer->read(channel, static_cast<float>(ctx->sampleRate), outBandsDb, bands);
+}
+
 float porta_test_saturation(float sample, float driveDb) {
     SaturationStage stage;
-    stage.prepare(48000.0f, 1);
+    stage.prepare(48000.0f, 1, 1);
     stage.setDriveDb(driveDb);
     stage.startBlock(1);
     return stage.processSample(sample);
 }
 
+void porta_test_saturation_block(const float* input, float* output, int frames, float sampleRate, float driveDb, int oversampling) {
+    if (!input || !output || frames <= 0) {
+        return;
+    }
+    SaturationStage stage;
+    stage.prepare(sampleRate, 1, frames);
+    stage.setOversamplingFactor(oversampling);
+    stage.setDriveDb(driveDb);
+    std::memcpy(output, input, static_cast<size_t>(frames) * sizeof(float));
+    stage.process(output, frames, 1);
+}
+
+float porta_test_compander_gain(float envelope, int useTable) {
+    constexpr CompanderCurve curve{};
+    if (!useTable) {
+        return curve.gain(envelope);
+    }
+    return SharedTableCache<CompanderGainTable>::acquire(curve)->gain(envelope);
+}
+
+void porta_test_head_bump_design(float sampleRate, float freqHz, float gainDb, int useTable, float* outCoefficients) {
+    if (!outCoefficients) {
+        return;
+    }
+    HeadBump headBump;
+    headBump.prepare(sampleRate, 1);
+    const BiquadCoefficients c = useTable ? headBump.design(freqHz, gainDb) : headBump.designExact(freqHz, gainDb);
+    const float values[5] = {c.b0, c.b1, c.b2, c.a1, c.a2};
+    std::memcpy(outCoefficients, values, sizeof(values));
+}
+
 void porta_test_head_bump(const float* input, float* output, int frames, float sampleRate, float gainDb, float freqHz) {
     if (!input || !output || frames <= 0) {
         return;
@@ -422,4 +1768,20 @@ void porta_test_apply_dropouts(float* interleaved, int frames, int channels, flo
     dropouts.process(interleaved, frames, channels);
 }
 
+int porta_test_count_dropouts(int frames, int blockSize, float sampleRate, float dropoutRatePerMin, uint32_t seed) {
+    if (frames <= 0 || blockSize <= 0) {
+        return 0;
+    }
+
+    Dropouts dropouts;
+    dropouts.prepare(sampleRate, 1);
+    dropouts.setRate(dropoutRatePerMin);
+    dropouts.setSeed(seed);
+    std::vector<float> block(static_cast<size_t>(blockSize), 1.0f);
+    for (int offset = 0; offset < frames; offset += blockSize) {
+        dropouts.process(block.data(), std::min(blockSize, frames - offset), 1);
+    }
+    return dropouts.dropoutCount();
+}
+
 } // extern "C"
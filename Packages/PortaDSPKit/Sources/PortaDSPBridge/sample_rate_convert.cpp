@@ -0,0 +1,103 @@
+#include "PortaDSPBridge.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../../../../DSPCore/include/modules/float_wav_writer.h"
+#include "../../../../DSPCore/include/modules/mapped_audio_file.h"
+#include "../../../../DSPCore/include/modules/sample_rate_converter.h"
+
+namespace {
+
+constexpr int kFileBlock = 16384;
+
+} // namespace
+
+extern "C" {
+
+porta_src_handle porta_src_create(double inRate, double outRate, int channels, int maxInputFrames, int quality) {
+    if (inRate <= 0.0 || outRate <= 0.0 || channels < 1 || maxInputFrames < 1 || quality < PORTA_VARISPEED_ECO ||
+        quality > PORTA_VARISPEED_HIGH) {
+        return nullptr;
+    }
+    auto* converter = new SampleRateConverter;
+    converter->prepare(inRate, outRate, channels, maxInputFrames, static_cast<SincQuality>(quality));
+    return converter;
+}
+
+void porta_src_destroy(porta_src_handle s) {
+    delete static_cast<SampleRateConverter*>(s);
+}
+
+void porta_src_reset(porta_src_handle s) {
+    if (auto* converter = static_cast<SampleRateConverter*>(s)) {
+        converter->reset();
+    }
+}
+
+int porta_src_max_output(porta_src_handle s, int inputFrames) {
+    const auto* converter = static_cast<const SampleRateConverter*>(s);
+    return converter ? converter->maxOutputFrames(inputFrames < 0 ? 0 : inputFrames) : 0;
+}
+
+int porta_src_process(porta_src_handle s, const float* input, int inputFrames, float* output, int outputCapacity) {
+    auto* converter = static_cast<SampleRateConverter*>(s);
+    if (!converter || !input || !output || inputFrames <= 0 || outputCapacity <= 0) {
+        return 0;
+    }
+    return converter->process(input, inputFrames, output, outputCapacity);
+}
+
+int porta_src_flush(porta_src_handle s, float* output, int outputCapacity) {
+    auto* converter = static_cast<SampleRateConverter*>(s);
+    if (!converter || !output || outputCapacity <= 0) {
+        return 0;
+    }
+    return converter->flush(output, outputCapacity);
+}
+
+int porta_src_convert_file(const char* inPath, const char* outPath, double outRate, int quality) {
+    if (!inPath || !outPath || outRate < 1.0 || outRate > 4294967295.0 || quality < PORTA_VARISPEED_ECO ||
+        quality > PORTA_VARISPEED_HIGH) {
+        return -1;
+    }
+    MappedAudioFile source;
+    if (!source.open(inPath)) {
+        return -1;
+    }
+    const int channels = source.channels();
+    auto converter = std::make_unique<SampleRateConverter>();
+    converter->prepare(source.sampleRate(), outRate, channels, kFileBlock, static_cast<SincQuality>(quality));
+    const auto outFrames =
+        static_cast<uint64_t>(std::ceil(static_cast<double>(source.frames()) * outRate / source.sampleRate() - 1.0e-9));
+    // Written beside the destination and renamed into place when complete.
+    FloatWavWriter writer;
+    if (!writer.open(outPath, channels, static_cast<uint32_t>(std::lround(outRate)), outFrames)) {
+        return -1;
+    }
+
+    std::vector<float> input(static_cast<size_t>(kFileBlock) * static_cast<size_t>(channels));
+    const int capacity = converter->maxOutputFrames(kFileBlock);
+    std::vector<float> output(static_cast<size_t>(capacity) * static_cast<size_t>(channels));
+    bool ok = true;
+    for (int64_t start = 0; ok && start < source.frames(); start += kFileBlock) {
+        const auto frames = static_cast<int>(std::min<int64_t>(kFileBlock, source.frames() - start));
+        for (int c = 0; c < channels; ++c) {
+            source.read(start, frames, c, 1.0f, input.data() + c, channels);
+        }
+        const int written = converter->process(input.data(), frames, output.data(), capacity);
+        ok = writer.write(output.data(), static_cast<size_t>(written) * static_cast<size_t>(channels));
+    }
+    for (int written = 1; ok && written > 0;) {
+        written = converter->flush(output.data(), capacity);
+        ok = writer.write(output.data(), static_cast<size_t>(written) * static_cast<size_t>(channels));
+    }
+    if (!ok || !writer.commit()) {
+        return -1;
+    }
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,28 @@
+#pragma once
+
+// Generated by scripts/generate_saturation_trim_table.py; do not edit.
+//
+// Make-up gain that restores the RMS of a full-scale sine after tanh() at a
+// drive of kSaturationTrimMinDb + i * (range / (size - 1)) dB.
+
+constexpr int kSaturationTrimTableSize = 64;
+constexpr float kSaturationTrimMinDb = -60.0f;
+constexpr float kSaturationTrimMaxDb = 40.0f;
+constexpr float kSaturationTrimTable[kSaturationTrimTableSize] = {
+    1000.00018f, 832.980591f, 693.857361f, 577.969666f,
+    481.437775f, 401.028625f, 334.049194f, 278.256836f,
+    231.782928f, 193.071106f, 160.824921f, 133.964645f,
+    111.59066f, 92.9536896f, 77.4296112f, 64.4985428f,
+    53.7274437f, 44.7556496f, 37.2826385f, 31.0581818f,
+    25.8738251f, 21.5559502f, 17.9599495f, 14.9654055f,
+    12.4720354f, 10.3963308f, 8.66878319f, 7.23152781f,
+    6.03643131f, 5.04345846f, 4.21932936f, 3.53641272f,
+    2.97177124f, 2.50639057f, 2.12450886f, 1.8130461f,
+    1.56110895f, 1.35953975f, 1.2005167f, 1.07719636f,
+    0.98342979f, 0.913588047f, 0.862517893f, 0.825620532f,
+    0.798995793f, 0.779558063f, 0.765052319f, 0.75394845f,
+    0.745256662f, 0.73834002f, 0.732773423f, 0.728257835f,
+    0.724574029f, 0.721555769f, 0.719074786f, 0.717030108f,
+    0.715341687f, 0.71394515f, 0.712788522f, 0.711829662f,
+    0.71103406f, 0.710373461f, 0.709824622f, 0.709368467f,
+};
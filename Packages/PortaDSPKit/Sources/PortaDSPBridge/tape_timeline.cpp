@@ -0,0 +1,400 @@
+#include "PortaDSPBridge.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../../../DSPCore/include/modules/content_hash.h"
+#include "../../../../DSPCore/include/modules/float_wav_writer.h"
+#include "../../../../DSPCore/include/modules/freeze_cache.h"
+#include "../../../../DSPCore/include/modules/peak_pyramid.h"
+#include "../../../../DSPCore/include/modules/tape_timeline.h"
+#include "../../../../DSPCore/include/modules/varispeed.h"
+#include "../../../../DSPCore/include/modules/waveform_overview.h"
+
+namespace {
+
+struct PortaTimeline {
+    PortaTimeline(double sampleRate, int tracks) : reader(sampleRate, tracks), freeze(tracks) {}
+
+    TapeTimelineReader reader;
+    // Where the last processed block ended, to notice seeks.
+    int64_t nextPosition = -1;
+
+    FreezeCache freeze;
+    std::mutex freezeMutex; // one porta_timeline_freeze at a time
+
+    Varispeed varispeed;
+    bool varispeedReady = false;
+    std::vector<float> varispeedInput; // tape read ahead of the interpolator, interleaved
+    int64_t varispeedFed = 0;          // next tape frame to feed it
+    double varispeedNext = -1.0;       // tape position the last varispeed block ended at
+};
+
+std::vector<TimelineRegion> toTimelineRegions(const porta_tape_region_t* regions, int count) {
+    std::vector<TimelineRegion> converted;
+    converted.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        TimelineRegion region;
+        region.track = regions[i].track;
+        region.path = regions[i].path ? regions[i].path : "";
+        region.start = regions[i].start;
+        region.duration = regions[i].duration;
+        region.fileOffset = regions[i].fileOffset;
+        region.gain = regions[i].gain;
+        converted.push_back(std::move(region));
+    }
+    return converted;
+}
+
+int clampTracks(int tracks) {
+    return tracks < 1 ? 1 : (tracks > PORTA_MAX_TRACKS ? PORTA_MAX_TRACKS : tracks);
+}
+
+// Bumped whenever the chain changes what it renders for the same settings.
+constexpr uint64_t kFreezeFormat = 1;
+// Tape rendered ahead of each segment and processed live before frozen
+// coverage ends, so filters, envelopes and delays have settled.
+constexpr double kFreezePrerollSeconds = 1.0;
+
+/** One segment of the tape to freeze, and the file it lives in. */
+struct FreezeSegment {
+    int64_t start = 0;
+    int64_t warmStart = 0;
+    std::string path;
+};
+
+/** A frozen segment file, if `path` holds one that fits. */
+std::shared_ptr<MappedAudioFile> openSegment(const std::string& path, double sampleRate, int tracks) {
+    auto file = std::make_shared<MappedAudioFile>();
+    if (!file->open(path) || file->channels() != tracks || file->frames() < PORTA_FREEZE_SEGMENT_FRAMES ||
+        std::fabs(file->sampleRate() - sampleRate) > 0.5) {
+        return nullptr;
+    }
+    file->prefetch(0, PORTA_FREEZE_SEGMENT_FRAMES);
+    return file;
+}
+
+/**
+ * Render one segment through h from its pre-roll and write it to its file.
+ * Returns false if the timeline or h's settings changed under it, or the
+ * file could not be written.
+ */
+bool renderSegment(PortaTimeline& timeline, porta_dsp_handle h, uint64_t version, uint64_t settings,
+                   const FreezeSegment& segment, std::vector<float>& input, std::vector<float>& output) {
+    const int tracks = timeline.reader.tracks();
+    const int64_t lead = segment.start - segment.warmStart;
+    const auto frames = static_cast<int>(lead + PORTA_FREEZE_SEGMENT_FRAMES);
+    input.resize(static_cast<size_t>(frames) * static_cast<size_t>(tracks));
+    output.resize(input.size());
+    if (!timeline.reader.renderLatest(version, segment.warmStart, input.data(), frames) ||
+        porta_render_offline_at(h, segment.warmStart, input.data(), output.data(), frames, tracks, frames, 0, 1) != 0 ||
+        porta_get_settings_hash(h) != settings) {
+        return false;
+    }
+    FloatWavWriter writer;
+    return writer.open(segment.path, tracks, static_cast<uint32_t>(std::lround(timeline.reader.sampleRate())),
+                       PORTA_FREEZE_SEGMENT_FRAMES) &&
+           writer.write(output.data() + static_cast<size_t>(lead) * static_cast<size_t>(tracks),
+                        static_cast<size_t>(PORTA_FREEZE_SEGMENT_FRAMES) * static_cast<size_t>(tracks)) &&
+           writer.commit();
+}
+
+} // namespace
+
+extern "C" {
+
+porta_timeline_handle porta_timeline_create(double sampleRate, int tracks) {
+    return new PortaTimeline(sampleRate, clampTracks(tracks));
+}
+
+void porta_timeline_destroy(porta_timeline_handle t) {
+    delete static_cast<PortaTimeline*>(t);
+}
+
+int porta_timeline_set_regions(porta_timeline_handle t, const porta_tape_region_t* regions, int count) {
+    auto* timeline = static_cast<PortaTimeline*>(t);
+    if (!timeline || count < 0 || (count > 0 && !regions)) {
+        return 0;
+    }
+    const auto converted = toTimelineRegions(regions, count);
+    return timeline->reader.setRegions(converted.data(), count);
+}
+
+void porta_timeline_render(porta_timeline_handle t, int64_t position, float* interleaved, int frames) {
+    auto* timeline = static_cast<PortaTimeline*>(t);
+    if (!timeline || !interleaved || frames <= 0) {
+        return;
+    }
+    timeline->reader.render(position, interleaved, frames);
+}
+
+void porta_timeline_process(porta_timeline_handle t, porta_dsp_handle h, int64_t position, float* interleaved,
+                            int frames) {
+    auto* timeline = static_cast<PortaTimeline*>(t);
+    if (!timeline || !interleaved || frames <= 0) {
+        return;
+    }
+    if (!h) {
+        timeline->reader.render(position, interleaved, frames);
+        return;
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    const FreezeCache::Coverage coverage =
+        timeline->freeze.coverage(position, frames, porta_get_settings_hash(h), timeline->reader.version());
+    if (coverage == FreezeCache::Coverage::Frozen) {
+        timeline->freeze.read(position, interleaved, frames);
+        timeline->nextPosition = -1; // h has not moved with the tape
+    } else {
+        timeline->reader.render(position, interleaved, frames);
+        if (position != timeline->nextPosition) {
+            porta_set_position(h, position);
+        }
+        timeline->nextPosition = position + frames;
+        porta_process_interleaved(h, interleaved, frames, timeline->reader.tracks());
+        if (coverage == FreezeCache::Coverage::WarmUp) {
+            // h only runs to settle before it takes over from the freeze.
+            timeline->freeze.read(position, interleaved, frames);
+        }
+    }
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+    timeline->freeze.recordBlock(coverage != FreezeCache::Coverage::Live, frames, static_cast<uint64_t>(nanos.count()));
+}
+
+int porta_timeline_freeze(porta_timeline_handle t, porta_dsp_handle h, const char* directory, int threads) {
+    auto* timeline = static_cast<PortaTimeline*>(t);
+    if (!timeline || !h || !directory) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(timeline->freezeMutex);
+    const TapeTimelineReader& reader = timeline->reader;
+    const uint64_t version = reader.latestVersion();
+    const uint64_t settings = porta_get_settings_hash(h);
+    const int64_t preroll = std::llround(kFreezePrerollSeconds * reader.sampleRate());
+    const int64_t count = (reader.latestEnd() + PORTA_FREEZE_SEGMENT_FRAMES - 1) / PORTA_FREEZE_SEGMENT_FRAMES;
+
+    // Each segment is named after everything its output depends on, so one
+    // already on disk is mapped rather than rendered again.
+    std::vector<FreezeSegment> segments(static_cast<size_t>(count));
+    std::vector<std::shared_ptr<MappedAudioFile>> files(segments.size());
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        FreezeSegment& segment = segments[i];
+        segment.start = static_cast<int64_t>(i) * PORTA_FREEZE_SEGMENT_FRAMES;
+        segment.warmStart = std::max<int64_t>(0, segment.start - preroll);
+        ContentHash key;
+        key.add(kFreezeFormat);
+        key.add(settings);
+        key.add(reader.tracks());
+        key.add(segment.start);
+        key.add(segment.warmStart);
+        key.add(static_cast<int64_t>(PORTA_FREEZE_SEGMENT_FRAMES));
+        key.add(reader.contentHash(segment.warmStart, segment.start + PORTA_FREEZE_SEGMENT_FRAMES));
+        segment.path = std::string(directory) + "/" + key.hex() + ".wav";
+        auto file = timeline->freeze.find(segment.path);
+        files[i] = file && file->matchesDisk() ? file : openSegment(segment.path, reader.sampleRate(), reader.tracks());
+        if (!files[i]) {
+            missing.push_back(i);
+        }
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> stale{false};
+    auto worker = [&] {
+        std::vector<float> input;
+        std::vector<float> output;
+        for (size_t m = next.fetch_add(1); m < missing.size() && !stale.load(); m = next.fetch_add(1)) {
+            const FreezeSegment& segment = segments[missing[m]];
+            if (!renderSegment(*timeline, h, version, settings, segment, input, output)) {
+                stale.store(reader.latestVersion() != version || porta_get_settings_hash(h) != settings);
+                continue;
+            }
+            files[missing[m]] = openSegment(segment.path, reader.sampleRate(), reader.tracks());
+        }
+    };
+    const int threadCount = static_cast<int>(std::clamp<size_t>(static_cast<size_t>(std::max(threads, 1)), 1,
+                                                                std::max<size_t>(missing.size(), 1)));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threadCount; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (stale.load()) {
+        return -1;
+    }
+
+    int frozen = 0;
+    int rendered = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        frozen += files[i] ? 1 : 0;
+    }
+    for (const size_t i : missing) {
+        rendered += files[i] ? 1 : 0;
+    }
+    timeline->freeze.publish(std::move(files), PORTA_FREEZE_SEGMENT_FRAMES, preroll, settings, version);
+    timeline->freeze.recordFreeze(rendered, frozen - rendered);
+    return frozen;
+}
+
+void porta_timeline_unfreeze(porta_timeline_handle t) {
+    if (auto* timeline = static_cast<PortaTimeline*>(t)) {
+        std::lock_guard<std::mutex> lock(timeline->freezeMutex);
+        timeline->freeze.clear();
+    }
+}
+
+void porta_timeline_get_freeze_stats(porta_timeline_handle t, porta_freeze_stats_t* out) {
+    const auto* timeline = static_cast<const PortaTimeline*>(t);
+    if (!timeline || !out) {
+        return;
+    }
+    const FreezeCache::Stats stats = timeline->freeze.stats();
+    out->frozenBlocks = stats.frozenBlocks;
+    out->liveBlocks = stats.liveBlocks;
+    out->frozenFrames = stats.frozenFrames;
+    out->liveFrames = stats.liveFrames;
+    out->frozenNanos = stats.frozenNanos;
+    out->liveNanos = stats.liveNanos;
+    out->segmentsRendered = stats.segmentsRendered;
+    out->segmentsReused = stats.segmentsReused;
+}
+
+porta_peaks_handle porta_peaks_create(double sampleRate) {
+    return new PeakPyramid(sampleRate);
+}
+
+void porta_peaks_destroy(porta_peaks_handle p) {
+    delete static_cast<PeakPyramid*>(p);
+}
+
+void porta_peaks_append(porta_peaks_handle p, const float* samples, int frames, int stride) {
+    auto* peaks = static_cast<PeakPyramid*>(p);
+    if (!peaks || !samples || frames <= 0 || stride < 1) {
+        return;
+    }
+    peaks->append(samples, frames, stride);
+}
+
+int64_t porta_peaks_frames(porta_peaks_handle p) {
+    const auto* peaks = static_cast<const PeakPyramid*>(p);
+    return peaks ? peaks->frames() : 0;
+}
+
+int porta_peaks_save(porta_peaks_handle p, const char* takePath) {
+    const auto* peaks = static_cast<const PeakPyramid*>(p);
+    if (!peaks || !takePath) {
+        return -1;
+    }
+    return peaks->save(PeakPyramid::sidecarPath(takePath)) ? 0 : -1;
+}
+
+int porta_peaks_query(porta_peaks_handle p, int64_t start, int64_t end, int bins, float* outMin, float* outMax,
+                      float* outRms) {
+    const auto* peaks = static_cast<const PeakPyramid*>(p);
+    if (!peaks || end <= start || bins <= 0 || !outMin || !outMax || !outRms) {
+        return -1;
+    }
+    const double width = static_cast<double>(end - start) / bins;
+    for (int b = 0; b < bins; ++b) {
+        const int64_t binStart = start + static_cast<int64_t>(width * b);
+        const int64_t binEnd = std::max(start + static_cast<int64_t>(width * (b + 1)), binStart + 1);
+        const PeakStats stats = peaks->stats(binStart, binEnd);
+        outMin[b] = stats.min;
+        outMax[b] = stats.max;
+        outRms[b] = stats.rms();
+    }
+    return 0;
+}
+
+porta_overview_handle porta_overview_create(double sampleRate, int tracks) {
+    return new WaveformOverview(sampleRate, clampTracks(tracks));
+}
+
+void porta_overview_destroy(porta_overview_handle o) {
+    delete static_cast<WaveformOverview*>(o);
+}
+
+int porta_overview_set_regions(porta_overview_handle o, const porta_tape_region_t* regions, int count) {
+    auto* overview = static_cast<WaveformOverview*>(o);
+    if (!overview || count < 0 || (count > 0 && !regions)) {
+        return 0;
+    }
+    const auto converted = toTimelineRegions(regions, count);
+    return overview->setRegions(converted.data(), count);
+}
+
+int porta_overview_query(porta_overview_handle o, int track, int64_t start, int64_t end, int bins, float* outMin,
+                         float* outMax, float* outRms) {
+    const auto* overview = static_cast<const WaveformOverview*>(o);
+    if (!overview || !outMin || !outMax || !outRms) {
+        return -1;
+    }
+    return overview->query(track, start, end, bins, outMin, outMax, outRms) ? 0 : -1;
+}
+
+int porta_timeline_prepare_varispeed(porta_timeline_handle t, int maxFrames, int quality) {
+    auto* timeline = static_cast<PortaTimeline*>(t);
+    if (!timeline || maxFrames <= 0 || quality < PORTA_VARISPEED_ECO || quality > PORTA_VARISPEED_HIGH) {
+        return -1;
+    }
+    const int tracks = timeline->reader.tracks();
+    timeline->varispeed.prepare(tracks, maxFrames, static_cast<VarispeedQuality>(quality));
+    const int frames = std::max(timeline->varispeed.historyFrames(), timeline->varispeed.maxInputFrames());
+    timeline->varispeedInput.assign(static_cast<size_t>(frames) * static_cast<size_t>(tracks), 0.0f);
+    timeline->varispeedNext = -1.0;
+    timeline->varispeedReady = true;
+    return 0;
+}
+
+double porta_timeline_process_varispeed(porta_timeline_handle t, porta_dsp_handle h, double position, double rate,
+                                        float* interleaved, int frames) {
+    auto* timeline = static_cast<PortaTimeline*>(t);
+    if (!timeline || !interleaved || frames <= 0) {
+        return position;
+    }
+    const int tracks = timeline->reader.tracks();
+    if (!timeline->varispeedReady) {
+        std::fill(interleaved, interleaved + static_cast<size_t>(frames) * static_cast<size_t>(tracks), 0.0f);
+        return position;
+    }
+    Varispeed& varispeed = timeline->varispeed;
+    float* input = timeline->varispeedInput.data();
+    if (std::fabs(position - timeline->varispeedNext) > 1.0e-3) {
+        // Seek: fill the history with the tape leading up to the new read
+        // head, which sits latency() frames behind the newest frame fed.
+        const double whole = std::floor(position);
+        const int64_t newest = static_cast<int64_t>(whole) + varispeed.latency();
+        timeline->reader.render(newest + 1 - varispeed.historyFrames(), input, varispeed.historyFrames());
+        varispeed.prime(input, position - whole, rate);
+        timeline->varispeedFed = newest + 1;
+        if (h) {
+            porta_set_position(h, static_cast<int64_t>(whole));
+        }
+    }
+    for (int done = 0; done < frames;) {
+        const int chunk = std::min(frames - done, varispeed.maxOutputFrames());
+        const int needed = varispeed.inputFramesFor(chunk, rate);
+        timeline->reader.render(timeline->varispeedFed, input, needed);
+        timeline->varispeedFed += needed;
+        float* out = interleaved + static_cast<size_t>(done) * static_cast<size_t>(tracks);
+        varispeed.process(input, needed, out, chunk, rate);
+        if (h) {
+            porta_process_interleaved(h, out, chunk, tracks);
+        }
+        done += chunk;
+    }
+    timeline->varispeedNext =
+        static_cast<double>(timeline->varispeedFed - 1 - varispeed.latency()) + varispeed.phase();
+    return timeline->varispeedNext;
+}
+
+} // extern "C"
@@ -215,6 +215,10 @@ public final class PortaDSPAudioUnit: AUAudioUnit {
     private var scratchCapacity: Int = 0
     private var dspHandle: PortaDSPBridge.porta_dsp_handle?
     private var lastParams = PortaDSP.Params()
+    private var quality = PortaDSP.Quality.high
+    private var qualityGoverned = false
+    /// The morph set with `morph(from:to:position:)`, replayed on a new DSP handle; nil once parameters are pushed.
+    private var presetMorph: (from: PortaDSP.Params, to: PortaDSP.Params, position: Float)?
     private lazy var internalFactoryPresets: [AUAudioUnitPreset] = {
         PortaPreset.factoryPresets.enumerated().map { index, preset in
             let descriptor = AUAudioUnitPreset()
@@ -355,6 +359,61 @@ public final class PortaDSPAudioUnit: AUAudioUnit {
         return meters
     }
 
+    /// Render-callback time against the real-time budget; see `PortaDSP.timingStats`.
+    public func readTimingStats() -> PortaDSP.TimingStats {
+        guard let handle = dspHandle else { return PortaDSP.TimingStats() }
+        var raw = porta_timing_stats_t()
+        porta_get_timing_stats(handle, &raw)
+        return PortaDSP.TimingStats(raw)
+    }
+
+    /// Processing cost tier, kept across render-resource allocations; see `PortaDSP.setQuality(_:)`.
+    public func setQuality(_ quality: PortaDSP.Quality) {
+        self.quality = quality
+        guard let handle = dspHandle else { return }
+        porta_set_quality(handle, quality.rawValue)
+    }
+
+    /// Lets the tier follow the render load, up to the one set with `setQuality(_:)`; see `PortaDSP.setQualityGovernor(_:)`.
+    public func setQualityGovernor(_ enabled: Bool) {
+        qualityGoverned = enabled
+        guard let handle = dspHandle else { return }
+        porta_set_quality_governor(handle, enabled ? 1 : 0)
+    }
+
+    public func readQualityState() -> PortaDSP.QualityState {
+        guard let handle = dspHandle else { return PortaDSP.QualityState() }
+        var raw = porta_quality_state_t()
+        porta_get_quality_state(handle, &raw)
+        return PortaDSP.QualityState(raw)
+    }
+
+    /// Tone curve of the head bump and HF loss stages as currently rendered; see `PortaDSP.frequencyResponse(at:)`.
+    public func frequencyResponse(at frequencies: [Float]) -> PortaDSP.FrequencyResponse? {
+        guard let handle = dspHandle, !frequencies.isEmpty else { return nil }
+        var magnitude = [Float](repeating: 0, count: frequencies.count)
+        var phase = [Float](repeating: 0, count: frequencies.count)
+        guard porta_get_frequency_response(handle, frequencies, &magnitude, &phase, Int32(frequencies.count)) == 0 else {
+            return nil
+        }
+        return PortaDSP.FrequencyResponse(magnitudeDb: magnitude, phaseRadians: phase)
+    }
+
+    /// Band levels of the rendered output for spectrum views. The analyzer starts on the first call, so the
+    /// first few calls return nil until it has captured `fftSize` frames.
+    public func readSpectrum(channel: Int, bands: Int = 32, fftSize: Int = 4096) -> [Float]? {
+        guard let handle = dspHandle, bands > 0, porta_analyzer_enable(handle, Int32(fftSize)) == 0 else { return nil }
+        var levels = [Float](repeating: -120.0, count: bands)
+        let written = porta_analyzer_read(handle, Int32(channel), &levels, Int32(bands))
+        return written == bands ? levels : nil
+    }
+
+    /// Moves noise and modulation to tape position `sampleIndex` (frames from the start) at the next render.
+    public func setTapePosition(sampleIndex: Int64) {
+        guard let handle = dspHandle else { return }
+        porta_set_position(handle, sampleIndex)
+    }
+
     private func handleParameterChange(address: AUParameterAddress, value: AUValue) {
         guard let definition = PortaDSPAudioUnit.definition(forAddress: address) else { return }
         var updated = lastParams
@@ -363,7 +422,18 @@ public final class PortaDSPAudioUnit: AUAudioUnit {
         pushParametersToDSP()
     }
 
+    /// Renders `position` of the way between two presets; see `PortaDSP.morph(from:to:position:)`.
+    /// Parameter changes, including a preset, end the morph.
+    public func morph(from presetA: PortaDSP.Params, to presetB: PortaDSP.Params, position: Float) {
+        presetMorph = (presetA, presetB, position)
+        guard let handle = dspHandle else { return }
+        var a = presetA.makeCParams()
+        var b = presetB.makeCParams()
+        porta_morph(handle, &a, &b, position)
+    }
+
     private func pushParametersToDSP() {
+        presetMorph = nil
         guard let handle = dspHandle else { return }
         var cParams = lastParams.makeCParams()
         porta_update_params(handle, &cParams)
@@ -409,6 +479,7 @@ public final class PortaDSPAudioUnit: AUAudioUnit {
 
     private func setParameters(_ params: PortaDSP.Params, clearPresetSelection: Bool) {
         lastParams = params
+        presetMorph = nil
         if clearPresetSelection {
             currentPresetSelection = nil
         }
@@ -429,16 +500,34 @@ public final class PortaDSPAudioUnit: AUAudioUnit {
         scratchCapacity = frames * channels
         interleavedScratch = UnsafeMutablePointer<Float>.allocate(capacity: scratchCapacity)
         interleavedScratch?.initialize(repeating: 0, count: scratchCapacity)
-        dspHandle = porta_create(outputBus.format.sampleRate, Int32(frames), Int32(channels))
+        // A handle kept from an earlier allocation is reconfigured in place, so
+        // hosts that toggle render resources on format changes skip the rebuild.
+        let sampleRate = outputBus.format.sampleRate
+        let reused = dspHandle.map { porta_reconfigure($0, sampleRate, Int32(frames), Int32(channels)) == 0 } ?? false
+        if !reused {
+            releaseDSP()
+            dspHandle = porta_create(sampleRate, Int32(frames), Int32(channels))
+            setQuality(quality)
+            setQualityGovernor(qualityGoverned)
+        }
+        let morph = presetMorph
         applyPresetParameters(lastParams)
+        if let morph {
+            self.morph(from: morph.from, to: morph.to, position: morph.position)
+        }
     }
 
     public override func deallocateRenderResources() {
-        releaseDSP()
+        // The DSP handle is kept for the next allocation and freed on deinit.
         releaseScratch()
         super.deallocateRenderResources()
     }
 
+    public override func reset() {
+        super.reset()
+        if let handle = dspHandle { porta_reset(handle) }
+    }
+
     // MARK: Rendering
 
     public override var internalRenderBlock: AUInternalRenderBlock {
@@ -740,6 +829,22 @@ public final class PortaDSPAudioUnit {
     public func exportPresetDictionary() -> [String: Any] { [:] }
 
     public func applyPresetDictionary(_ dictionary: [String: Any]) {}
+
+    public func setTapePosition(sampleIndex: Int64) {}
+
+    public func morph(from presetA: PortaDSP.Params, to presetB: PortaDSP.Params, position: Float) {}
+
+    public func readSpectrum(channel: Int, bands: Int = 32, fftSize: Int = 4096) -> [Float]? { nil }
+
+    public func frequencyResponse(at frequencies: [Float]) -> PortaDSP.FrequencyResponse? { nil }
+
+    public func readTimingStats() -> PortaDSP.TimingStats { PortaDSP.TimingStats() }
+
+    public func setQuality(_ quality: PortaDSP.Quality) {}
+
+    public func setQualityGovernor(_ enabled: Bool) {}
+
+    public func readQualityState() -> PortaDSP.QualityState { PortaDSP.QualityState() }
 }
 
 public enum PortaDSPNodeFactory {
@@ -26,4 +26,14 @@ enum PortaDSPTesting {
             )
         }
     }
+
+    static func countDropouts(
+        frames: Int,
+        blockSize: Int,
+        sampleRate: Float,
+        dropoutRatePerMinute: Float,
+        seed: UInt32
+    ) -> Int {
+        Int(porta_test_count_dropouts(Int32(frames), Int32(blockSize), sampleRate, dropoutRatePerMinute, seed))
+    }
 }
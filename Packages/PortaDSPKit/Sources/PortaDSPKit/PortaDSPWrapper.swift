@@ -5,7 +5,12 @@ import Foundation
 import PortaDSPBridge
 
 public final class PortaDSP {
-    private var handle: PortaDSPBridge.porta_dsp_handle?
+    /// Largest track count a single instance processes.
+    public static let maxTracks = Int(PORTA_MAX_TRACKS)
+
+    fileprivate var handle: PortaDSPBridge.porta_dsp_handle?
+    /// Pool the handle goes back to on deinit; held so the pool outlives its instances.
+    private let pool: PortaDSPPool?
 
     public struct Params: Codable, Equatable, Sendable {
         public var wowDepth: Float = 0.0006
@@ -22,17 +27,41 @@ public final class PortaDSP {
         public init() {}
     }
 
-    public init(sampleRate: Double = 48000.0, maxBlock: Int = 512, tracks: Int = 4) {
-        self.handle = porta_create(sampleRate, Int32(maxBlock), Int32(tracks))
+    /// - Parameter workerThreads: Helper threads that render slices of wide (8+ track) blocks in parallel
+    ///   with the audio thread. Capped at the core count minus one; `0` keeps processing single-threaded.
+    public init(sampleRate: Double = 48000.0, maxBlock: Int = 512, tracks: Int = 4, workerThreads: Int = 0) {
+        self.handle = porta_create_with_workers(sampleRate, Int32(maxBlock), Int32(tracks), Int32(workerThreads))
+        self.pool = nil
     }
 
-    deinit { if let h = handle { porta_destroy(h) } }
+    fileprivate init(handle: PortaDSPBridge.porta_dsp_handle?, pool: PortaDSPPool) {
+        self.handle = handle
+        self.pool = pool
+    }
+
+    deinit {
+        guard let h = handle else { return }
+        if let pool {
+            pool.release(h)
+        } else {
+            porta_destroy(h)
+        }
+    }
 
     public func update(_ p: Params) {
         var c = p.makeCParams()
         if let h = handle { porta_update_params(h, &c) }
     }
 
+    /// Renders `position` (0...1) of the way from `presetA` to `presetB`. Both presets are compiled once
+    /// per pair, so sweeping the position blends coefficients without redesigning filters, and a jump
+    /// glides over ~20 ms. `update(_:)` ends the morph.
+    public func morph(from presetA: Params, to presetB: Params, position: Float) {
+        var a = presetA.makeCParams()
+        var b = presetB.makeCParams()
+        if let h = handle { porta_morph(h, &a, &b, position) }
+    }
+
     // MARK: - Simple processing helper (offline or tap-based demo)
     public func processInterleaved(buffer: inout [Float], frames: Int, channels: Int) {
         guard let h = handle else { return }
@@ -41,14 +70,268 @@ public final class PortaDSP {
         }
     }
 
-    public func readMeters() -> [Float] {
-        var out = [Float](repeating: -120.0, count: 8)
+    /// Processes interleaved 16-bit PCM in place, converting to and from float one block at a time.
+    /// With `dither`, TPDF dither of +-1 LSB is added before the output is rounded.
+    public func processInt16(buffer: inout [Int16], frames: Int, channels: Int, dither: Bool = true) {
+        guard let h = handle else { return }
+        buffer.withUnsafeMutableBufferPointer { bp in
+            porta_process_int16(h, bp.baseAddress, Int32(frames), Int32(channels), dither ? 1 : 0)
+        }
+    }
+
+    /// Processes interleaved 24-bit PCM, packed little-endian in three bytes per sample, in place.
+    public func processInt24(buffer: inout [UInt8], frames: Int, channels: Int, dither: Bool = true) {
+        guard let h = handle else { return }
+        buffer.withUnsafeMutableBufferPointer { bp in
+            porta_process_int24(h, bp.baseAddress, Int32(frames), Int32(channels), dither ? 1 : 0)
+        }
+    }
+
+    /// Processes interleaved 32-bit PCM in place.
+    public func processInt32(buffer: inout [Int32], frames: Int, channels: Int, dither: Bool = false) {
+        guard let h = handle else { return }
+        buffer.withUnsafeMutableBufferPointer { bp in
+            porta_process_int32(h, bp.baseAddress, Int32(frames), Int32(channels), dither ? 1 : 0)
+        }
+    }
+
+    /// Offline render of `input` with this instance's settings, split into `chunkFrames`-long chunks rendered
+    /// concurrently on `threads` threads. Each chunk warms up on the `prerollFrames` of input before it, so the
+    /// result converges on a sequential render as the pre-roll grows. This instance's own state is not touched.
+    public func renderOffline(input: [Float], channels: Int, chunkFrames: Int, prerollFrames: Int, threads: Int) -> [Float] {
+        guard let h = handle, channels > 0 else { return [] }
+        let frames = input.count / channels
+        var output = [Float](repeating: 0, count: frames * channels)
+        input.withUnsafeBufferPointer { inBuffer in
+            output.withUnsafeMutableBufferPointer { outBuffer in
+                _ = porta_render_offline(h, inBuffer.baseAddress, outBuffer.baseAddress, Int64(frames), Int32(channels),
+                                         Int32(chunkFrames), Int32(prerollFrames), Int32(threads))
+            }
+        }
+        return output
+    }
+
+    /// Runs the saturation nonlinearity at `factor` (1, 2, 4 or 8) times the session rate to suppress aliasing.
+    public func setSaturationOversampling(_ factor: Int) {
+        if let h = handle { porta_set_saturation_oversampling(h, Int32(factor)) }
+    }
+
+    /// Delay in samples added by the saturation oversampling filters.
+    public var saturationLatencySamples: Int {
+        guard let h = handle else { return 0 }
+        return Int(porta_get_saturation_latency_samples(h))
+    }
+
+    /// Bytes of DSP state this instance owns, all carved from one block allocated at creation.
+    public var memoryFootprint: Int {
+        guard let h = handle else { return 0 }
+        return Int(porta_get_memory_footprint(h))
+    }
+
+    /// Bytes of read-only lookup tables shared by every instance in the process; not part of `memoryFootprint`.
+    public static var sharedTableBytes: Int {
+        Int(porta_get_shared_table_bytes())
+    }
+
+    /// Total delay in samples the chain adds (oversampling, wow/flutter, azimuth), for host delay compensation.
+    /// Re-read after changing parameters, oversampling or the low-latency mode.
+    public var latencySamples: Int {
+        guard let h = handle else { return 0 }
+        return Int(porta_get_latency_samples(h))
+    }
+
+    /// How long processing takes against the real-time budget (`frames / sampleRate`), counted on every call
+    /// since the instance was created. Load is time over budget; subtract two readings for an interval.
+    public struct TimingStats: Equatable, Sendable {
+        public static let bucketCount = Int(PORTA_TIMING_BUCKETS)
+
+        public var calls = 0
+        /// Calls that took longer than their budget: the callback would have missed its deadline.
+        public var overruns = 0
+        public var busySeconds: Double = 0
+        public var budgetSeconds: Double = 0
+        public var maxLoad: Float = 0
+        public var lastLoad: Float = 0
+        /// Calls per load bucket, four per octave; bucket `b` starts at `bucketFloor(b)`, and bucket 24 at 1.0.
+        public var histogram = [Int](repeating: 0, count: TimingStats.bucketCount)
+
+        public init() {}
+
+        init(_ raw: porta_timing_stats_t) {
+            calls = Int(raw.calls)
+            overruns = Int(raw.overruns)
+            busySeconds = Double(raw.busyNanos) / 1e9
+            budgetSeconds = Double(raw.budgetNanos) / 1e9
+            maxLoad = raw.maxLoad
+            lastLoad = raw.lastLoad
+            histogram = withUnsafeBytes(of: raw.histogram) { Array($0.bindMemory(to: UInt64.self)).map { Int($0) } }
+        }
+
+        /// Lowest load bucket `b` counts; the first and last buckets also take everything below and above.
+        public static func bucketFloor(_ bucket: Int) -> Float {
+            porta_timing_bucket_floor(Int32(bucket))
+        }
+
+        /// Average load over every call.
+        public var meanLoad: Double { budgetSeconds > 0 ? busySeconds / budgetSeconds : 0 }
+
+        /// Smallest load that at least `fraction` (0...1) of calls stayed under, to bucket resolution.
+        public func loadPercentile(_ fraction: Double) -> Float {
+            let target = Double(histogram.reduce(0, +)) * min(max(fraction, 0), 1)
+            var seen = 0
+            for (bucket, count) in histogram.enumerated() {
+                seen += count
+                if count > 0, Double(seen) >= target {
+                    return TimingStats.bucketFloor(bucket + 1)
+                }
+            }
+            return 0
+        }
+
+        /// Counts between an earlier reading and this one; the extremes stay lifetime values.
+        public func since(_ earlier: TimingStats) -> TimingStats {
+            var delta = self
+            delta.calls -= earlier.calls
+            delta.overruns -= earlier.overruns
+            delta.busySeconds -= earlier.busySeconds
+            delta.budgetSeconds -= earlier.budgetSeconds
+            delta.histogram = zip(histogram, earlier.histogram).map { $0 - $1 }
+            return delta
+        }
+    }
+
+    /// Always-on callback timing; lock-free and safe to read from any thread while audio runs.
+    public var timingStats: TimingStats {
+        guard let h = handle else { return TimingStats() }
+        var raw = porta_timing_stats_t()
+        porta_get_timing_stats(h, &raw)
+        return TimingStats(raw)
+    }
+
+    /// Processing cost tiers. `.high` is the exact chain; `.standard` reads the saturation from a table and
+    /// runs the wow/flutter and azimuth modulation at control rate; `.eco` also draws hiss at half rate and
+    /// updates the noise-reduction gain every 16 frames.
+    public enum Quality: Int32, Sendable, Comparable {
+        case eco = 0
+        case standard = 1
+        case high = 2
+
+        public static func < (lhs: Quality, rhs: Quality) -> Bool { lhs.rawValue < rhs.rawValue }
+    }
+
+    /// Renders at `quality` from the next block, or caps the governor there when it is on. Safe while audio runs.
+    public func setQuality(_ quality: Quality) {
+        if let h = handle { porta_set_quality(h, quality.rawValue) }
+    }
+
+    /// Lets the quality follow the callback load: it steps down when the render callback nears its deadline
+    /// and back up after several seconds of headroom, never above the tier set with `setQuality(_:)`.
+    public func setQualityGovernor(_ enabled: Bool) {
+        if let h = handle { porta_set_quality_governor(h, enabled ? 1 : 0) }
+    }
+
+    public struct QualityState: Equatable, Sendable {
+        /// Tier blocks are rendered at now.
+        public var quality: Quality = .high
+        /// The governor's smoothed load, 0 while it is off.
+        public var smoothedLoad: Float = 0
+        /// Governor tier changes since it was enabled.
+        public var stepsDown = 0
+        public var stepsUp = 0
+
+        public init() {}
+
+        init(_ raw: porta_quality_state_t) {
+            quality = Quality(rawValue: Int32(raw.tier)) ?? .high
+            smoothedLoad = raw.smoothedLoad
+            stepsDown = Int(raw.stepsDown)
+            stepsUp = Int(raw.stepsUp)
+        }
+    }
+
+    /// The tier in use and the governor's view of the load; lock-free and safe to read while audio runs.
+    public var qualityState: QualityState {
+        guard let h = handle else { return QualityState() }
+        var raw = porta_quality_state_t()
+        porta_get_quality_state(h, &raw)
+        return QualityState(raw)
+    }
+
+    /// Centres the wow/flutter read head on the smallest delay the current depths need, for live monitoring.
+    public func setLowLatencyMode(_ enabled: Bool) {
+        if let h = handle { porta_set_low_latency(h, enabled ? 1 : 0) }
+    }
+
+    /// Jumps to tape position `sampleIndex` (frames from the start) before the next processed block.
+    /// Hiss, dropouts and wow/flutter then match an unbroken render from zero at that position.
+    public func setPosition(_ sampleIndex: Int64) {
+        if let h = handle { porta_set_position(h, sampleIndex) }
+    }
+
+    /// Clears all DSP state before the next processed block, as if the instance had just been created.
+    /// Settings are kept and nothing is reallocated, so this is safe to call from the render thread.
+    public func reset() {
+        if let h = handle { porta_reset(h) }
+    }
+
+    /// Changes the sample rate, block size and track count in place, reusing the existing buffers where they
+    /// are large enough, and resets. Must not be called while another thread is processing.
+    @discardableResult
+    public func reconfigure(sampleRate: Double, maxBlock: Int, tracks: Int) -> Bool {
+        guard let h = handle else { return false }
+        return porta_reconfigure(h, sampleRate, Int32(maxBlock), Int32(tracks)) == 0
+    }
+
+    /// Bypasses noise reduction per track: bit `n` bypasses track `n`. `Params.nrTrack4Bypass` still maps to bit 3.
+    public func setNoiseReductionBypassMask(_ mask: UInt64) {
+        if let h = handle { porta_set_nr_bypass_mask(h, mask) }
+    }
+
+    public func readMeters(maxChannels: Int = 8) -> [Float] {
+        var out = [Float](repeating: -120.0, count: max(0, min(maxChannels, PortaDSP.maxTracks)))
         if let h = handle {
             _ = porta_get_meters_dbfs(h, &out, Int32(out.count))
         }
         return out
     }
 
+    /// Magnitude and phase of the linear tone stages (head bump, then HF loss) at each frequency.
+    public struct FrequencyResponse: Equatable {
+        public var magnitudeDb: [Float]
+        public var phaseRadians: [Float]
+    }
+
+    /// Evaluates the tone stages' transfer function from the coefficients the last processed block used,
+    /// without rendering audio. Saturation, noise, dropouts and the compander are not included.
+    /// Safe to call from the UI thread while audio is running.
+    public func frequencyResponse(at frequencies: [Float]) -> FrequencyResponse? {
+        guard let h = handle, !frequencies.isEmpty else { return nil }
+        var magnitude = [Float](repeating: 0, count: frequencies.count)
+        var phase = [Float](repeating: 0, count: frequencies.count)
+        guard porta_get_frequency_response(h, frequencies, &magnitude, &phase, Int32(frequencies.count)) == 0 else {
+            return nil
+        }
+        return FrequencyResponse(magnitudeDb: magnitude, phaseRadians: phase)
+    }
+
+    /// Starts capturing processed audio for `readSpectrum`. The render thread only copies each block into a
+    /// ring; the transform runs on the reader's thread. `fftSize` must be a power of two from 256 to 16384.
+    /// Returns false for an unsupported size, or if the analyzer is already running at a different size.
+    @discardableResult
+    public func enableAnalyzer(fftSize: Int = 4096) -> Bool {
+        guard let h = handle else { return false }
+        return porta_analyzer_enable(h, Int32(fftSize)) == 0
+    }
+
+    /// Levels of the newest `fftSize` frames of `channel` in `bands` log-spaced bands from 20 Hz to Nyquist,
+    /// in dBFS on the meter scale. Nil until the analyzer is enabled and has captured enough audio.
+    public func readSpectrum(channel: Int, bands: Int = 32) -> [Float]? {
+        guard let h = handle, bands > 0 else { return nil }
+        var out = [Float](repeating: -120.0, count: bands)
+        let written = porta_analyzer_read(h, Int32(channel), &out, Int32(bands))
+        return written == bands ? out : nil
+    }
+
     // MARK: - Standalone helpers
 
     public static func passthrough(input: [Float], frames: Int, channels: Int) -> [Float] {
@@ -70,3 +353,506 @@ public final class PortaDSP {
     }
 }
 
+/// Keeps released `PortaDSP` instances around so hosts that create and drop them often skip the allocation.
+/// An acquired instance behaves exactly like a new one with default settings.
+public final class PortaDSPPool {
+    private let pool: PortaDSPBridge.porta_pool_handle?
+
+    /// - Parameter maxIdle: Released instances kept for reuse; any beyond this are destroyed.
+    public init(maxIdle: Int = 4) {
+        self.pool = porta_pool_create(Int32(maxIdle))
+    }
+
+    deinit { if let p = pool { porta_pool_destroy(p) } }
+
+    /// Returns an idle instance with the same layout if there is one, else reconfigures or creates one.
+    public func acquire(sampleRate: Double = 48000.0, maxBlock: Int = 512, tracks: Int = 4) -> PortaDSP {
+        PortaDSP(handle: porta_pool_acquire(pool, sampleRate, Int32(maxBlock), Int32(tracks)), pool: self)
+    }
+
+    fileprivate func release(_ handle: PortaDSPBridge.porta_dsp_handle) {
+        porta_pool_release(pool, handle)
+    }
+}
+
+/// Multitrack tape playback from memory-mapped takes. Regions are handed over without locking the render
+/// thread, and rendering any position is a binary search per track, so seeks never open files.
+public final class PortaTapeTimeline {
+    public struct Region: Equatable, Sendable {
+        public var url: URL
+        /// 0-based track index.
+        public var track: Int
+        /// Timeline start in seconds.
+        public var start: TimeInterval
+        public var duration: TimeInterval
+        /// Seconds into the take where the region begins.
+        public var fileOffset: TimeInterval
+        public var gain: Float
+
+        public init(url: URL, track: Int, start: TimeInterval, duration: TimeInterval,
+                    fileOffset: TimeInterval = 0, gain: Float = 1) {
+            self.url = url
+            self.track = track
+            self.start = start
+            self.duration = duration
+            self.fileOffset = fileOffset
+            self.gain = gain
+        }
+
+        fileprivate static func withCRegions<R>(_ regions: [Region],
+                                                _ body: ([porta_tape_region_t], Int32) -> R) -> R {
+            let paths = regions.map { strdup($0.url.path) }
+            defer { paths.forEach { free($0) } }
+            let cRegions = zip(regions, paths).map { region, path in
+                porta_tape_region_t(path: path, track: Int32(region.track), start: region.start,
+                                    duration: region.duration, fileOffset: region.fileOffset, gain: region.gain)
+            }
+            return body(cRegions, Int32(cRegions.count))
+        }
+    }
+
+    private let handle: PortaDSPBridge.porta_timeline_handle?
+    public let sampleRate: Double
+    public let tracks: Int
+
+    public init(sampleRate: Double = 48000.0, tracks: Int = 4) {
+        self.sampleRate = sampleRate
+        self.tracks = max(1, min(tracks, PortaDSP.maxTracks))
+        self.handle = porta_timeline_create(sampleRate, Int32(self.tracks))
+    }
+
+    deinit { if let h = handle { porta_timeline_destroy(h) } }
+
+    /// Replaces the timeline, mapping takes not seen before. Not realtime-safe; call off the render thread.
+    /// Regions whose take is missing, unreadable or at another sample rate are skipped.
+    /// - Returns: The number of regions kept.
+    @discardableResult
+    public func setRegions(_ regions: [Region]) -> Int {
+        guard let h = handle else { return 0 }
+        return Region.withCRegions(regions) { Int(porta_timeline_set_regions(h, $0, $1)) }
+    }
+
+    /// Writes `frames` interleaved frames of every track from timeline frame `position`, then runs them
+    /// through `dsp` when given (keeping its tape position in step across seeks).
+    public func render(position: Int64, into buffer: inout [Float], frames: Int, through dsp: PortaDSP? = nil) {
+        guard let h = handle, frames > 0 else { return }
+        precondition(buffer.count >= frames * tracks, "Buffer too small for \(frames) frames of \(tracks) tracks")
+        buffer.withUnsafeMutableBufferPointer { bp in
+            if let dsp, let dspHandle = dsp.handle {
+                porta_timeline_process(h, dspHandle, position, bp.baseAddress, Int32(frames))
+            } else {
+                porta_timeline_render(h, position, bp.baseAddress, Int32(frames))
+            }
+        }
+    }
+
+    /// How often `render(position:into:frames:through:)` played frozen tape, and what that saved.
+    public struct FreezeStats: Equatable, Sendable {
+        /// Processed blocks copied from the freeze, and run through the DSP.
+        public var frozenBlocks = 0
+        public var liveBlocks = 0
+        public var frozenFrames = 0
+        public var liveFrames = 0
+        /// Render-thread time spent on each kind of block.
+        public var frozenSeconds: Double = 0
+        public var liveSeconds: Double = 0
+        /// Segments rendered, and found already on disk, by every `freeze` so far.
+        public var segmentsRendered = 0
+        public var segmentsReused = 0
+
+        public init() {}
+
+        /// Share of processed blocks served from the freeze.
+        public var hitRate: Double {
+            let blocks = frozenBlocks + liveBlocks
+            return blocks > 0 ? Double(frozenBlocks) / Double(blocks) : 0
+        }
+
+        /// Render-thread time the freeze saved: the frozen frames at the live cost per frame, less copying them.
+        public var savedSeconds: Double {
+            guard liveFrames > 0 else { return 0 }
+            return max(0, Double(frozenFrames) * liveSeconds / Double(liveFrames) - frozenSeconds)
+        }
+    }
+
+    /// Renders the timeline through `dsp`'s current settings into segment files in `directory` (created if
+    /// needed), so that `render(position:into:frames:through:)` with the same `dsp` copies frozen stretches
+    /// instead of processing them. Each segment file is named after the regions it covers, the settings and
+    /// the noise seeds, so after an edit only the segments it touches render again; any change to the regions
+    /// or `dsp`'s settings plays live until the next freeze. Varispeed playback always runs live. Blocks; call
+    /// off the render thread.
+    /// - Returns: The number of segments frozen, or nil if the regions or settings changed while it ran.
+    @discardableResult
+    public func freeze(through dsp: PortaDSP, in directory: URL, threads: Int = 1) -> Int? {
+        guard let h = handle, let dspHandle = dsp.handle else { return nil }
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        let frozen = porta_timeline_freeze(h, dspHandle, directory.path, Int32(max(1, threads)))
+        return frozen >= 0 ? Int(frozen) : nil
+    }
+
+    /// Stops playing frozen tape; the segment files stay for a later `freeze`.
+    public func unfreeze() {
+        guard let h = handle else { return }
+        porta_timeline_unfreeze(h)
+    }
+
+    public var freezeStats: FreezeStats {
+        guard let h = handle else { return FreezeStats() }
+        var raw = porta_freeze_stats_t()
+        porta_timeline_get_freeze_stats(h, &raw)
+        var stats = FreezeStats()
+        stats.frozenBlocks = Int(raw.frozenBlocks)
+        stats.liveBlocks = Int(raw.liveBlocks)
+        stats.frozenFrames = Int(raw.frozenFrames)
+        stats.liveFrames = Int(raw.liveFrames)
+        stats.frozenSeconds = Double(raw.frozenNanos) / 1e9
+        stats.liveSeconds = Double(raw.liveNanos) / 1e9
+        stats.segmentsRendered = Int(raw.segmentsRendered)
+        stats.segmentsReused = Int(raw.segmentsReused)
+        return stats
+    }
+
+    /// Interpolator cost/quality for varispeed playback.
+    public enum VarispeedQuality: Int32, Sendable {
+        case eco = 0
+        case standard = 1
+        case high = 2
+    }
+
+    /// Allocates varispeed playback for blocks of up to `maxFrames`. Call off the render thread.
+    @discardableResult
+    public func prepareVarispeed(maxFrames: Int, quality: VarispeedQuality = .standard) -> Bool {
+        guard let h = handle else { return false }
+        return porta_timeline_prepare_varispeed(h, Int32(maxFrames), quality.rawValue) == 0
+    }
+
+    /// Renders `frames` frames at tape speed `rate` (0.25...2.0; pitch and tempo together) from the
+    /// fractional tape frame `position`, gliding from the previous block's speed, then runs them through
+    /// `dsp` when given. Needs `prepareVarispeed` first.
+    /// - Returns: The tape position to pass to the next block; any other position seeks.
+    @discardableResult
+    public func render(position: Double, rate: Double, into buffer: inout [Float], frames: Int,
+                       through dsp: PortaDSP? = nil) -> Double {
+        guard let h = handle, frames > 0 else { return position }
+        precondition(buffer.count >= frames * tracks, "Buffer too small for \(frames) frames of \(tracks) tracks")
+        return buffer.withUnsafeMutableBufferPointer { bp in
+            porta_timeline_process_varispeed(h, dsp?.handle, position, rate, bp.baseAddress, Int32(frames))
+        }
+    }
+}
+
+/// Fixed-ratio sample-rate conversion of interleaved audio with the same windowed-sinc kernels as
+/// varispeed. Output lines up with the input (no delay to compensate), and a stream converted block by
+/// block then flushed has exactly `ceil(inputFrames * outputRate / inputRate)` frames.
+public final class PortaSampleRateConverter {
+    public typealias Quality = PortaTapeTimeline.VarispeedQuality
+
+    private let handle: PortaDSPBridge.porta_src_handle?
+    public let inputRate: Double
+    public let outputRate: Double
+    public let channels: Int
+    public let maxInputFrames: Int
+
+    public init?(from inputRate: Double, to outputRate: Double, channels: Int = 2, maxInputFrames: Int = 4096,
+                 quality: Quality = .standard) {
+        guard let h = porta_src_create(inputRate, outputRate, Int32(channels), Int32(maxInputFrames),
+                                       quality.rawValue) else { return nil }
+        self.handle = h
+        self.inputRate = inputRate
+        self.outputRate = outputRate
+        self.channels = channels
+        self.maxInputFrames = maxInputFrames
+    }
+
+    deinit { if let h = handle { porta_src_destroy(h) } }
+
+    /// Starts a new stream.
+    public func reset() { porta_src_reset(handle) }
+
+    /// Converts `input` (whole interleaved frames, at most `maxInputFrames` of them) and returns the
+    /// output frames it completes.
+    public func process(_ input: [Float]) -> [Float] {
+        let frames = min(input.count / channels, maxInputFrames)
+        guard frames > 0 else { return [] }
+        return collect(capacity: Int(porta_src_max_output(handle, Int32(frames)))) { out, capacity in
+            input.withUnsafeBufferPointer { porta_src_process(handle, $0.baseAddress, Int32(frames), out, capacity) }
+        }
+    }
+
+    /// Returns the outputs still waiting on input past the end of the stream.
+    public func flush() -> [Float] {
+        var tail: [Float] = []
+        let capacity = Int(porta_src_max_output(handle, Int32(maxInputFrames)))
+        while true {
+            let block = collect(capacity: capacity) { porta_src_flush(handle, $0, $1) }
+            if block.isEmpty { return tail }
+            tail += block
+        }
+    }
+
+    private func collect(capacity: Int, _ fill: (UnsafeMutablePointer<Float>?, Int32) -> Int32) -> [Float] {
+        var output = [Float](repeating: 0, count: capacity * channels)
+        let written = output.withUnsafeMutableBufferPointer { fill($0.baseAddress, Int32(capacity)) }
+        output.removeLast(output.count - Int(written) * channels)
+        return output
+    }
+
+    /// Converts the audio file at `source` to `sampleRate`, writing a 32-bit float WAV to `destination`
+    /// that only appears once complete. Not realtime-safe.
+    @discardableResult
+    public static func convertFile(at source: URL, to destination: URL, sampleRate: Double,
+                                   quality: Quality = .standard) -> Bool {
+        porta_src_convert_file(source.path, destination.path, sampleRate, quality.rawValue) == 0
+    }
+}
+
+/// All channel strips of the console mixed in one native pass: trim, 3-band EQ, aux and cue sends, fader,
+/// pan and group assign, onto planar buses. Replaces a graph of mixer nodes per strip.
+public final class PortaChannelMixer {
+    /// Knob and switch positions of one strip, 0...1 with 0.5 at centre, as on the console.
+    public struct Strip: Equatable, Sendable {
+        public var trim: Float = 0.5
+        public var hiEQ: Float = 0.5
+        public var midEQ: Float = 0.5
+        public var loEQ: Float = 0.5
+        public var aux1: Float = 0
+        public var aux2: Float = 0
+        public var tapeCue: Float = 0
+        public var pan: Float = 0.5
+        public var fader: Float = 0.75
+        public var mute = false
+        public var assignL = true
+        public var assignR = true
+
+        public init() {}
+
+        fileprivate var cValue: porta_strip_t {
+            porta_strip_t(trim: trim, hiEQ: hiEQ, midEQ: midEQ, loEQ: loEQ, aux1: aux1, aux2: aux2,
+                          tapeCue: tapeCue, pan: pan, fader: fader, mute: mute ? 1 : 0,
+                          assignL: assignL ? 1 : 0, assignR: assignR ? 1 : 0)
+        }
+    }
+
+    /// One block of the mix buses; FX sends are mono.
+    public struct Buses: Equatable, Sendable {
+        public var groupL: [Float]
+        public var groupR: [Float]
+        public var fx1: [Float]
+        public var fx2: [Float]
+        public var cueL: [Float]
+        public var cueR: [Float]
+
+        public init(frames: Int) {
+            groupL = [Float](repeating: 0, count: frames)
+            groupR = groupL
+            fx1 = groupL
+            fx2 = groupL
+            cueL = groupL
+            cueR = groupL
+        }
+    }
+
+    /// Where a realtime block is written; nil buses are skipped.
+    public struct BusPointers {
+        public var groupL: UnsafeMutablePointer<Float>?
+        public var groupR: UnsafeMutablePointer<Float>?
+        public var fx1: UnsafeMutablePointer<Float>?
+        public var fx2: UnsafeMutablePointer<Float>?
+        public var cueL: UnsafeMutablePointer<Float>?
+        public var cueR: UnsafeMutablePointer<Float>?
+
+        public init(groupL: UnsafeMutablePointer<Float>? = nil, groupR: UnsafeMutablePointer<Float>? = nil,
+                    fx1: UnsafeMutablePointer<Float>? = nil, fx2: UnsafeMutablePointer<Float>? = nil,
+                    cueL: UnsafeMutablePointer<Float>? = nil, cueR: UnsafeMutablePointer<Float>? = nil) {
+            self.groupL = groupL
+            self.groupR = groupR
+            self.fx1 = fx1
+            self.fx2 = fx2
+            self.cueL = cueL
+            self.cueR = cueR
+        }
+    }
+
+    private let handle: PortaDSPBridge.porta_mixer_handle?
+    public let sampleRate: Double
+    public let maxFrames: Int
+    /// 1 or 2 channels per strip.
+    public let stripChannels: [Int]
+
+    public init?(sampleRate: Double = 48000.0, maxFrames: Int = 512, stripChannels: [Int]) {
+        let channels = stripChannels.map { $0 == 2 ? 2 : 1 }
+        guard let h = channels.map(Int32.init).withUnsafeBufferPointer({
+            porta_mixer_create(sampleRate, Int32(maxFrames), $0.baseAddress, Int32($0.count))
+        }) else { return nil }
+        self.handle = h
+        self.sampleRate = sampleRate
+        self.maxFrames = maxFrames
+        self.stripChannels = channels
+    }
+
+    deinit { if let h = handle { porta_mixer_destroy(h) } }
+
+    /// Takes effect from the next block, ramped across it. Safe from any thread.
+    public func setStrip(_ index: Int, _ strip: Strip) {
+        var value = strip.cValue
+        porta_mixer_set_strip(handle, Int32(index), &value)
+    }
+
+    /// Mixes `frames` frames; input `s` holds strip `s` with frame i, channel c at `i * strides[s] + c`.
+    /// A nil input is silence. Realtime-safe.
+    public func process(inputs: [UnsafePointer<Float>?], strides: [Int], frames: Int, into buses: BusPointers) {
+        precondition(inputs.count >= stripChannels.count && strides.count >= stripChannels.count,
+                     "One input and stride per strip")
+        let cStrides = strides.map(Int32.init)
+        var out = porta_mixer_buses_t(groupL: buses.groupL, groupR: buses.groupR, fx1: buses.fx1, fx2: buses.fx2,
+                                      cueL: buses.cueL, cueR: buses.cueR)
+        inputs.withUnsafeBufferPointer { ip in
+            cStrides.withUnsafeBufferPointer { sp in
+                _ = porta_mixer_process(handle, ip.baseAddress, sp.baseAddress, Int32(frames), &out)
+            }
+        }
+    }
+
+    /// Mixes `frames` frames from one array per strip (stereo strips interleaved; nil is silence) into new buses.
+    public func mix(_ sources: [[Float]?], frames: Int) -> Buses {
+        var buses = Buses(frames: frames)
+        let strides = stripChannels
+        func withInputs<R>(_ index: Int, _ pointers: [UnsafePointer<Float>?],
+                           _ body: ([UnsafePointer<Float>?]) -> R) -> R {
+            guard index < stripChannels.count else { return body(pointers) }
+            guard index < sources.count, let source = sources[index] else {
+                return withInputs(index + 1, pointers + [nil], body)
+            }
+            precondition(source.count >= frames * stripChannels[index], "Strip \(index) source too short")
+            return source.withUnsafeBufferPointer { withInputs(index + 1, pointers + [$0.baseAddress], body) }
+        }
+        withInputs(0, []) { inputs in
+            buses.groupL.withUnsafeMutableBufferPointer { gl in
+                buses.groupR.withUnsafeMutableBufferPointer { gr in
+                    buses.fx1.withUnsafeMutableBufferPointer { f1 in
+                        buses.fx2.withUnsafeMutableBufferPointer { f2 in
+                            buses.cueL.withUnsafeMutableBufferPointer { cl in
+                                buses.cueR.withUnsafeMutableBufferPointer { cr in
+                                    process(inputs: inputs, strides: strides, frames: frames,
+                                            into: BusPointers(groupL: gl.baseAddress, groupR: gr.baseAddress,
+                                                              fx1: f1.baseAddress, fx2: f2.baseAddress,
+                                                              cueL: cl.baseAddress, cueR: cr.baseAddress))
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return buses
+    }
+
+    /// Post-EQ, pre-fader signal of `strip` from the last block, as fed to DIRECT recording.
+    public func direct(strip: Int, frames: Int) -> [Float] {
+        var out = [Float](repeating: 0, count: frames)
+        let copied = out.withUnsafeMutableBufferPointer {
+            porta_mixer_copy_direct(handle, Int32(strip), $0.baseAddress, Int32(frames))
+        }
+        return Array(out.prefix(Int(copied)))
+    }
+
+    /// Post-fader peak (linear) of each strip over the last block.
+    public func peaks() -> [Float] {
+        var out = [Float](repeating: 0, count: stripChannels.count)
+        let count = out.withUnsafeMutableBufferPointer {
+            porta_mixer_read_peaks(handle, $0.baseAddress, Int32($0.count))
+        }
+        return Array(out.prefix(Int(count)))
+    }
+}
+
+/// Min/max/RMS per bin of a waveform overview.
+public struct PortaWaveformBins: Equatable, Sendable {
+    public var min: [Float]
+    public var max: [Float]
+    public var rms: [Float]
+
+    fileprivate static func query(bins: Int,
+                                  _ fill: (UnsafeMutablePointer<Float>?, UnsafeMutablePointer<Float>?,
+                                           UnsafeMutablePointer<Float>?) -> Int32) -> PortaWaveformBins? {
+        guard bins > 0 else { return nil }
+        var mins = [Float](repeating: 0, count: bins)
+        var maxes = [Float](repeating: 0, count: bins)
+        var rms = [Float](repeating: 0, count: bins)
+        let status = mins.withUnsafeMutableBufferPointer { mn in
+            maxes.withUnsafeMutableBufferPointer { mx in
+                rms.withUnsafeMutableBufferPointer { rm in fill(mn.baseAddress, mx.baseAddress, rm.baseAddress) }
+            }
+        }
+        return status == 0 ? PortaWaveformBins(min: mins, max: maxes, rms: rms) : nil
+    }
+}
+
+/// Builds the peak pyramid of one take as it is recorded, then saves it as a sidecar next to the take
+/// for `PortaWaveformOverview`. Appending allocates; call it from the recording tap, not the render thread.
+public final class PortaWaveformPeaks {
+    private let handle: PortaDSPBridge.porta_peaks_handle?
+    public let sampleRate: Double
+
+    public init(sampleRate: Double = 48000.0) {
+        self.sampleRate = sampleRate
+        self.handle = porta_peaks_create(sampleRate)
+    }
+
+    deinit { if let h = handle { porta_peaks_destroy(h) } }
+
+    /// Frames appended so far.
+    public var frames: Int64 { handle.map { porta_peaks_frames($0) } ?? 0 }
+
+    /// Adds `frames` samples read every `stride` floats from `samples`.
+    public func append(_ samples: UnsafePointer<Float>, frames: Int, stride: Int = 1) {
+        guard let h = handle, frames > 0 else { return }
+        porta_peaks_append(h, samples, Int32(frames), Int32(stride))
+    }
+
+    /// Writes the sidecar for the take at `takeURL` (its path with ".peaks" appended).
+    @discardableResult
+    public func save(nextTo takeURL: URL) -> Bool {
+        guard let h = handle else { return false }
+        return porta_peaks_save(h, takeURL.path) == 0
+    }
+
+    /// `bins` equal bins of take frames `range`, e.g. to draw a take while it is still being recorded.
+    public func bins(_ range: Range<Int64>, bins: Int) -> PortaWaveformBins? {
+        guard let h = handle else { return nil }
+        return PortaWaveformBins.query(bins: bins) {
+            porta_peaks_query(h, range.lowerBound, range.upperBound, Int32(bins), $0, $1, $2)
+        }
+    }
+}
+
+/// Tape-wide waveform overview read from the takes' peak sidecars, never from their audio.
+public final class PortaWaveformOverview {
+    private let handle: PortaDSPBridge.porta_overview_handle?
+    public let sampleRate: Double
+    public let tracks: Int
+
+    public init(sampleRate: Double = 48000.0, tracks: Int = 4) {
+        self.sampleRate = sampleRate
+        self.tracks = max(1, min(tracks, PortaDSP.maxTracks))
+        self.handle = porta_overview_create(sampleRate, Int32(self.tracks))
+    }
+
+    deinit { if let h = handle { porta_overview_destroy(h) } }
+
+    /// Replaces the layout, loading sidecars not loaded yet.
+    /// - Returns: The number of regions whose take has a sidecar at this sample rate.
+    @discardableResult
+    public func setRegions(_ regions: [PortaTapeTimeline.Region]) -> Int {
+        guard let h = handle else { return 0 }
+        return PortaTapeTimeline.Region.withCRegions(regions) { Int(porta_overview_set_regions(h, $0, $1)) }
+    }
+
+    /// `bins` equal bins of `track` between timeline frames `range`, merged across regions; gaps are silence.
+    public func bins(track: Int, _ range: Range<Int64>, bins: Int) -> PortaWaveformBins? {
+        guard let h = handle else { return nil }
+        return PortaWaveformBins.query(bins: bins) {
+            porta_overview_query(h, Int32(track), range.lowerBound, range.upperBound, Int32(bins), $0, $1, $2)
+        }
+    }
+}
@@ -0,0 +1,57 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class CallbackTimingTests: XCTestCase {
+    private let channels = 2
+
+    private func process(_ dsp: PortaDSP, calls: Int, frames: Int) {
+        var block = [Float](repeating: 0, count: frames * channels)
+        for call in 0..<calls {
+            for i in 0..<(frames * channels) {
+                block[i] = 0.3 * sinf(0.02 * Float(call * frames * channels + i))
+            }
+            dsp.processInterleaved(buffer: &block, frames: frames, channels: channels)
+        }
+    }
+
+    func testEveryCallIsCountedAgainstItsBudget() {
+        let dsp = PortaDSP(sampleRate: 48_000, maxBlock: 512, tracks: channels)
+        XCTAssertEqual(dsp.timingStats, PortaDSP.TimingStats())
+
+        process(dsp, calls: 50, frames: 256)
+        let stats = dsp.timingStats
+        XCTAssertEqual(stats.calls, 50)
+        XCTAssertEqual(stats.histogram.reduce(0, +), 50)
+        XCTAssertEqual(stats.budgetSeconds, 50 * 256 / 48_000, accuracy: 1e-6)
+        XCTAssertGreaterThan(stats.busySeconds, 0)
+        XCTAssertGreaterThan(stats.maxLoad, 0)
+        XCTAssertLessThanOrEqual(stats.lastLoad, stats.maxLoad)
+        XCTAssertLessThanOrEqual(stats.overruns, stats.calls)
+        XCTAssertGreaterThan(stats.loadPercentile(0.5), 0)
+        XCTAssertLessThanOrEqual(stats.loadPercentile(0.5), stats.loadPercentile(1))
+
+        process(dsp, calls: 10, frames: 64)
+        let delta = dsp.timingStats.since(stats)
+        XCTAssertEqual(delta.calls, 10)
+        XCTAssertEqual(delta.histogram.reduce(0, +), 10)
+        XCTAssertEqual(delta.budgetSeconds, 10 * 64 / 48_000, accuracy: 1e-6)
+    }
+
+    func testBucketsAreQuarterOctavesWithTheDeadlineAtTwentyFour() {
+        XCTAssertEqual(PortaDSP.TimingStats.bucketCount, 32)
+        XCTAssertEqual(PortaDSP.TimingStats.bucketFloor(24), 1, accuracy: 1e-6)
+        XCTAssertEqual(PortaDSP.TimingStats.bucketFloor(20), 0.5, accuracy: 1e-6)
+        XCTAssertEqual(PortaDSP.TimingStats.bucketFloor(25), powf(2, 0.25), accuracy: 1e-6)
+    }
+
+    func testPooledInstanceStartsCountingAfresh() {
+        let pool = PortaDSPPool(maxIdle: 1)
+        do {
+            let dsp = pool.acquire(sampleRate: 48_000, maxBlock: 512, tracks: channels)
+            process(dsp, calls: 5, frames: 128)
+            XCTAssertEqual(dsp.timingStats.calls, 5)
+        }
+        let reused = pool.acquire(sampleRate: 48_000, maxBlock: 512, tracks: channels)
+        XCTAssertEqual(reused.timingStats.calls, 0)
+    }
+}
@@ -0,0 +1,127 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class ChannelMixerTests: XCTestCase {
+    private let sampleRate = 48_000.0
+    private let frames = 512
+
+    /// Two mono strips and one stereo strip, all at unity trim and fader with nothing else engaged.
+    private func makeMixer() throws -> PortaChannelMixer {
+        let mixer = try XCTUnwrap(PortaChannelMixer(sampleRate: sampleRate, maxFrames: frames, stripChannels: [1, 1, 2]))
+        for index in 0..<3 { mixer.setStrip(index, unity()) }
+        return mixer
+    }
+
+    private func unity() -> PortaChannelMixer.Strip {
+        var strip = PortaChannelMixer.Strip()
+        strip.trim = 1
+        strip.fader = 1
+        return strip
+    }
+
+    private func sine(_ frequency: Double, block: Int = 0, amplitude: Float = 0.5) -> [Float] {
+        (0..<frames).map { amplitude * Float(sin(2 * Double.pi * frequency * Double(block * frames + $0) / sampleRate)) }
+    }
+
+    /// Mixes the same sources twice so gain ramps have settled.
+    private func settledMix(_ mixer: PortaChannelMixer, _ sources: [[Float]?]) -> PortaChannelMixer.Buses {
+        _ = mixer.mix(sources, frames: frames)
+        return mixer.mix(sources, frames: frames)
+    }
+
+    func testMonoStripPansWithConstantPower() throws {
+        let mixer = try makeMixer()
+        let source = sine(440)
+        var buses = settledMix(mixer, [source, nil, nil])
+        for i in 0..<frames {
+            XCTAssertEqual(buses.groupL[i], source[i] * 0.70710678, accuracy: 1e-5)
+            XCTAssertEqual(buses.groupR[i], source[i] * 0.70710678, accuracy: 1e-5)
+        }
+
+        var left = unity()
+        left.pan = 0
+        mixer.setStrip(0, left)
+        buses = settledMix(mixer, [source, nil, nil])
+        XCTAssertEqual(buses.groupR.map(abs).max(), 0)
+        for i in 0..<frames { XCTAssertEqual(buses.groupL[i], source[i], accuracy: 1e-5) }
+
+        left.assignL = false
+        mixer.setStrip(0, left)
+        buses = settledMix(mixer, [source, nil, nil])
+        XCTAssertEqual(buses.groupL.map(abs).max(), 0)
+    }
+
+    func testSendsArePreFaderAndStripsSum() throws {
+        let mixer = try makeMixer()
+        var strip = unity()
+        strip.aux1 = 0.5
+        strip.aux2 = 0.25
+        strip.tapeCue = 1
+        strip.mute = true
+        mixer.setStrip(0, strip)
+        let a = sine(440)
+        let b = sine(1_000, amplitude: 0.25)
+        let buses = settledMix(mixer, [a, b, nil])
+        for i in 0..<frames {
+            XCTAssertEqual(buses.fx1[i], 0.5 * a[i], accuracy: 1e-6)
+            XCTAssertEqual(buses.fx2[i], 0.25 * a[i], accuracy: 1e-6)
+            XCTAssertEqual(buses.cueL[i], a[i], accuracy: 1e-6)
+            // The first strip is muted on the groups, so only the second reaches them.
+            XCTAssertEqual(buses.groupL[i], b[i] * 0.70710678, accuracy: 1e-5)
+        }
+        let direct = mixer.direct(strip: 0, frames: frames)
+        XCTAssertEqual(direct.count, frames)
+        for i in 0..<frames { XCTAssertEqual(direct[i], a[i], accuracy: 1e-5) }
+        XCTAssertEqual(mixer.peaks()[0], 0)
+        XCTAssertEqual(mixer.peaks()[1], 0.25, accuracy: 1e-3)
+    }
+
+    func testStereoStripBalances() throws {
+        let mixer = try makeMixer()
+        var strip = unity()
+        strip.pan = 1
+        mixer.setStrip(2, strip)
+        let stereo = (0..<frames).flatMap { _ in [Float(0.3), Float(0.2)] }
+        var buses = PortaChannelMixer.Buses(frames: frames)
+        // The EQ settles on DC after a while; a flat EQ passes it unchanged.
+        for _ in 0..<20 { buses = mixer.mix([nil, nil, stereo], frames: frames) }
+        XCTAssertEqual(buses.groupL.last!, 0, accuracy: 1e-6)
+        XCTAssertEqual(buses.groupR.last!, 0.2, accuracy: 1e-4)
+    }
+
+    func testEQBandsHitTheirTargets() throws {
+        // One band fully up at a time, measured at its centre or on its plateau.
+        let cases: [(WritableKeyPath<PortaChannelMixer.Strip, Float>, Double, Float)] = [
+            (\.loEQ, 30, 12), (\.midEQ, 1_000, 9), (\.hiEQ, 20_000, 12)
+        ]
+        for (band, frequency, expectedDb) in cases {
+            let mixer = try makeMixer()
+            var strip = unity()
+            strip.pan = 0
+            strip[keyPath: band] = 1
+            mixer.setStrip(0, strip)
+            var peak: Float = 0
+            for block in 0..<200 {
+                let buses = mixer.mix([sine(frequency, block: block), nil, nil], frames: frames)
+                if block >= 100 { peak = max(peak, buses.groupL.map(abs).max()!) }
+            }
+            XCTAssertEqual(20 * log10(peak / 0.5), expectedDb, accuracy: 0.3, "\(frequency) Hz")
+        }
+    }
+
+    func testGainChangesRampAcrossOneBlock() throws {
+        let mixer = try makeMixer()
+        let dc = [Float](repeating: 1, count: frames)
+        var strip = unity()
+        strip.pan = 0
+        strip.fader = 0
+        mixer.setStrip(0, strip)
+        for _ in 0..<20 { _ = mixer.mix([dc, nil, nil], frames: frames) }
+        strip.fader = 1
+        mixer.setStrip(0, strip)
+        let ramp = mixer.mix([dc, nil, nil], frames: frames).groupL
+        XCTAssertLessThan(ramp[0], 0.01)
+        for i in 1..<frames { XCTAssertLessThanOrEqual(abs(ramp[i] - ramp[i - 1]), 2.0 / Float(frames)) }
+        XCTAssertEqual(ramp[frames - 1], 1, accuracy: 1e-3)
+    }
+}
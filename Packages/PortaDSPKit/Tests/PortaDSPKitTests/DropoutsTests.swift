@@ -41,4 +41,56 @@ final class DropoutsTests: XCTestCase {
             XCTAssertGreaterThan(buffer[index], dropoutValue, "Samples following the dropout should recover")
         }
     }
+
+    // Onsets are scheduled from a geometric inter-arrival draw, which must
+    // reproduce the per-frame Bernoulli (Poisson) statistics: the mean count is
+    // the run length divided by the mean cycle (idle gap plus event span), and
+    // the spread across seeds stays close to the renewal-process prediction.
+    func testScheduledOnsetsMatchPoissonStatistics() {
+        let sampleRate: Float = 1_000
+        let ratePerMinute: Float = 60
+        let frames = 200_000
+        let trials = 200
+
+        let p = Double(ratePerMinute) / 60.0 / Double(sampleRate)
+        let meanIdleFrames = (1.0 - p) / p
+        // 4 ms attack, 10-30 ms hold and 10 ms release at 1 kHz.
+        let meanEventFrames = 4.0 + 20.0 + 10.0
+        let expectedMean = Double(frames) / (meanIdleFrames + meanEventFrames + 1.0)
+
+        var counts: [Double] = []
+        for trial in 0..<trials {
+            let seed = UInt32(truncatingIfNeeded: 0x9E37_79B9 &* UInt64(trial + 1))
+            let count = PortaDSPTesting.countDropouts(
+                frames: frames,
+                blockSize: 512,
+                sampleRate: sampleRate,
+                dropoutRatePerMinute: ratePerMinute,
+                seed: seed
+            )
+            counts.append(Double(count))
+        }
+
+        let mean = counts.reduce(0, +) / Double(trials)
+        let variance = counts.reduce(0) { $0 + ($1 - mean) * ($1 - mean) } / Double(trials - 1)
+
+        XCTAssertEqual(mean, expectedMean, accuracy: expectedMean * 0.03)
+        // Inter-arrival gaps dominate the cycle, so the count is close to Poisson.
+        XCTAssertGreaterThan(variance, mean * 0.6)
+        XCTAssertLessThan(variance, mean * 1.4)
+    }
+
+    func testBlockSizeDoesNotChangeEventSchedule() {
+        let counts = [1, 37, 512, 4_096].map { blockSize in
+            PortaDSPTesting.countDropouts(
+                frames: 500_000,
+                blockSize: blockSize,
+                sampleRate: 48_000,
+                dropoutRatePerMinute: 30,
+                seed: 0x0BAD_5EED
+            )
+        }
+        XCTAssertGreaterThan(counts[0], 0)
+        XCTAssertTrue(counts.allSatisfy { $0 == counts[0] }, "Idle skipping must not depend on block boundaries: \(counts)")
+    }
 }
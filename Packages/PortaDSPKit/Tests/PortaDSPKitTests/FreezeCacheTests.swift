@@ -0,0 +1,130 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class FreezeCacheTests: XCTestCase {
+    private let sampleRate = 48_000
+    private let block = 512
+    private var directory: URL!
+    private var cache: URL { directory.appendingPathComponent("Frozen") }
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    /// Eight seconds of a mono 32-bit float sine.
+    private func writeTake(_ name: String, frequency: Double) throws -> URL {
+        let frames = 8 * sampleRate
+        var data = Data()
+        func append<T: FixedWidthInteger>(_ x: T) { withUnsafeBytes(of: x.littleEndian) { data.append(contentsOf: $0) } }
+        data.append(contentsOf: Array("RIFF".utf8)); append(UInt32(36 + frames * 4))
+        data.append(contentsOf: Array("WAVEfmt ".utf8)); append(UInt32(16))
+        append(UInt16(3)); append(UInt16(1)); append(UInt32(sampleRate)); append(UInt32(sampleRate * 4))
+        append(UInt16(4)); append(UInt16(32))
+        data.append(contentsOf: Array("data".utf8)); append(UInt32(frames * 4))
+        for i in 0..<frames {
+            append(Float(0.4 * sin(2 * Double.pi * frequency * Double(i) / Double(sampleRate))).bitPattern)
+        }
+        let url = directory.appendingPathComponent(name)
+        try data.write(to: url)
+        return url
+    }
+
+    private func regions() throws -> [PortaTapeTimeline.Region] {
+        let a = try writeTake("a.wav", frequency: 220)
+        let b = try writeTake("b.wav", frequency: 330)
+        return [
+            .init(url: a, track: 0, start: 0, duration: 8),
+            .init(url: b, track: 1, start: 1, duration: 6),
+            .init(url: a, track: 2, start: 0.5, duration: 7, fileOffset: 0.5, gain: 0.7),
+            .init(url: b, track: 3, start: 0, duration: 6),
+            .init(url: b, track: 3, start: 6, duration: 2, fileOffset: 6)
+        ]
+    }
+
+    private func play(_ timeline: PortaTapeTimeline, through dsp: PortaDSP, seconds: Int) -> [Float] {
+        var output: [Float] = []
+        var buffer = [Float](repeating: 0, count: block * 4)
+        for position in stride(from: 0, to: seconds * sampleRate - block, by: block) {
+            timeline.render(position: Int64(position), into: &buffer, frames: block, through: dsp)
+            output += buffer
+        }
+        return output
+    }
+
+    private func segmentFiles() throws -> Int {
+        try FileManager.default.contentsOfDirectory(atPath: cache.path).filter { $0.hasSuffix(".wav") }.count
+    }
+
+    func testFrozenPlaybackMatchesLiveProcessing() throws {
+        let regions = try regions()
+        let live = PortaTapeTimeline(sampleRate: Double(sampleRate), tracks: 4)
+        live.setRegions(regions)
+        let reference = play(live, through: PortaDSP(tracks: 4), seconds: 9)
+
+        let timeline = PortaTapeTimeline(sampleRate: Double(sampleRate), tracks: 4)
+        timeline.setRegions(regions)
+        let dsp = PortaDSP(tracks: 4)
+        XCTAssertEqual(timeline.freeze(through: dsp, in: cache, threads: 2), 3)
+        XCTAssertEqual(try segmentFiles(), 3)
+        let frozen = play(timeline, through: dsp, seconds: 9)
+
+        // Frozen segments render with their own pre-roll, so they match to well below the hiss.
+        XCTAssertEqual(frozen.count, reference.count)
+        var worst: Float = 0
+        for i in reference.indices { worst = max(worst, abs(frozen[i] - reference[i])) }
+        XCTAssertLessThan(worst, 2e-4)
+
+        // Everything up to the last segment's warm-up came from the freeze; the tail past it ran live.
+        let stats = timeline.freezeStats
+        XCTAssertGreaterThan(stats.hitRate, 0.85)
+        XCTAssertGreaterThan(stats.liveBlocks, 0)
+        XCTAssertEqual(stats.segmentsRendered, 3)
+        XCTAssertGreaterThanOrEqual(stats.savedSeconds, 0)
+    }
+
+    func testEditsPlayLiveAndRefreezeOnlyWhatChanged() throws {
+        var regions = try regions()
+        let timeline = PortaTapeTimeline(sampleRate: Double(sampleRate), tracks: 4)
+        timeline.setRegions(regions)
+        let dsp = PortaDSP(tracks: 4)
+        XCTAssertEqual(timeline.freeze(through: dsp, in: cache), 3)
+
+        var buffer = [Float](repeating: 0, count: block * 4)
+        func liveBlocks(at position: Int) -> Int {
+            let before = timeline.freezeStats.liveBlocks
+            timeline.render(position: Int64(position), into: &buffer, frames: block, through: dsp)
+            return timeline.freezeStats.liveBlocks - before
+        }
+        XCTAssertEqual(liveBlocks(at: 48_000), 0)
+
+        // A parameter edit plays live at once, and a freeze with new settings renders every segment.
+        var params = PortaDSP.Params()
+        params.headBumpGainDb = 4
+        dsp.update(params)
+        XCTAssertEqual(liveBlocks(at: 48_000), 1)
+        XCTAssertEqual(timeline.freeze(through: dsp, in: cache), 3)
+        XCTAssertEqual(timeline.freezeStats.segmentsRendered, 6)
+
+        // Going back finds the first freeze's files.
+        dsp.update(PortaDSP.Params())
+        XCTAssertEqual(timeline.freeze(through: dsp, in: cache), 3)
+        XCTAssertEqual(timeline.freezeStats.segmentsRendered, 6)
+        XCTAssertEqual(timeline.freezeStats.segmentsReused, 3)
+
+        // A region edit after six seconds only touches the last segment.
+        regions[4].gain = 0.5
+        timeline.setRegions(regions)
+        XCTAssertEqual(liveBlocks(at: 0), 1)
+        XCTAssertEqual(timeline.freeze(through: dsp, in: cache), 3)
+        XCTAssertEqual(timeline.freezeStats.segmentsRendered, 7)
+        XCTAssertEqual(timeline.freezeStats.segmentsReused, 5)
+
+        timeline.unfreeze()
+        XCTAssertEqual(liveBlocks(at: 48_000), 1)
+    }
+}
@@ -0,0 +1,62 @@
+import XCTest
+import PortaDSPBridge
+@testable import PortaDSPKit
+
+final class FrequencyResponseTests: XCTestCase {
+    private let sampleRate: Float = 48_000
+    private let frequencies: [Float] = [30, 100, 1_000, 5_000, 12_000]
+
+    private func settledDSP(_ params: PortaDSP.Params) -> PortaDSP {
+        let dsp = PortaDSP(sampleRate: Double(sampleRate), maxBlock: 256, tracks: 1)
+        dsp.update(params)
+        var block = [Float](repeating: 0, count: 256)
+        for _ in 0..<200 {
+            dsp.processInterleaved(buffer: &block, frames: 256, channels: 1)
+        }
+        return dsp
+    }
+
+    private func linearParams() -> PortaDSP.Params {
+        var params = PortaDSP.Params()
+        params.headBumpGainDb = 6
+        params.headBumpFreqHz = 100
+        params.lpfCutoffHz = 6_000
+        return params
+    }
+
+    // The analytic curve matches the gain a steady tone actually gets through
+    // head bump and HF loss once the smoothers have settled.
+    func testMatchesMeasuredToneGain() throws {
+        let params = linearParams()
+        let response = try XCTUnwrap(settledDSP(params).frequencyResponse(at: frequencies))
+
+        for (index, frequency) in frequencies.enumerated() {
+            var input = [Float](repeating: 0, count: 48_000)
+            for i in input.indices { input[i] = 0.01 * sinf(2 * Float.pi * frequency * Float(i) / sampleRate) }
+            var bumped = [Float](repeating: 0, count: input.count)
+            var output = [Float](repeating: 0, count: input.count)
+            porta_test_head_bump(input, &bumped, Int32(input.count), sampleRate, params.headBumpGainDb,
+                                 params.headBumpFreqHz)
+            porta_test_apply_hf_loss(bumped, &output, Int32(input.count), 1, sampleRate, params.lpfCutoffHz)
+
+            let tail = 24_000..<48_000
+            let inRms = sqrtf(input[tail].reduce(0) { $0 + $1 * $1 } / Float(tail.count))
+            let outRms = sqrtf(output[tail].reduce(0) { $0 + $1 * $1 } / Float(tail.count))
+            XCTAssertEqual(response.magnitudeDb[index], 20 * log10f(outRms / inRms), accuracy: 0.05,
+                           "At \(frequency) Hz")
+        }
+    }
+
+    func testFlatWhenToneStagesAreNeutral() throws {
+        var params = PortaDSP.Params()
+        params.headBumpGainDb = 0
+        params.lpfCutoffHz = 24_000
+        let response = try XCTUnwrap(settledDSP(params).frequencyResponse(at: frequencies))
+        for value in response.magnitudeDb {
+            XCTAssertEqual(value, 0, accuracy: 1e-3)
+        }
+        for value in response.phaseRadians {
+            XCTAssertEqual(value, 0, accuracy: 1e-3)
+        }
+    }
+}
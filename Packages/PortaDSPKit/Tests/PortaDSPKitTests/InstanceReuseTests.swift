@@ -0,0 +1,105 @@
+import XCTest
+import PortaDSPBridge
+@testable import PortaDSPKit
+
+final class InstanceReuseTests: XCTestCase {
+    private let channels = 4
+
+    private func makeParams() -> PortaDSP.Params {
+        var params = PortaDSP.Params()
+        params.wowDepth = 0.003
+        params.flutterDepth = 0.002
+        params.headBumpGainDb = 4
+        params.satDriveDb = 8
+        params.hissLevelDbFS = -50
+        params.lpfCutoffHz = 9_000
+        params.azimuthJitterMs = 0.4
+        params.crosstalkDb = -40
+        params.dropoutRatePerMin = 300
+        return params
+    }
+
+    private func render(_ dsp: PortaDSP, frames: Int, channels: Int, phase: Float) -> [Float] {
+        var output: [Float] = []
+        var block = [Float](repeating: 0, count: 256 * channels)
+        var frame = 0
+        while frame < frames {
+            let count = min(256, frames - frame)
+            for i in 0..<count {
+                for c in 0..<channels {
+                    block[i * channels + c] = 0.4 * sinf(0.01 * Float(frame + i) * Float(c + 1) + phase)
+                }
+            }
+            dsp.processInterleaved(buffer: &block, frames: count, channels: channels)
+            output.append(contentsOf: block[0..<(count * channels)])
+            frame += count
+        }
+        return output
+    }
+
+    private func freshRender(sampleRate: Double, maxBlock: Int, tracks: Int, frames: Int) -> [Float] {
+        let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: maxBlock, tracks: tracks)
+        dsp.update(makeParams())
+        return render(dsp, frames: frames, channels: tracks, phase: 0)
+    }
+
+    // After a reset every stage, down to the smoothers and the random
+    // streams, starts over, so the output matches a new instance exactly.
+    func testResetMatchesNewInstance() {
+        let reference = freshRender(sampleRate: 48_000, maxBlock: 256, tracks: channels, frames: 48_000)
+
+        let dsp = PortaDSP(sampleRate: 48_000, maxBlock: 256, tracks: channels)
+        dsp.update(makeParams())
+        _ = render(dsp, frames: 30_000, channels: channels, phase: 1.3)
+        let footprint = dsp.memoryFootprint
+        dsp.reset()
+
+        XCTAssertEqual(render(dsp, frames: 48_000, channels: channels, phase: 0), reference)
+        XCTAssertEqual(dsp.memoryFootprint, footprint, "Reset must not reallocate")
+    }
+
+    func testReconfigureMatchesNewInstance() {
+        let reference = freshRender(sampleRate: 44_100, maxBlock: 512, tracks: 8, frames: 30_000)
+
+        let dsp = PortaDSP(sampleRate: 48_000, maxBlock: 256, tracks: channels)
+        dsp.update(makeParams())
+        _ = render(dsp, frames: 20_000, channels: channels, phase: 0.7)
+        XCTAssertTrue(dsp.reconfigure(sampleRate: 44_100, maxBlock: 512, tracks: 8))
+
+        XCTAssertEqual(render(dsp, frames: 30_000, channels: 8, phase: 0), reference)
+    }
+
+    // A pooled instance comes back with default settings, not the ones the
+    // previous user left behind.
+    func testPooledInstanceBehavesLikeNewOne() {
+        let pool = PortaDSPPool(maxIdle: 2)
+        do {
+            let used = pool.acquire(sampleRate: 48_000, maxBlock: 256, tracks: channels)
+            used.update(makeParams())
+            used.setSaturationOversampling(4)
+            _ = render(used, frames: 10_000, channels: channels, phase: 2.1)
+        }
+
+        let recycled = pool.acquire(sampleRate: 48_000, maxBlock: 256, tracks: channels)
+        XCTAssertEqual(recycled.saturationLatencySamples, 0)
+        recycled.update(makeParams())
+
+        let reference = freshRender(sampleRate: 48_000, maxBlock: 256, tracks: channels, frames: 24_000)
+        XCTAssertEqual(render(recycled, frames: 24_000, channels: channels, phase: 0), reference)
+    }
+
+    // Requests are clamped before they are matched, so an out-of-range track
+    // count finds the idle handle it created rather than reconfiguring another.
+    func testPoolMatchesClampedLayout() {
+        let pool = porta_pool_create(2)
+        defer { porta_pool_destroy(pool) }
+        let wide = porta_pool_acquire(pool, 48_000, 256, PORTA_MAX_TRACKS + 36)
+        let other = porta_pool_acquire(pool, 44_100, 512, 2)
+        porta_pool_release(pool, wide)
+        porta_pool_release(pool, other)
+
+        let again = porta_pool_acquire(pool, 48_000, 256, PORTA_MAX_TRACKS + 36)
+        XCTAssertEqual(again, wide)
+        porta_pool_release(pool, again)
+    }
+}
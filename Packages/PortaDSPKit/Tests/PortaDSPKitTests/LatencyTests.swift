@@ -0,0 +1,48 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class LatencyTests: XCTestCase {
+    private let sampleRate: Double = 48_000
+
+    /// Index of the output peak relative to an impulse at frame 10 on both tracks.
+    private func impulseDelay(_ dsp: PortaDSP, frames: Int) -> Int {
+        var buffer = [Float](repeating: 0, count: frames * 2)
+        buffer[20] = 0.01
+        buffer[21] = 0.01
+        dsp.processInterleaved(buffer: &buffer, frames: frames, channels: 2)
+        let left = stride(from: 0, to: buffer.count, by: 2).map { abs(buffer[$0]) }
+        let peak = left.indices.max { left[$0] < left[$1] } ?? 0
+        return peak - 10
+    }
+
+    func testReportedLatencyMatchesImpulseResponse() {
+        let frames = 2_048
+        for (oversampling, lowLatency, jitterMs) in [(1, false, Float(0)), (1, true, Float(0)), (2, true, Float(0.2)), (8, false, Float(0.2))] {
+            let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: 2)
+            var params = PortaDSP.Params.linear()
+            params.azimuthJitterMs = jitterMs
+            dsp.update(params)
+            dsp.setSaturationOversampling(oversampling)
+            dsp.setLowLatencyMode(lowLatency)
+
+            XCTAssertEqual(impulseDelay(dsp, frames: frames), dsp.latencySamples,
+                           "oversampling \(oversampling), low latency \(lowLatency), jitter \(jitterMs) ms")
+        }
+    }
+
+    func testLowLatencyModeRemovesFixedWowFlutterDelay() {
+        let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: 512, tracks: 2)
+        dsp.update(PortaDSP.Params())
+        let standard = dsp.latencySamples
+        XCTAssertGreaterThan(standard, Int(0.015 * sampleRate), "The default read head sits ~17 ms into the delay line")
+
+        dsp.setLowLatencyMode(true)
+        let low = dsp.latencySamples
+        XCTAssertLessThan(low, Int(0.001 * sampleRate))
+
+        var deeper = PortaDSP.Params()
+        deeper.wowDepth = 0.01
+        dsp.update(deeper)
+        XCTAssertGreaterThan(dsp.latencySamples, low, "Low-latency delay grows with the modulation depth")
+    }
+}
@@ -28,6 +28,115 @@ final class ModuleDSPTests: XCTestCase {
         XCTAssertGreaterThan(trims[0], 0)
     }
 
+    // The trim comes from a table generated ahead of time; at its grid points it
+    // must equal the make-up gain that restores a full-scale sine's RMS.
+    func testSaturationTrimTableMatchesSineRmsCompensation() {
+        let step: Float = 100.0 / 63.0
+        for index in [10, 42, 50, 60] {
+            let driveDb = -60.0 + step * Float(index)
+            let driveLinear = powf(10.0, driveDb / 20.0)
+
+            let samples = 2_048
+            var acc = 0.0
+            for n in 0..<samples {
+                let y = tanh(Double(driveLinear) * sin(2.0 * Double.pi * (Double(n) + 0.5) / Double(samples)))
+                acc += y * y
+            }
+            let expected = Float(0.5.squareRoot() / (acc / Double(samples)).squareRoot())
+
+            let trim = porta_test_saturation(0.5, driveDb) / tanhf(driveLinear * 0.5)
+            XCTAssertEqual(trim, expected, accuracy: expected * 1e-4, "drive \(driveDb) dB")
+        }
+    }
+
+    // The compander reads its gain curve from a shared table indexed by the
+    // float exponent; across the detector range it must track the exact
+    // log/pow curve to well under a thousandth of a dB.
+    func testCompanderGainTableMatchesExactCurve() {
+        var levelDb: Float = -110
+        while levelDb <= 30 {
+            let envelope = powf(10, levelDb / 20)
+            let exact = porta_test_compander_gain(envelope, 0)
+            let table = porta_test_compander_gain(envelope, 1)
+            XCTAssertEqual(20 * log10f(table / exact), 0, accuracy: 1e-4, "level \(levelDb) dB")
+            levelDb += 0.37
+        }
+    }
+
+    // Head-bump designs are interpolated from a shared per-rate table. Above
+    // 200 Hz, where float coefficients resolve the response, the table must
+    // track the exact design to about a hundredth of a dB; lower down both
+    // are limited by float rounding, and the table must be no worse.
+    func testHeadBumpTableMatchesExactDesign() {
+        func design(_ sampleRate: Float, _ freqHz: Float, _ gainDb: Float, table: Bool) -> [Double] {
+            var c = [Float](repeating: 0, count: 5)
+            porta_test_head_bump_design(sampleRate, freqHz, gainDb, table ? 1 : 0, &c)
+            return c.map(Double.init)
+        }
+        func magnitudeDb(_ c: [Double], at freqHz: Double, sampleRate: Double) -> Double {
+            let w = 2 * Double.pi * freqHz / sampleRate
+            func power(_ x0: Double, _ x1: Double, _ x2: Double) -> Double {
+                let re = x0 + x1 * cos(w) + x2 * cos(2 * w)
+                let im = x1 * sin(w) + x2 * sin(2 * w)
+                return re * re + im * im
+            }
+            return 10 * log10(power(c[0], c[1], c[2]) / power(1, c[3], c[4]))
+        }
+        func reference(_ sampleRate: Double, _ freqHz: Double, _ gainDb: Double) -> [Double] {
+            let w = 2 * Double.pi * freqHz / sampleRate
+            let alpha = sin(w) / 2.8
+            let a = pow(10, gainDb / 40)
+            let a0 = 1 + alpha / a
+            return [(1 + alpha * a) / a0, -2 * cos(w) / a0, (1 - alpha * a) / a0, -2 * cos(w) / a0, (1 - alpha / a) / a0]
+        }
+
+        for sampleRate: Float in [44_100, 48_000, 96_000] {
+            // A live handle holds the rate's table, so the helper does not rebuild it per call.
+            let handle = porta_create(Double(sampleRate), 64, 2)
+            defer { porta_destroy(handle) }
+            var worstTable = 0.0
+            var worstExact = 0.0
+            var freqHz: Float = 20
+            while freqHz < 0.45 * sampleRate {
+                var gainDb: Float = -12
+                while gainDb <= 12 {
+                    let table = design(sampleRate, freqHz, gainDb, table: true)
+                    let exact = design(sampleRate, freqHz, gainDb, table: false)
+                    let ideal = reference(Double(sampleRate), Double(freqHz), Double(gainDb))
+                    for probe in [0.5, 1, 2].map({ Double(freqHz) * $0 }) where probe < 0.49 * Double(sampleRate) {
+                        let expected = magnitudeDb(ideal, at: probe, sampleRate: Double(sampleRate))
+                        let tableError = abs(magnitudeDb(table, at: probe, sampleRate: Double(sampleRate)) - expected)
+                        let exactError = abs(magnitudeDb(exact, at: probe, sampleRate: Double(sampleRate)) - expected)
+                        if freqHz >= 200 {
+                            XCTAssertLessThan(tableError, 0.02, "\(sampleRate) Hz: \(freqHz) Hz, \(gainDb) dB")
+                        } else {
+                            worstTable = max(worstTable, tableError)
+                            worstExact = max(worstExact, exactError)
+                        }
+                    }
+                    gainDb += 0.7
+                }
+                freqHz *= 1.12
+            }
+            XCTAssertLessThanOrEqual(worstTable, worstExact, "\(sampleRate) Hz below 200 Hz")
+        }
+    }
+
+    // Interpolated or not, at any rate and for any setting, the design keeps
+    // both poles inside the unit circle.
+    func testHeadBumpDesignIsAlwaysStable() {
+        for sampleRate: Float in [8_000, 48_000, 192_000, 384_000] {
+            for freqHz: Float in [0, 1, 10, 20, 80, 200, 0.45 * sampleRate, 1e6, .nan] {
+                for gainDb: Float in [-40, -12, -3, 0, 0.5, 12, 40, .nan] {
+                    var c = [Float](repeating: 0, count: 5)
+                    porta_test_head_bump_design(sampleRate, freqHz, gainDb, 1, &c)
+                    XCTAssertLessThan(abs(c[4]), 1, "\(sampleRate) Hz: \(freqHz) Hz, \(gainDb) dB")
+                    XCTAssertLessThan(abs(c[3]), 1 + c[4], "\(sampleRate) Hz: \(freqHz) Hz, \(gainDb) dB")
+                }
+            }
+        }
+    }
+
     // The head-bump filter ramps its biquad coefficients from unity toward the
     // target over ~20 ms, so its response to the very first sample is essentially
     // unity; the resonant boost accrues over subsequent samples (see
@@ -0,0 +1,143 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class MultitrackTests: XCTestCase {
+    private let sampleRate: Double = 48_000
+
+    private func makeTone(frames: Int, channels: Int, activeTracks: Set<Int>) -> [Float] {
+        var buffer = [Float](repeating: 0, count: frames * channels)
+        for frame in 0..<frames {
+            let value = 0.25 * sinf(2.0 * Float.pi * 440.0 * Float(frame) / Float(sampleRate))
+            for track in activeTracks {
+                buffer[frame * channels + track] = value
+            }
+        }
+        return buffer
+    }
+
+    func testTwentyFourTracksProcessAndMeterEveryChannel() {
+        let channels = 24
+        let frames = 512
+        let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels)
+        dsp.update(PortaDSP.Params())
+
+        var buffer = makeTone(frames: frames, channels: channels, activeTracks: Set(0..<channels))
+        dsp.processInterleaved(buffer: &buffer, frames: frames, channels: channels)
+        XCTAssertTrue(buffer.allSatisfy { $0.isFinite })
+
+        let meters = dsp.readMeters(maxChannels: PortaDSP.maxTracks)
+        XCTAssertEqual(meters.count, PortaDSP.maxTracks)
+        for track in 0..<channels {
+            XCTAssertGreaterThan(meters[track], -40.0, "Track \(track) should be metered")
+        }
+        for track in channels..<PortaDSP.maxTracks {
+            XCTAssertEqual(meters[track], -120.0, accuracy: 1.0e-6)
+        }
+    }
+
+    // Crosstalk bleeds only between the two tracks of a pair, so a signal on
+    // track 2 must reach track 3 and leave every other track silent.
+    func testCrosstalkStaysWithinTrackPair() {
+        let channels = 8
+        let frames = 1_024
+        let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels)
+        var params = PortaDSP.Params.linear()
+        params.crosstalkDb = -12
+        dsp.update(params)
+
+        var buffer = makeTone(frames: frames, channels: channels, activeTracks: [2])
+        dsp.processInterleaved(buffer: &buffer, frames: frames, channels: channels)
+
+        func peak(_ track: Int) -> Float {
+            (0..<frames).map { abs(buffer[$0 * channels + track]) }.max() ?? 0
+        }
+
+        XCTAssertGreaterThan(peak(3), 0.01, "Partner track should receive bleed")
+        for track in [0, 1, 4, 5, 6, 7] {
+            XCTAssertEqual(peak(track), 0, accuracy: 1.0e-6, "Track \(track) is outside the pair")
+        }
+    }
+
+    func testNoiseReductionBypassMaskAffectsOnlySelectedTracks() {
+        let channels = 8
+        let frames = 2_048
+        let params = PortaDSP.Params.linear()
+        let input = makeTone(frames: frames, channels: channels, activeTracks: Set(0..<channels))
+
+        let reference = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels)
+        reference.update(params)
+        var expected = input
+        reference.processInterleaved(buffer: &expected, frames: frames, channels: channels)
+
+        let bypassed = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels)
+        bypassed.update(params)
+        bypassed.setNoiseReductionBypassMask(1 << 5)
+        var actual = input
+        bypassed.processInterleaved(buffer: &actual, frames: frames, channels: channels)
+
+        for track in 0..<channels {
+            let differs = (0..<frames).contains { abs(actual[$0 * channels + track] - expected[$0 * channels + track]) > 1.0e-6 }
+            XCTAssertEqual(differs, track == 5, "Only track 5 should change when its NR is bypassed")
+        }
+    }
+
+    func testWorkerThreadsDoNotChangeOutput() {
+        let channels = 24
+        let frames = 256
+        var params = PortaDSP.Params()
+        params.dropoutRatePerMin = 120
+        params.crosstalkDb = -24
+        let input = makeTone(frames: frames, channels: channels, activeTracks: Set(0..<channels))
+
+        let serial = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels)
+        let parallel = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels, workerThreads: 3)
+        serial.update(params)
+        parallel.update(params)
+        serial.setNoiseReductionBypassMask(0b1010_0000)
+        parallel.setNoiseReductionBypassMask(0b1010_0000)
+
+        for _ in 0..<20 {
+            var expected = input
+            var actual = input
+            serial.processInterleaved(buffer: &expected, frames: frames, channels: channels)
+            parallel.processInterleaved(buffer: &actual, frames: frames, channels: channels)
+            XCTAssertEqual(actual, expected)
+        }
+    }
+
+    // The hot loops run fixed-width kernels for 1, 2, 4 and 8 tracks and a
+    // generic one otherwise. Every stage keys its state on the track index, so
+    // the first pair must come out the same whichever kernel rendered it.
+    func testChannelKernelsAgreeAcrossWidths() {
+        let frames = 256
+        var params = PortaDSP.Params()
+        params.satDriveDb = 8
+        params.hissLevelDbFS = -50
+        params.dropoutRatePerMin = 300
+
+        func firstPair(channels: Int) -> [Float] {
+            let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: frames, tracks: channels)
+            dsp.update(params)
+            var output: [Float] = []
+            var buffer = [Float](repeating: 0, count: frames * channels)
+            for block in 0..<40 {
+                for frame in 0..<frames {
+                    for track in 0..<channels {
+                        buffer[frame * channels + track] = 0.4 * sinf(0.01 * Float(block * frames + frame) * Float(track + 1))
+                    }
+                }
+                dsp.processInterleaved(buffer: &buffer, frames: frames, channels: channels)
+                for frame in 0..<frames {
+                    output.append(buffer[frame * channels])
+                    output.append(buffer[frame * channels + 1])
+                }
+            }
+            return output
+        }
+
+        let reference = firstPair(channels: 2)
+        for channels in [3, 4, 5, 8] {
+            XCTAssertEqual(firstPair(channels: channels), reference, "\(channels) tracks")
+        }
+    }
+}
@@ -0,0 +1,84 @@
+import XCTest
+import Foundation
+import PortaDSPBridge
+@testable import PortaDSPKit
+
+final class OversamplingTests: XCTestCase {
+    private let sampleRate: Float = 48_000
+
+    // A hard-driven 15 kHz tone puts its 3rd harmonic at 45 kHz, which folds
+    // back to 3 kHz at the base rate. Oversampling the nonlinearity must push
+    // that alias well below what the 1x path produces.
+    func testOversamplingSuppressesFoldedHarmonic() {
+        let frames = 16_384
+        let input = (0..<frames).map { n in 0.8 * sinf(2.0 * Float.pi * 15_000 * Float(n) / sampleRate) }
+
+        func aliasRelativeDb(oversampling: Int32) -> Double {
+            var output = [Float](repeating: 0, count: frames)
+            input.withUnsafeBufferPointer { inPtr in
+                output.withUnsafeMutableBufferPointer { outPtr in
+                    porta_test_saturation_block(inPtr.baseAddress, outPtr.baseAddress, Int32(frames), sampleRate, 24.0, oversampling)
+                }
+            }
+            let analysis = Array(output[4_096...])
+            let fundamental = tonePower(analysis, frequency: 15_000)
+            let alias = tonePower(analysis, frequency: 3_000)
+            return 10.0 * log10(alias / fundamental)
+        }
+
+        let base = aliasRelativeDb(oversampling: 1)
+        XCTAssertLessThan(aliasRelativeDb(oversampling: 2), base - 12.0)
+        XCTAssertLessThan(aliasRelativeDb(oversampling: 8), base - 20.0)
+    }
+
+    // For a small impulse tanh is effectively linear, so the output peak lands
+    // exactly at the latency the bridge reports for the chosen factor.
+    func testReportedLatencyMatchesImpulsePeak() {
+        let dsp = PortaDSP(sampleRate: Double(sampleRate), maxBlock: 256, tracks: 1)
+        XCTAssertEqual(dsp.saturationLatencySamples, 0)
+
+        for factor in [2, 4, 8] {
+            dsp.setSaturationOversampling(factor)
+            let latency = dsp.saturationLatencySamples
+            XCTAssertGreaterThan(latency, 0)
+
+            let frames = 256
+            var impulse = [Float](repeating: 0, count: frames)
+            impulse[10] = 0.01
+            var output = [Float](repeating: 0, count: frames)
+            impulse.withUnsafeBufferPointer { inPtr in
+                output.withUnsafeMutableBufferPointer { outPtr in
+                    porta_test_saturation_block(inPtr.baseAddress, outPtr.baseAddress, Int32(frames), sampleRate, 6.0, Int32(factor))
+                }
+            }
+            let peakIndex = output.indices.max { abs(output[$0]) < abs(output[$1]) } ?? 0
+            XCTAssertEqual(peakIndex - 10, latency, "Impulse peak should sit at the reported latency for \(factor)x")
+        }
+    }
+
+    func testOversampledChainStaysFinite() {
+        let dsp = PortaDSP(sampleRate: Double(sampleRate), maxBlock: 512, tracks: 2)
+        var params = PortaDSP.Params()
+        params.satDriveDb = 24.0
+        dsp.update(params)
+        dsp.setSaturationOversampling(4)
+
+        var buffer = (0..<(2_048 * 2)).map { n in sinf(Float(n) * 0.05) }
+        dsp.processInterleaved(buffer: &buffer, frames: 2_048, channels: 2)
+        XCTAssertTrue(buffer.allSatisfy { $0.isFinite })
+    }
+
+    private func tonePower(_ signal: [Float], frequency: Double) -> Double {
+        let count = signal.count
+        let omega = 2.0 * Double.pi * frequency / Double(sampleRate)
+        var re = 0.0
+        var im = 0.0
+        for (index, sample) in signal.enumerated() {
+            let window = 0.5 - 0.5 * cos(2.0 * Double.pi * Double(index) / Double(count - 1))
+            let value = Double(sample) * window
+            re += value * cos(omega * Double(index))
+            im += value * sin(omega * Double(index))
+        }
+        return re * re + im * im
+    }
+}
@@ -0,0 +1,79 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class PCMProcessingTests: XCTestCase {
+    private let channels = 2
+    private let frames = 512
+
+    private func makeDSP() -> PortaDSP {
+        let dsp = PortaDSP(sampleRate: 48_000, maxBlock: frames, tracks: channels)
+        var params = PortaDSP.Params()
+        params.satDriveDb = 6
+        dsp.update(params)
+        return dsp
+    }
+
+    private func makeSignal(block: Int) -> [Float] {
+        (0..<(frames * channels)).map { 0.5 * sinf(0.003 * Float(block * frames * channels + $0)) }
+    }
+
+    // Without dither the integer path is the float path rounded to the word
+    // length, give or take a rounding tie.
+    func testInt16MatchesFloatPathWithoutDither() {
+        let floatDSP = makeDSP()
+        let pcmDSP = makeDSP()
+        for block in 0..<20 {
+            var pcm = makeSignal(block: block).map { Int16(($0 * 32_768).rounded()) }
+            var reference = pcm.map { Float($0) / 32_768 }
+            floatDSP.processInterleaved(buffer: &reference, frames: frames, channels: channels)
+            pcmDSP.processInt16(buffer: &pcm, frames: frames, channels: channels, dither: false)
+
+            for (sample, expected) in zip(pcm, reference) {
+                XCTAssertEqual(Float(sample), min(max(expected * 32_768, -32_768), 32_767), accuracy: 1)
+            }
+        }
+    }
+
+    func testInt24RoundTripsPackedSamples() {
+        let floatDSP = makeDSP()
+        let pcmDSP = makeDSP()
+        let input = makeSignal(block: 0).map { Int32(($0 * 8_388_608).rounded()) }
+        var packed = [UInt8]()
+        for value in input {
+            let raw = UInt32(bitPattern: value)
+            packed.append(contentsOf: [UInt8(raw & 0xFF), UInt8((raw >> 8) & 0xFF), UInt8((raw >> 16) & 0xFF)])
+        }
+        var reference = input.map { Float($0) / 8_388_608 }
+        floatDSP.processInterleaved(buffer: &reference, frames: frames, channels: channels)
+        pcmDSP.processInt24(buffer: &packed, frames: frames, channels: channels, dither: false)
+
+        for i in 0..<input.count {
+            let raw = UInt32(packed[3 * i]) | UInt32(packed[3 * i + 1]) << 8 | UInt32(packed[3 * i + 2]) << 16
+            let sample = Int32(bitPattern: raw << 8) >> 8
+            XCTAssertEqual(Float(sample), reference[i] * 8_388_608, accuracy: 1)
+        }
+    }
+
+    // TPDF dither spans +-1 LSB, so after rounding each sample is within
+    // 1.5 LSB of the unquantised value and the error averages out to zero.
+    func testDitherIsBoundedAndUnbiased() {
+        let floatDSP = makeDSP()
+        let pcmDSP = makeDSP()
+        var errorSum = 0.0
+        var count = 0
+        for block in 0..<20 {
+            var pcm = makeSignal(block: block).map { Int16(($0 * 32_768).rounded()) }
+            var reference = pcm.map { Float($0) / 32_768 }
+            floatDSP.processInterleaved(buffer: &reference, frames: frames, channels: channels)
+            pcmDSP.processInt16(buffer: &pcm, frames: frames, channels: channels, dither: true)
+
+            for (sample, expected) in zip(pcm, reference) {
+                let error = Double(sample) - Double(expected) * 32_768
+                XCTAssertLessThanOrEqual(abs(error), 1.5 + 1e-3)
+                errorSum += error
+                count += 1
+            }
+        }
+        XCTAssertEqual(errorSum / Double(count), 0, accuracy: 0.02)
+    }
+}
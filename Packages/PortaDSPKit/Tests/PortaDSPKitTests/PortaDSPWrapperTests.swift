@@ -47,6 +47,34 @@ final class PortaDSPWrapperTests: XCTestCase {
         XCTAssertTrue(processedDiffersFromInput, "Processing should alter at least one sample")
     }
 
+    // All state is carved from the block sized at creation, so processing the
+    // configured layout must not grow the footprint.
+    func testMemoryFootprintIsFixedAtCreation() {
+        let small = PortaDSP(sampleRate: sampleRate, maxBlock: 512, tracks: 2)
+        let dsp = PortaDSP(sampleRate: sampleRate, maxBlock: 512, tracks: 8)
+        let footprint = dsp.memoryFootprint
+        XCTAssertGreaterThan(small.memoryFootprint, 0)
+        XCTAssertGreaterThan(footprint, small.memoryFootprint)
+
+        var buffer = makeTestBuffer(frames: 512, channels: 8)
+        for _ in 0..<8 {
+            dsp.processInterleaved(buffer: &buffer, frames: 512, channels: 8)
+        }
+        XCTAssertEqual(dsp.memoryFootprint, footprint)
+    }
+
+    // Lookup tables are built once per configuration and shared, so more
+    // instances do not add to them.
+    func testSharedTablesDoNotGrowWithInstanceCount() {
+        let first = PortaDSP(sampleRate: sampleRate, maxBlock: 512, tracks: 2)
+        let shared = PortaDSP.sharedTableBytes
+        XCTAssertGreaterThan(shared, 0)
+
+        let more = (0..<16).map { _ in PortaDSP(sampleRate: sampleRate, maxBlock: 512, tracks: 8) }
+        XCTAssertEqual(PortaDSP.sharedTableBytes, shared)
+        withExtendedLifetime((first, more)) {}
+    }
+
     func testReadMetersReportsChannelRMS() {
         let frames = 48
         let channels = 2
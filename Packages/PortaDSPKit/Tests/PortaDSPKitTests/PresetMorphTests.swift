@@ -0,0 +1,148 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class PresetMorphTests: XCTestCase {
+    private let tracks = 2
+    private let block = 256
+
+    /// Two presets apart in every stage, without the random parts, so renders compare sample by sample.
+    private var presetA: PortaDSP.Params {
+        var params = PortaDSP.Params()
+        params.wowDepth = 0.0005
+        params.flutterDepth = 0.00025
+        params.headBumpGainDb = 1.5
+        params.headBumpFreqHz = 85
+        params.satDriveDb = -5
+        params.hissLevelDbFS = -120
+        params.lpfCutoffHz = 13_500
+        params.azimuthJitterMs = 0.16
+        params.crosstalkDb = -68
+        params.dropoutRatePerMin = 0
+        return params
+    }
+
+    private var presetB: PortaDSP.Params {
+        var params = presetA
+        params.wowDepth = 0.0014
+        params.flutterDepth = 0.0008
+        params.headBumpGainDb = 2
+        params.headBumpFreqHz = 75
+        params.satDriveDb = -1
+        params.lpfCutoffHz = 9_800
+        params.azimuthJitterMs = 0.4
+        params.crosstalkDb = -52
+        return params
+    }
+
+    private func program(_ i: Int) -> Float {
+        0.3 * sinf(0.0131 * Float(i)) + 0.05 * sinf(0.21 * Float(i))
+    }
+
+    /// Renders `blocks` blocks, calling `control` before each.
+    private func render(_ dsp: PortaDSP, blocks: Int, control: (Int) -> Void = { _ in }) -> [Float] {
+        var output: [Float] = []
+        var buffer = [Float](repeating: 0, count: block * tracks)
+        for b in 0..<blocks {
+            control(b)
+            for i in buffer.indices { buffer[i] = program(b * buffer.count + i) }
+            dsp.processInterleaved(buffer: &buffer, frames: block, channels: tracks)
+            output += buffer
+        }
+        return output
+    }
+
+    private func rendered(_ params: PortaDSP.Params, blocks: Int) -> [Float] {
+        let dsp = PortaDSP(maxBlock: block, tracks: tracks)
+        dsp.update(params)
+        return render(dsp, blocks: blocks)
+    }
+
+    private func maxDifference(_ a: ArraySlice<Float>, _ b: ArraySlice<Float>) -> Float {
+        zip(a, b).reduce(0) { max($0, abs($1.0 - $1.1)) }
+    }
+
+    /// Largest second difference on the left track: a click shows up as a spike well above the program's own.
+    private func roughness(_ x: [Float]) -> Float {
+        let left = stride(from: 0, to: x.count, by: tracks).map { x[$0] }
+        return (2..<left.count).reduce(0) { max($0, abs(left[$1] - 2 * left[$1 - 1] + left[$1 - 2])) }
+    }
+
+    func testEndpointsRenderTheirPresets() {
+        for (position, preset) in [(Float(0), presetA), (Float(1), presetB)] {
+            let dsp = PortaDSP(maxBlock: block, tracks: tracks)
+            dsp.morph(from: presetA, to: presetB, position: position)
+            XCTAssertEqual(render(dsp, blocks: 200), rendered(preset, blocks: 200), "position \(position)")
+        }
+    }
+
+    // Blending in float can miss the far end by an ulp; for the jitter depth
+    // that moves the whole-sample centre, and the render shifts by a sample.
+    func testEndpointsMatchPresetsWithDifferentJitterDepths() {
+        var shallow = presetA
+        shallow.azimuthJitterMs = 0.2
+        var deep = presetA
+        deep.azimuthJitterMs = 1.0
+        for (position, preset) in [(Float(0), shallow), (Float(1), deep)] {
+            let dsp = PortaDSP(sampleRate: 48_000, maxBlock: block, tracks: tracks)
+            dsp.morph(from: shallow, to: deep, position: position)
+            let reference = PortaDSP(sampleRate: 48_000, maxBlock: block, tracks: tracks)
+            reference.update(preset)
+            XCTAssertEqual(dsp.latencySamples, reference.latencySamples, "position \(position)")
+            XCTAssertEqual(render(dsp, blocks: 200), render(reference, blocks: 200), "position \(position)")
+        }
+    }
+
+    func testSweepingThePositionIsClickFree() {
+        let blocks = 800
+        let dsp = PortaDSP(maxBlock: block, tracks: tracks)
+        var footprint = 0
+        let swept = render(dsp, blocks: blocks) { b in
+            dsp.morph(from: self.presetA, to: self.presetB, position: min(1, Float(b) / Float(blocks / 2)))
+            if b == 1 { footprint = dsp.memoryFootprint }
+        }
+        let limit = max(roughness(rendered(presetA, blocks: blocks)), roughness(rendered(presetB, blocks: blocks)))
+        XCTAssertLessThan(roughness(swept), 1.1 * limit)
+        XCTAssertEqual(dsp.memoryFootprint, footprint, "Sweeping a compiled pair must not reallocate")
+    }
+
+    func testNewPairDoesNotReallocateOnTheAudioThread() {
+        let dsp = PortaDSP(maxBlock: block, tracks: tracks)
+        dsp.update(presetA)
+        _ = render(dsp, blocks: 1)
+        let footprint = dsp.memoryFootprint
+
+        // The deepest jitter the bridge allows, then one beyond it that is clamped.
+        for jitterMs: Float in [2, 50] {
+            var deeper = presetB
+            deeper.azimuthJitterMs = jitterMs
+            dsp.morph(from: presetA, to: deeper, position: 1)
+            _ = render(dsp, blocks: 1)
+            XCTAssertEqual(dsp.memoryFootprint, footprint, "\(jitterMs) ms")
+        }
+    }
+
+    func testJumpingThePositionGlides() {
+        let blocks = 400
+        let dsp = PortaDSP(maxBlock: block, tracks: tracks)
+        let jumped = render(dsp, blocks: blocks) { b in
+            dsp.morph(from: self.presetA, to: self.presetB, position: b < blocks / 2 ? 0 : 1)
+        }
+        let limit = max(roughness(rendered(presetA, blocks: blocks)), roughness(rendered(presetB, blocks: blocks)))
+        // Switching with update(_:) instead nearly triples the roughness at the jump.
+        XCTAssertLessThan(roughness(jumped), 1.2 * limit)
+        // The glide settles well within half a second of the jump.
+        let settled = (blocks / 2 + 100) * block * tracks
+        XCTAssertLessThan(maxDifference(jumped[settled...], rendered(presetB, blocks: blocks)[settled...]), 1e-3)
+    }
+
+    func testUpdateEndsTheMorph() {
+        let blocks = 400
+        let dsp = PortaDSP(maxBlock: block, tracks: tracks)
+        let output = render(dsp, blocks: blocks) { b in
+            if b == 0 { dsp.morph(from: self.presetA, to: self.presetB, position: 0.5) }
+            if b == 100 { dsp.update(self.presetB) }
+        }
+        let settled = 300 * block * tracks
+        XCTAssertLessThan(maxDifference(output[settled...], rendered(presetB, blocks: blocks)[settled...]), 1e-3)
+    }
+}
@@ -0,0 +1,119 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class QualityTierTests: XCTestCase {
+    private let tracks = 4
+    private let block = 512
+
+    /// Default chain driven harder, without the random parts, so tiers can be compared sample by sample.
+    private var quietParams: PortaDSP.Params {
+        var params = PortaDSP.Params()
+        params.satDriveDb = 6
+        params.hissLevelDbFS = -120
+        params.dropoutRatePerMin = 0
+        return params
+    }
+
+    private func render(_ dsp: PortaDSP, blocks: Int, input: (Int) -> Float) -> [Float] {
+        var output: [Float] = []
+        var buffer = [Float](repeating: 0, count: block * tracks)
+        for b in 0..<blocks {
+            for i in buffer.indices { buffer[i] = input(b * buffer.count + i) }
+            dsp.processInterleaved(buffer: &buffer, frames: block, channels: tracks)
+            output += buffer
+        }
+        return output
+    }
+
+    private func program(_ i: Int) -> Float {
+        0.3 * sinf(0.0031 * Float(i)) + 0.1 * sinf(0.117 * Float(i))
+    }
+
+    private func maxDifference(_ a: [Float], _ b: [Float]) -> Float {
+        zip(a, b).reduce(0) { max($0, abs($1.0 - $1.1)) }
+    }
+
+    private func rmsDb(_ x: ArraySlice<Float>) -> Float {
+        10 * log10f(x.reduce(0) { $0 + $1 * $1 } / Float(x.count))
+    }
+
+    func testDefaultsToHighAndReportsTheRequestedTier() {
+        let dsp = PortaDSP(tracks: tracks)
+        XCTAssertEqual(dsp.qualityState, PortaDSP.QualityState())
+        dsp.setQuality(.eco)
+        XCTAssertEqual(dsp.qualityState.quality, .eco)
+        XCTAssertEqual(dsp.qualityState.smoothedLoad, 0)
+    }
+
+    func testCheaperTiersStayCloseToHigh() {
+        func renderAt(_ quality: PortaDSP.Quality) -> [Float] {
+            let dsp = PortaDSP(tracks: tracks)
+            dsp.update(quietParams)
+            dsp.setQuality(quality)
+            return render(dsp, blocks: 60, input: program)
+        }
+        let high = renderAt(.high)
+        // Standard: table tanh and control-rate modulation, ~-80 dB, mostly the head bump's own rounding.
+        XCTAssertLessThan(maxDifference(renderAt(.standard), high), 5e-4)
+        // Eco: the compander gain lags by up to 16 frames on transients, ~-60 dB.
+        XCTAssertLessThan(maxDifference(renderAt(.eco), high), 3e-3)
+    }
+
+    func testSwitchingTiersWhileRunningIsContinuous() {
+        let dsp = PortaDSP(tracks: tracks)
+        dsp.update(quietParams)
+        let high = PortaDSP(tracks: tracks)
+        high.update(quietParams)
+        var switched: [Float] = []
+        var buffer = [Float](repeating: 0, count: block * tracks)
+        let tiers: [PortaDSP.Quality] = [.high, .eco, .standard, .high, .standard, .eco]
+        for b in 0..<60 {
+            dsp.setQuality(tiers[(b / 2) % tiers.count])
+            for i in buffer.indices { buffer[i] = program(b * buffer.count + i) }
+            dsp.processInterleaved(buffer: &buffer, frames: block, channels: tracks)
+            switched += buffer
+        }
+        XCTAssertLessThan(maxDifference(switched, render(high, blocks: 60, input: program)), 3e-3)
+    }
+
+    func testEcoHissKeepsItsLevelAndSeeksExactly() {
+        let params = PortaDSP.Params.linear(hissLevelDbFS: -40)
+        func hiss(_ quality: PortaDSP.Quality, from position: Int) -> [Float] {
+            let dsp = PortaDSP(maxBlock: 256, tracks: 2)
+            dsp.update(params)
+            dsp.setLowLatencyMode(true)
+            dsp.setNoiseReductionBypassMask(~0)
+            dsp.setQuality(quality)
+            dsp.setPosition(Int64(position))
+            var output: [Float] = []
+            var buffer = [Float](repeating: 0, count: 256 * 2)
+            for _ in stride(from: position, to: 96_000, by: 256) {
+                for i in buffer.indices { buffer[i] = 0 }
+                dsp.processInterleaved(buffer: &buffer, frames: 256, channels: 2)
+                output += buffer
+            }
+            return output
+        }
+        let eco = hiss(.eco, from: 0)
+        XCTAssertEqual(rmsDb(eco[...]), rmsDb(hiss(.high, from: 0)[...]), accuracy: 0.2)
+
+        // An odd position lands between two half-rate draws and still matches the unbroken render.
+        let position = 48_301
+        let sought = hiss(.eco, from: position)
+        XCTAssertEqual(Array(sought.prefix(eco.count - position * 2)), Array(eco[(position * 2)...]))
+    }
+
+    func testGovernorTracksLoadAndStaysUnderTheCeiling() {
+        let dsp = PortaDSP(tracks: tracks)
+        dsp.setQuality(.standard)
+        dsp.setQualityGovernor(true)
+        _ = render(dsp, blocks: 20, input: program)
+        let state = dsp.qualityState
+        XCTAssertGreaterThan(state.smoothedLoad, 0)
+        XCTAssertLessThanOrEqual(state.quality, .standard)
+
+        dsp.setQualityGovernor(false)
+        XCTAssertEqual(dsp.qualityState.quality, .standard)
+        XCTAssertEqual(dsp.qualityState.smoothedLoad, 0)
+    }
+}
@@ -0,0 +1,114 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class SampleRateConverterTests: XCTestCase {
+    private var directory: URL!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    /// 1 kHz left, 5 kHz right, at `time` seconds.
+    private func tone(_ time: Double) -> (Float, Float) {
+        (Float(0.5 * sin(2 * Double.pi * 1_000 * time)), Float(0.3 * sin(2 * Double.pi * 5_000 * time)))
+    }
+
+    private func interleavedTone(frames: Int, sampleRate: Double) -> [Float] {
+        (0..<frames).flatMap { i -> [Float] in
+            let (l, r) = tone(Double(i) / sampleRate)
+            return [l, r]
+        }
+    }
+
+    /// Converts `input` in uneven blocks, then flushes.
+    private func convert(_ input: [Float], from inRate: Double, to outRate: Double,
+                         quality: PortaSampleRateConverter.Quality) throws -> [Float] {
+        let converter = try XCTUnwrap(PortaSampleRateConverter(from: inRate, to: outRate, channels: 2,
+                                                               maxInputFrames: 1_024, quality: quality))
+        var output: [Float] = []
+        var offset = 0
+        var size = 100
+        while offset < input.count {
+            let end = min(offset + 2 * size, input.count)
+            output += converter.process(Array(input[offset..<end]))
+            offset = end
+            size = size * 7 % 1_000 + 1
+        }
+        return output + converter.flush()
+    }
+
+    /// Signal-to-error ratio in dB against the tone, away from the stream's edges.
+    private func snr(_ output: [Float], sampleRate: Double) -> Double {
+        var signal = 0.0
+        var error = 0.0
+        let frames = output.count / 2
+        for k in 200..<(frames - 200) {
+            let (l, r) = tone(Double(k) / sampleRate)
+            signal += Double(l * l + r * r)
+            error += pow(Double(output[2 * k] - l), 2) + pow(Double(output[2 * k + 1] - r), 2)
+        }
+        return 10 * log10(signal / error)
+    }
+
+    func testLengthAndAccuracyAcrossRatesAndTiers() throws {
+        let expectations: [(PortaSampleRateConverter.Quality, Double)] = [(.eco, 55), (.standard, 85), (.high, 98)]
+        for (inRate, outRate) in [(44_100.0, 48_000.0), (48_000.0, 44_100.0), (48_000.0, 96_000.0), (44_100.0, 47_999.5)] {
+            let frames = Int(inRate / 2) + 17
+            let input = interleavedTone(frames: frames, sampleRate: inRate)
+            for (quality, minimum) in expectations {
+                let output = try convert(input, from: inRate, to: outRate, quality: quality)
+                XCTAssertEqual(output.count / 2, Int((Double(frames) * outRate / inRate).rounded(.up)),
+                               "\(inRate) -> \(outRate)")
+                XCTAssertGreaterThan(snr(output, sampleRate: outRate), minimum, "\(inRate) -> \(outRate) \(quality)")
+            }
+        }
+    }
+
+    func testBlockSizeDoesNotChangeTheOutput() throws {
+        let input = interleavedTone(frames: 10_000, sampleRate: 44_100)
+        let converter = try XCTUnwrap(PortaSampleRateConverter(from: 44_100, to: 48_000, maxInputFrames: 10_000))
+        let whole = converter.process(input) + converter.flush()
+        let pieces = try convert(input, from: 44_100, to: 48_000, quality: .standard)
+        XCTAssertEqual(whole, pieces)
+    }
+
+    func testConvertedFilePlaysOnASessionRateTimeline() throws {
+        // One second of the tone as a stereo 32-bit float WAV at 44.1 kHz.
+        let frames = 44_100
+        var data = Data()
+        func append<T: FixedWidthInteger>(_ x: T) { withUnsafeBytes(of: x.littleEndian) { data.append(contentsOf: $0) } }
+        data.append(contentsOf: Array("RIFF".utf8)); append(UInt32(36 + frames * 8))
+        data.append(contentsOf: Array("WAVEfmt ".utf8)); append(UInt32(16))
+        append(UInt16(3)); append(UInt16(2)); append(UInt32(44_100)); append(UInt32(44_100 * 8))
+        append(UInt16(8)); append(UInt16(32))
+        data.append(contentsOf: Array("data".utf8)); append(UInt32(frames * 8))
+        for sample in interleavedTone(frames: frames, sampleRate: 44_100) { append(sample.bitPattern) }
+        let source = directory.appendingPathComponent("import.wav")
+        try data.write(to: source)
+
+        let timeline = PortaTapeTimeline(sampleRate: 48_000, tracks: 2)
+        XCTAssertEqual(timeline.setRegions([.init(url: source, track: 0, start: 0, duration: 1)]), 0)
+
+        let converted = directory.appendingPathComponent("import-48k.wav")
+        XCTAssertTrue(PortaSampleRateConverter.convertFile(at: source, to: converted, sampleRate: 48_000))
+        XCTAssertFalse(FileManager.default.fileExists(atPath: converted.path + ".partial"))
+        XCTAssertEqual(timeline.setRegions([.init(url: converted, track: 0, start: 0, duration: 1)]), 1)
+
+        // A track plays the take's first channel.
+        var buffer = [Float](repeating: 0, count: 2 * 1_000)
+        timeline.render(position: 20_000, into: &buffer, frames: 1_000)
+        var worst: Float = 0
+        for i in 0..<1_000 {
+            worst = max(worst, abs(buffer[2 * i] - tone(Double(20_000 + i) / 48_000).0))
+        }
+        XCTAssertLessThan(worst, 1e-3)
+
+        XCTAssertFalse(PortaSampleRateConverter.convertFile(at: directory.appendingPathComponent("missing.wav"),
+                                                            to: converted, sampleRate: 48_000))
+    }
+}
@@ -0,0 +1,70 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class SpectrumAnalyzerTests: XCTestCase {
+    private let sampleRate = 48_000
+    private let channels = 2
+    private let blockFrames = 256
+    private let bands = 32
+
+    private func render(_ dsp: PortaDSP, blocks: Int, frequency: Float, startBlock: Int = 0) {
+        var block = [Float](repeating: 0, count: blockFrames * channels)
+        for b in startBlock..<(startBlock + blocks) {
+            for i in 0..<blockFrames {
+                let phase = 2 * Float.pi * frequency * Float(b * blockFrames + i) / Float(sampleRate)
+                block[i * channels] = 0.5 * sinf(phase)
+                block[i * channels + 1] = 0.05 * sinf(phase)
+            }
+            dsp.processInterleaved(buffer: &block, frames: blockFrames, channels: channels)
+        }
+    }
+
+    private func bandRange(_ band: Int) -> ClosedRange<Float> {
+        let ratio = powf(Float(sampleRate / 2) / 20, 1 / Float(bands))
+        return (20 * powf(ratio, Float(band)))...(20 * powf(ratio, Float(band + 1)))
+    }
+
+    func testEnableValidatesSize() {
+        let dsp = PortaDSP(sampleRate: Double(sampleRate), maxBlock: blockFrames, tracks: channels)
+        XCTAssertNil(dsp.readSpectrum(channel: 0, bands: bands))
+        XCTAssertFalse(dsp.enableAnalyzer(fftSize: 1000))
+        XCTAssertFalse(dsp.enableAnalyzer(fftSize: 128))
+        XCTAssertTrue(dsp.enableAnalyzer(fftSize: 4096))
+        XCTAssertTrue(dsp.enableAnalyzer(fftSize: 4096))
+        XCTAssertFalse(dsp.enableAnalyzer(fftSize: 2048))
+        XCTAssertNil(dsp.readSpectrum(channel: 0, bands: bands), "Not enough audio captured yet")
+    }
+
+    // A tone lands in the band that contains it, and the bands of each
+    // channel add up to what the RMS meter reports for the same stretch.
+    func testToneLandsInItsBandAndBandsSumToMeter() throws {
+        let dsp = PortaDSP(sampleRate: Double(sampleRate), maxBlock: blockFrames, tracks: channels)
+        XCTAssertTrue(dsp.enableAnalyzer(fftSize: 4096))
+        render(dsp, blocks: 40, frequency: 1_000)
+        _ = dsp.readMeters(maxChannels: channels)
+        // Exactly one transform's worth of frames since the meters were drained.
+        render(dsp, blocks: 4096 / blockFrames, frequency: 1_000, startBlock: 40)
+        let meters = dsp.readMeters(maxChannels: channels)
+
+        for channel in 0..<channels {
+            let spectrum = try XCTUnwrap(dsp.readSpectrum(channel: channel, bands: bands))
+            XCTAssertEqual(spectrum.count, bands)
+            let peak = spectrum.indices.max { spectrum[$0] < spectrum[$1] }!
+            XCTAssertTrue(bandRange(peak).contains(1_000), "Peak in band \(peak)")
+
+            let total = 10 * log10f(spectrum.reduce(0) { $0 + powf(10, $1 / 10) })
+            XCTAssertEqual(total, meters[channel], accuracy: 0.1)
+        }
+    }
+
+    // Reading is non-destructive: two reads with no audio in between agree.
+    func testReadsDoNotConsumeAudio() throws {
+        let dsp = PortaDSP(sampleRate: Double(sampleRate), maxBlock: blockFrames, tracks: channels)
+        XCTAssertTrue(dsp.enableAnalyzer(fftSize: 1024))
+        render(dsp, blocks: 8, frequency: 440)
+        let first = try XCTUnwrap(dsp.readSpectrum(channel: 1, bands: 16))
+        let second = try XCTUnwrap(dsp.readSpectrum(channel: 1, bands: 16))
+        XCTAssertEqual(first, second)
+        XCTAssertNil(dsp.readSpectrum(channel: channels, bands: 16))
+    }
+}
@@ -0,0 +1,88 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class TapeTimelineReaderTests: XCTestCase {
+    private let sampleRate = 48_000
+    private var directory: URL!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    /// Mono 32-bit float WAV whose frame `i` holds `value(i)`.
+    private func writeTake(_ name: String, frames: Int, value: (Int) -> Float) throws -> URL {
+        var data = Data()
+        func append<T: FixedWidthInteger>(_ x: T) { withUnsafeBytes(of: x.littleEndian) { data.append(contentsOf: $0) } }
+        let payload = frames * 4
+        data.append(contentsOf: Array("RIFF".utf8)); append(UInt32(36 + payload))
+        data.append(contentsOf: Array("WAVEfmt ".utf8)); append(UInt32(16))
+        append(UInt16(3)); append(UInt16(1)); append(UInt32(sampleRate)); append(UInt32(sampleRate * 4))
+        append(UInt16(4)); append(UInt16(32))
+        data.append(contentsOf: Array("data".utf8)); append(UInt32(payload))
+        for i in 0..<frames { append(value(i).bitPattern) }
+        let url = directory.appendingPathComponent(name)
+        try data.write(to: url)
+        return url
+    }
+
+    func testRendersRegionsSampleAccurately() throws {
+        let take = try writeTake("take.wav", frames: 48_000) { Float($0) / 48_000 }
+        let punch = try writeTake("punch.wav", frames: 4_800) { _ in -1 }
+        let timeline = PortaTapeTimeline(sampleRate: Double(sampleRate), tracks: 4)
+        let kept = timeline.setRegions([
+            .init(url: take, track: 1, start: 0.5, duration: 1.0),
+            .init(url: punch, track: 1, start: 0.75, duration: 0.05, gain: 0.5),
+            .init(url: take, track: 3, start: 0, duration: 0.5, fileOffset: 0.25),
+            .init(url: directory.appendingPathComponent("missing.wav"), track: 0, start: 0, duration: 1)
+        ])
+        XCTAssertEqual(kept, 3)
+
+        func expected(_ frame: Int, track: Int) -> Float {
+            switch track {
+            case 1 where (36_000..<38_400).contains(frame): return -0.5
+            case 1 where (24_000..<72_000).contains(frame): return Float(frame - 24_000) / 48_000
+            case 3 where (0..<24_000).contains(frame): return Float(frame + 12_000) / 48_000
+            default: return 0
+            }
+        }
+
+        // Arbitrary, unaligned seeks across every region boundary.
+        var buffer = [Float](repeating: .nan, count: 4 * 333)
+        for position in stride(from: 0, to: 80_000, by: 997) {
+            timeline.render(position: Int64(position), into: &buffer, frames: 333)
+            for frame in 0..<333 {
+                for track in 0..<4 {
+                    XCTAssertEqual(buffer[frame * 4 + track], expected(position + frame, track: track),
+                                   accuracy: 1e-6, "frame \(position + frame) track \(track)")
+                }
+            }
+        }
+    }
+
+    func testReplacingRegionsTakesEffectOnNextRender() throws {
+        let take = try writeTake("take.wav", frames: 4_800) { _ in 0.25 }
+        let timeline = PortaTapeTimeline(sampleRate: Double(sampleRate), tracks: 1)
+        var buffer = [Float](repeating: 0, count: 64)
+        timeline.render(position: 0, into: &buffer, frames: 64)
+        XCTAssertEqual(buffer.max(), 0)
+
+        timeline.setRegions([.init(url: take, track: 0, start: 0, duration: 0.1)])
+        timeline.render(position: 0, into: &buffer, frames: 64)
+        XCTAssertEqual(buffer, [Float](repeating: 0.25, count: 64))
+
+        timeline.setRegions([])
+        timeline.render(position: 0, into: &buffer, frames: 64)
+        XCTAssertEqual(buffer.max(), 0)
+    }
+
+    func testTakesAtAnotherSampleRateAreSkipped() throws {
+        let take = try writeTake("take.wav", frames: 4_800) { _ in 1 }
+        let timeline = PortaTapeTimeline(sampleRate: 44_100, tracks: 1)
+        XCTAssertEqual(timeline.setRegions([.init(url: take, track: 0, start: 0, duration: 0.1)]), 0)
+    }
+}
@@ -16,4 +16,15 @@ extension PortaDSP.Params {
         params.nrTrack4Bypass = false
         return params
     }
+
+    /// zeroed() with crosstalk and the low-pass out of the way and hiss at `hissLevelDbFS`, so the chain
+    /// is close to a plain delay.
+    static func linear(hissLevelDbFS: Float = -120) -> PortaDSP.Params {
+        var params = zeroed()
+        params.hissLevelDbFS = hissLevelDbFS
+        params.crosstalkDb = -120
+        params.lpfCutoffHz = 20_000
+        params.headBumpFreqHz = 80
+        return params
+    }
 }
@@ -0,0 +1,86 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class VarispeedTests: XCTestCase {
+    private let sampleRate = 48_000
+    private let frequency = 440.0
+    private var directory: URL!
+    private var timeline: PortaTapeTimeline!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        // Four seconds of a 440 Hz sine at half scale as a mono 32-bit float WAV.
+        let frames = 4 * sampleRate
+        var data = Data()
+        func append<T: FixedWidthInteger>(_ x: T) { withUnsafeBytes(of: x.littleEndian) { data.append(contentsOf: $0) } }
+        data.append(contentsOf: Array("RIFF".utf8)); append(UInt32(36 + frames * 4))
+        data.append(contentsOf: Array("WAVEfmt ".utf8)); append(UInt32(16))
+        append(UInt16(3)); append(UInt16(1)); append(UInt32(sampleRate)); append(UInt32(sampleRate * 4))
+        append(UInt16(4)); append(UInt16(32))
+        data.append(contentsOf: Array("data".utf8)); append(UInt32(frames * 4))
+        for i in 0..<frames { append(tone(Double(i)).bitPattern) }
+        let url = directory.appendingPathComponent("tone.wav")
+        try data.write(to: url)
+
+        timeline = PortaTapeTimeline(sampleRate: Double(sampleRate), tracks: 2)
+        XCTAssertEqual(timeline.setRegions([.init(url: url, track: 0, start: 0, duration: 4)]), 1)
+        XCTAssertTrue(timeline.prepareVarispeed(maxFrames: 256, quality: .standard))
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    private func tone(_ frame: Double) -> Float {
+        Float(0.5 * sin(2 * Double.pi * frequency * frame / Double(sampleRate)))
+    }
+
+    func testUnitSpeedMatchesPlainPlayback() {
+        var varispeed = [Float](repeating: 0, count: 2 * 1_000)
+        var plain = varispeed
+        let next = timeline.render(position: 1_000, rate: 1, into: &varispeed, frames: 1_000)
+        timeline.render(position: 1_000, into: &plain, frames: 1_000)
+        XCTAssertEqual(next, 2_000, accuracy: 1e-9)
+        for i in 0..<varispeed.count {
+            XCTAssertEqual(varispeed[i], plain[i], accuracy: 1e-5, "sample \(i)")
+        }
+    }
+
+    func testSpeedChangeFollowsTheTapeAndGlides() {
+        // Start at half speed straight after a seek, then glide up to double speed over four blocks.
+        var buffer = [Float](repeating: 0, count: 2 * 256)
+        var position = 10_000.25
+        var expected = position
+        var rate = 0.5
+        for target in [0.5, 0.875, 1.25, 1.625, 2.0] {
+            position = timeline.render(position: position, rate: target, into: &buffer, frames: 256)
+            for i in 0..<256 {
+                XCTAssertEqual(buffer[2 * i], tone(expected), accuracy: 2e-4, "rate \(target) frame \(i)")
+                XCTAssertEqual(buffer[2 * i + 1], 0)
+                expected += rate + (target - rate) * Double(i + 1) / 256
+            }
+            rate = target
+        }
+        XCTAssertEqual(position, expected, accuracy: 1e-6)
+    }
+
+    func testBlockSizeDoesNotChangeTheOutput() {
+        var whole = [Float](repeating: 0, count: 2 * 700)
+        timeline.render(position: 3_000.5, rate: 0.7, into: &whole, frames: 700)
+
+        var pieces = [Float]()
+        var position = 3_000.5
+        for frames in [100, 256, 344] {
+            var block = [Float](repeating: 0, count: 2 * frames)
+            position = timeline.render(position: position, rate: 0.7, into: &block, frames: frames)
+            pieces += block
+        }
+        XCTAssertEqual(pieces.count, whole.count)
+        for i in 0..<whole.count {
+            XCTAssertEqual(pieces[i], whole[i], accuracy: 1e-6, "sample \(i)")
+        }
+        XCTAssertEqual(position, 3_000.5 + 700 * 0.7, accuracy: 1e-6)
+    }
+}
@@ -0,0 +1,93 @@
+import XCTest
+@testable import PortaDSPKit
+
+final class WaveformPeaksTests: XCTestCase {
+    private let sampleRate = 48_000.0
+    private var directory: URL!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    /// Appends `signal` in uneven blocks, the way a recording tap delivers it.
+    private func buildPeaks(of signal: [Float]) -> PortaWaveformPeaks {
+        let peaks = PortaWaveformPeaks(sampleRate: sampleRate)
+        var offset = 0
+        var size = 100
+        while offset < signal.count {
+            let frames = min(size, signal.count - offset)
+            signal.withUnsafeBufferPointer { peaks.append($0.baseAddress! + offset, frames: frames) }
+            offset += frames
+            size = size * 7 % 1_900 + 1
+        }
+        return peaks
+    }
+
+    private func signal(frames: Int) -> [Float] {
+        (0..<frames).map { i in 0.6 * sinf(Float(i) * 0.003) + 0.3 * sinf(Float(i) * 0.71) }
+    }
+
+    func testBinsMatchTheSamplesAtEveryLevel() throws {
+        let samples = signal(frames: 300_000)
+        let peaks = buildPeaks(of: samples)
+        XCTAssertEqual(peaks.frames, 300_000)
+
+        for width in [256, 4_096, 65_536, 3 * 4_096] {
+            let bins = samples.count / width
+            let result = try XCTUnwrap(peaks.bins(0..<Int64(bins * width), bins: bins))
+            for b in 0..<bins {
+                let slice = samples[(b * width)..<((b + 1) * width)]
+                let rms = sqrt(slice.reduce(0) { $0 + Double($1) * Double($1) } / Double(width))
+                XCTAssertEqual(result.min[b], slice.min()!, accuracy: 1e-6)
+                XCTAssertEqual(result.max[b], slice.max()!, accuracy: 1e-6)
+                XCTAssertEqual(Double(result.rms[b]), rms, accuracy: 1e-5, "width \(width) bin \(b)")
+            }
+        }
+    }
+
+    func testOverviewMergesRegionsFromSidecars() throws {
+        let samples = signal(frames: 96_000)
+        let take = directory.appendingPathComponent("take.caf")
+        XCTAssertTrue(buildPeaks(of: samples).save(nextTo: take))
+        XCTAssertTrue(FileManager.default.fileExists(atPath: take.path + ".peaks"))
+
+        // Track 0: the take, with a quieter, inverted punch-in from later in it laid over 24576..<49152.
+        let overview = PortaWaveformOverview(sampleRate: sampleRate, tracks: 2)
+        let kept = overview.setRegions([
+            .init(url: take, track: 0, start: 0, duration: 2),
+            .init(url: take, track: 0, start: 0.512, duration: 0.512, fileOffset: 1.024, gain: -0.5),
+            .init(url: directory.appendingPathComponent("no-sidecar.caf"), track: 1, start: 0, duration: 1)
+        ])
+        XCTAssertEqual(kept, 2)
+
+        func timeline(_ frame: Int) -> Float {
+            switch frame {
+            case 24_576..<49_152: return -0.5 * samples[frame + 24_576]
+            case 0..<96_000: return samples[frame]
+            default: return 0
+            }
+        }
+
+        // 4096-frame bins over 3 s: bin and region edges line up with the take's bins, so only the
+        // sidecar's 16-bit quantisation is left.
+        let width = 4_096
+        let bins = 144_000 / width
+        let result = try XCTUnwrap(overview.bins(track: 0, 0..<Int64(bins * width), bins: bins))
+        let tolerance: Float = 2.0 / 32_767 // sidecar quantisation
+        for b in 0..<bins {
+            let slice = ((b * width)..<((b + 1) * width)).map(timeline)
+            let rms = sqrt(slice.reduce(0) { $0 + Double($1) * Double($1) } / Double(width))
+            XCTAssertEqual(result.min[b], slice.min()!, accuracy: tolerance, "bin \(b)")
+            XCTAssertEqual(result.max[b], slice.max()!, accuracy: tolerance, "bin \(b)")
+            XCTAssertEqual(Double(result.rms[b]), rms, accuracy: 1e-4, "bin \(b)")
+        }
+
+        let silent = try XCTUnwrap(overview.bins(track: 1, 0..<48_000, bins: 10))
+        XCTAssertEqual(silent.max, [Float](repeating: 0, count: 10))
+    }
+}
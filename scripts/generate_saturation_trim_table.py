@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Regenerate the saturation make-up gain table used by the DSP bridge.
+
+For each drive setting the table holds rms(sine) / rms(tanh(drive * sine)),
+the trim that brings a full-scale sine back to its original RMS after the
+tanh stage. Drive values are computed in float32, as the bridge does.
+
+Usage:
+    python3 scripts/generate_saturation_trim_table.py > \\
+        Packages/PortaDSPKit/Sources/PortaDSPBridge/saturation_trim_table.h
+"""
+
+import math
+import struct
+
+TABLE_SIZE = 64
+MIN_DB = -60.0
+MAX_DB = 40.0
+SINE_SAMPLES = 2048
+
+
+def f32(value):
+    return struct.unpack("f", struct.pack("f", value))[0]
+
+
+def trim_for(linear):
+    omega = 2.0 * math.pi / SINE_SAMPLES
+    acc = 0.0
+    for n in range(SINE_SAMPLES):
+        y = math.tanh(linear * math.sin(omega * (n + 0.5)))
+        acc += y * y
+    rms_out = math.sqrt(acc / SINE_SAMPLES)
+    rms_in = 0.7071067811865476
+    return rms_in / rms_out if rms_out > 1e-12 else 1.0
+
+
+def main():
+    step = f32((MAX_DB - MIN_DB) / (TABLE_SIZE - 1))
+    values = []
+    for i in range(TABLE_SIZE):
+        db = f32(MIN_DB + f32(step * i))
+        linear = f32(10.0 ** f32(db / 20.0))
+        values.append(f32(trim_for(linear)))
+
+    print("#pragma once")
+    print()
+    print("// Generated by scripts/generate_saturation_trim_table.py; do not edit.")
+    print("//")
+    print("// Make-up gain that restores the RMS of a full-scale sine after tanh() at a")
+    print("// drive of kSaturationTrimMinDb + i * (range / (size - 1)) dB.")
+    print()
+    print(f"constexpr int kSaturationTrimTableSize = {TABLE_SIZE};")
+    print(f"constexpr float kSaturationTrimMinDb = {MIN_DB:.1f}f;")
+    print(f"constexpr float kSaturationTrimMaxDb = {MAX_DB:.1f}f;")
+    print("constexpr float kSaturationTrimTable[kSaturationTrimTableSize] = {")
+    for row in range(0, TABLE_SIZE, 4):
+        cells = ", ".join(f"{v:.9g}f" for v in values[row:row + 4])
+        print(f"    {cells},")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()